@@ -29,6 +29,7 @@
 // Globals
 unsigned long timer;
 void (*current_loop)(void);
+motion_program_t motion_program;
 
 // Function Declarations
 void main_loop(void);
@@ -80,6 +81,10 @@ void setup() {
   // Initialize Strategy subsystem
   initializeStrategy();
 
+  // Initialize Movement subsystem
+  initializeMovement(&robot_location);
+  startStreamedProgram(&motion_program, &robot_location);
+
   // Initialize Control subsystem
   initializeControl();
 
@@ -153,6 +158,10 @@ void main_loop(void) {
     printLocalizeMeasure();
   #endif
 
+  #ifdef DEBUG_MOTORS
+    printMotorLog();
+  #endif
+
 }
 
 void movement_loop(void) {
@@ -161,10 +170,7 @@ void movement_loop(void) {
   static double right_distance;
   static double left_speed;
   static double right_speed;
-  static gaussian_location_t next_location = {
-      .x_mu = 264.0,
-      .y_mu = 264.0
-  };
+  static waypoints_t waypoints;
 
   // Heartbeat
   toggleLED(2);
@@ -179,15 +185,20 @@ void movement_loop(void) {
     printLocalizeMotion();
   #endif
 
-  // Determine next cell to go to (strategy step)
-  strategy(&robot_location, &robot_maze_state, &next_location);
+  // Determine the next cells to go to (strategy step)
+  strategyLookahead(&robot_location, &robot_maze_state, &waypoints);
 
   #ifdef DEBUG_STRATEGY
+    cell_t next_cell = waypoints.count > 0 ? waypointAt(&waypoints, 0) : waypoints.from;
+    gaussian_location_t next_location = robot_location;
+    next_location.x_mu = cellNumberToCoordinateDistance(next_cell.x);
+    next_location.y_mu = cellNumberToCoordinateDistance(next_cell.y);
     printStrategy(&next_location);
   #endif
 
-  // Determine what speed to set the motors to (speed profile + error correction, or turning profile + error correction)
-  calculateSpeed(&robot_location, &next_location, &left_speed, &right_speed);
+  // Determine what speed to set the motors to (the waypoints are added to the motion program, which drives
+  // straights through without stopping and turns between them along arcs)
+  calculateLookaheadSpeed(&robot_location, &waypoints, &motion_program, &left_speed, &right_speed);
 
   #ifdef DEBUG_MOVEMENT
     //printSpeedData(left_speed, right_speed);
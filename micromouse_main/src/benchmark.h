@@ -0,0 +1,44 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+#ifdef ARDUINO
+#error Do not run benchmarks on the Arduino!
+#endif
+#include <stdio.h>
+#include <time.h>
+
+/* Monotonic time in nanoseconds */
+static inline double benchNowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* CPU timestamp counter for cycle counts, 0 where there is none */
+static inline unsigned long long benchNowCycles() {
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int low, high;
+    asm volatile("rdtsc" : "=a"(low), "=d"(high));
+    return ((unsigned long long) high << 32) | low;
+#else
+    return 0;
+#endif
+}
+
+/* Keeps the optimizer from discarding a computed value */
+template <typename T>
+static inline void benchKeep(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+#define BENCH_FUNC_BEGIN \
+int main() {
+
+#define BENCH_SECTION(name) \
+    puts("\n[\033[36mBENCH\033[0m] " name)
+
+#define BENCH_FUNC_END(name) \
+    printf("\n[\033[36mDONE\033[0m] " name "\n"); \
+    return 0; \
+}
+
+#endif
@@ -6,40 +6,66 @@
 
 // General
 #include "control.h"
+#include "motor_model.h"
 #include "../settings.h"
 #include "../devices/encoders.h"
 #include "../devices/motors.h"
 #include "../util/conversions.h"
+#include "../util/queue.h"
+
+
+#define MOTOR_LOG_SIZE 32   // Control loops speedController can log before printMotorLog has to print them
 
 
 typedef struct {
-    double  set_speed;          // The speed we are trying to achieve (in mm/sec)
-    double  int_error;          // The summation of errors over time
     int     ticks_travelled;    // How far each wheel has travelled since last call to distanceTravelled()
 } controller_state_t;
 
+typedef struct {
+    unsigned long loop;         // Count of control loops run, so identify_motors can tell lines were dropped
+    unsigned long dt_us;
+    int ticks[2];
+    double outputs[2];
+} motor_log_entry_t;
+
 /* Stores the state of the controller for each motor, left first, then right */
 volatile controller_state_t controllers[] = {
     {
-        .set_speed = 0,
-        .int_error = 0,
         .ticks_travelled = 0
     },
     {
-        .set_speed = 0,
-        .int_error = 0,
         .ticks_travelled = 0
     },
 };
 
+/* The speed loop and motor model of each motor, left first, then right
+ * - speedController runs them from the Timer2 interrupt, setSpeedPID changes the speed loops from
+ *   movement_loop in the Timer3 interrupt with interrupts off, so speedController never sees them half set
+ * - noInterrupts() and interrupts() are also compiler barriers, so they are not volatile */
+speed_control_t speed_controls[2];
+motor_model_t motor_models[2];
+
+/* Control loops logged with DEBUG_MOTORS, speedController can not print from the interrupt
+ * - Only touched with interrupts off outside of speedController, loops are dropped while it is full */
+queue<motor_log_entry_t, MOTOR_LOG_SIZE> motor_log(motor_log_entry_t {});
+
 
 //Function declarations
 void printEncoderData(double left_distance, double right_distance);
 
 
 /* initialize control
- * starts the PID loop with a speed of 0 on each motor */
+ * starts the PID loop with a speed of 0 on each motor
+ * - Without MOTOR_FEEDFORWARD the models are all 0, which leaves the PI terms alone */
 void initializeControl(void) {
+    for (int i = 0; i < 2; i++) {
+        initializeSpeedControl(&speed_controls[i]);
+        #if MOTOR_FEEDFORWARD
+            initializeMotorModel(&motor_models[i], i);
+        #else
+            motor_models[i] = {};
+        #endif
+    }
     setSpeedPID(0.0, 0.0);
 
     Timer2.attachInterrupt(speedController).start(CONTROL_LOOP_TIME);
@@ -68,12 +94,45 @@ void printEncoderData(double left_distance, double right_distance) {
     Serial.println(right_distance);
 }
 
+/* print motor log
+ * - A line for control/identify_motors each control loop, see motor_identification.h */
+void printMotorLog(void) {
+    motor_log_entry_t entry;
+    while (true) {
+        noInterrupts();
+        bool logged = !motor_log.empty();
+        if (logged) {
+            entry = motor_log.pop();
+        }
+        interrupts();
+        if (!logged) {
+            return;
+        }
+
+        Serial.print("DEBUG_MOTORS: ");
+        Serial.print(entry.loop);
+        Serial.print(", ");
+        Serial.print(entry.dt_us);
+        Serial.print(", ");
+        Serial.print(entry.ticks[LEFT]);
+        Serial.print(", ");
+        Serial.print(entry.outputs[LEFT], 4);
+        Serial.print(", ");
+        Serial.print(entry.ticks[RIGHT]);
+        Serial.print(", ");
+        Serial.println(entry.outputs[RIGHT], 4);
+    }
+}
+
 /* set speed PID
- * Sets the speed that the control algorithm uses */
+ * Sets the speed that the control algorithm uses
+ * - It ramps there over a movement loop, the time until the next speed is set */
 void setSpeedPID(double left_speed, double right_speed){
+    // This runs in movement_loop's Timer3 interrupt, speedController's Timer2 interrupt must not run
+    // halfway through setting the speed loops it reads
     noInterrupts();
-    controllers[LEFT].set_speed = left_speed;
-    controllers[RIGHT].set_speed = right_speed;
+    setSpeedTarget(&speed_controls[LEFT], left_speed, MOVEMENT_LOOP_TIME / 1000000.0);
+    setSpeedTarget(&speed_controls[RIGHT], right_speed, MOVEMENT_LOOP_TIME / 1000000.0);
     interrupts();
 }
 
@@ -82,36 +141,36 @@ void setSpeedPID(double left_speed, double right_speed){
 void speedController(void) {
     
     static unsigned long prev_time = micros();
+    static unsigned long loop = 0;
 
-    int ticks;
+    int ticks[2];
     double cur_speed;
-    double error;
-    double output; // Value between 0 and 1
+    double output[2]; // Value between -1 and 1
     unsigned long cur_time = micros();
+    double dt = (double)(cur_time-prev_time) / 1000000;
 
     for (int i = 0; i < 2; i++){
         // Read encoder ticks, and update ticks_travelled
-        ticks = readEncoder(i);
-        controllers[i].ticks_travelled += ticks;
+        ticks[i] = readEncoder(i);
+        controllers[i].ticks_travelled += ticks[i];
 
         // Calculate Speed we are going in mm/sec
-        cur_speed = ticksToMM(ticks) / ((double)(cur_time-prev_time) / 1000000);
+        cur_speed = ticksToMM(ticks[i]) / dt;
 
-        // calculate error
-        error = cur_speed - controllers[i].set_speed;
-
-        // add to integral error sum (bounded)
-        if (controllers[i].int_error + error > -1 * INT_BOUND && controllers[i].int_error + error < INT_BOUND) {
-            controllers[i].int_error += error;
-        }
+        output[i] = speedControlStep(&speed_controls[i], &motor_models[i], cur_speed, dt);
 
-        output = (-1 * MOTOR_TAU_P * error) + (-1 * MOTOR_TAU_I * controllers[i].int_error);
-
-        // Limit output between -1 and 1
-        if (output > 1) output = 1;
-        if (output < -1) output = -1;
-
-        setMotorPWM(i, output);
+        setMotorPWM(i, output[i]);
     }
+
+    #ifdef DEBUG_MOTORS
+        motor_log_entry_t entry = {
+            .loop = loop,
+            .dt_us = cur_time - prev_time,
+            .ticks = { ticks[LEFT], ticks[RIGHT] },
+            .outputs = { output[LEFT], output[RIGHT] },
+        };
+        motor_log.push(entry);
+    #endif
+    loop++;
     prev_time = cur_time;
 }
@@ -22,6 +22,11 @@ void distanceTravelled(double* left_distance, double* right_distance);
  * Sets the speed that the control algorithm uses */
 void setSpeedPID(double left_speed, double right_speed);
 
+/* print motor log
+ * Prints the control loops speedController logged with DEBUG_MOTORS since the last call,
+ * from the main loop as the ISR can not print */
+void printMotorLog(void);
+
 /* speed controller
  * This function is a ISR to run the PID loop */
 void speedController(void);
@@ -0,0 +1,212 @@
+#ifndef ARDUINO
+/* control_benchmark
+ * The trajectories of movement_test driven through the speed loop of each wheel into motor_model.h's
+ * model of the motors, with the robot's location following the encoder ticks, to see how far the
+ * wheels lag what movement asks for with and without feedforward
+ */
+
+#include <math.h>
+#include "motor_model.h"
+#include "../movement/movement.h"
+#include "../localization/localization.h"
+#include "../strategy/path_compiler.h"
+#include "../util/conversions.h"
+#include "../benchmark.h"
+#include "../settings.h"
+#include "../types.h"
+
+
+#define MOVEMENT_STEP (MOVEMENT_LOOP_TIME / 1000000.0)  // s
+#define CONTROL_STEP (CONTROL_LOOP_TIME / 1000000.0)    // s
+#define PLANT_STEPS 10                                  // Steps of the model per control loop
+#define MAX_MOVEMENT_STEPS 2000
+
+
+/* One wheel: its real speed and distance, and the speed loop driving it */
+typedef struct {
+    speed_control_t control;
+    double speed;               // mm/s
+    double distance;            // mm
+    int ticks;                  // Encoder ticks of distance
+} wheel_t;
+
+/* One trajectory with one model in the speed loop
+ *  - arrive: seconds until within OUTER_TOLERANCE_MM of the goal, -1 if never
+ *  - speed_error: mean of |wheel speed - set speed| over control loops while moving in mm/s
+ *  - distance_lag: largest distance a wheel fell behind or ran ahead of its set speed in mm */
+typedef struct {
+    double arrive;
+    double speed_error;
+    double distance_lag;
+    int loops;
+} tracking_run_t;
+
+wheel_t wheels[2];
+double set_distances[2];
+
+
+void startTrackingRun(double x, double y, double theta, tracking_run_t* run) {
+    initializeLocalization();
+    robot_location.x_mu = x;
+    robot_location.y_mu = y;
+    robot_location.theta_mu = theta;
+    initializeMovement(&robot_location);
+    setMovementTick(MOVEMENT_STEP);
+    for (int i = 0; i < 2; i++) {
+        initializeSpeedControl(&wheels[i].control);
+        wheels[i].speed = 0;
+        wheels[i].distance = 0;
+        wheels[i].ticks = 0;
+        set_distances[i] = 0;
+    }
+    run->arrive = -1;
+    run->speed_error = 0;
+    run->distance_lag = 0;
+    run->loops = 0;
+}
+
+/* Run the control loops of one movement loop toward left_speed and right_speed the way setSpeedPID and
+ * speedController do, then localize on the encoder ticks the way movement_loop does */
+void driveWheels(const motor_model_t* model, const motor_model_t* plant, double left_speed, double right_speed,
+                 tracking_run_t* run) {
+    double set_speeds[2] = { left_speed, right_speed };
+    int start_ticks[2];
+    for (int i = 0; i < 2; i++) {
+        setSpeedTarget(&wheels[i].control, set_speeds[i], MOVEMENT_STEP);
+        start_ticks[i] = wheels[i].ticks;
+    }
+
+    double mm_per_tick = ticksToMM(1);
+    for (int loop = 0; loop < MOVEMENT_LOOP_TIME / CONTROL_LOOP_TIME; loop++) {
+        bool moving = false;
+        for (int i = 0; i < 2; i++) {
+            wheel_t* wheel = &wheels[i];
+            int ticks = (int) floor(wheel->distance / mm_per_tick);
+            double cur_speed = ticksToMM(ticks - wheel->ticks) / CONTROL_STEP;
+            wheel->ticks = ticks;
+
+            double output = speedControlStep(&wheel->control, model, cur_speed, CONTROL_STEP);
+            double start_distance = wheel->distance;
+            for (int j = 0; j < PLANT_STEPS; j++) {
+                double before = wheel->speed;
+                wheel->speed = motorModelStep(plant, output, wheel->speed, CONTROL_STEP / PLANT_STEPS);
+                wheel->distance += (before + wheel->speed) / 2 * CONTROL_STEP / PLANT_STEPS;
+            }
+
+            set_distances[i] += wheel->control.loop_speed * CONTROL_STEP;
+            double mean_speed = (wheel->distance - start_distance) / CONTROL_STEP;
+            if (wheel->control.loop_speed != 0 || fabs(mean_speed) > 1) {
+                run->speed_error += fabs(mean_speed - wheel->control.loop_speed);
+                moving = true;
+            }
+            run->distance_lag = fmax(run->distance_lag, fabs(set_distances[i] - wheel->distance));
+        }
+        run->loops += moving;
+    }
+
+    localizeMotionStep(ticksToMM(wheels[LEFT].ticks - start_ticks[LEFT]),
+                       ticksToMM(wheels[RIGHT].ticks - start_ticks[RIGHT]));
+}
+
+void finishTrackingRun(tracking_run_t* run) {
+    run->speed_error = run->loops > 0 ? run->speed_error / (2 * run->loops) : 0;
+}
+
+/* calculateSpeed from (x, y, theta) to goal, like movement_test's goTo */
+void simulateGoTo(const motor_model_t* model, const motor_model_t* plant, double x, double y, double theta,
+                  gaussian_location_t* goal, tracking_run_t* run) {
+    startTrackingRun(x, y, theta, run);
+    double left_speed, right_speed;
+    for (int steps = 0; steps < MAX_MOVEMENT_STEPS; steps++) {
+        calculateSpeed(&robot_location, goal, &left_speed, &right_speed);
+        driveWheels(model, plant, left_speed, right_speed, run);
+        if (run->arrive < 0 && IS_BETWEEN_ERROR(robot_location.x_mu, goal->x_mu, OUTER_TOLERANCE_MM) &&
+                IS_BETWEEN_ERROR(robot_location.y_mu, goal->y_mu, OUTER_TOLERANCE_MM)) {
+            run->arrive = (steps + 1) * MOVEMENT_STEP;
+        }
+    }
+    finishTrackingRun(run);
+}
+
+/* calculateProgramSpeed through program, like movement_test's runProgram */
+void simulateProgram(const motor_model_t* model, const motor_model_t* plant, motion_program_t* program,
+                     tracking_run_t* run) {
+    startTrackingRun(cellNumberToCoordinateDistance(program->start.x),
+                     cellNumberToCoordinateDistance(program->start.y), directionToRAD[program->start_heading], run);
+    program->next_command = 0;
+    startMotionProgram(program);
+    double left_speed, right_speed;
+    for (int steps = 0; steps < MAX_MOVEMENT_STEPS; steps++) {
+        if (calculateProgramSpeed(&robot_location, program, &left_speed, &right_speed)) {
+            run->arrive = steps * MOVEMENT_STEP;
+            break;
+        }
+        driveWheels(model, plant, left_speed, right_speed, run);
+    }
+    finishTrackingRun(run);
+}
+
+void printTrackingRun(const tracking_run_t* run) {
+    printf("\t%7.2f\t%6.1f\t%6.1f", run->arrive, run->speed_error, run->distance_lag);
+}
+
+
+BENCH_FUNC_BEGIN {
+
+    motor_model_t plant, none = {}, off;
+    initializeMotorModel(&plant, LEFT);
+    off = plant;
+    off.back_emf *= 1.2;
+    off.inertia *= 0.8;
+    const motor_model_t* models[] = { &none, &plant, &off };
+
+    BENCH_SECTION("Speed loop with PI only vs feedforward from the motor model, movement_test trajectories, "
+                  "time to arrive (s), mean speed error (mm/s) and largest distance lag (mm) of the wheels");
+    printf("deadband %.3f, back_emf %.5f /(mm/s), inertia %.5f /(mm/s^2), time constant %.0f ms, MOVEMENT_LOOP_TIME "
+            "%d us, CONTROL_LOOP_TIME %d us\n", plant.deadband, plant.back_emf, plant.inertia,
+            1000 * plant.inertia / plant.back_emf, MOVEMENT_LOOP_TIME, CONTROL_LOOP_TIME);
+    printf("                \t   PI only\t\t\t   feedforward\t\t\t   20%% off model\n");
+    printf("trajectory      \t arrive\t speed\t   lag\t arrive\t speed\t   lag\t arrive\t speed\t   lag\n");
+
+    gaussian_location_t goal;
+    tracking_run_t run;
+    struct { const char* name; int start_x; double offset; Direction heading; int goal_x; int goal_y; } go_tos[] = {
+        { "straight",       0, 0, East,  1, 0 },
+        { "straight (pid)", 0, 5, East,  10, 0 },
+        { "turn, straight", 0, 0, South, 1, 0 },
+        { "diagonal",       0, 0, North, 1, 1 },
+    };
+    for (unsigned int t = 0; t < sizeof(go_tos) / sizeof(go_tos[0]); t++) {
+        goal.x_mu = cellNumberToCoordinateDistance(go_tos[t].goal_x);
+        goal.y_mu = cellNumberToCoordinateDistance(go_tos[t].goal_y);
+        printf("%-16s", go_tos[t].name);
+        for (int m = 0; m < 3; m++) {
+            simulateGoTo(models[m], &plant, cellNumberToCoordinateDistance(go_tos[t].start_x),
+                         cellNumberToCoordinateDistance(0) + go_tos[t].offset, directionToRAD[go_tos[t].heading],
+                         &goal, &run);
+            printTrackingRun(&run);
+        }
+        printf("\n");
+    }
+
+    static motion_program_t program;
+    cell_t start = { .x = 0, .y = 0 };
+    cell_t path[] = { { 0, 0 }, { 1, 0 }, { 2, 0 }, { 3, 0 }, { 3, 1 }, { 2, 1 }, { 1, 1 }, { 1, 2 }, { 1, 3 },
+                      { 2, 3 }, { 2, 2 } };
+    TurnStyle styles[] = { TURN_IN_PLACE, TURN_SEARCH_ARCS };
+    const char* style_names[] = { "program", "program, arcs" };
+    for (int s = 0; s < 2; s++) {
+        initializeMotionProgram(&program, start, East);
+        program.turn_style = styles[s];
+        compilePath(&program, path, 11);
+        printf("%-16s", style_names[s]);
+        for (int m = 0; m < 3; m++) {
+            simulateProgram(models[m], &plant, &program, &run);
+            printTrackingRun(&run);
+        }
+        printf("\n");
+    }
+
+} BENCH_FUNC_END("control_benchmark")
+
+#endif // ARDUINO
@@ -0,0 +1,102 @@
+#ifndef ARDUINO
+/* identify_motors
+ * Fit the motor model of each wheel to a logged run and write it to the header settings.h includes
+ *
+ *   ./identify_motors <log> [header]
+ *
+ * The log is the serial output of a run with DEBUG_MOTORS, other lines in it are skipped, and so are
+ * the loops next to any the robot dropped. The header defaults to ../motor_model_constants.h, next to
+ * settings.h. Drive both ways at a range of speeds with changes of speed in between, so the fit sees
+ * the wheels accelerate and hold a speed.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <vector>
+
+#include "motor_identification.h"
+#include "../settings.h"
+
+
+#define LOG_LINE_LENGTH 256
+
+
+/* Write the models to path as motor_model_constants.h */
+bool writeMotorModelHeader(const char* path, const char* log, const motor_model_t* models,
+                           const motor_fit_t* fits, const double* rms_errors) {
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        return false;
+    }
+    const char* names[] = { "LEFT", "RIGHT" };
+    fprintf(file, "/* motor_model_constants.h\n"
+                  " *\n"
+                  " * Generated by control/identify_motors from %s, do not edit.\n", log);
+    for (int i = 0; i < 2; i++) {
+        fprintf(file, " * %-5s %d loops fitted, %d skipped, rms speed error %.2f mm/s\n", names[i],
+                fits[i].samples, fits[i].skipped, rms_errors[i]);
+    }
+    fprintf(file, " */\n\n"
+                  "#ifndef _MOTOR_MODEL_CONSTANTS_H_\n"
+                  "#define _MOTOR_MODEL_CONSTANTS_H_\n\n\n");
+    for (int i = 0; i < 2; i++) {
+        fprintf(file, "#define %s_MOTOR_MODEL_DEADBAND    %.6g\t// Output the wheel starts turning at\n",
+                names[i], models[i].deadband);
+        fprintf(file, "#define %s_MOTOR_MODEL_BACK_EMF    %.6g\t// Output per mm/s\n", names[i], models[i].back_emf);
+        fprintf(file, "#define %s_MOTOR_MODEL_INERTIA     %.6g\t// Output per mm/s^2\n", names[i], models[i].inertia);
+    }
+    fprintf(file, "\n\n#endif //_MOTOR_MODEL_CONSTANTS_H_\n");
+    return fclose(file) == 0;
+}
+
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <log> [header]\n", argv[0]);
+        return 2;
+    }
+    const char* header = argc > 2 ? argv[2] : "../motor_model_constants.h";
+
+    FILE* file = fopen(argv[1], "r");
+    if (file == NULL) {
+        fprintf(stderr, "could not open %s\n", argv[1]);
+        return 1;
+    }
+    std::vector<motor_log_sample_t> samples;
+    char line[LOG_LINE_LENGTH];
+    motor_log_sample_t sample;
+    while (fgets(line, sizeof(line), file) != NULL) {
+        if (parseMotorLogLine(line, &sample)) {
+            samples.push_back(sample);
+        }
+    }
+    fclose(file);
+    printf("%zu DEBUG_MOTORS samples in %s\n", samples.size(), argv[1]);
+
+    motor_fit_t fits[2];
+    motor_model_t models[2];
+    double rms_errors[2];
+    const char* names[] = { "left", "right" };
+    for (int i = 0; i < 2; i++) {
+        initializeMotorFit(&fits[i]);
+        addMotorFitSamples(&fits[i], samples.data(), (int) samples.size(), i);
+        if (!solveMotorFit(&fits[i], &models[i], &rms_errors[i])) {
+            fprintf(stderr, "could not fit the %s wheel from %d loops, drive it more both ways\n", names[i],
+                    fits[i].samples);
+            return 1;
+        }
+        printf("%-5s deadband %.4f, back_emf %.6f /(mm/s), inertia %.6f /(mm/s^2), time constant %.0f ms, "
+               "rms error %.2f mm/s over %d loops\n", names[i], models[i].deadband, models[i].back_emf,
+               models[i].inertia, 1000 * models[i].inertia / models[i].back_emf, rms_errors[i], fits[i].samples);
+    }
+
+    if (!writeMotorModelHeader(header, argv[1], models, fits, rms_errors)) {
+        fprintf(stderr, "could not write %s\n", header);
+        return 1;
+    }
+    printf("written to %s\n", header);
+    return 0;
+}
+
+#endif // ARDUINO
@@ -0,0 +1,152 @@
+#ifndef ARDUINO
+/* motor_identification.cpp */
+
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "motor_identification.h"
+#include "../settings.h"
+#include "../util/conversions.h"
+
+
+#define MOTOR_FIT_MIN_PIVOT 1e-9    // Smallest pivot, relative to the diagonal, of a fit that is pinned down
+
+
+/* parse motor log line
+ * - The line can start with anything the serial capture adds, a timestamp say */
+bool parseMotorLogLine(const char* line, motor_log_sample_t* sample) {
+    const char* start = strstr(line, "DEBUG_MOTORS:");
+    if (start == NULL) {
+        return false;
+    }
+    double dt_us;
+    if (sscanf(start, "DEBUG_MOTORS: %lu , %lf , %d , %lf , %d , %lf", &sample->loop, &dt_us, &sample->ticks[LEFT],
+               &sample->output[LEFT], &sample->ticks[RIGHT], &sample->output[RIGHT]) != 6 || dt_us <= 0) {
+        return false;
+    }
+    sample->dt = dt_us / 1000000.0;
+    return true;
+}
+
+/* applied output */
+double appliedOutput(double output) {
+    int pwm = (int) (output * MAX_PWM_OUTPUT);
+    if (pwm < MIN_PWM_OUTPUT && pwm > -1 * MIN_PWM_OUTPUT) {
+        return 0;
+    }
+    return pwm / (double) MAX_PWM_OUTPUT;
+}
+
+/* initialize motor fit */
+void initializeMotorFit(motor_fit_t* fit) {
+    memset(fit, 0, sizeof(motor_fit_t));
+}
+
+/* add motor fit samples
+ * - The ticks of a sample are counted under the output of the one before it, so each loop fitted
+ *   takes three samples, of consecutive loops */
+void addMotorFitSamples(motor_fit_t* fit, const motor_log_sample_t* samples, int num_samples, int id) {
+    for (int i = 0; i + 2 < num_samples; i++) {
+        const motor_log_sample_t* first = &samples[i + 1];
+        const motor_log_sample_t* second = &samples[i + 2];
+        int ticks = first->ticks[id], next_ticks = second->ticks[id];
+        if (first->loop != samples[i].loop + 1 || second->loop != first->loop + 1 ||
+                ticks == 0 || next_ticks == 0 || (ticks > 0) != (next_ticks > 0)) {
+            fit->skipped++;
+            continue;
+        }
+
+        double speed = ticksToMM(ticks) / first->dt;
+        double next_speed = ticksToMM(next_ticks) / second->dt;
+        double terms[MOTOR_FIT_TERMS] = {
+            speed,
+            appliedOutput(samples[i].output[id]),
+            appliedOutput(first->output[id]),
+            speed > 0 ? 1.0 : -1.0,
+        };
+        for (int row = 0; row < MOTOR_FIT_TERMS; row++) {
+            for (int col = 0; col < MOTOR_FIT_TERMS; col++) {
+                fit->normal[row][col] += terms[row] * terms[col];
+            }
+            fit->rhs[row] += terms[row] * next_speed;
+        }
+        fit->sum_squares += next_speed * next_speed;
+        fit->sum_dt += second->dt;
+        fit->samples++;
+    }
+}
+
+/* Solve the normal equations for the coefficients by Gaussian elimination, false if singular */
+static bool solveNormal(const motor_fit_t* fit, double* coefficients) {
+    double a[MOTOR_FIT_TERMS][MOTOR_FIT_TERMS + 1];
+    for (int row = 0; row < MOTOR_FIT_TERMS; row++) {
+        for (int col = 0; col < MOTOR_FIT_TERMS; col++) {
+            a[row][col] = fit->normal[row][col];
+        }
+        a[row][MOTOR_FIT_TERMS] = fit->rhs[row];
+    }
+
+    for (int col = 0; col < MOTOR_FIT_TERMS; col++) {
+        int pivot = col;
+        for (int row = col + 1; row < MOTOR_FIT_TERMS; row++) {
+            if (fabs(a[row][col]) > fabs(a[pivot][col])) {
+                pivot = row;
+            }
+        }
+        if (fabs(a[pivot][col]) <= MOTOR_FIT_MIN_PIVOT * fit->normal[col][col] || a[pivot][col] == 0) {
+            return false;
+        }
+        for (int k = 0; k <= MOTOR_FIT_TERMS; k++) {
+            double swap = a[col][k];
+            a[col][k] = a[pivot][k];
+            a[pivot][k] = swap;
+        }
+        for (int row = col + 1; row < MOTOR_FIT_TERMS; row++) {
+            double factor = a[row][col] / a[col][col];
+            for (int k = col; k <= MOTOR_FIT_TERMS; k++) {
+                a[row][k] -= factor * a[col][k];
+            }
+        }
+    }
+
+    for (int row = MOTOR_FIT_TERMS - 1; row >= 0; row--) {
+        double sum = a[row][MOTOR_FIT_TERMS];
+        for (int k = row + 1; k < MOTOR_FIT_TERMS; k++) {
+            sum -= a[row][k] * coefficients[k];
+        }
+        coefficients[row] = sum / a[row][row];
+    }
+    return true;
+}
+
+/* solve motor fit
+ * - a = exp(-dt / tau) has to be between 0 and 1, and the outputs have to speed the wheel up */
+bool solveMotorFit(const motor_fit_t* fit, motor_model_t* model, double* rms_error) {
+    double c[MOTOR_FIT_TERMS];
+    if (fit->samples < MOTOR_FIT_TERMS || !solveNormal(fit, c)) {
+        return false;
+    }
+
+    double decay = c[0], gain = c[1] + c[2];
+    if (decay <= 0 || decay >= 1 || gain <= 0) {
+        return false;
+    }
+    double dt = fit->sum_dt / fit->samples;
+    model->back_emf = (1 - decay) / gain;
+    model->deadband = -1 * c[3] / gain;
+    model->inertia = model->back_emf * -1 * dt / log(decay);
+
+    if (rms_error != NULL) {
+        // At the least squares solution the residual sum of squares is y'y - c'X'y
+        double residual = fit->sum_squares;
+        for (int i = 0; i < MOTOR_FIT_TERMS; i++) {
+            residual -= c[i] * fit->rhs[i];
+        }
+        *rms_error = sqrt(fmax(residual, 0) / fit->samples);
+    }
+    return true;
+}
+
+#endif // ARDUINO
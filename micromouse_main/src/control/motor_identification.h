@@ -0,0 +1,77 @@
+/* motor_identification.h
+ *
+ * Fit the model of control/motor_model.h to a logged run of each wheel.
+ * With DEBUG_MOTORS speedController logs each control loop and the main
+ * loop prints them as lines
+ *
+ *      DEBUG_MOTORS: loop, dt_us, left_ticks, left_output, right_ticks, right_output
+ *
+ * the count of the loop, the encoder ticks counted over the last dt_us and
+ * the output then given to setMotorPWM, held until the next line. Loops
+ * the log had no room for are missing, and the count shows where. The speeds the encoders
+ * measure are means over a loop, and for a first order model with the
+ * output held over each loop the mean speed of one loop follows from the
+ * one before and the outputs of both
+ *
+ *      v[k+1] = a * v[k] + b0 * s[k] + b1 * s[k+1]
+ *      s[k] = (u[k] - deadband * sign(v[k])) / back_emf
+ *
+ * where a = exp(-dt / tau) with tau = inertia / back_emf, and b0 + b1 = 1 - a.
+ * Loops the wheel stands or changes direction in are left out, friction
+ * holds it there rather than following the model, so sign(v) is the same
+ * in both. That leaves v[k+1] linear in v[k], u[k], u[k+1] and sign(v),
+ * the coefficients are fitted by least squares and the model is read
+ * back from them.
+ */
+
+#ifndef _MOTOR_IDENTIFICATION_H_
+#define _MOTOR_IDENTIFICATION_H_
+
+#include "motor_model.h"
+
+
+#define MOTOR_FIT_TERMS 4   // v[k], u[k], u[k+1], sign(v)
+
+
+typedef struct {
+    unsigned long loop;     // Count of the control loop
+    double dt;              // s the ticks were counted over
+    int ticks[2];           // Encoder ticks of each wheel over dt, left first
+    double output[2];       // Output given to setMotorPWM after, -1 to 1
+} motor_log_sample_t;
+
+typedef struct {
+    // Normal equations of the least squares fit
+    double normal[MOTOR_FIT_TERMS][MOTOR_FIT_TERMS];
+    double rhs[MOTOR_FIT_TERMS];
+    double sum_squares;     // Sum of the squares of v[k+1]
+    double sum_dt;
+    int samples;            // Loops fitted
+    int skipped;            // Loops left out, standing, changing direction or next to a missing one
+} motor_fit_t;
+
+
+/* parse motor log line
+ * Read a DEBUG_MOTORS line, false for any other line of the serial output */
+bool parseMotorLogLine(const char* line, motor_log_sample_t* sample);
+
+/* applied output
+ * The output setMotorPWM drives the motor with, rounded to its PWM steps and 0 below MIN_PWM_OUTPUT */
+double appliedOutput(double output);
+
+/* initialize motor fit
+ * With no loops added */
+void initializeMotorFit(motor_fit_t* fit);
+
+/* add motor fit samples
+ * Add the loops of wheel id from num_samples log samples, in the order they were logged */
+void addMotorFitSamples(motor_fit_t* fit, const motor_log_sample_t* samples, int num_samples, int id);
+
+/* solve motor fit
+ * The model the loops added fit best, false if they do not pin it down or it is not a
+ * stable first order model
+ *  - rms_error is set to the rms error of the fitted mean speeds in mm/s, if not NULL */
+bool solveMotorFit(const motor_fit_t* fit, motor_model_t* model, double* rms_error);
+
+
+#endif //_MOTOR_IDENTIFICATION_H_
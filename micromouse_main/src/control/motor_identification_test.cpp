@@ -0,0 +1,152 @@
+#ifndef ARDUINO
+#include <math.h>
+#include <stdlib.h>
+#include "motor_identification.h"
+#include "../testing.h"
+#include "../settings.h"
+#include "../util/conversions.h"
+
+
+#define IS_WITHIN_PERCENT(x,y,p) (fabs((x) - (y)) < fabs(y) * (p) / 100.0)
+
+#define PLANT_STEPS 10      // Steps of the model per control loop
+#define LOG_SAMPLES 6000    // 60 s of control loops
+#define DT_JITTER_US 20     // Largest the timer is off a control loop by
+#define DROP_EVERY 37       // Loops between those the log drops
+
+
+/* Log of both wheels of plants driven by held random outputs, as speedController logs it
+ * - The wheels are stepped PLANT_STEPS times a loop and the ticks are those of the whole distance
+ *   so far, so they are quantized like the encoders, and each loop is off by up to DT_JITTER_US */
+void logRun(const motor_model_t* plants, motor_log_sample_t* samples, int num_samples) {
+    double speeds[2] = { 0, 0 }, positions[2] = { 0, 0 }, outputs[2] = { 0, 0 };
+    int ticks_counted[2] = { 0, 0 }, hold[2] = { 0, 0 };
+    double mm_per_tick = ticksToMM(1);
+    srand(25);
+
+    for (int s = 0; s < num_samples; s++) {
+        int dt_us = CONTROL_LOOP_TIME + rand() % (2 * DT_JITTER_US + 1) - DT_JITTER_US;
+        double dt = dt_us / 1000000.0;
+        samples[s].loop = s;
+        samples[s].dt = dt;
+        for (int i = 0; i < 2; i++) {
+            // Ticks under the output of the last sample
+            for (int j = 0; j < PLANT_STEPS; j++) {
+                double before = speeds[i];
+                speeds[i] = motorModelStep(&plants[i], appliedOutput(outputs[i]), speeds[i], dt / PLANT_STEPS);
+                positions[i] += (before + speeds[i]) / 2 * dt / PLANT_STEPS;
+            }
+            int ticks = (int) floor(positions[i] / mm_per_tick);
+            samples[s].ticks[i] = ticks - ticks_counted[i];
+            ticks_counted[i] = ticks;
+
+            // A new output every 5 to 30 loops, both ways and through the deadband
+            if (--hold[i] <= 0) {
+                outputs[i] = 1.6 * rand() / (double) RAND_MAX - 0.8;
+                hold[i] = 5 + rand() % 26;
+            }
+            samples[s].output[i] = outputs[i];
+        }
+    }
+}
+
+bool recovers(const motor_model_t* fitted, const motor_model_t* plant, double percent) {
+    return IS_WITHIN_PERCENT(fitted->deadband, plant->deadband, percent) &&
+           IS_WITHIN_PERCENT(fitted->back_emf, plant->back_emf, percent) &&
+           IS_WITHIN_PERCENT(fitted->inertia, plant->inertia, percent);
+}
+
+
+TEST_FUNC_BEGIN {
+
+    motor_log_sample_t sample;
+    if (!parseMotorLogLine("[12:00:01] DEBUG_MOTORS: 4012, 10004, 37, 0.3125, -2, -0.0500\r\n", &sample) ||
+            sample.loop != 4012 || sample.dt != 0.010004 || sample.ticks[LEFT] != 37 || sample.output[LEFT] != 0.3125 ||
+            sample.ticks[RIGHT] != -2 || sample.output[RIGHT] != -0.05 ||
+            parseMotorLogLine("DEBUG_ENCODERS: 1.20, 1.30\n", &sample) ||
+            parseMotorLogLine("DEBUG_MOTORS: 10000, 37, 0.3125, -2, -0.0500\n", &sample)) {
+        TEST_FAIL("Parse log lines");
+    } else {
+        TEST_PASS("Parse log lines");
+    }
+
+    // setMotorPWM truncates to its steps and drops anything under MIN_PWM_OUTPUT
+    if (appliedOutput(0.1) != 0 || appliedOutput(-0.1) != 0 || appliedOutput(0.5) != 127.0 / MAX_PWM_OUTPUT ||
+            appliedOutput(-1) != -1) {
+        TEST_FAIL("Applied output");
+    } else {
+        TEST_PASS("Applied output");
+    }
+
+    // Two different wheels, with time constants of 120 ms and 290 ms
+    motor_model_t plants[2] = {
+        { .deadband = 0.15, .back_emf = 0.001, .inertia = 0.00012 },
+        { .deadband = 0.24, .back_emf = 0.0007, .inertia = 0.0002 },
+    };
+    static motor_log_sample_t samples[LOG_SAMPLES];
+    logRun(plants, samples, LOG_SAMPLES);
+
+    bool all_recovered = true;
+    for (int i = 0; i < 2; i++) {
+        motor_fit_t fit;
+        motor_model_t fitted;
+        double rms_error;
+        initializeMotorFit(&fit);
+        addMotorFitSamples(&fit, samples, LOG_SAMPLES, i);
+        all_recovered = all_recovered && solveMotorFit(&fit, &fitted, &rms_error) &&
+                        recovers(&fitted, &plants[i], 3) && rms_error < 5;
+    }
+    if (!all_recovered) {
+        TEST_FAIL("Fit recovers the model of each wheel");
+    } else {
+        TEST_PASS("Fit recovers the model of each wheel");
+    }
+
+    // Loops next to those the log dropped are left out, the rest still fit
+    static motor_log_sample_t kept[LOG_SAMPLES];
+    int num_kept = 0, gaps = 0;
+    for (int s = 0; s < LOG_SAMPLES; s++) {
+        if (s % DROP_EVERY == DROP_EVERY - 1) {
+            gaps++;
+        } else {
+            kept[num_kept++] = samples[s];
+        }
+    }
+    bool fits_around_gaps = true;
+    for (int i = 0; i < 2; i++) {
+        motor_fit_t fit;
+        motor_model_t fitted;
+        initializeMotorFit(&fit);
+        addMotorFitSamples(&fit, kept, num_kept, i);
+        motor_fit_t runs;
+        initializeMotorFit(&runs);
+        for (int start = 0; start < num_kept; start += DROP_EVERY - 1) {
+            int run = num_kept - start < DROP_EVERY - 1 ? num_kept - start : DROP_EVERY - 1;
+            addMotorFitSamples(&runs, &kept[start], run, i);
+        }
+        fits_around_gaps = fits_around_gaps && fit.samples == runs.samples && solveMotorFit(&fit, &fitted, NULL) &&
+                           recovers(&fitted, &plants[i], 3);
+    }
+    if (!fits_around_gaps || gaps == 0) {
+        TEST_FAIL("Dropped log lines");
+    } else {
+        TEST_PASS("Dropped log lines");
+    }
+
+    // A wheel that never turns gives nothing to fit
+    for (int s = 0; s < LOG_SAMPLES; s++) {
+        samples[s].ticks[RIGHT] = 0;
+    }
+    motor_fit_t fit;
+    motor_model_t fitted;
+    initializeMotorFit(&fit);
+    addMotorFitSamples(&fit, samples, LOG_SAMPLES, RIGHT);
+    if (solveMotorFit(&fit, &fitted, NULL) || fit.samples != 0) {
+        TEST_FAIL("Standing wheel");
+    } else {
+        TEST_PASS("Standing wheel");
+    }
+
+} TEST_FUNC_END("motor_identification_test")
+
+#endif // ARDUINO
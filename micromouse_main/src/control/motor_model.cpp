@@ -0,0 +1,114 @@
+/* motor_model.cpp */
+
+
+#include <math.h>
+
+#include "motor_model.h"
+#include "../settings.h"
+
+
+/* initialize motor model */
+void initializeMotorModel(motor_model_t* model, int id) {
+    if (id == LEFT) {
+        model->deadband = LEFT_MOTOR_MODEL_DEADBAND;
+        model->back_emf = LEFT_MOTOR_MODEL_BACK_EMF;
+        model->inertia = LEFT_MOTOR_MODEL_INERTIA;
+    } else {
+        model->deadband = RIGHT_MOTOR_MODEL_DEADBAND;
+        model->back_emf = RIGHT_MOTOR_MODEL_BACK_EMF;
+        model->inertia = RIGHT_MOTOR_MODEL_INERTIA;
+    }
+}
+
+/* motor feedforward
+ * - Friction is against the direction of travel, or of the acceleration when starting off */
+double motorFeedforward(const motor_model_t* model, double speed, double accel) {
+    double direction = speed != 0 ? speed : accel;
+    if (direction == 0) {
+        return 0;
+    }
+    return (direction > 0 ? model->deadband : -model->deadband) + model->back_emf * speed + model->inertia * accel;
+}
+
+/* motor model step
+ * - The deadband is friction against the way the wheel turns, and holds a standing wheel unless the
+ *   output is past it; the speed closes exponentially on the steady speed of what is left, with time
+ *   constant inertia / back_emf, and stops rather than turning back */
+double motorModelStep(const motor_model_t* model, double output, double speed, double dt) {
+    double direction = speed != 0 ? speed : output;
+    double drive;
+    if (speed == 0 && fabs(output) <= model->deadband) {
+        return 0;
+    } else if (direction > 0) {
+        drive = output - model->deadband;
+    } else {
+        drive = output + model->deadband;
+    }
+    double steady_speed = drive / model->back_emf;
+    double next_speed = steady_speed + (speed - steady_speed) * exp(-dt * model->back_emf / model->inertia);
+    if (speed != 0 && (next_speed > 0) != (speed > 0)) {
+        return 0;
+    }
+    return next_speed;
+}
+
+/* initialize speed control */
+void initializeSpeedControl(speed_control_t* control) {
+    control->set_speed = 0;
+    control->set_accel = 0;
+    control->target_speed = 0;
+    control->loop_speed = 0;
+    control->int_error = 0;
+}
+
+/* set speed target */
+void setSpeedTarget(speed_control_t* control, double target_speed, double ramp_time) {
+    control->target_speed = target_speed;
+    if (ramp_time > 0) {
+        control->set_accel = (target_speed - control->set_speed) / ramp_time;
+    } else {
+        control->set_speed = target_speed;
+        control->set_accel = 0;
+    }
+}
+
+/* Set speed time s after now on the ramp, held at the target past its end */
+static double rampedSpeed(const speed_control_t* control, double time) {
+    double speed = control->set_speed + control->set_accel * time;
+    if ((control->set_accel > 0 && speed > control->target_speed) ||
+            (control->set_accel < 0 && speed < control->target_speed)) {
+        return control->target_speed;
+    }
+    return speed;
+}
+
+/* speed control step
+ * - cur_speed is measured over the last dt, so it is compared with the mean set speed over it, and
+ *   the feedforward is for the set speed halfway through the next dt the output is held for */
+double speedControlStep(speed_control_t* control, const motor_model_t* model, double cur_speed, double dt) {
+
+    // calculate error
+    double error = cur_speed - control->loop_speed;
+
+    // add to integral error sum (bounded)
+    if (control->int_error + error > -1 * INT_BOUND && control->int_error + error < INT_BOUND) {
+        control->int_error += error;
+    }
+
+    // The mean set speed and acceleration over the next dt, ramping on to its end and stopping on the target
+    double next_speed = rampedSpeed(control, dt);
+    double accel = dt > 0 ? (next_speed - control->set_speed) / dt : 0;
+    control->loop_speed = (control->set_speed + next_speed) / 2;
+    control->set_speed = next_speed;
+    if (control->set_speed == control->target_speed) {
+        control->set_accel = 0;
+    }
+
+    double output = (-1 * MOTOR_TAU_P * error) + (-1 * MOTOR_TAU_I * control->int_error);
+    output += motorFeedforward(model, control->loop_speed, accel);
+
+    // Limit output between -1 and 1
+    if (output > 1) output = 1;
+    if (output < -1) output = -1;
+    return output;
+}
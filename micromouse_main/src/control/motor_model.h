@@ -0,0 +1,65 @@
+/* motor_model.h
+ *
+ * A first order model of a wheel driven by a motor, and the speed loop
+ * that speedController runs for each wheel. For an output u between -1
+ * and 1 the wheel speed v in mm/s follows
+ *
+ *      deadband * sign(v) + back_emf * v + inertia * dv/dt = u
+ *
+ * The deadband is friction, and with the output setMotorPWM drops below
+ * MIN_PWM_OUTPUT it holds a standing wheel until |u| is past it. back_emf
+ * is the output per mm/s held at a steady speed and inertia the output
+ * per mm/s^2 of acceleration.
+ *
+ * The loop adds the output the model needs for the set speed and its
+ * acceleration to the PI terms, so those only have to correct what the
+ * model gets wrong instead of waiting for an error to build up.
+ */
+
+#ifndef _MOTOR_MODEL_H_
+#define _MOTOR_MODEL_H_
+
+
+typedef struct {
+    double deadband;        // Output the wheel starts turning at
+    double back_emf;        // Output per mm/s
+    double inertia;         // Output per mm/s^2
+} motor_model_t;
+
+typedef struct {
+    double set_speed;       // Speed the loop follows now in mm/s
+    double set_accel;       // Rate set_speed ramps at in mm/s^2
+    double target_speed;    // Speed set_speed ramps to
+    double loop_speed;      // Mean of set_speed over the last step, what the measured speed is held to
+    double int_error;       // Sum of the speed errors, bounded by INT_BOUND
+} speed_control_t;
+
+
+/* initialize motor model
+ * The model of motor id, LEFT or RIGHT, from motor_model_constants.h */
+void initializeMotorModel(motor_model_t* model, int id);
+
+/* motor feedforward
+ * Output that holds the wheel at speed while accelerating at accel, 0 at a standstill */
+double motorFeedforward(const motor_model_t* model, double speed, double accel);
+
+/* motor model step
+ * Speed of the wheel dt s after it was at speed with output held for the whole time */
+double motorModelStep(const motor_model_t* model, double output, double speed, double dt);
+
+/* initialize speed control
+ * Stopped, with no error summed */
+void initializeSpeedControl(speed_control_t* control);
+
+/* set speed target
+ * Ramp the set speed to target_speed over ramp_time s, at once if ramp_time is 0 */
+void setSpeedTarget(speed_control_t* control, double target_speed, double ramp_time);
+
+/* speed control step
+ * Ramp the set speed on by dt and return the output, -1 to 1, for a wheel measured at cur_speed
+ * - PI on the speed error with MOTOR_TAU_P and MOTOR_TAU_I, plus motorFeedforward of the set speed
+ *   and acceleration, none for a model of all 0 */
+double speedControlStep(speed_control_t* control, const motor_model_t* model, double cur_speed, double dt);
+
+
+#endif //_MOTOR_MODEL_H_
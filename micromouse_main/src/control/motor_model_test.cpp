@@ -0,0 +1,92 @@
+#ifndef ARDUINO
+#include <math.h>
+#include "motor_model.h"
+#include "../testing.h"
+#include "../settings.h"
+
+
+#define IS_BETWEEN_ERROR(x,y,e) (((x) < (y) + (e)) && ((x) > (y) - (e)))
+
+#define CONTROL_STEP (CONTROL_LOOP_TIME / 1000000.0)   // s
+#define PLANT_STEPS 10                                  // Steps of the model per control loop
+
+
+/* Mean absolute speed error of the speed loop with feedforward from model, driving the wheel of
+ * plant from standing through a ramp to speed over ramp_time s and holding it for as long again
+ * - Speeds are the means over each control loop, as the encoders measure them */
+double rampError(const motor_model_t* model, const motor_model_t* plant, double speed, double ramp_time) {
+    speed_control_t control;
+    initializeSpeedControl(&control);
+    setSpeedTarget(&control, speed, ramp_time);
+
+    double wheel_speed = 0, mean_speed = 0, error_sum = 0;
+    int loops = (int) (2 * ramp_time / CONTROL_STEP);
+    for (int i = 0; i < loops; i++) {
+        double set_start = control.set_speed;
+        double output = speedControlStep(&control, model, mean_speed, CONTROL_STEP);
+        mean_speed = 0;
+        for (int j = 0; j < PLANT_STEPS; j++) {
+            double before = wheel_speed;
+            wheel_speed = motorModelStep(plant, output, wheel_speed, CONTROL_STEP / PLANT_STEPS);
+            mean_speed += (before + wheel_speed) / 2 / PLANT_STEPS;
+        }
+        error_sum += fabs(mean_speed - (set_start + control.set_speed) / 2);
+    }
+    return error_sum / loops;
+}
+
+
+TEST_FUNC_BEGIN {
+
+    motor_model_t model;
+    initializeMotorModel(&model, LEFT);
+    motor_model_t none = { .deadband = 0, .back_emf = 0, .inertia = 0 };
+
+    // Holding the feedforward of a speed keeps the wheel there
+    bool holds = true;
+    for (double speed = -300; speed <= 300; speed += 25) {
+        holds = holds && IS_BETWEEN_ERROR(motorModelStep(&model, motorFeedforward(&model, speed, 0), speed, 1.0),
+                                          speed, 1e-9);
+    }
+    if (!holds) {
+        TEST_FAIL("Feedforward holds speed");
+    } else {
+        TEST_PASS("Feedforward holds speed");
+    }
+
+    // Within the deadband a standing wheel stays put and a moving one slows down
+    if (motorModelStep(&model, 0.9 * model.deadband, 0, 1.0) != 0 ||
+            !(motorModelStep(&model, -0.9 * model.deadband, 100, 0.01) < 100) ||
+            !(motorModelStep(&model, -0.9 * model.deadband, 100, 0.01) > 0)) {
+        TEST_FAIL("Deadband");
+    } else {
+        TEST_PASS("Deadband");
+    }
+
+    // Open loop, the feedforward of a ramp drives the model along it
+    double speed = 0, accel = 1000, dt = 1e-4, max_error = 0;
+    for (double time = 0; time < 0.2; time += dt) {
+        double set_speed = accel * (time + dt / 2);
+        speed = motorModelStep(&model, motorFeedforward(&model, set_speed, accel), speed, dt);
+        max_error = fmax(max_error, fabs(speed - accel * (time + dt)));
+    }
+    if (max_error > 0.5) {
+        TEST_FAIL("Feedforward follows a ramp");
+    } else {
+        TEST_PASS("Feedforward follows a ramp");
+    }
+
+    // In the speed loop the feedforward cuts the lag of PI alone, even with a model 20% off
+    motor_model_t off = model;
+    off.back_emf *= 1.2;
+    off.inertia *= 0.8;
+    double pi_error = rampError(&none, &model, 75, 0.05);
+    if (!(rampError(&model, &model, 75, 0.05) < pi_error / 10) || !(rampError(&off, &model, 75, 0.05) < pi_error / 4)) {
+        TEST_FAIL("Feedforward in the speed loop");
+    } else {
+        TEST_PASS("Feedforward in the speed loop");
+    }
+
+} TEST_FUNC_END("motor_model_test")
+
+#endif // ARDUINO
@@ -1,5 +1,7 @@
 /* Arduino.h macros for testing */
 #ifndef ARDUINO
+#include <math.h>   // Arduino.h includes it too, it has to come before the macros below
+
 #define PI 3.1415926535897932384626433832795
 #define HALF_PI 1.5707963267948966192313216916398
 #define TWO_PI 6.283185307179586476925286766559
@@ -4,16 +4,18 @@
 #ifndef _GAUSSIAN_LOCATION_H_
 #define _GAUSSIAN_LOCATION_H_
 
+#include "../settings.h"
 
-/* Set the location type to double */
-typedef double location_t;
 
-/* gaussian_location_t
+/* Set the location type, selected by LOCATION_TYPE in settings.h */
+typedef LOCATION_TYPE location_t;
+
+/* gaussian_location
  * Defines the location of the robot in mm from
  * the top left of the maze(starting point), theta
  * is defined as the angle in degrees counter-clockwise
  * from the x axis
- * 
+ *
  * (0,0) starts in the top left corner of the maze inside of the maze
  * +---------> +x axis
  * |
@@ -21,16 +23,22 @@ typedef double location_t;
  * |
  * V
  * +y axis
- * 
+ *
+ * T is the numeric backend, see util/numeric_policy.h
  * */
-typedef struct {
-    location_t x_mu;           /* Mean x location */
-    location_t y_mu;           /* Mean y location */
-    location_t theta_mu;       /* Mean theta location */
-    location_t x_sigma;       /* Covariance in x */
-    location_t xy_sigma;      /* Covariance in x and y */
-    location_t y_sigma;       /* Covariance in y */
-    location_t theta_sigma;   /* Covariance in theta */
-} gaussian_location_t;
+template <typename T>
+struct gaussian_location {
+    T x_mu;           /* Mean x location */
+    T y_mu;           /* Mean y location */
+    T theta_mu;       /* Mean theta location */
+    T x_sigma;       /* Covariance in x */
+    T xy_sigma;      /* Covariance in x and y */
+    T y_sigma;       /* Covariance in y */
+    T theta_sigma;   /* Covariance in theta */
+    T x_theta_sigma; /* Covariance in x and theta */
+    T y_theta_sigma; /* Covariance in y and theta */
+};
+
+typedef gaussian_location<location_t> gaussian_location_t;
 
 #endif //_GAUSSIAN_LOCATION_H_
@@ -6,12 +6,22 @@
 
 
 #include "../types.h"
+#include "localization_math.h"
+
+
+typedef struct {
+    bool hit;               // Does the wall we hit exists?
+    double distance_hit;    // What was the furthest distance from the sensor to the hit
+    char side;              // Determines the orientation of the wall we hit, 0: parallel to x-axis, 1: parallel to y-axis
+    Direction dir;          // The direction from the robot to the wall hit
+    probabilistic_wall_t *wall;
+} hit_data_t;
 
 
 // The current state of the maze
 extern probabilistic_maze_t robot_maze_state;
 
-// The current location of the robot
+// The current location of the robot, the summary of the particles with PARTICLE_FILTER
 extern gaussian_location_t robot_location;
 
 
@@ -34,6 +44,13 @@ void mazeMappingAndMeasureStep(sensor_reading_t* sensor_data);
 
 
 /*----------- Private Functions -----------*/
+extern pose_transform_t sensor_offsets[NUM_SENSORS];
+
+/* update robot_maze_state based on the given sensor reading
+ * - update_maze: false only casts the ray into robot_maze_state and fills in hit_data */
+void processMeasurementMapping(pose_transform_t* sensor_location, sensor_reading_t *measurement, hit_data_t* hit_data,
+                                    int sensor_num, bool update_maze);
+
 void calculateMotion(gaussian_location_t* motion, double left_distance, double right_distance);
 void rotateCovariance(double rotate_by, double* x_sigma, double* y_sigma, double* xy_sigma);
 void addMotion(gaussian_location_t* current_location, gaussian_location_t* motion,
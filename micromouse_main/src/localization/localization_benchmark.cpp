@@ -0,0 +1,566 @@
+#ifndef ARDUINO
+#include <math.h>
+#include "localization.h"
+#include "localization_math.h"
+#include "localization_test_data.h"
+#include "particle_filter.h"
+#include "../benchmark.h"
+#include "../settings.h"
+#include "../util/numeric_policy.h"
+#include "../util/trig.h"
+
+
+#define MOTION_REPETITIONS 200
+#define TRIG_EVALUATIONS 100000
+#define TICK_REPETITIONS 20
+#define MAPPING_REPETITIONS 50
+#define MAPPING_RUNS 5  // Best of
+#define WALL_UPDATES 1000000
+#define DOUBLE_WALL_UPDATE 0.9    // What a double wall was multiplied by on each update
+#define MAPPING_HEADINGS 4
+#define EKF_REPETITIONS 200
+#define EKF_RUNS 5  // Best of
+#define PARTICLE_RUNS 3  // Best of
+
+
+// Counted by sinCos in localization.cpp, which is built with TRIG_COUNT_CALLS for this benchmark
+unsigned long trig_call_count = 0;
+
+
+/* Result of running every row of localization_test_data through one backend */
+typedef struct {
+    double ns_per_update;
+    double max_error_xy;    // Largest error in x or y against the double reference in mm
+    double max_error_theta; // Largest error in theta against the double reference in radians
+} motion_benchmark_t;
+
+
+/* Distance between two angles, accounting for the wrap at 2 pi */
+double angleError(double a, double b) {
+    return fabs(angleDifference(wrapAngle(a), wrapAngle(b)));
+}
+
+/* Runs localizeMotionStep's math (calculateMotion + addMotion) for one row */
+template <typename T>
+gaussian_location<T> motionStep(const double* row) {
+    gaussian_location<T> location;
+    location.x_mu = row[2];
+    location.y_mu = row[3];
+    location.theta_mu = row[4];
+
+    gaussian_location<T> motion;
+    calculateMotion<T>(&motion, row[0], row[1]);
+    addMotion<T>(&location, &motion, &location);
+    return location;
+}
+
+template <typename T>
+motion_benchmark_t benchmarkMotionBackend() {
+    motion_benchmark_t result = { 0.0, 0.0, 0.0 };
+
+    // Accuracy against the double reference
+    for (int i = 0; i < LOCALIZATION_TEST_DATA_ROWS; i++) {
+        gaussian_location<double> reference = motionStep<double>(localization_test_data[i]);
+        gaussian_location<T> location = motionStep<T>(localization_test_data[i]);
+
+        double error_x = fabs(numeric_policy<T>::toDouble(location.x_mu) - reference.x_mu);
+        double error_y = fabs(numeric_policy<T>::toDouble(location.y_mu) - reference.y_mu);
+        double error_theta = angleError(numeric_policy<T>::toDouble(location.theta_mu), reference.theta_mu);
+
+        if (error_x > result.max_error_xy) result.max_error_xy = error_x;
+        if (error_y > result.max_error_xy) result.max_error_xy = error_y;
+        if (error_theta > result.max_error_theta) result.max_error_theta = error_theta;
+    }
+
+    // Convert the inputs once so the timing only covers the kernel
+    static gaussian_location<T> starts[LOCALIZATION_TEST_DATA_ROWS];
+    static T lefts[LOCALIZATION_TEST_DATA_ROWS];
+    static T rights[LOCALIZATION_TEST_DATA_ROWS];
+    for (int i = 0; i < LOCALIZATION_TEST_DATA_ROWS; i++) {
+        starts[i].x_mu = localization_test_data[i][2];
+        starts[i].y_mu = localization_test_data[i][3];
+        starts[i].theta_mu = localization_test_data[i][4];
+        lefts[i] = localization_test_data[i][0];
+        rights[i] = localization_test_data[i][1];
+    }
+
+    double start = benchNowNs();
+    for (int r = 0; r < MOTION_REPETITIONS; r++) {
+        for (int i = 0; i < LOCALIZATION_TEST_DATA_ROWS; i++) {
+            gaussian_location<T> location = starts[i];
+            gaussian_location<T> motion;
+            calculateMotion<T>(&motion, lefts[i], rights[i]);
+            addMotion<T>(&location, &motion, &location);
+            benchKeep(location);
+        }
+    }
+    result.ns_per_update = (benchNowNs() - start) / (MOTION_REPETITIONS * LOCALIZATION_TEST_DATA_ROWS);
+
+    return result;
+}
+
+template <typename T>
+void printMotionBackend() {
+    motion_benchmark_t result = benchmarkMotionBackend<T>();
+    printf("%-8s\t%10.1f\t%14.6f\t%17.7f\n", numeric_policy<T>::name(),
+            result.ns_per_update, result.max_error_xy, result.max_error_theta);
+}
+
+
+/* ns for one sine and cosine pair of the same angle, from libm and from the table */
+typedef struct {
+    double libm_ns;
+    double table_ns;
+    double max_error;   // Largest error of the table against double libm
+} trig_benchmark_t;
+
+template <typename T>
+trig_benchmark_t benchmarkTrigBackend() {
+    trig_benchmark_t result = { 0.0, 0.0, 0.0 };
+
+    // Angles spread over the range the robot sees, including slightly negative and above 2 pi
+    static T angles[TRIG_EVALUATIONS];
+    for (int i = 0; i < TRIG_EVALUATIONS; i++) {
+        angles[i] = -0.5 + (TWO_PI + 1.0) * i / TRIG_EVALUATIONS;
+    }
+
+    for (int i = 0; i < TRIG_EVALUATIONS; i++) {
+        T s, c;
+        sinCosTable(angles[i], &s, &c);
+        double angle = numeric_policy<T>::toDouble(angles[i]);
+        double error_s = fabs(numeric_policy<T>::toDouble(s) - sin(angle));
+        double error_c = fabs(numeric_policy<T>::toDouble(c) - cos(angle));
+        if (error_s > result.max_error) result.max_error = error_s;
+        if (error_c > result.max_error) result.max_error = error_c;
+    }
+
+    double start = benchNowNs();
+    for (int i = 0; i < TRIG_EVALUATIONS; i++) {
+        T s = numeric_policy<T>::sin(angles[i]);
+        T c = numeric_policy<T>::cos(angles[i]);
+        benchKeep(s);
+        benchKeep(c);
+    }
+    result.libm_ns = (benchNowNs() - start) / TRIG_EVALUATIONS;
+
+    start = benchNowNs();
+    for (int i = 0; i < TRIG_EVALUATIONS; i++) {
+        T s, c;
+        sinCosTable(angles[i], &s, &c);
+        benchKeep(s);
+        benchKeep(c);
+    }
+    result.table_ns = (benchNowNs() - start) / TRIG_EVALUATIONS;
+
+    return result;
+}
+
+template <typename T>
+trig_benchmark_t printTrigBackend() {
+    trig_benchmark_t result = benchmarkTrigBackend<T>();
+    printf("%-8s\t%10.1f\t%10.1f\t%10.2f\t%12.2e\n", numeric_policy<T>::name(),
+            result.libm_ns, result.table_ns, result.libm_ns / result.table_ns, result.max_error);
+    return result;
+}
+
+/* Runs one control tick for every recorded measurement row
+ * - with_motion: run localizeMotionStep before mazeMappingAndMeasureStep */
+void runRecordedTicks(bool with_motion) {
+    sensor_reading_t sensor_data[NUM_SENSORS];
+
+    for (int i = 0; i < LOCALIZATION_MEASUREMENT_LOCATION_ROWS; i++) {
+        robot_location.x_mu = localization_measurement_locations[i][0];
+        robot_location.y_mu = localization_measurement_locations[i][1];
+        robot_location.theta_mu = localization_measurement_locations[i][2];
+
+        for (int j = 0; j < NUM_SENSORS; j++) {
+            sensor_data[j].state = GOOD;
+            sensor_data[j].distance = localization_measurement_data[i][j];
+        }
+
+        if (with_motion) {
+            localizeMotionStep(1.0, 1.02);
+        }
+        mazeMappingAndMeasureStep(sensor_data);
+        benchKeep(robot_location);
+    }
+}
+
+/* Prints sinCos calls and ns per recorded tick */
+void printRecordedTicks(bool with_motion, const trig_benchmark_t* trig) {
+    initializeLocalization();
+    trig_call_count = 0;
+    runRecordedTicks(with_motion);
+    double calls_per_tick = (double) trig_call_count / LOCALIZATION_MEASUREMENT_LOCATION_ROWS;
+
+    double start = benchNowNs();
+    for (int r = 0; r < TICK_REPETITIONS; r++) {
+        initializeLocalization();
+        runRecordedTicks(with_motion);
+    }
+    double ns_per_tick = (benchNowNs() - start) / (TICK_REPETITIONS * LOCALIZATION_MEASUREMENT_LOCATION_ROWS);
+
+    printf("sinCos calls per tick:      %.1f\n", calls_per_tick);
+    printf("trig ns per tick (libm):    %.1f\n", calls_per_tick * trig->libm_ns);
+    printf("trig ns per tick (table):   %.1f\n", calls_per_tick * trig->table_ns);
+    #ifdef TRIG_LOOKUP_TABLE
+        printf("total ns per tick (table):  %.1f\n", ns_per_tick);
+    #else
+        printf("total ns per tick (libm):   %.1f\n", ns_per_tick);
+    #endif
+}
+
+/* ns per processMeasurementMapping call over the recorded measurements turned to each heading, best of MAPPING_RUNS */
+double benchmarkMapping() {
+    static pose_transform_t sensor_locations[MAPPING_HEADINGS][LOCALIZATION_MEASUREMENT_LOCATION_ROWS][NUM_SENSORS];
+    for (int heading = 0; heading < MAPPING_HEADINGS; heading++) {
+        for (int i = 0; i < LOCALIZATION_MEASUREMENT_LOCATION_ROWS; i++) {
+            gaussian_location_t location;
+            location.x_mu = localization_measurement_locations[i][0] + 2 * (CELL_LENGTH + WALL_THICKNESS);
+            location.y_mu = localization_measurement_locations[i][1] + 2 * (CELL_LENGTH + WALL_THICKNESS);
+            location.theta_mu = wrapAngle(localization_measurement_locations[i][2] + heading * HALF_PI);
+
+            pose_transform_t robot_transform;
+            makePoseTransform(&location, &robot_transform);
+            for (int j = 0; j < NUM_SENSORS; j++) {
+                composePoseTransform(&robot_transform, &sensor_offsets[j], &sensor_locations[heading][i][j]);
+            }
+        }
+    }
+
+    double best_ns = 0.0;
+    for (int run = 0; run < MAPPING_RUNS; run++) {
+        double start = benchNowNs();
+        for (int r = 0; r < MAPPING_REPETITIONS; r++) {
+            initializeLocalization();
+            for (int heading = 0; heading < MAPPING_HEADINGS; heading++) {
+                for (int i = 0; i < LOCALIZATION_MEASUREMENT_LOCATION_ROWS; i++) {
+                    for (int j = 0; j < NUM_SENSORS; j++) {
+                        sensor_reading_t reading;
+                        reading.state = GOOD;
+                        reading.distance = localization_measurement_data[i][j];
+
+                        hit_data_t hit_data;
+                        processMeasurementMapping(&sensor_locations[heading][i][j], &reading, &hit_data, j, true);
+                        benchKeep(hit_data);
+                    }
+                }
+            }
+        }
+        double ns = (benchNowNs() - start) /
+                        (MAPPING_REPETITIONS * MAPPING_HEADINGS * LOCALIZATION_MEASUREMENT_LOCATION_ROWS * NUM_SENSORS);
+        if (run == 0 || ns < best_ns) best_ns = ns;
+    }
+    return best_ns;
+}
+
+/* Wall update as it was done with one double per wall: multiply, clamp and compare to WALL_THRESHOLD */
+bool updateDoubleWall(double* exists, bool hit) {
+    if (hit) {
+        *exists = (1.0 - ((1.0 - *exists) * DOUBLE_WALL_UPDATE));
+    } else {
+        *exists = *exists * DOUBLE_WALL_UPDATE;
+    }
+    if (*exists > 1.0) *exists = 1.0;
+    if (*exists < 0.0) *exists = 0.0;
+    return *exists > WALL_THRESHOLD;
+}
+
+/* Wall update with int8 log odds: saturating add and integer compare */
+bool updateLogOddsWall(probabilistic_wall_t* wall, bool hit) {
+    updateWallLogOdds(wall, hit ? WALL_LOG_ODDS_UPDATE : -WALL_LOG_ODDS_UPDATE);
+    return wallExists(wall);
+}
+
+/* Applies the same pseudo random sequence of hits and misses to the walls of both representations */
+void printWallUpdates() {
+    static unsigned short indices[WALL_UPDATES];
+    static bool hits[WALL_UPDATES];
+    unsigned int seed = 12345;
+    for (int i = 0; i < WALL_UPDATES; i++) {
+        seed = seed * 1103515245 + 12345;
+        indices[i] = (seed >> 8) % NUM_WALLS;
+        hits[i] = ((seed >> 20) % 3) != 0;  // Mostly hits so walls move through the threshold and saturate
+    }
+
+    static double double_walls[NUM_WALLS];
+    static probabilistic_wall_t log_odds_walls[NUM_WALLS];
+    for (int i = 0; i < NUM_WALLS; i++) {
+        double_walls[i] = 0.5;
+        log_odds_walls[i].log_odds = 0;
+    }
+
+    int count = 0;
+    double start = benchNowNs();
+    for (int i = 0; i < WALL_UPDATES; i++) {
+        count += updateDoubleWall(&double_walls[indices[i]], hits[i]);
+    }
+    double double_ns = (benchNowNs() - start) / WALL_UPDATES;
+    benchKeep(count);
+
+    count = 0;
+    start = benchNowNs();
+    for (int i = 0; i < WALL_UPDATES; i++) {
+        count += updateLogOddsWall(&log_odds_walls[indices[i]], hits[i]);
+    }
+    double log_odds_ns = (benchNowNs() - start) / WALL_UPDATES;
+    benchKeep(count);
+
+    printf("wall type \tbytes/maze\tns/update\tMupdates/s\n");
+    printf("double    \t%10u\t%9.2f\t%10.1f\n", (unsigned int) (NUM_WALLS * sizeof(double)), double_ns, 1e3 / double_ns);
+    printf("int8 log odds\t%10u\t%9.2f\t%10.1f\n", (unsigned int) (NUM_WALLS * sizeof(probabilistic_wall_t)),
+            log_odds_ns, 1e3 / log_odds_ns);
+    printf("log odds threshold: %d (probability %f)\n", WALL_LOG_ODDS_THRESHOLD,
+            1.0 / (1.0 + exp(-(double) WALL_LOG_ODDS_THRESHOLD / WALL_LOG_ODDS_SCALE)));
+}
+
+
+/* ns and timestamp counter cycles per EKF step */
+typedef struct {
+    double predict_ns;
+    double predict_cycles;
+    double update_ns;
+    double update_cycles;
+} ekf_benchmark_t;
+
+/* Runs ekfPredict on every row of localization_test_data and ekfUpdate with a range measurement
+ * of each sensor, best of EKF_RUNS */
+template <typename T>
+ekf_benchmark_t benchmarkEkfBackend() {
+    ekf_benchmark_t result = { 0.0, 0.0, 0.0, 0.0 };
+
+    static gaussian_location<T> starts[LOCALIZATION_TEST_DATA_ROWS];
+    static gaussian_location<T> motions[LOCALIZATION_TEST_DATA_ROWS];
+    for (int i = 0; i < LOCALIZATION_TEST_DATA_ROWS; i++) {
+        starts[i].x_mu = localization_test_data[i][2];
+        starts[i].y_mu = localization_test_data[i][3];
+        starts[i].theta_mu = localization_test_data[i][4];
+        starts[i].x_sigma = INIT_X_SIGMA;
+        starts[i].y_sigma = INIT_Y_SIGMA;
+        starts[i].theta_sigma = INIT_THETA_SIGMA;
+        starts[i].xy_sigma = starts[i].x_theta_sigma = starts[i].y_theta_sigma = 0;
+        calculateMotion<T>(&motions[i], localization_test_data[i][0], localization_test_data[i][1]);
+    }
+
+    // Jacobians of each sensor seen from each start, with a wall 40mm away along the sensor's dominant axis
+    static pose_transform<T> robots[LOCALIZATION_TEST_DATA_ROWS];
+    static pose_transform<T> offsets[NUM_SENSORS];
+    static matrix<T, 1, 3> jacobians[LOCALIZATION_TEST_DATA_ROWS][NUM_SENSORS];
+    for (int j = 0; j < NUM_SENSORS; j++) {
+        offsets[j].x = sensor_offsets[j].x;
+        offsets[j].y = sensor_offsets[j].y;
+        offsets[j].theta = sensor_offsets[j].theta;
+        offsets[j].sin_theta = sensor_offsets[j].sin_theta;
+        offsets[j].cos_theta = sensor_offsets[j].cos_theta;
+    }
+    for (int i = 0; i < LOCALIZATION_TEST_DATA_ROWS; i++) {
+        makePoseTransform(&starts[i], &robots[i]);
+        for (int j = 0; j < NUM_SENSORS; j++) {
+            pose_transform<T> sensor;
+            composePoseTransform(&robots[i], &offsets[j], &sensor);
+            int side = abs(sensor.cos_theta) >= abs(sensor.sin_theta) ? 0 : 1;
+            jacobians[i][j] = rangeJacobian(&robots[i], &offsets[j], &sensor, T(40), side);
+        }
+    }
+
+    for (int run = 0; run < EKF_RUNS; run++) {
+        double start = benchNowNs();
+        unsigned long long start_cycles = benchNowCycles();
+        for (int r = 0; r < EKF_REPETITIONS; r++) {
+            for (int i = 0; i < LOCALIZATION_TEST_DATA_ROWS; i++) {
+                gaussian_location<T> location = starts[i];
+                ekfPredict<T>(&location, &motions[i]);
+                benchKeep(location);
+            }
+        }
+        double count = EKF_REPETITIONS * LOCALIZATION_TEST_DATA_ROWS;
+        double ns = (benchNowNs() - start) / count;
+        double cycles = (benchNowCycles() - start_cycles) / count;
+        if (run == 0 || ns < result.predict_ns) {
+            result.predict_ns = ns;
+            result.predict_cycles = cycles;
+        }
+
+        start = benchNowNs();
+        start_cycles = benchNowCycles();
+        for (int r = 0; r < EKF_REPETITIONS; r++) {
+            for (int i = 0; i < LOCALIZATION_TEST_DATA_ROWS; i++) {
+                gaussian_location<T> location = starts[i];
+                for (int j = 0; j < NUM_SENSORS; j++) {
+                    ekfUpdate<T>(&location, T(1), jacobians[i][j], T(RANGE_SENSOR_VARIANCE));
+                }
+                benchKeep(location);
+            }
+        }
+        count = EKF_REPETITIONS * LOCALIZATION_TEST_DATA_ROWS * NUM_SENSORS;
+        ns = (benchNowNs() - start) / count;
+        cycles = (benchNowCycles() - start_cycles) / count;
+        if (run == 0 || ns < result.update_ns) {
+            result.update_ns = ns;
+            result.update_cycles = cycles;
+        }
+    }
+    return result;
+}
+
+template <typename T>
+void printEkfBackend() {
+    ekf_benchmark_t result = benchmarkEkfBackend<T>();
+    printf("%-8s\t%10.1f\t%10.0f\t%10.1f\t%10.0f\n", numeric_policy<T>::name(),
+            result.predict_ns, result.predict_cycles, result.update_ns, result.update_cycles);
+}
+
+
+/* Pose error against the recorded locations and time per particle */
+typedef struct {
+    double particles_per_ms;
+    double ms_per_step;
+    double mean_error_xy;       // Mean distance from the recorded location in mm
+    double mean_error_theta;    // Mean error against the recorded theta in radians
+} particle_benchmark_t;
+
+/* Sensor readings of one recorded row */
+void recordedReadings(int row, sensor_reading_t* sensor_data) {
+    for (int j = 0; j < NUM_SENSORS; j++) {
+        sensor_data[j].state = GOOD;
+        sensor_data[j].distance = localization_measurement_data[row][j];
+    }
+}
+
+/* Adds the error of location against recorded row to the running sums */
+void addRecordedError(int row, gaussian_location_t* location, double* error_xy, double* error_theta) {
+    double dx = location->x_mu - localization_measurement_locations[row][0];
+    double dy = location->y_mu - localization_measurement_locations[row][1];
+    *error_xy += sqrt(dx * dx + dy * dy);
+    *error_theta += angleError(location->theta_mu, localization_measurement_locations[row][2]);
+}
+
+/* Maps the start cell from the recorded measurements, the particle filters then localize in it */
+void mapRecordedMeasurements() {
+    initializeLocalization();
+    runRecordedTicks(false);
+}
+
+/* Runs a particle filter of N particles (a motion step of no movement and a measurement step per row)
+ * over the recorded measurements, starting from the initial spread around the first recorded location */
+template <int N>
+particle_benchmark_t benchmarkParticleFilter() {
+    static particle_filter<N> filter;
+    particle_benchmark_t result = { 0.0, 0.0, 0.0, 0.0 };
+
+    gaussian_location_t start = { .x_mu = localization_measurement_locations[0][0],
+                                  .y_mu = localization_measurement_locations[0][1],
+                                  .theta_mu = localization_measurement_locations[0][2],
+                                  .x_sigma = INIT_X_SIGMA, .xy_sigma = INIT_XY_SIGMA, .y_sigma = INIT_Y_SIGMA,
+                                  .theta_sigma = INIT_THETA_SIGMA, .x_theta_sigma = 0, .y_theta_sigma = 0 };
+
+    for (int run = 0; run < PARTICLE_RUNS; run++) {
+        initializeParticles(&filter, &start, PARTICLE_SEED);
+        double error_xy = 0.0, error_theta = 0.0;
+        double elapsed = 0.0;
+
+        for (int i = 0; i < LOCALIZATION_MEASUREMENT_LOCATION_ROWS; i++) {
+            sensor_reading_t sensor_data[NUM_SENSORS];
+            recordedReadings(i, sensor_data);
+
+            gaussian_location_t estimate;
+            double begin = benchNowNs();
+            particleMotionStep(&filter, (location_t) 0, (location_t) 0);
+            particleMeasureStep(&filter, sensor_data);
+            particleResample(&filter);
+            particleEstimate(&filter, &estimate);
+            elapsed += benchNowNs() - begin;
+            benchKeep(estimate);
+
+            addRecordedError(i, &estimate, &error_xy, &error_theta);
+        }
+
+        double ms_per_step = elapsed / 1e6 / LOCALIZATION_MEASUREMENT_LOCATION_ROWS;
+        if (run == 0 || ms_per_step < result.ms_per_step) {
+            result.ms_per_step = ms_per_step;
+            result.particles_per_ms = N / ms_per_step;
+        }
+        result.mean_error_xy = error_xy / LOCALIZATION_MEASUREMENT_LOCATION_ROWS;
+        result.mean_error_theta = error_theta / LOCALIZATION_MEASUREMENT_LOCATION_ROWS;
+    }
+    return result;
+}
+
+template <int N>
+void printParticleFilter() {
+    particle_benchmark_t result = benchmarkParticleFilter<N>();
+    printf("particles %-4d\t%12.0f\t%10.4f\t%14.2f\t%17.4f\n", N, result.particles_per_ms, result.ms_per_step,
+            result.mean_error_xy, result.mean_error_theta);
+}
+
+/* The EKF over the same recorded measurements, for reference */
+void printEkfRecorded() {
+    double error_xy = 0.0, error_theta = 0.0;
+    double elapsed = 0.0;
+
+    initializeLocalization();
+    robot_location.x_mu = localization_measurement_locations[0][0];
+    robot_location.y_mu = localization_measurement_locations[0][1];
+    robot_location.theta_mu = localization_measurement_locations[0][2];
+    for (int i = 0; i < LOCALIZATION_MEASUREMENT_LOCATION_ROWS; i++) {
+        sensor_reading_t sensor_data[NUM_SENSORS];
+        recordedReadings(i, sensor_data);
+
+        double begin = benchNowNs();
+        localizeMotionStep(0.0, 0.0);
+        mazeMappingAndMeasureStep(sensor_data);
+        elapsed += benchNowNs() - begin;
+
+        addRecordedError(i, &robot_location, &error_xy, &error_theta);
+    }
+
+    printf("EKF (maps too)\t%12s\t%10.4f\t%14.2f\t%17.4f\n", "-", elapsed / 1e6 / LOCALIZATION_MEASUREMENT_LOCATION_ROWS,
+            error_xy / LOCALIZATION_MEASUREMENT_LOCATION_ROWS, error_theta / LOCALIZATION_MEASUREMENT_LOCATION_ROWS);
+}
+
+
+BENCH_FUNC_BEGIN {
+
+    BENCH_SECTION("sin + cos of one angle per numeric backend (libm vs sinCos table)");
+    printf("backend \t   libm ns\t  table ns\t   speedup\t   max error\n");
+    trig_benchmark_t trig_double = printTrigBackend<double>();
+    printTrigBackend<float>();
+    printTrigBackend<q16_16_t>();
+
+    BENCH_SECTION("Per tick trig cost of localizeMotionStep + mazeMappingAndMeasureStep (recorded measurements)");
+    printRecordedTicks(true, &trig_double);
+
+    BENCH_SECTION("Per invocation cost of mazeMappingAndMeasureStep (recorded measurements)");
+    printRecordedTicks(false, &trig_double);
+
+    BENCH_SECTION("processMeasurementMapping per ray (recorded measurements, 4 headings)");
+    printf("ray caster ns/ray:          %.1f\n", benchmarkMapping());
+
+    BENCH_SECTION("Wall update throughput, double vs int8 log odds (1M pseudo random updates)");
+    printWallUpdates();
+
+    BENCH_SECTION("localizeMotionStep kernel per numeric backend (all localization_test_data rows)");
+    printf("backend \tns/update\tmax err xy (mm)\tmax err theta (rad)\n");
+    printMotionBackend<double>();
+    printMotionBackend<float>();
+    printMotionBackend<q16_16_t>();
+
+    // Q16.16 can not hold the theta variances (about 1e-5 rad^2), so the EKF only runs in floating point
+    BENCH_SECTION("EKF predict and per sensor update per numeric backend (cycles from the timestamp counter)");
+    printf("backend \tpredict ns\tpredict cyc\t update ns\tupdate cyc\n");
+    printEkfBackend<double>();
+    printEkfBackend<float>();
+
+    BENCH_SECTION("Particle filter on the recorded measurements (error against the recorded locations)");
+    printf("filter        	particles/ms	   ms/step	mean err xy mm	mean err theta rad\n");
+    mapRecordedMeasurements();
+    printParticleFilter<32>();
+    printParticleFilter<64>();
+    printParticleFilter<128>();
+    printParticleFilter<256>();
+    printParticleFilter<512>();
+    printEkfRecorded();
+
+} BENCH_FUNC_END("localization_benchmark")
+
+#endif // ARDUINO
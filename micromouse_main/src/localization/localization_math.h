@@ -0,0 +1,304 @@
+/* localization_math.h
+ *
+ * Motion model of the localization subsystem templated on the numeric
+ * backend, so the same code can run in double, float or Q16.16 fixed
+ * point (see util/numeric_policy.h). localization.cpp instantiates it
+ * with location_t.
+ *
+ * pose_transform caches the sine and cosine of a pose so that points
+ * and directions relative to it can be mapped with multiply-adds.
+ *
+ * The EKF works on the state (x, y, theta) with the 3x3 covariance
+ * stored in the *_sigma fields of gaussian_location:
+ *  - ekfPredict: adds a motion and propagates the covariance through
+ *    the motion Jacobian
+ *  - ekfUpdate: corrects with one scalar measurement, rangeJacobian
+ *    gives the measurement Jacobian of a distance sensor ray
+ */
+
+#ifndef _LOCALIZATION_MATH_H_
+#define _LOCALIZATION_MATH_H_
+
+#include "gaussian_location.h"
+#include "../settings.h"
+#include "../util/numeric_policy.h"
+#include "../util/trig.h"
+#include "../util/matrix.h"
+#include "../abs.h"
+
+
+#define ENCODER_VARIANCE(d) (((ENCODER_VARIANCE_PER_MM) * abs(d)) + (ENCODER_VARIANCE_BASE))
+
+// Below this change in theta, sin(x)/x and (1 - cos(x))/x are evaluated by their series
+#define SMALL_ANGLE_RAD 0.25
+
+
+/* Rotate the covariance matrix described by x_sigma, y_sigma, and xy_sigma
+ * Assumes xy_sigma starts as 0 */
+template <typename T>
+void rotateCovariance(T rotate_by, T* x_sigma, T* y_sigma, T* xy_sigma) {
+
+    /* Rotation matrix
+        R:  [r1, r2]
+            [r3, r4]    */
+    T r1, r3;
+    sinCos(rotate_by, &r3, &r1);
+    T r2 = -1 * r3;
+    T r4 = r1;
+
+    // Rotate with: R * Sigma * R'
+    T x_temp = *x_sigma;
+    T y_temp = *y_sigma;
+
+    *x_sigma = (r1 * r1 * (x_temp)) + (r2 * r2 * (y_temp));
+    *y_sigma = (r3 * r3 * (x_temp)) + (r4 * r4 * (y_temp));
+    *xy_sigma = (r1 * r3 * (x_temp)) + (r2 * r4 * (y_temp));
+    *xy_sigma = -1 * *xy_sigma; // our axis are setup inverted in the y direction
+}
+
+/* Run the wheel distances through the system model
+ *  - The arc is written as distance * sin(x)/x instead of turn_radius * sin(x)
+ *    so nearly straight motion does not need a huge turn radius, which would
+ *    overflow the fixed point backend */
+template <typename T>
+void calculateMotion(gaussian_location<T>* motion, T left_distance, T right_distance) {
+
+    /* Run the motion through the system model */
+
+    T distance_travelled = (left_distance + right_distance) / 2;
+
+    // If going straight
+    if (left_distance != right_distance) {
+
+        // change_in_theta = (dr - dl)/l;
+        T delta_theta = (right_distance - left_distance) / WHEEL_BASE_LENGTH;
+
+        // sin(change_in_theta) / change_in_theta and (1 - cos(change_in_theta)) / change_in_theta
+        T sin_ratio;
+        T cos_ratio;
+        if (abs(delta_theta) < SMALL_ANGLE_RAD) {
+            T theta_sq = delta_theta * delta_theta;
+            sin_ratio = 1 - theta_sq * (1.0 / 6 - theta_sq * (1.0 / 120));
+            cos_ratio = delta_theta * (0.5 - theta_sq * (1.0 / 24 - theta_sq * (1.0 / 720)));
+        } else {
+            T sin_theta, cos_theta;
+            sinCos(delta_theta, &sin_theta, &cos_theta);
+            sin_ratio = sin_theta / delta_theta;
+            cos_ratio = (1 - cos_theta) / delta_theta;
+        }
+
+        // x = R .* sin(change_in_theta);
+        motion->x_mu = distance_travelled * sin_ratio;
+
+        // y = -1 .* R .* cos(change_in_theta) + R;
+        motion->y_mu = distance_travelled * cos_ratio;
+
+        // y = -1 .* y;
+        motion->y_mu = -1 * motion->y_mu; // our axis are setup inverted in the y direction
+
+        // theta = 2*pi - change_in_theta;
+        motion->theta_mu = TWO_PI - delta_theta; // our axis are setup inverted in the y direction
+
+    } else { // Special case when going perfectly straight
+
+        motion->x_mu = left_distance;
+        motion->y_mu = 0.0;
+        motion->theta_mu = 0.0;
+
+    }
+
+    /* Calculate the change in the covariance matrix */
+
+    motion->x_sigma = X_VARIANCE * ENCODER_VARIANCE(distance_travelled);
+    motion->y_sigma = Y_VARIANCE * ENCODER_VARIANCE(distance_travelled);
+    motion->xy_sigma = 0;
+    motion->theta_sigma = THETA_VARIANCE * ENCODER_VARIANCE(distance_travelled);
+
+    // If not straight
+    if (left_distance != right_distance)
+        // rotate covariance by motion->theta_mu
+        rotateCovariance(motion->theta_mu, &motion->x_sigma, &motion->y_sigma, &motion->xy_sigma);
+
+}
+
+/* Add in the mean of motion to the mean of current_location to get the final location
+ *  - In our inverted y axis this is a plain rotation of the motion by the current theta
+ *  - final_location may be the same as current_location */
+template <typename T>
+void addMotion(gaussian_location<T>* current_location, gaussian_location<T>* motion,
+                    gaussian_location<T>* final_location) {
+
+    T sin_theta, cos_theta;
+    sinCos(current_location->theta_mu, &sin_theta, &cos_theta);
+
+/* Calculate the change in x and y from rotating by the global theta */
+    T x_delta = (motion->x_mu * cos_theta) - (motion->y_mu * sin_theta);
+    T y_delta = (motion->x_mu * sin_theta) + (motion->y_mu * cos_theta);
+
+/* Calculate final location */
+    final_location->x_mu = current_location->x_mu + x_delta;
+    final_location->y_mu = current_location->y_mu + y_delta;
+
+/* limit final theta between 0 and 2 pi */
+    final_location->theta_mu = wrapAngle(current_location->theta_mu + motion->theta_mu);
+}
+
+/* A pose with the sine and cosine of its theta, built once and reused for every point mapped through it */
+template <typename T>
+struct pose_transform {
+    T x;
+    T y;
+    T theta;
+    T sin_theta;
+    T cos_theta;
+};
+
+typedef pose_transform<location_t> pose_transform_t;
+
+/* Build the transform of location, this is the only trig evaluated for it */
+template <typename T>
+void makePoseTransform(gaussian_location<T>* location, pose_transform<T>* transform) {
+    transform->x = location->x_mu;
+    transform->y = location->y_mu;
+    transform->theta = location->theta_mu;
+    sinCos(location->theta_mu, &transform->sin_theta, &transform->cos_theta);
+}
+
+/* Map the point (local_x, local_y) relative to transform into global coordinates */
+template <typename T>
+void transformPoint(pose_transform<T>* transform, T local_x, T local_y, T* x, T* y) {
+    *x = transform->x + (local_x * transform->cos_theta) - (local_y * transform->sin_theta);
+    *y = transform->y + (local_x * transform->sin_theta) + (local_y * transform->cos_theta);
+}
+
+/* Same as addMotion(), for an offset whose sine and cosine are already known in offset
+ * - Angles are added with the sum formulas so no trig is evaluated
+ * - final_transform may not be the same as transform */
+template <typename T>
+void composePoseTransform(pose_transform<T>* transform, pose_transform<T>* offset, pose_transform<T>* final_transform) {
+    transformPoint(transform, offset->x, offset->y, &final_transform->x, &final_transform->y);
+    final_transform->theta = wrapAngle(transform->theta + offset->theta);
+    final_transform->sin_theta = (transform->sin_theta * offset->cos_theta) + (transform->cos_theta * offset->sin_theta);
+    final_transform->cos_theta = (transform->cos_theta * offset->cos_theta) - (transform->sin_theta * offset->sin_theta);
+}
+
+
+/* Covariance of location over (x, y, theta) */
+template <typename T>
+matrix<T, 3, 3> covarianceOf(gaussian_location<T>* location) {
+    matrix<T, 3, 3> P = {{
+        { location->x_sigma,        location->xy_sigma,         location->x_theta_sigma },
+        { location->xy_sigma,       location->y_sigma,          location->y_theta_sigma },
+        { location->x_theta_sigma,  location->y_theta_sigma,    location->theta_sigma   }
+    }};
+    return P;
+}
+
+/* Store P as the covariance of location, averaging out any asymmetry from rounding */
+template <typename T>
+void setCovariance(gaussian_location<T>* location, const matrix<T, 3, 3>& P) {
+    location->x_sigma = P.m[0][0];
+    location->y_sigma = P.m[1][1];
+    location->theta_sigma = P.m[2][2];
+    location->xy_sigma = (P.m[0][1] + P.m[1][0]) / 2;
+    location->x_theta_sigma = (P.m[0][2] + P.m[2][0]) / 2;
+    location->y_theta_sigma = (P.m[1][2] + P.m[2][1]) / 2;
+}
+
+/* EKF predict step
+ *  - The mean moves the same as addMotion(location, motion, location)
+ *  - P = F * P * F' + G * Q * G', F is the Jacobian of the motion model in the robot's
+ *    state and G rotates the motion's covariance Q (from calculateMotion) into global axes */
+template <typename T>
+void ekfPredict(gaussian_location<T>* location, gaussian_location<T>* motion) {
+
+    T sin_theta, cos_theta;
+    sinCos(location->theta_mu, &sin_theta, &cos_theta);
+
+    T x_delta = (motion->x_mu * cos_theta) - (motion->y_mu * sin_theta);
+    T y_delta = (motion->x_mu * sin_theta) + (motion->y_mu * cos_theta);
+
+    matrix<T, 3, 3> F = {{
+        { 1, 0, -y_delta },
+        { 0, 1, x_delta  },
+        { 0, 0, 1        }
+    }};
+    matrix<T, 3, 3> G = {{
+        { cos_theta,    -sin_theta, 0 },
+        { sin_theta,    cos_theta,  0 },
+        { 0,            0,          1 }
+    }};
+    matrix<T, 3, 3> Q = {{
+        { motion->x_sigma,  motion->xy_sigma,   0                   },
+        { motion->xy_sigma, motion->y_sigma,    0                   },
+        { 0,                0,                  motion->theta_sigma }
+    }};
+
+    setCovariance(location, (F * covarianceOf(location) * transpose(F)) + (G * Q * transpose(G)));
+
+    location->x_mu = location->x_mu + x_delta;
+    location->y_mu = location->y_mu + y_delta;
+    location->theta_mu = wrapAngle(location->theta_mu + motion->theta_mu);
+}
+
+/* EKF update step with one scalar measurement
+ *  - innovation: measured value - expected value
+ *  - H: Jacobian of the expected value in (x, y, theta), variance: variance of the measurement
+ *  - Measurements more than sqrt(EKF_GATE) standard deviations from the expected value are
+ *    rejected as outliers, returns if the measurement was used */
+template <typename T>
+bool ekfUpdate(gaussian_location<T>* location, T innovation, const matrix<T, 1, 3>& H, T variance) {
+
+    matrix<T, 3, 3> P = covarianceOf(location);
+    matrix<T, 3, 1> PHt = P * transpose(H);
+
+    // Innovation covariance
+    T S = (H * PHt).m[0][0] + variance;
+    if (!(S > 0) || innovation * innovation > EKF_GATE * S) {
+        return false;
+    }
+
+    // Kalman gain
+    matrix<T, 3, 1> K = (1 / S) * PHt;
+
+    location->x_mu = location->x_mu + K.m[0][0] * innovation;
+    location->y_mu = location->y_mu + K.m[1][0] * innovation;
+    location->theta_mu = wrapAngle(location->theta_mu + K.m[2][0] * innovation);
+
+    // Joseph form keeps P symmetric and positive: (I - K H) P (I - K H)' + K R K'
+    matrix<T, 3, 3> I_KH = identityMatrix<T, 3>() - (K * H);
+    setCovariance(location, (I_KH * P * transpose(I_KH)) + (variance * (K * transpose(K))));
+    return true;
+}
+
+/* Jacobian in (x, y, theta) of the distance a sensor's ray travels to an axis aligned wall
+ *  - robot: the robot's pose, offset: the sensor's pose on the robot, sensor: the two composed
+ *  - distance: the expected distance to the wall, side: 0 if the wall is crossed moving along x
+ *    (a wall parallel to the y-axis), 1 if crossed moving along y
+ *
+ *  For side 0 the wall is at X = sensor x + distance * cos(phi), so
+ *  distance = (X - sensor x) / cos(phi), with phi the sensor's theta, and differentiating gives
+ *  the Jacobian below. Side 1 is the same with y and sin(phi). */
+template <typename T>
+matrix<T, 1, 3> rangeJacobian(pose_transform<T>* robot, pose_transform<T>* offset, pose_transform<T>* sensor,
+                                T distance, int side) {
+
+    // Derivative of the sensor's position with respect to the robot's theta
+    T dx_dtheta = -(offset->x * robot->sin_theta) - (offset->y * robot->cos_theta);
+    T dy_dtheta = (offset->x * robot->cos_theta) - (offset->y * robot->sin_theta);
+
+    matrix<T, 1, 3> H;
+    if (side == 0) {
+        H.m[0][0] = -1 / sensor->cos_theta;
+        H.m[0][1] = 0;
+        H.m[0][2] = (-dx_dtheta + distance * sensor->sin_theta) / sensor->cos_theta;
+    } else {
+        H.m[0][0] = 0;
+        H.m[0][1] = -1 / sensor->sin_theta;
+        H.m[0][2] = (-dy_dtheta - distance * sensor->cos_theta) / sensor->sin_theta;
+    }
+    return H;
+}
+
+
+#endif //_LOCALIZATION_MATH_H_
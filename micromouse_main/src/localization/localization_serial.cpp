@@ -23,27 +23,27 @@ void printLocalizeMapping() {
 
     Serial.print("DEBUG_LOCALIZE_MAPPING:");
     Serial.print(" North: ");
-    Serial.print(robot_maze_state.cells[0][0].north->exists);
+    Serial.print(wallProbability(mazeWall(&robot_maze_state, 0, 0, North)));
     Serial.print(" East: ");
-    Serial.print(robot_maze_state.cells[0][0].east->exists);
+    Serial.print(wallProbability(mazeWall(&robot_maze_state, 0, 0, East)));
     Serial.print(" South: ");
-    Serial.print(robot_maze_state.cells[0][0].south->exists);
+    Serial.print(wallProbability(mazeWall(&robot_maze_state, 0, 0, South)));
     Serial.print(" West: ");
-    Serial.print(robot_maze_state.cells[0][0].west->exists);
+    Serial.print(wallProbability(mazeWall(&robot_maze_state, 0, 0, West)));
     Serial.println();
 
     // Serial.print("DEBUG_LOCALIZE_MAPPING: \r\n");
     // for (int y = 0; y < 5; y++) {
     //     for (int x = 0; x < 5; x++) {
     //         Serial.print("|XXXXXXX| ");
-    //         Serial.print(robot_maze_state.cells[x][y].north->exists);
+    //         Serial.print(wallProbability(mazeWall(&robot_maze_state, x, y, North)));
     //         Serial.print("\t");
     //     }
     //     Serial.print("|\r\n|-------------------------------------------------------------------------------|\r\n");
 
     //     for (int x = 0; x < 5; x++) {
     //         Serial.print("| ");
-    //         Serial.print(robot_maze_state.cells[x][y].west->exists);
+    //         Serial.print(wallProbability(mazeWall(&robot_maze_state, x, y, West)));
     //         Serial.print("\t|\t");
     //     }
     //     Serial.print("|\r\n|-------------------------------------------------------------------------------|\r\n");
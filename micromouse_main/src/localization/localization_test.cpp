@@ -1,6 +1,7 @@
 #ifndef ARDUINO
 #include "localization.h"
 #include "localization_test_data.h"
+#include "particle_filter.h"
 #include "../testing.h"
 #include "../settings.h"
 #include "../util/conversions.h"
@@ -13,7 +14,7 @@ void print_maze_state() {
     printf("\nMaze State:\n");
     for (int y = 0; y < 5; y++) {
         for (int x = 0; x < 5; x++) {
-            printf("|XXXXXXX| %.3f\t", robot_maze_state.cells[x][y].north->exists);
+            printf("|XXXXXXX| %.3f\t", wallProbability(mazeWall(&robot_maze_state, x, y, North)));
         }
         printf("|\n|");
         for (int i = 0; i < 79; i++)
@@ -21,7 +22,7 @@ void print_maze_state() {
         printf("|\n");
 
         for (int x = 0; x < 5; x++) {
-            printf("| %.3f\t|\t", robot_maze_state.cells[x][y].west->exists);
+            printf("| %.3f\t|\t", wallProbability(mazeWall(&robot_maze_state, x, y, West)));
         }
         printf("|\n|");
 
@@ -32,6 +33,34 @@ void print_maze_state() {
     printf("\n");
 }
 
+/* Map one front reading of the east wall, 0.5 radians off the axes, after a motion step, true if any wall changed */
+bool mapsAfterMotion(double left_distance, double right_distance) {
+    initializeLocalization();
+    localizeMotionStep(left_distance, right_distance);
+
+    robot_location.x_mu = cellNumberToCoordinateDistance(1);
+    robot_location.y_mu = cellNumberToCoordinateDistance(1);
+    robot_location.theta_mu = 0.5;
+
+    sensor_reading_t readings[NUM_SENSORS];
+    for (int i = 0; i < NUM_SENSORS; i++) {
+        readings[i] = (sensor_reading_t){ .state = ERROR, .distance = 0 };
+    }
+    readings[2] = (sensor_reading_t){ .state = GOOD, .distance = 50 };
+
+    static double walls[NUM_WALLS];
+    for (int i = 0; i < NUM_WALLS; i++) {
+        walls[i] = wallProbability(mazeWallByNumber(&robot_maze_state, i));
+    }
+    mazeMappingAndMeasureStep(readings);
+    for (int i = 0; i < NUM_WALLS; i++) {
+        if (wallProbability(mazeWallByNumber(&robot_maze_state, i)) != walls[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
 TEST_FUNC_BEGIN {
     
 /* Test robot_location setup */
@@ -86,6 +115,7 @@ TEST_FUNC_BEGIN {
     // printf("x: %f, y: %f, theta: %f\n", robot_location.x_mu, robot_location.y_mu, robot_location.theta_mu);
 
 
+#if LOCALIZATION_FILTER == EKF_FILTER  // The particle filter's steps are random, see the particle tests below
 /* Test localizeMotionStep */
 
     for (int i = 0; i < LOCALIZATION_TEST_DATA_ROWS; i++) {
@@ -128,247 +158,11 @@ TEST_FUNC_BEGIN {
     TEST_PASS("localize motion step");
     after_localize_motion_step:
     ;
+#endif
 
     // Test mazeMappingAndMeasureStep
     initializeLocalization();
 
-    double measurements[][NUM_SENSORS] = {
-        {40, 56, 45, 41, 56},
-        {41, 56, 38, 41, 58},
-        {40, 55, 41, 43, 58},
-        {39, 54, 39, 41, 60},
-        {40, 56, 40, 41, 57},
-        {40, 55, 40, 41, 57},
-        {42, 56, 43, 41, 59},
-        {40, 53, 39, 45, 59},
-        {41, 54, 40, 43, 58},
-        {41, 53, 38, 41, 57},
-        {39, 54, 39, 42, 60},
-        {39, 56, 39, 42, 59},
-        {41, 55, 41, 42, 58},
-        {39, 54, 40, 41, 57},
-        {41, 56, 41, 44, 59},
-        {41, 55, 40, 42, 57},
-        {41, 56, 40, 42, 58},
-        {40, 54, 39, 42, 55},
-        {41, 56, 39, 40, 57},
-        {42, 56, 39, 40, 57},
-        {41, 55, 41, 42, 59},
-        {41, 56, 37, 43, 57},
-        {40, 55, 38, 40, 58},
-        {40, 54, 39, 42, 59},
-        {41, 53, 41, 43, 60},
-        {40, 53, 40, 43, 57},
-        {39, 54, 41, 43, 57},
-        {39, 56, 40, 41, 58},
-        {42, 55, 40, 42, 58},
-        {40, 55, 39, 42, 60},
-        {39, 53, 39, 42, 57},
-        {40, 55, 38, 42, 57},
-        {39, 56, 42, 40, 56},
-        {39, 52, 41, 41, 56},
-        {41, 54, 39, 46, 57},
-        {41, 55, 39, 42, 57},
-        {40, 56, 39, 41, 57},
-        {43, 54, 38, 41, 59},
-        {39, 54, 41, 43, 58},
-        {40, 54, 39, 41, 58},
-        {40, 56, 39, 44, 57},
-        {39, 53, 40, 41, 58},
-        {42, 55, 40, 40, 60},
-        {40, 55, 37, 41, 58},
-        {40, 54, 39, 42, 58},
-        {40, 55, 39, 42, 57},
-        {41, 54, 39, 42, 57},
-        {41, 57, 39, 42, 59},
-        {41, 55, 39, 46, 59},
-        {39, 53, 40, 42, 56},
-        {40, 54, 41, 41, 58},
-        {39, 55, 39, 44, 57},
-        {41, 54, 39, 43, 58},
-        {39, 55, 40, 43, 58},
-        {42, 55, 42, 42, 59},
-        {40, 54, 39, 41, 59},
-        {40, 54, 39, 42, 59},
-        {41, 54, 41, 42, 58},
-        {43, 56, 39, 41, 57},
-        {41, 54, 38, 42, 60},
-        {40, 55, 39, 44, 57},
-        {39, 53, 41, 42, 58},
-        {41, 54, 40, 42, 59},
-        {41, 54, 39, 42, 56},
-        {40, 53, 40, 40, 58},
-        {41, 53, 40, 42, 59},
-        {40, 54, 41, 43, 58},
-        {39, 54, 40, 42, 59},
-        {40, 54, 39, 41, 60},
-        {41, 55, 39, 42, 60},
-        {41, 53, 40, 41, 57},
-        {40, 55, 38, 40, 59},
-        {41, 56, 39, 43, 58},
-        {41, 56, 39, 40, 58},
-        {43, 55, 39, 42, 59},
-        {41, 55, 40, 42, 59},
-        {41, 58, 41, 43, 58},
-        {39, 55, 39, 41, 59},
-        {41, 56, 43, 41, 59},
-        {41, 56, 42, 44, 57},
-        {40, 54, 40, 42, 57},
-        {42, 54, 40, 43, 59},
-        {41, 54, 41, 41, 58},
-        {41, 53, 40, 46, 59},
-        {43, 53, 38, 42, 59},
-        {40, 56, 39, 40, 60},
-        {40, 55, 39, 41, 59},
-        {42, 53, 38, 41, 57},
-        {40, 54, 39, 43, 59},
-        {39, 54, 38, 41, 58},
-        {40, 53, 41, 43, 58},
-        {40, 54, 40, 41, 58},
-        {43, 56, 42, 42, 58},
-        {40, 54, 39, 42, 58},
-        {40, 54, 38, 40, 59},
-        {40, 52, 40, 40, 57},
-        {38, 54, 40, 44, 58},
-        {40, 53, 41, 40, 57},
-        {41, 54, 39, 42, 59},
-        {40, 55, 41, 40, 57},
-        {42, 54, 39, 41, 58},
-        {42, 55, 40, 42, 59},
-        {41, 55, 40, 41, 57},
-        {40, 55, 40, 43, 58},
-        {41, 55, 39, 42, 58},
-        {40, 52, 40, 40, 58},
-        {40, 55, 40, 42, 59},
-        {39, 53, 39, 43, 58},
-        {41, 54, 38, 42, 59},
-        {41, 53, 40, 41, 60},
-        {40, 54, 40, 43, 56},
-        {41, 53, 39, 42, 58},
-        {42, 54, 42, 41, 57},
-        {40, 55, 39, 41, 57},
-        {39, 55, 40, 42, 56},
-        {41, 53, 40, 41, 57}
-    };
-
-    double locations[][3] = {
-        {84.01, 84.02, 3.14},    // DEBUG_LOCALIZE_MEASURE
-        {84.01, 84.06, 3.14},    // DEBUG_LOCALIZE_MEASURE
-        {84.07, 84.17, 3.14},    // DEBUG_LOCALIZE_MEASURE
-        {84.09, 84.32, 3.15},    // DEBUG_LOCALIZE_MEASURE
-        {84.13, 84.33, 3.15},    // DEBUG_LOCALIZE_MEASURE
-        {84.17, 84.37, 3.15},    // DEBUG_LOCALIZE_MEASURE
-        {84.26, 84.38, 3.15},    // DEBUG_LOCALIZE_MEASURE
-        {84.28, 84.57, 3.15},    // DEBUG_LOCALIZE_MEASURE
-        {84.31, 84.64, 3.15},    // DEBUG_LOCALIZE_MEASURE
-        {84.30, 84.67, 3.15},    // DEBUG_LOCALIZE_MEASURE
-        {84.32, 84.80, 3.15},    // DEBUG_LOCALIZE_MEASURE
-        {84.33, 84.85, 3.15},    // DEBUG_LOCALIZE_MEASURE
-        {84.38, 84.87, 3.15},    // DEBUG_LOCALIZE_MEASURE
-        {84.41, 84.90, 3.15},    // DEBUG_LOCALIZE_MEASURE
-        {84.46, 84.95, 3.15},    // DEBUG_LOCALIZE_MEASURE
-        {84.50, 84.93, 3.15},    // DEBUG_LOCALIZE_MEASURE
-        {84.53, 84.92, 3.15},    // DEBUG_LOCALIZE_MEASURE
-        {84.54, 84.90, 3.15},    // DEBUG_LOCALIZE_MEASURE
-        {84.55, 84.83, 3.15},    // DEBUG_LOCALIZE_MEASURE
-        {84.55, 84.74, 3.15},    // DEBUG_LOCALIZE_MEASURE
-        {84.60, 84.79, 3.15},    // DEBUG_LOCALIZE_MEASURE
-        {84.57, 84.78, 3.15},    // DEBUG_LOCALIZE_MEASURE
-        {84.56, 84.78, 3.15},    // DEBUG_LOCALIZE_MEASURE
-        {84.57, 84.86, 3.15},    // DEBUG_LOCALIZE_MEASURE
-        {84.61, 84.97, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {84.64, 85.03, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {84.69, 85.09, 3.15},    // DEBUG_LOCALIZE_MEASURE
-        {84.71, 85.08, 3.15},    // DEBUG_LOCALIZE_MEASURE
-        {84.74, 85.06, 3.15},    // DEBUG_LOCALIZE_MEASURE
-        {84.74, 85.11, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {84.75, 85.16, 3.15},    // DEBUG_LOCALIZE_MEASURE
-        {84.73, 85.15, 3.15},    // DEBUG_LOCALIZE_MEASURE
-        {84.80, 85.08, 3.15},    // DEBUG_LOCALIZE_MEASURE
-        {84.84, 85.11, 3.15},    // DEBUG_LOCALIZE_MEASURE
-        {84.85, 85.18, 3.15},    // DEBUG_LOCALIZE_MEASURE
-        {84.85, 85.15, 3.15},    // DEBUG_LOCALIZE_MEASURE
-        {84.85, 85.10, 3.15},    // DEBUG_LOCALIZE_MEASURE
-        {84.83, 85.07, 3.15},    // DEBUG_LOCALIZE_MEASURE
-        {84.88, 85.14, 3.15},    // DEBUG_LOCALIZE_MEASURE
-        {84.88, 85.15, 3.15},    // DEBUG_LOCALIZE_MEASURE
-        {84.88, 85.16, 3.15},    // DEBUG_LOCALIZE_MEASURE
-        {84.90, 85.21, 3.15},    // DEBUG_LOCALIZE_MEASURE
-        {84.93, 85.17, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {84.89, 85.16, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {84.89, 85.18, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {84.89, 85.17, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {84.89, 85.16, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {84.90, 85.12, 3.15},    // DEBUG_LOCALIZE_MEASURE
-        {84.90, 85.21, 3.15},    // DEBUG_LOCALIZE_MEASURE
-        {84.92, 85.24, 3.15},    // DEBUG_LOCALIZE_MEASURE
-        {84.96, 85.24, 3.15},    // DEBUG_LOCALIZE_MEASURE
-        {84.96, 85.28, 3.15},    // DEBUG_LOCALIZE_MEASURE
-        {84.96, 85.30, 3.15},    // DEBUG_LOCALIZE_MEASURE
-        {84.98, 85.33, 3.15},    // DEBUG_LOCALIZE_MEASURE
-        {85.04, 85.31, 3.15},    // DEBUG_LOCALIZE_MEASURE
-        {85.04, 85.32, 3.15},    // DEBUG_LOCALIZE_MEASURE
-        {85.04, 85.36, 3.15},    // DEBUG_LOCALIZE_MEASURE
-        {85.08, 85.35, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {85.08, 85.22, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {85.06, 85.26, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {85.05, 85.28, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {85.09, 85.34, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {85.11, 85.35, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {85.11, 85.30, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {85.13, 85.30, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {85.14, 85.34, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {85.18, 85.37, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {85.19, 85.42, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {85.19, 85.45, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {85.18, 85.45, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {85.20, 85.42, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {85.18, 85.38, 3.17},    // DEBUG_LOCALIZE_MEASURE
-        {85.17, 85.35, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {85.17, 85.26, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {85.17, 85.22, 3.17},    // DEBUG_LOCALIZE_MEASURE
-        {85.19, 85.22, 3.17},    // DEBUG_LOCALIZE_MEASURE
-        {85.22, 85.17, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {85.22, 85.19, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {85.29, 85.16, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {85.35, 85.15, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {85.36, 85.16, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {85.37, 85.18, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {85.40, 85.17, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {85.41, 85.30, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {85.39, 85.29, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {85.38, 85.27, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {85.37, 85.27, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {85.34, 85.22, 3.17},    // DEBUG_LOCALIZE_MEASURE
-        {85.33, 85.29, 3.17},    // DEBUG_LOCALIZE_MEASURE
-        {85.31, 85.30, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {85.34, 85.36, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {85.35, 85.35, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {85.41, 85.26, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {85.40, 85.28, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {85.37, 85.28, 3.17},    // DEBUG_LOCALIZE_MEASURE
-        {85.38, 85.28, 3.17},    // DEBUG_LOCALIZE_MEASURE
-        {85.39, 85.38, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {85.42, 85.35, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {85.41, 85.36, 3.17},    // DEBUG_LOCALIZE_MEASURE
-        {85.45, 85.29, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {85.44, 85.25, 3.17},    // DEBUG_LOCALIZE_MEASURE
-        {85.45, 85.23, 3.17},    // DEBUG_LOCALIZE_MEASURE
-        {85.46, 85.17, 3.17},    // DEBUG_LOCALIZE_MEASURE
-        {85.47, 85.20, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {85.46, 85.18, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {85.47, 85.21, 3.17},    // DEBUG_LOCALIZE_MEASURE
-        {85.48, 85.23, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {85.47, 85.31, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {85.44, 85.33, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {85.45, 85.36, 3.17},    // DEBUG_LOCALIZE_MEASURE
-        {85.46, 85.35, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {85.45, 85.36, 3.17},    // DEBUG_LOCALIZE_MEASURE
-        {85.50, 85.29, 3.17},    // DEBUG_LOCALIZE_MEASURE
-        {85.49, 85.25, 3.16},    // DEBUG_LOCALIZE_MEASURE
-        {85.50, 85.23, 3.16}     // DEBUG_LOCALIZE_MEASURE
-    };
-
     sensor_reading_t sensor_test_data[NUM_SENSORS];
     sensor_test_data[0] = (sensor_reading_t){ .state = GOOD, .distance = 40 };
     sensor_test_data[1] = (sensor_reading_t){ .state = GOOD, .distance = 56  };
@@ -380,27 +174,27 @@ TEST_FUNC_BEGIN {
     robot_location.y_mu = 84.0;
     robot_location.theta_mu = PI;
 
-    //robot_maze_state.cells[0][0].south->exists = 1.0;
-    //robot_maze_state.cells[0][1].south->exists = 1.0;
+    //wallProbability(mazeWall(&robot_maze_state, 0, 0, South)) = 1.0;
+    //wallProbability(mazeWall(&robot_maze_state, 0, 1, South)) = 1.0;
 
     printf("Robot_location: (%f, %f, %f)\n\n", robot_location.x_mu, robot_location.y_mu, robot_location.theta_mu);
     
     for (int i = 0; i < 1; i++) {
 
-        // printf("measurements[i][0]: %f\n", measurements[i][0]);
-        // sensor_test_data[0].distance = measurements[i][0];
+        // printf("localization_measurement_data[i][0]: %f\n", localization_measurement_data[i][0]);
+        // sensor_test_data[0].distance = localization_measurement_data[i][0];
         // printf("sensor_test_data[0].distance: %f\n", sensor_test_data[0].distance);
-        // printf("measurements[i][1]: %f\n", measurements[i][1]);
-        // sensor_test_data[1].distance = measurements[i][1];
+        // printf("localization_measurement_data[i][1]: %f\n", localization_measurement_data[i][1]);
+        // sensor_test_data[1].distance = localization_measurement_data[i][1];
         // printf("sensor_test_data[1].distance: %f\n", sensor_test_data[1].distance);
-        // printf("measurements[i][2]: %f\n", measurements[i][2]);
-        // sensor_test_data[2].distance = measurements[i][2];
+        // printf("localization_measurement_data[i][2]: %f\n", localization_measurement_data[i][2]);
+        // sensor_test_data[2].distance = localization_measurement_data[i][2];
         // printf("sensor_test_data[2].distance: %f\n", sensor_test_data[2].distance);
-        // printf("measurements[i][3]: %f\n", measurements[i][3]);
-        // sensor_test_data[3].distance = measurements[i][3];
+        // printf("localization_measurement_data[i][3]: %f\n", localization_measurement_data[i][3]);
+        // sensor_test_data[3].distance = localization_measurement_data[i][3];
         // printf("sensor_test_data[3].distance: %f\n", sensor_test_data[3].distance);
-        // printf("measurements[i][4]: %f\n", measurements[i][4]);
-        // sensor_test_data[4].distance = measurements[i][4];
+        // printf("localization_measurement_data[i][4]: %f\n", localization_measurement_data[i][4]);
+        // sensor_test_data[4].distance = localization_measurement_data[i][4];
         // printf("sensor_test_data[4].distance: %f\n", sensor_test_data[4].distance);
         // printf("\n");
 
@@ -409,13 +203,285 @@ TEST_FUNC_BEGIN {
         printf("Robot_location: (%f, %f, %f)\n\n", robot_location.x_mu, robot_location.y_mu, robot_location.theta_mu);
     }
 
-    // printf("North: %f\n", robot_maze_state.cells[1][1].north->exists);
-    // printf("East: %f\n", robot_maze_state.cells[1][1].east->exists);
-    // printf("South: %f\n", robot_maze_state.cells[1][1].south->exists);
-    // printf("West: %f\n", robot_maze_state.cells[1][1].west->exists);
+    // printf("North: %f\n", wallProbability(mazeWall(&robot_maze_state, 1, 1, North)));
+    // printf("East: %f\n", wallProbability(mazeWall(&robot_maze_state, 1, 1, East)));
+    // printf("South: %f\n", wallProbability(mazeWall(&robot_maze_state, 1, 1, South)));
+    // printf("West: %f\n", wallProbability(mazeWall(&robot_maze_state, 1, 1, West)));
     
     print_maze_state();
 
+/* Test mapping off the axes, along a search arc at the stable speed but not spinning on the spot */
+
+    {
+        double forward = STRAIGHT_PROFILE_STABLE_SPEED * CONTROL_LOOP_TIME / 1000000.0;
+        double turn = forward * WHEEL_BASE_LENGTH / (CELL_LENGTH + WALL_THICKNESS);
+        if (!mapsAfterMotion(forward - turn, forward + turn) || mapsAfterMotion(-forward, forward)) {
+            TEST_FAIL("mapping along an arc");
+        } else {
+            TEST_PASS("mapping along an arc");
+        }
+    }
+
+/* Test the EKF predict step against numerical derivatives of addMotion */
+
+    {
+        gaussian_location_t location = { .x_mu = 300.0, .y_mu = 500.0, .theta_mu = 0.7,
+                                         .x_sigma = 9.0, .xy_sigma = 1.5, .y_sigma = 4.0, .theta_sigma = 0.02,
+                                         .x_theta_sigma = 0.1, .y_theta_sigma = -0.05 };
+        gaussian_location_t motion;
+        calculateMotion(&motion, 20.0, 26.0);
+
+        // F[i][j] = d(location after motion)[i] / d(location)[j]
+        double F[3][3];
+        for (int j = 0; j < 3; j++) {
+            double step = 1e-2;  // Spans several steps of the sine table, so its interpolation does not show up as slope error
+            gaussian_location_t plus = location, minus = location;
+            (&plus.x_mu)[j] += step;
+            (&minus.x_mu)[j] -= step;
+            addMotion(&plus, &motion, &plus);
+            addMotion(&minus, &motion, &minus);
+            for (int i = 0; i < 3; i++) {
+                double difference = i == 2 ? angleDifference(plus.theta_mu, minus.theta_mu) : (&plus.x_mu)[i] - (&minus.x_mu)[i];
+                F[i][j] = difference / (2 * step);
+            }
+        }
+
+        double P[3][3] = { { location.x_sigma, location.xy_sigma, location.x_theta_sigma },
+                           { location.xy_sigma, location.y_sigma, location.y_theta_sigma },
+                           { location.x_theta_sigma, location.y_theta_sigma, location.theta_sigma } };
+        double G[3][3] = { { cos(location.theta_mu), -sin(location.theta_mu), 0 },
+                           { sin(location.theta_mu), cos(location.theta_mu), 0 },
+                           { 0, 0, 1 } };
+        double Q[3][3] = { { motion.x_sigma, motion.xy_sigma, 0 },
+                           { motion.xy_sigma, motion.y_sigma, 0 },
+                           { 0, 0, motion.theta_sigma } };
+
+        // expected = F * P * F' + G * Q * G'
+        double expected[3][3];
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++) {
+                expected[i][j] = 0;
+                for (int k = 0; k < 3; k++) {
+                    for (int l = 0; l < 3; l++) {
+                        expected[i][j] += F[i][k] * P[k][l] * F[j][l] + G[i][k] * Q[k][l] * G[j][l];
+                    }
+                }
+            }
+        }
+
+        gaussian_location_t expected_mean = location;
+        addMotion(&expected_mean, &motion, &expected_mean);
+        ekfPredict(&location, &motion);
+        matrix<location_t, 3, 3> covariance = covarianceOf(&location);
+
+        if (location.x_mu != expected_mean.x_mu || location.y_mu != expected_mean.y_mu ||
+                location.theta_mu != expected_mean.theta_mu) {
+            TEST_FAIL("ekf predict");
+            goto after_ekf_predict;
+        }
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++) {
+                if (!IS_BETWEEN_ERROR(covariance.m[i][j], expected[i][j], 0.001 * (1 + abs(expected[i][j])))) {
+                    printf("P[%d][%d]: %f, expected %f\n", i, j, covariance.m[i][j], expected[i][j]);
+                    TEST_FAIL("ekf predict");
+                    goto after_ekf_predict;
+                }
+            }
+        }
+    }
+
+    TEST_PASS("ekf predict");
+    after_ekf_predict:
+    ;
+
+/* Test rangeJacobian against numerical derivatives of the ray caster's distance */
+
+    {
+        initializeLocalization();
+        setWallProbability(mazeWall(&robot_maze_state, 0, 0, East), 1.0);
+        setWallProbability(mazeWall(&robot_maze_state, 0, 0, North), 1.0);
+
+        // Front sensor towards the east wall, left sensors towards the north wall
+        gaussian_location_t location = { .x_mu = 80.0, .y_mu = 90.0, .theta_mu = 0.15,
+                                         .x_sigma = 0.0, .xy_sigma = 0.0, .y_sigma = 0.0, .theta_sigma = 0.0,
+                                         .x_theta_sigma = 0.0, .y_theta_sigma = 0.0 };
+        int sensors[] = { 2, 1 };
+
+        for (int n = 0; n < 2; n++) {
+            int sensor = sensors[n];
+            sensor_reading_t reading = { .state = GOOD, .distance = 60 };
+
+            pose_transform_t robot_transform, sensor_location;
+            hit_data_t hit_data;
+            makePoseTransform(&location, &robot_transform);
+            composePoseTransform(&robot_transform, &sensor_offsets[sensor], &sensor_location);
+            processMeasurementMapping(&sensor_location, &reading, &hit_data, sensor, true);
+            if (!hit_data.hit) {
+                TEST_FAIL("ekf range jacobian");
+                goto after_ekf_range_jacobian;
+            }
+            matrix<location_t, 1, 3> H = rangeJacobian(&robot_transform, &sensor_offsets[sensor], &sensor_location,
+                                                        (location_t) hit_data.distance_hit, (int) hit_data.side);
+
+            for (int j = 0; j < 3; j++) {
+                double step = 1e-2;  // Spans several steps of the sine table, so its interpolation does not show up as slope error
+                double distances[2];
+                for (int k = 0; k < 2; k++) {
+                    gaussian_location_t moved = location;
+                    (&moved.x_mu)[j] += k == 0 ? step : -step;
+                    makePoseTransform(&moved, &robot_transform);
+                    composePoseTransform(&robot_transform, &sensor_offsets[sensor], &sensor_location);
+                    hit_data_t moved_hit;
+                    processMeasurementMapping(&sensor_location, &reading, &moved_hit, sensor, true);
+                    distances[k] = moved_hit.distance_hit;
+                }
+                double derivative = (distances[0] - distances[1]) / (2 * step);
+                if (!IS_BETWEEN_ERROR(H.m[0][j], derivative, 0.001 * (1 + abs(derivative)))) {
+                    printf("Sensor %d, H[%d]: %f, expected %f\n", sensor, j, H.m[0][j], derivative);
+                    TEST_FAIL("ekf range jacobian");
+                    goto after_ekf_range_jacobian;
+                }
+            }
+        }
+    }
+
+    TEST_PASS("ekf range jacobian");
+    after_ekf_range_jacobian:
+    ;
+
+#if LOCALIZATION_FILTER == EKF_FILTER  // The particle filter's steps are random, see the particle tests below
+/* Test the EKF measurement update in mazeMappingAndMeasureStep */
+
+    {
+        initializeLocalization();
+        setWallProbability(mazeWall(&robot_maze_state, 0, 0, East), 1.0);
+
+        // Only the front sensor, the robot is really at x = 84 so the east wall is 168 - 84 - 46 = 38 away
+        sensor_reading_t readings[NUM_SENSORS];
+        for (int i = 0; i < NUM_SENSORS; i++) {
+            readings[i] = (sensor_reading_t){ .state = ERROR, .distance = 0 };
+        }
+        readings[2] = (sensor_reading_t){ .state = GOOD, .distance = 38 };
+
+        robot_location.x_mu = 90.0;
+        robot_location.y_mu = 84.0;
+        robot_location.theta_mu = 0.0;
+        mazeMappingAndMeasureStep(readings);
+
+        if (!(robot_location.x_mu < 90.0 && robot_location.x_mu > 84.0) || robot_location.y_mu != 84.0 ||
+                !(robot_location.x_sigma < INIT_X_SIGMA) || robot_location.y_sigma != INIT_Y_SIGMA) {
+            printf("Robot_location: (%f, %f, %f), x_sigma: %f\n", robot_location.x_mu, robot_location.y_mu,
+                    robot_location.theta_mu, robot_location.x_sigma);
+            TEST_FAIL("ekf measurement update");
+            goto after_ekf_update;
+        }
+
+        // A reading far outside the gate is rejected
+        gaussian_location_t before = robot_location;
+        readings[2].distance = 38 + 30 * sqrt(before.x_sigma + RANGE_SENSOR_VARIANCE);
+        mazeMappingAndMeasureStep(readings);
+        if (robot_location.x_mu != before.x_mu || robot_location.x_sigma != before.x_sigma) {
+            TEST_FAIL("ekf measurement update");
+            goto after_ekf_update;
+        }
+    }
+
+    TEST_PASS("ekf measurement update");
+    after_ekf_update:
+    ;
+#endif
+
+/* Test particle resampling keeps only the particles with weight */
+
+    {
+        static particle_filter<64> filter;
+        gaussian_location_t start = { .x_mu = 84.0, .y_mu = 84.0, .theta_mu = 0.0,
+                                      .x_sigma = 100.0, .xy_sigma = 0.0, .y_sigma = 100.0, .theta_sigma = 0.1,
+                                      .x_theta_sigma = 0.0, .y_theta_sigma = 0.0 };
+        initializeParticles(&filter, &start, PARTICLE_SEED);
+
+        // All the weight on particles 10 and 40
+        for (int i = 0; i < 64; i++) {
+            filter.weight[i] = 0;
+        }
+        filter.weight[10] = 0.75;
+        filter.weight[40] = 0.25;
+        location_t x_10 = filter.x[10], x_40 = filter.x[40];
+
+        if (!particleResample(&filter)) {
+            TEST_FAIL("particle resampling");
+            goto after_particle_resampling;
+        }
+        int count_10 = 0, count_40 = 0;
+        for (int i = 0; i < 64; i++) {
+            count_10 += filter.x[i] == x_10;
+            count_40 += filter.x[i] == x_40;
+            if (filter.weight[i] != (location_t) 1 / 64) {
+                TEST_FAIL("particle resampling");
+                goto after_particle_resampling;
+            }
+        }
+        // Low variance resampling gives each particle its share of the pool to within one
+        if (count_10 + count_40 != 64 || count_10 < 47 || count_10 > 49 || particleResample(&filter)) {
+            printf("copies: %d, %d\n", count_10, count_40);
+            TEST_FAIL("particle resampling");
+            goto after_particle_resampling;
+        }
+    }
+
+    TEST_PASS("particle resampling");
+    after_particle_resampling:
+    ;
+
+/* Test the particle filter finds the robot in a closed start cell */
+
+    {
+        initializeLocalization();
+        setWallProbability(mazeWall(&robot_maze_state, 0, 0, East), 1.0);
+        setWallProbability(mazeWall(&robot_maze_state, 0, 0, South), 1.0);
+
+        // Readings from the true pose (84, 84, 0.05), rounded to whole mm like the sensors
+        gaussian_location_t truth = { .x_mu = 84.0, .y_mu = 84.0, .theta_mu = 0.05,
+                                      .x_sigma = 0.0, .xy_sigma = 0.0, .y_sigma = 0.0, .theta_sigma = 0.0,
+                                      .x_theta_sigma = 0.0, .y_theta_sigma = 0.0 };
+        pose_transform_t truth_transform;
+        makePoseTransform(&truth, &truth_transform);
+        sensor_reading_t readings[NUM_SENSORS];
+        for (int j = 0; j < NUM_SENSORS; j++) {
+            pose_transform_t sensor_location;
+            composePoseTransform(&truth_transform, &sensor_offsets[j], &sensor_location);
+            sensor_reading_t reading = { .state = GOOD, .distance = TOO_FAR_DISTANCE };
+            hit_data_t hit_data;
+            processMeasurementMapping(&sensor_location, &reading, &hit_data, j, false);
+            readings[j] = (sensor_reading_t){ .state = GOOD, .distance = (unsigned char) (hit_data.distance_hit + 0.5) };
+        }
+
+        static particle_filter<256> filter;
+        gaussian_location_t start = { .x_mu = 92.0, .y_mu = 78.0, .theta_mu = TWO_PI - 0.1,
+                                      .x_sigma = 100.0, .xy_sigma = 0.0, .y_sigma = 100.0, .theta_sigma = 0.04,
+                                      .x_theta_sigma = 0.0, .y_theta_sigma = 0.0 };
+        initializeParticles(&filter, &start, PARTICLE_SEED);
+
+        gaussian_location_t estimate;
+        for (int step = 0; step < 30; step++) {
+            particleMotionStep(&filter, 0.0, 0.0);
+            particleMeasureStep(&filter, readings);
+            particleResample(&filter);
+        }
+        particleEstimate(&filter, &estimate);
+
+        if (!IS_BETWEEN_ERROR(estimate.x_mu, truth.x_mu, 3.0) || !IS_BETWEEN_ERROR(estimate.y_mu, truth.y_mu, 3.0) ||
+                !IS_BETWEEN_ERROR(angleDifference(estimate.theta_mu, truth.theta_mu), 0.0, 0.03)) {
+            printf("Estimate: (%f, %f, %f)\n", estimate.x_mu, estimate.y_mu, estimate.theta_mu);
+            TEST_FAIL("particle filter localization");
+            goto after_particle_filter;
+        }
+    }
+
+    TEST_PASS("particle filter localization");
+    after_particle_filter:
+    ;
+
     //TEST_FAIL("not all tests written yet!!!");
 
     // Test localizeMeasureStep
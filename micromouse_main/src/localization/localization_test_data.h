@@ -3,6 +3,8 @@
 #ifndef _LOCALIZATION_TEST_DATA_H_
 #define _LOCALIZATION_TEST_DATA_H_
 
+#include "../settings.h"
+
 #define LOCALIZATION_TEST_DATA_ROWS  967
 #define LOCALIZATION_TEST_DATA_COL   8
 
@@ -976,4 +978,246 @@ const double localization_test_data[LOCALIZATION_TEST_DATA_ROWS][LOCALIZATION_TE
    {   27.533642,	   71.134393,	   76.062057,	   86.537467,	   4.7322229,	   66.374371,	   38.565629,	  4.2940244 	},
 };
 
+/* Sensor readings (mm) recorded while sitting in the start cell facing west,
+ * and the location localization reported for each (x, y, theta) */
+#define LOCALIZATION_MEASUREMENT_ROWS           116
+#define LOCALIZATION_MEASUREMENT_LOCATION_ROWS  115
+
+const double localization_measurement_data[LOCALIZATION_MEASUREMENT_ROWS][NUM_SENSORS] = {
+    {40, 56, 45, 41, 56},
+    {41, 56, 38, 41, 58},
+    {40, 55, 41, 43, 58},
+    {39, 54, 39, 41, 60},
+    {40, 56, 40, 41, 57},
+    {40, 55, 40, 41, 57},
+    {42, 56, 43, 41, 59},
+    {40, 53, 39, 45, 59},
+    {41, 54, 40, 43, 58},
+    {41, 53, 38, 41, 57},
+    {39, 54, 39, 42, 60},
+    {39, 56, 39, 42, 59},
+    {41, 55, 41, 42, 58},
+    {39, 54, 40, 41, 57},
+    {41, 56, 41, 44, 59},
+    {41, 55, 40, 42, 57},
+    {41, 56, 40, 42, 58},
+    {40, 54, 39, 42, 55},
+    {41, 56, 39, 40, 57},
+    {42, 56, 39, 40, 57},
+    {41, 55, 41, 42, 59},
+    {41, 56, 37, 43, 57},
+    {40, 55, 38, 40, 58},
+    {40, 54, 39, 42, 59},
+    {41, 53, 41, 43, 60},
+    {40, 53, 40, 43, 57},
+    {39, 54, 41, 43, 57},
+    {39, 56, 40, 41, 58},
+    {42, 55, 40, 42, 58},
+    {40, 55, 39, 42, 60},
+    {39, 53, 39, 42, 57},
+    {40, 55, 38, 42, 57},
+    {39, 56, 42, 40, 56},
+    {39, 52, 41, 41, 56},
+    {41, 54, 39, 46, 57},
+    {41, 55, 39, 42, 57},
+    {40, 56, 39, 41, 57},
+    {43, 54, 38, 41, 59},
+    {39, 54, 41, 43, 58},
+    {40, 54, 39, 41, 58},
+    {40, 56, 39, 44, 57},
+    {39, 53, 40, 41, 58},
+    {42, 55, 40, 40, 60},
+    {40, 55, 37, 41, 58},
+    {40, 54, 39, 42, 58},
+    {40, 55, 39, 42, 57},
+    {41, 54, 39, 42, 57},
+    {41, 57, 39, 42, 59},
+    {41, 55, 39, 46, 59},
+    {39, 53, 40, 42, 56},
+    {40, 54, 41, 41, 58},
+    {39, 55, 39, 44, 57},
+    {41, 54, 39, 43, 58},
+    {39, 55, 40, 43, 58},
+    {42, 55, 42, 42, 59},
+    {40, 54, 39, 41, 59},
+    {40, 54, 39, 42, 59},
+    {41, 54, 41, 42, 58},
+    {43, 56, 39, 41, 57},
+    {41, 54, 38, 42, 60},
+    {40, 55, 39, 44, 57},
+    {39, 53, 41, 42, 58},
+    {41, 54, 40, 42, 59},
+    {41, 54, 39, 42, 56},
+    {40, 53, 40, 40, 58},
+    {41, 53, 40, 42, 59},
+    {40, 54, 41, 43, 58},
+    {39, 54, 40, 42, 59},
+    {40, 54, 39, 41, 60},
+    {41, 55, 39, 42, 60},
+    {41, 53, 40, 41, 57},
+    {40, 55, 38, 40, 59},
+    {41, 56, 39, 43, 58},
+    {41, 56, 39, 40, 58},
+    {43, 55, 39, 42, 59},
+    {41, 55, 40, 42, 59},
+    {41, 58, 41, 43, 58},
+    {39, 55, 39, 41, 59},
+    {41, 56, 43, 41, 59},
+    {41, 56, 42, 44, 57},
+    {40, 54, 40, 42, 57},
+    {42, 54, 40, 43, 59},
+    {41, 54, 41, 41, 58},
+    {41, 53, 40, 46, 59},
+    {43, 53, 38, 42, 59},
+    {40, 56, 39, 40, 60},
+    {40, 55, 39, 41, 59},
+    {42, 53, 38, 41, 57},
+    {40, 54, 39, 43, 59},
+    {39, 54, 38, 41, 58},
+    {40, 53, 41, 43, 58},
+    {40, 54, 40, 41, 58},
+    {43, 56, 42, 42, 58},
+    {40, 54, 39, 42, 58},
+    {40, 54, 38, 40, 59},
+    {40, 52, 40, 40, 57},
+    {38, 54, 40, 44, 58},
+    {40, 53, 41, 40, 57},
+    {41, 54, 39, 42, 59},
+    {40, 55, 41, 40, 57},
+    {42, 54, 39, 41, 58},
+    {42, 55, 40, 42, 59},
+    {41, 55, 40, 41, 57},
+    {40, 55, 40, 43, 58},
+    {41, 55, 39, 42, 58},
+    {40, 52, 40, 40, 58},
+    {40, 55, 40, 42, 59},
+    {39, 53, 39, 43, 58},
+    {41, 54, 38, 42, 59},
+    {41, 53, 40, 41, 60},
+    {40, 54, 40, 43, 56},
+    {41, 53, 39, 42, 58},
+    {42, 54, 42, 41, 57},
+    {40, 55, 39, 41, 57},
+    {39, 55, 40, 42, 56},
+    {41, 53, 40, 41, 57}
+};
+
+const double localization_measurement_locations[LOCALIZATION_MEASUREMENT_LOCATION_ROWS][3] = {
+    {84.01, 84.02, 3.14},    // DEBUG_LOCALIZE_MEASURE
+    {84.01, 84.06, 3.14},    // DEBUG_LOCALIZE_MEASURE
+    {84.07, 84.17, 3.14},    // DEBUG_LOCALIZE_MEASURE
+    {84.09, 84.32, 3.15},    // DEBUG_LOCALIZE_MEASURE
+    {84.13, 84.33, 3.15},    // DEBUG_LOCALIZE_MEASURE
+    {84.17, 84.37, 3.15},    // DEBUG_LOCALIZE_MEASURE
+    {84.26, 84.38, 3.15},    // DEBUG_LOCALIZE_MEASURE
+    {84.28, 84.57, 3.15},    // DEBUG_LOCALIZE_MEASURE
+    {84.31, 84.64, 3.15},    // DEBUG_LOCALIZE_MEASURE
+    {84.30, 84.67, 3.15},    // DEBUG_LOCALIZE_MEASURE
+    {84.32, 84.80, 3.15},    // DEBUG_LOCALIZE_MEASURE
+    {84.33, 84.85, 3.15},    // DEBUG_LOCALIZE_MEASURE
+    {84.38, 84.87, 3.15},    // DEBUG_LOCALIZE_MEASURE
+    {84.41, 84.90, 3.15},    // DEBUG_LOCALIZE_MEASURE
+    {84.46, 84.95, 3.15},    // DEBUG_LOCALIZE_MEASURE
+    {84.50, 84.93, 3.15},    // DEBUG_LOCALIZE_MEASURE
+    {84.53, 84.92, 3.15},    // DEBUG_LOCALIZE_MEASURE
+    {84.54, 84.90, 3.15},    // DEBUG_LOCALIZE_MEASURE
+    {84.55, 84.83, 3.15},    // DEBUG_LOCALIZE_MEASURE
+    {84.55, 84.74, 3.15},    // DEBUG_LOCALIZE_MEASURE
+    {84.60, 84.79, 3.15},    // DEBUG_LOCALIZE_MEASURE
+    {84.57, 84.78, 3.15},    // DEBUG_LOCALIZE_MEASURE
+    {84.56, 84.78, 3.15},    // DEBUG_LOCALIZE_MEASURE
+    {84.57, 84.86, 3.15},    // DEBUG_LOCALIZE_MEASURE
+    {84.61, 84.97, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {84.64, 85.03, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {84.69, 85.09, 3.15},    // DEBUG_LOCALIZE_MEASURE
+    {84.71, 85.08, 3.15},    // DEBUG_LOCALIZE_MEASURE
+    {84.74, 85.06, 3.15},    // DEBUG_LOCALIZE_MEASURE
+    {84.74, 85.11, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {84.75, 85.16, 3.15},    // DEBUG_LOCALIZE_MEASURE
+    {84.73, 85.15, 3.15},    // DEBUG_LOCALIZE_MEASURE
+    {84.80, 85.08, 3.15},    // DEBUG_LOCALIZE_MEASURE
+    {84.84, 85.11, 3.15},    // DEBUG_LOCALIZE_MEASURE
+    {84.85, 85.18, 3.15},    // DEBUG_LOCALIZE_MEASURE
+    {84.85, 85.15, 3.15},    // DEBUG_LOCALIZE_MEASURE
+    {84.85, 85.10, 3.15},    // DEBUG_LOCALIZE_MEASURE
+    {84.83, 85.07, 3.15},    // DEBUG_LOCALIZE_MEASURE
+    {84.88, 85.14, 3.15},    // DEBUG_LOCALIZE_MEASURE
+    {84.88, 85.15, 3.15},    // DEBUG_LOCALIZE_MEASURE
+    {84.88, 85.16, 3.15},    // DEBUG_LOCALIZE_MEASURE
+    {84.90, 85.21, 3.15},    // DEBUG_LOCALIZE_MEASURE
+    {84.93, 85.17, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {84.89, 85.16, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {84.89, 85.18, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {84.89, 85.17, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {84.89, 85.16, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {84.90, 85.12, 3.15},    // DEBUG_LOCALIZE_MEASURE
+    {84.90, 85.21, 3.15},    // DEBUG_LOCALIZE_MEASURE
+    {84.92, 85.24, 3.15},    // DEBUG_LOCALIZE_MEASURE
+    {84.96, 85.24, 3.15},    // DEBUG_LOCALIZE_MEASURE
+    {84.96, 85.28, 3.15},    // DEBUG_LOCALIZE_MEASURE
+    {84.96, 85.30, 3.15},    // DEBUG_LOCALIZE_MEASURE
+    {84.98, 85.33, 3.15},    // DEBUG_LOCALIZE_MEASURE
+    {85.04, 85.31, 3.15},    // DEBUG_LOCALIZE_MEASURE
+    {85.04, 85.32, 3.15},    // DEBUG_LOCALIZE_MEASURE
+    {85.04, 85.36, 3.15},    // DEBUG_LOCALIZE_MEASURE
+    {85.08, 85.35, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {85.08, 85.22, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {85.06, 85.26, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {85.05, 85.28, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {85.09, 85.34, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {85.11, 85.35, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {85.11, 85.30, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {85.13, 85.30, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {85.14, 85.34, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {85.18, 85.37, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {85.19, 85.42, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {85.19, 85.45, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {85.18, 85.45, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {85.20, 85.42, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {85.18, 85.38, 3.17},    // DEBUG_LOCALIZE_MEASURE
+    {85.17, 85.35, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {85.17, 85.26, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {85.17, 85.22, 3.17},    // DEBUG_LOCALIZE_MEASURE
+    {85.19, 85.22, 3.17},    // DEBUG_LOCALIZE_MEASURE
+    {85.22, 85.17, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {85.22, 85.19, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {85.29, 85.16, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {85.35, 85.15, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {85.36, 85.16, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {85.37, 85.18, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {85.40, 85.17, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {85.41, 85.30, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {85.39, 85.29, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {85.38, 85.27, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {85.37, 85.27, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {85.34, 85.22, 3.17},    // DEBUG_LOCALIZE_MEASURE
+    {85.33, 85.29, 3.17},    // DEBUG_LOCALIZE_MEASURE
+    {85.31, 85.30, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {85.34, 85.36, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {85.35, 85.35, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {85.41, 85.26, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {85.40, 85.28, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {85.37, 85.28, 3.17},    // DEBUG_LOCALIZE_MEASURE
+    {85.38, 85.28, 3.17},    // DEBUG_LOCALIZE_MEASURE
+    {85.39, 85.38, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {85.42, 85.35, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {85.41, 85.36, 3.17},    // DEBUG_LOCALIZE_MEASURE
+    {85.45, 85.29, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {85.44, 85.25, 3.17},    // DEBUG_LOCALIZE_MEASURE
+    {85.45, 85.23, 3.17},    // DEBUG_LOCALIZE_MEASURE
+    {85.46, 85.17, 3.17},    // DEBUG_LOCALIZE_MEASURE
+    {85.47, 85.20, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {85.46, 85.18, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {85.47, 85.21, 3.17},    // DEBUG_LOCALIZE_MEASURE
+    {85.48, 85.23, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {85.47, 85.31, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {85.44, 85.33, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {85.45, 85.36, 3.17},    // DEBUG_LOCALIZE_MEASURE
+    {85.46, 85.35, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {85.45, 85.36, 3.17},    // DEBUG_LOCALIZE_MEASURE
+    {85.50, 85.29, 3.17},    // DEBUG_LOCALIZE_MEASURE
+    {85.49, 85.25, 3.16},    // DEBUG_LOCALIZE_MEASURE
+    {85.50, 85.23, 3.16}     // DEBUG_LOCALIZE_MEASURE
+};
+
 #endif //_LOCALIZATION_TEST_DATA_H_
@@ -0,0 +1,259 @@
+/* particle_filter.h
+ *
+ * Particle filter alternative to the EKF in localization_math.h, selected
+ * with LOCALIZATION_FILTER in settings.h. localization.cpp keeps one
+ * particle_filter_t and summarizes it into robot_location every step, so
+ * strategy and movement work the same with either filter.
+ *
+ * The pool is a fixed size template parameter, so there is no heap and
+ * the host benchmark can size NUM_PARTICLES to the control loop budget.
+ * Particles are stored as one array per field, the likelihood of all
+ * particles is evaluated one sensor at a time (batched) through the ray
+ * caster of processMeasurementMapping, with the maze left unchanged.
+ */
+
+#ifndef _PARTICLE_FILTER_H_
+#define _PARTICLE_FILTER_H_
+
+#include <math.h>
+
+#include "localization.h"
+#include "localization_math.h"
+#include "../settings.h"
+#include "../types.h"
+#include "../util/trig.h"
+#include "../abs.h"
+
+
+template <int N>
+struct particle_filter {
+    location_t x[N];
+    location_t y[N];
+    location_t theta[N];
+    location_t weight[N];           // Normalized to sum to 1
+    location_t log_likelihood[N];   // Scratch for the measurement step
+    location_t resample_x[N];       // Scratch for resampling
+    location_t resample_y[N];
+    location_t resample_theta[N];
+    unsigned long seed;             // State of the random number generator
+};
+
+typedef particle_filter<NUM_PARTICLES> particle_filter_t;
+
+
+/*----------- Random numbers -----------*/
+
+/* Uniform in [0, 1), xorshift32 */
+template <int N>
+location_t particleUniform(particle_filter<N>* filter) {
+    unsigned long seed = filter->seed & 0xFFFFFFFFUL;
+    seed ^= (seed << 13) & 0xFFFFFFFFUL;
+    seed ^= seed >> 17;
+    seed ^= (seed << 5) & 0xFFFFFFFFUL;
+    filter->seed = seed;
+    return (location_t) (seed >> 8) * (1.0 / 16777216.0);
+}
+
+/* Approximately standard normal, sum of four uniforms scaled to unit variance */
+template <int N>
+location_t particleGaussian(particle_filter<N>* filter) {
+    location_t sum = particleUniform(filter) + particleUniform(filter) + particleUniform(filter) + particleUniform(filter);
+    return (sum - 2) * 1.7320508;
+}
+
+
+/*----------- Public Functions -----------*/
+
+/* Spread the particles over location's mean and variances, with equal weights
+ * - seed must not be 0 */
+template <int N>
+void initializeParticles(particle_filter<N>* filter, gaussian_location_t* location, unsigned long seed) {
+    filter->seed = seed;
+
+    location_t x_deviation = sqrt(location->x_sigma);
+    location_t y_deviation = sqrt(location->y_sigma);
+    location_t theta_deviation = sqrt(location->theta_sigma);
+
+    for (int i = 0; i < N; i++) {
+        filter->x[i] = location->x_mu + x_deviation * particleGaussian(filter);
+        filter->y[i] = location->y_mu + y_deviation * particleGaussian(filter);
+        filter->theta[i] = wrapAngle(location->theta_mu + theta_deviation * particleGaussian(filter));
+        filter->weight[i] = (location_t) 1 / N;
+    }
+}
+
+/* Move every particle by the wheel distances with noise drawn from calculateMotion's covariance */
+template <int N>
+void particleMotionStep(particle_filter<N>* filter, location_t left_distance, location_t right_distance) {
+
+    gaussian_location_t motion;
+    calculateMotion(&motion, left_distance, right_distance);
+
+    // Cholesky factor of the x, y covariance: [a, 0; b, c]
+    location_t a = sqrt(motion.x_sigma);
+    location_t b = a > 0 ? motion.xy_sigma / a : 0;
+    location_t c_squared = motion.y_sigma - b * b;
+    location_t c = c_squared > 0 ? sqrt(c_squared) : 0;
+    location_t theta_deviation = sqrt(motion.theta_sigma);
+
+    for (int i = 0; i < N; i++) {
+        location_t noise_x = particleGaussian(filter);
+        location_t noise_y = particleGaussian(filter);
+
+        gaussian_location_t particle_motion;
+        particle_motion.x_mu = motion.x_mu + a * noise_x;
+        particle_motion.y_mu = motion.y_mu + b * noise_x + c * noise_y;
+        particle_motion.theta_mu = motion.theta_mu + theta_deviation * particleGaussian(filter);
+
+        gaussian_location_t particle;
+        particle.x_mu = filter->x[i];
+        particle.y_mu = filter->y[i];
+        particle.theta_mu = filter->theta[i];
+        addMotion(&particle, &particle_motion, &particle);
+
+        filter->x[i] = particle.x_mu;
+        filter->y[i] = particle.y_mu;
+        filter->theta[i] = particle.theta_mu;
+    }
+}
+
+/* Weight the particles by how well the GOOD sensor readings match the ray cast distances from each
+ * - Readings with no known wall near them give PARTICLE_MISS_LOG_LIKELIHOOD, which also bounds how
+ *   much one bad reading can take away from a particle
+ * - Returns the number of readings used */
+template <int N>
+int particleMeasureStep(particle_filter<N>* filter, sensor_reading_t* sensor_data) {
+
+    // Pose of every particle, the only trig of this step
+    static pose_transform_t particle_transforms[N];
+    for (int i = 0; i < N; i++) {
+        gaussian_location_t particle;
+        particle.x_mu = filter->x[i];
+        particle.y_mu = filter->y[i];
+        particle.theta_mu = filter->theta[i];
+        makePoseTransform(&particle, &particle_transforms[i]);
+        filter->log_likelihood[i] = 0;
+    }
+
+    int used = 0;
+    for (int j = 0; j < NUM_SENSORS; j++) {
+        if (sensor_data[j].state != GOOD) {
+            continue;
+        }
+        used++;
+
+        for (int i = 0; i < N; i++) {
+            pose_transform_t sensor_location;
+            composePoseTransform(&particle_transforms[i], &sensor_offsets[j], &sensor_location);
+
+            sensor_reading_t reading = sensor_data[j];
+            hit_data_t hit_data;
+            processMeasurementMapping(&sensor_location, &reading, &hit_data, j, false);
+
+            location_t log_likelihood = PARTICLE_MISS_LOG_LIKELIHOOD;
+            if (hit_data.hit) {
+                location_t error = sensor_data[j].distance - hit_data.distance_hit;
+                location_t hit_log_likelihood = -(error * error) / (2 * PARTICLE_RANGE_VARIANCE);
+                if (hit_log_likelihood > log_likelihood) {
+                    log_likelihood = hit_log_likelihood;
+                }
+            }
+            filter->log_likelihood[i] += log_likelihood;
+        }
+    }
+
+    if (used == 0) {
+        return 0;
+    }
+
+    // Scale by the largest likelihood so the exponentials do not underflow
+    location_t max_log_likelihood = filter->log_likelihood[0];
+    for (int i = 1; i < N; i++) {
+        if (filter->log_likelihood[i] > max_log_likelihood) {
+            max_log_likelihood = filter->log_likelihood[i];
+        }
+    }
+
+    location_t total = 0;
+    for (int i = 0; i < N; i++) {
+        filter->weight[i] *= exp(filter->log_likelihood[i] - max_log_likelihood);
+        total += filter->weight[i];
+    }
+    for (int i = 0; i < N; i++) {
+        filter->weight[i] /= total;
+    }
+
+    return used;
+}
+
+/* Low variance resampling, only once the effective number of particles drops below
+ * PARTICLE_RESAMPLE_RATIO of the pool
+ * - Returns if the particles were resampled */
+template <int N>
+bool particleResample(particle_filter<N>* filter) {
+
+    location_t sum_squares = 0;
+    for (int i = 0; i < N; i++) {
+        sum_squares += filter->weight[i] * filter->weight[i];
+    }
+    if (1 / sum_squares >= PARTICLE_RESAMPLE_RATIO * N) {
+        return false;
+    }
+
+    // One random offset, then N evenly spaced picks along the cumulative weights
+    location_t step = (location_t) 1 / N;
+    location_t pick = particleUniform(filter) * step;
+    location_t cumulative = filter->weight[0];
+    int i = 0;
+    for (int m = 0; m < N; m++) {
+        while (pick > cumulative && i < N - 1) {
+            i++;
+            cumulative += filter->weight[i];
+        }
+        filter->resample_x[m] = filter->x[i];
+        filter->resample_y[m] = filter->y[i];
+        filter->resample_theta[m] = filter->theta[i];
+        pick += step;
+    }
+
+    for (int m = 0; m < N; m++) {
+        filter->x[m] = filter->resample_x[m];
+        filter->y[m] = filter->resample_y[m];
+        filter->theta[m] = filter->resample_theta[m];
+        filter->weight[m] = step;
+    }
+    return true;
+}
+
+/* Weighted mean and covariance of the particles
+ * - theta is averaged as offsets from the first particle so the wrap at 2 pi does not split it */
+template <int N>
+void particleEstimate(particle_filter<N>* filter, gaussian_location_t* location) {
+
+    location_t reference = filter->theta[0];
+    location_t x_mu = 0, y_mu = 0, theta_offset = 0;
+    for (int i = 0; i < N; i++) {
+        x_mu += filter->weight[i] * filter->x[i];
+        y_mu += filter->weight[i] * filter->y[i];
+        theta_offset += filter->weight[i] * angleDifference(filter->theta[i], reference);
+    }
+
+    matrix<location_t, 3, 3> P = zeroMatrix<location_t, 3, 3>();
+    for (int i = 0; i < N; i++) {
+        location_t d[3] = { filter->x[i] - x_mu, filter->y[i] - y_mu,
+                            angleDifference(filter->theta[i], reference) - theta_offset };
+        for (int r = 0; r < 3; r++) {
+            for (int c = 0; c < 3; c++) {
+                P.m[r][c] += filter->weight[i] * d[r] * d[c];
+            }
+        }
+    }
+
+    location->x_mu = x_mu;
+    location->y_mu = y_mu;
+    location->theta_mu = wrapAngle(reference + theta_offset);
+    setCovariance(location, P);
+}
+
+
+#endif //_PARTICLE_FILTER_H_
@@ -1,34 +1,29 @@
 /* probabilistic_maze.cpp */
 
+#include <math.h>
+
 #include "probabilistic_maze.h"
 #include "../settings.h"
 
-/* initialize the state of the maze
- *   - Responsible for setting up the pointers to the
- * wall in such a way that there are no duplicates.
- */
-void initializeMaze(probabilistic_maze_t* maze) {
-    for (int i = 0; i < sizeof(maze->wall_buffer) / sizeof(maze->wall_buffer[0]); ++i) {
-        maze->wall_buffer[i].exists = 0.5;
-    }
-    for (int x = 0; x < MAZE_WIDTH; ++x) {
-        for (int y = 0; y < MAZE_HEIGHT; ++y) {
-            maze->cells[x][y] = {
-                .north = &maze->wall_buffer[x * (MAZE_WIDTH + 1) + y],
-                .east = &maze->wall_buffer[MAZE_HEIGHT * (MAZE_WIDTH + 1) + (x + 1) * MAZE_WIDTH + y],
-                .south = &maze->wall_buffer[x * (MAZE_WIDTH + 1) + (y + 1)],
-                .west = &maze->wall_buffer[MAZE_HEIGHT * (MAZE_WIDTH + 1) + x * MAZE_WIDTH + y]
-            };
-            if (y == 0) {
-                maze->cells[x][y].north->exists = 1;
-            } else if (y == MAZE_HEIGHT - 1) {
-                maze->cells[x][y].south->exists = 1;
-            }
-            if (x == 0) {
-                maze->cells[x][y].west->exists = 1;
-            } else if (x == MAZE_WIDTH - 1) {
-                maze->cells[x][y].east->exists = 1;
-            }
-        }
+/* Probability that the wall exists
+ *   - Saturated walls are exactly 1.0 or 0.0 */
+double wallProbability(const probabilistic_wall_t* wall) {
+    if (wall->log_odds >= WALL_LOG_ODDS_MAX) return 1.0;
+    if (wall->log_odds <= -WALL_LOG_ODDS_MAX) return 0.0;
+    return 1.0 / (1.0 + exp(-(double) wall->log_odds / WALL_LOG_ODDS_SCALE));
+}
+
+/* Set the wall to the log odds closest to probability
+ *   - 1.0 and 0.0 (or beyond) saturate */
+void setWallProbability(probabilistic_wall_t* wall, double probability) {
+    if (probability >= 1.0) {
+        wall->log_odds = WALL_LOG_ODDS_MAX;
+    } else if (probability <= 0.0) {
+        wall->log_odds = -WALL_LOG_ODDS_MAX;
+    } else {
+        double log_odds = WALL_LOG_ODDS_SCALE * log(probability / (1.0 - probability));
+        if (log_odds > WALL_LOG_ODDS_MAX) log_odds = WALL_LOG_ODDS_MAX;
+        if (log_odds < -WALL_LOG_ODDS_MAX) log_odds = -WALL_LOG_ODDS_MAX;
+        wall->log_odds = (int8_t) (log_odds >= 0 ? log_odds + 0.5 : log_odds - 0.5);
     }
 }
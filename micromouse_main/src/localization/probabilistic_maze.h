@@ -5,14 +5,15 @@
  * 
  * Structure of overall maze:
  * 
- *              maze
- *           /   |    \
- *       cell cell... cell
- *       / \   / \    / \                   
- *    wall  wall  wall   wall
+ *      horizontal_walls: the north wall of every cell plus
+ *                        the south border, row by row
+ *      vertical_walls:   the west wall of every cell plus
+ *                        the east border, row by row
  * 
- * Note: two cells will point to the same wall if the
- * two cells are adjacent.
+ * Walls are found from (x, y, Direction) with index math, there
+ * are no pointers. Two adjacent cells share the wall between them:
+ * the south wall of [x,y] is the north wall of [x,y+1] and the east
+ * wall of [x,y] is the west wall of [x+1,y].
  * 
  * --------------------------------------------------
  * 
@@ -25,19 +26,68 @@
  * 
  * Note: H = MAZE_HEIGHT
  *       W = MAZE_WIDTH
+ *
+ * probabilistic_grid_t<W, H> is the same maze for any size, for host
+ * code that works on half-size or synthetic grids. The functions
+ * here are templates on the size, so the robot's maze compiles to the
+ * same code as before.
+ *
+ * --------------------------------------------------
+ *
+ * Each wall stores the log odds of existing, ln(p / (1 - p)),
+ * as a saturating int8 in units of 1/WALL_LOG_ODDS_SCALE.
+ * Updates are integer adds and the WALL_THRESHOLD compare is an
+ * integer compare against WALL_LOG_ODDS_THRESHOLD. Use
+ * wallProbability() where the probability itself is needed.
+ *  - 0 is exactly 0.5
+ *  - +-WALL_LOG_ODDS_MAX is exactly 1.0 or 0.0, a wall known for
+ *    certain (the border, a maze loaded from a file) that sensor
+ *    updates leave alone
+ *  - Sensor updates stop at +-WALL_LOG_ODDS_CLAMP, so a wall seen
+ *    wrongly for a while still flips after a few contrary readings
  */
 
 #ifndef _PROBABILISTIC_MAZE_H_
 #define _PROBABILISTIC_MAZE_H_
 
+#include <stddef.h>
+#include <stdint.h>
+
 #include "../settings.h"
+#include "../util/direction.h"
+
+
+#define WALL_LOG_ODDS_SCALE 16      // Log odds units per nat
+#define WALL_LOG_ODDS_MAX   127     // Saturation limit, symmetric so 1.0 and 0.0 mirror each other
+#define WALL_LOG_ODDS_CLAMP 24      // Limit of sensor updates (probability 0.82), 3 updates of WALL_LOG_ODDS_UPDATE from the threshold
 
 
 typedef struct {
-    double exists;
+    int8_t log_odds;
 } probabilistic_wall_t;
 
 
+/* A maze W cells wide and H cells tall, the robot's maze is probabilistic_maze_t */
+template <int W, int H>
+struct probabilistic_grid_t {
+    static constexpr int width = W;
+    static constexpr int height = H;
+    static constexpr int num_horizontal_walls = (H + 1) * W;
+    static constexpr int num_vertical_walls = H * (W + 1);
+    static constexpr int num_walls = num_horizontal_walls + num_vertical_walls;
+
+    probabilistic_wall_t horizontal_walls[num_horizontal_walls];
+    probabilistic_wall_t vertical_walls[num_vertical_walls];
+};
+
+typedef probabilistic_grid_t<MAZE_WIDTH, MAZE_HEIGHT> probabilistic_maze_t;
+
+#define NUM_HORIZONTAL_WALLS (probabilistic_maze_t::num_horizontal_walls)
+#define NUM_VERTICAL_WALLS (probabilistic_maze_t::num_vertical_walls)
+#define NUM_WALLS (probabilistic_maze_t::num_walls)
+
+
+/* The four walls of a cell, see mazeCell() */
 typedef struct {
     probabilistic_wall_t* north;
     probabilistic_wall_t* east;
@@ -46,17 +96,113 @@ typedef struct {
 } probabilistic_cell_t;
 
 
-typedef struct {
-    probabilistic_cell_t cells[MAZE_WIDTH][MAZE_HEIGHT];
-    probabilistic_wall_t wall_buffer[MAZE_HEIGHT * (MAZE_WIDTH + 1) + (MAZE_HEIGHT + 1) * MAZE_WIDTH];
-} probabilistic_maze_t;
+/* Index in horizontal_walls of the north wall of [x,y], in a maze W cells wide */
+template <int W = MAZE_WIDTH>
+constexpr int horizontalWallIndex(int x, int y) {
+    return y * W + x;
+}
+
+/* Index in vertical_walls of the west wall of [x,y], in a maze W cells wide */
+template <int W = MAZE_WIDTH>
+constexpr int verticalWallIndex(int x, int y) {
+    return y * (W + 1) + x;
+}
+
+/* The wall on the dir side of [x,y]
+ *  - NULL for the diagonals, which have no wall */
+template <int W, int H>
+inline probabilistic_wall_t* mazeWall(probabilistic_grid_t<W, H>* maze, int x, int y, Direction dir) {
+    switch (dir) {
+        case North: return &maze->horizontal_walls[horizontalWallIndex<W>(x, y)];
+        case East:  return &maze->vertical_walls[verticalWallIndex<W>(x + 1, y)];
+        case South: return &maze->horizontal_walls[horizontalWallIndex<W>(x, y + 1)];
+        case West:  return &maze->vertical_walls[verticalWallIndex<W>(x, y)];
+        default:    return NULL;
+    }
+}
+
+/* Wall n of the maze for code that visits every wall, horizontal walls come first */
+template <int W, int H>
+inline probabilistic_wall_t* mazeWallByNumber(probabilistic_grid_t<W, H>* maze, int n) {
+    const int num_horizontal = probabilistic_grid_t<W, H>::num_horizontal_walls;
+    return n < num_horizontal ? &maze->horizontal_walls[n] : &maze->vertical_walls[n - num_horizontal];
+}
+
+/* The walls of [x,y] in the layout the maze used to store them in
+ *  - For migrating code written as cells[x][y].north->..., prefer mazeWall() */
+template <int W, int H>
+inline probabilistic_cell_t mazeCell(probabilistic_grid_t<W, H>* maze, int x, int y) {
+    probabilistic_cell_t cell = {
+        .north = mazeWall(maze, x, y, North),
+        .east = mazeWall(maze, x, y, East),
+        .south = mazeWall(maze, x, y, South),
+        .west = mazeWall(maze, x, y, West)
+    };
+    return cell;
+}
+
+
+/* e^x evaluated at compile time */
+constexpr double constexprExp(double x, double term, double sum, int n) {
+    return n > 60 ? sum : constexprExp(x, term * x / n, sum + term, n + 1);
+}
+
+constexpr double constexprExp(double x) {
+    return constexprExp(x, 1.0, 0.0, 1);
+}
+
+/* Smallest log odds whose probability is above probability */
+constexpr int logOddsAbove(double probability, int log_odds) {
+    return (log_odds >= WALL_LOG_ODDS_MAX ||
+            constexprExp((double) log_odds / WALL_LOG_ODDS_SCALE) > probability / (1.0 - probability)) ?
+                log_odds : logOddsAbove(probability, log_odds + 1);
+}
+
+// A wall exists when its log odds is at least this, the same as its probability being above WALL_THRESHOLD
+// (a constexpr variable so it is never evaluated at run time, even without optimization)
+constexpr int WALL_LOG_ODDS_THRESHOLD = logOddsAbove(WALL_THRESHOLD, -WALL_LOG_ODDS_MAX);
 
 
 /* Initialize the state of the maze
- *   - Responsible for setting up the pointers to the
- * wall in such a way that there are no duplicates.
+ *   - Every wall is unknown (0.5) except the border, which exists (1.0)
  */
-void initializeMaze(probabilistic_maze_t* maze);
+template <int W, int H>
+void initializeMaze(probabilistic_grid_t<W, H>* maze) {
+    for (int i = 0; i < probabilistic_grid_t<W, H>::num_walls; ++i) {
+        mazeWallByNumber(maze, i)->log_odds = 0;
+    }
+    for (int x = 0; x < W; ++x) {
+        mazeWall(maze, x, 0, North)->log_odds = WALL_LOG_ODDS_MAX;
+        mazeWall(maze, x, H - 1, South)->log_odds = WALL_LOG_ODDS_MAX;
+    }
+    for (int y = 0; y < H; ++y) {
+        mazeWall(maze, 0, y, West)->log_odds = WALL_LOG_ODDS_MAX;
+        mazeWall(maze, W - 1, y, East)->log_odds = WALL_LOG_ODDS_MAX;
+    }
+}
+
+/* Probability that the wall exists */
+double wallProbability(const probabilistic_wall_t* wall);
+
+/* Set the wall to the log odds closest to probability */
+void setWallProbability(probabilistic_wall_t* wall, double probability);
+
+/* Do we believe the wall exists, same as wallProbability(wall) > WALL_THRESHOLD */
+inline bool wallExists(const probabilistic_wall_t* wall) {
+    return wall->log_odds >= WALL_LOG_ODDS_THRESHOLD;
+}
+
+/* Add change to the log odds of the wall, clamped to +-WALL_LOG_ODDS_CLAMP
+ *  - Walls known for certain, at +-WALL_LOG_ODDS_MAX, do not change */
+inline void updateWallLogOdds(probabilistic_wall_t* wall, int change) {
+    if (wall->log_odds >= WALL_LOG_ODDS_MAX || wall->log_odds <= -WALL_LOG_ODDS_MAX) {
+        return;
+    }
+    int log_odds = wall->log_odds + change;
+    if (log_odds > WALL_LOG_ODDS_CLAMP) log_odds = WALL_LOG_ODDS_CLAMP;
+    if (log_odds < -WALL_LOG_ODDS_CLAMP) log_odds = -WALL_LOG_ODDS_CLAMP;
+    wall->log_odds = log_odds;
+}
 
 
 #endif //_PROBABILISTIC_MAZE_H_
@@ -6,10 +6,10 @@ int count_cell_references(probabilistic_maze_t *maze, probabilistic_wall_t *chec
     int count = 0;
     for (int x = 0; x < MAZE_WIDTH; ++x) {
         for (int y = 0; y < MAZE_HEIGHT; ++y) {
-            count += (maze->cells[x][y].north == check) +
-                     (maze->cells[x][y].east == check) +
-                     (maze->cells[x][y].south == check) +
-                     (maze->cells[x][y].west == check);
+            count += (mazeCell(maze, x, y).north == check) +
+                     (mazeCell(maze, x, y).east == check) +
+                     (mazeCell(maze, x, y).south == check) +
+                     (mazeCell(maze, x, y).west == check);
         }
     }
     return count;
@@ -21,7 +21,7 @@ TEST_FUNC_BEGIN {
     TEST_PASS("initializeMaze called");
 
     for (int x = 0; x < MAZE_WIDTH; ++x) {
-        if (maze.cells[x][0].north->exists != 1) {
+        if (wallProbability(mazeCell(&maze, x, 0).north) != 1) {
             TEST_FAIL("north border is 1");
             goto after_north_border;
         }
@@ -30,7 +30,7 @@ TEST_FUNC_BEGIN {
     after_north_border:
 
     for (int y = 0; y < MAZE_HEIGHT; ++y) {
-        if (maze.cells[MAZE_WIDTH - 1][y].east->exists != 1) {
+        if (wallProbability(mazeCell(&maze, MAZE_WIDTH - 1, y).east) != 1) {
             TEST_FAIL("east border is 1");
             goto after_east_border;
         }
@@ -39,7 +39,7 @@ TEST_FUNC_BEGIN {
     after_east_border:
 
     for (int x = 0; x < MAZE_WIDTH; ++x) {
-        if (maze.cells[x][MAZE_HEIGHT - 1].south->exists != 1) {
+        if (wallProbability(mazeCell(&maze, x, MAZE_HEIGHT - 1).south) != 1) {
             TEST_FAIL("south border is 1");
             goto after_south_border;
         }
@@ -48,7 +48,7 @@ TEST_FUNC_BEGIN {
     after_south_border:
 
     for (int y = 0; y < MAZE_HEIGHT; ++y) {
-        if (maze.cells[0][y].west->exists != 1) {
+        if (wallProbability(mazeCell(&maze, 0, y).west) != 1) {
             TEST_FAIL("west border is 1");
             goto after_west_border;
         }
@@ -58,53 +58,53 @@ TEST_FUNC_BEGIN {
 
     for (int x = 1; x < MAZE_WIDTH - 1; ++x) {
         for (int y = 1; y < MAZE_HEIGHT - 1; ++y) {
-            if (maze.cells[x][y].north->exists != 0.5 || maze.cells[x][y].south->exists != 0.5 || maze.cells[x][y].east->exists != 0.5 || maze.cells[x][y].west->exists != 0.5) {
+            if (wallProbability(mazeCell(&maze, x, y).north) != 0.5 || wallProbability(mazeCell(&maze, x, y).south) != 0.5 || wallProbability(mazeCell(&maze, x, y).east) != 0.5 || wallProbability(mazeCell(&maze, x, y).west) != 0.5) {
                 TEST_FAIL("interior borders are 0.5");
                 goto after_interior_borders;
             }
         }
     }
     for (int x = 1; x < MAZE_WIDTH - 1; ++x) {
-        if (maze.cells[x][0].south->exists != 0.5 || maze.cells[x][0].east->exists != 0.5 || maze.cells[x][0].west->exists != 0.5) {
+        if (wallProbability(mazeCell(&maze, x, 0).south) != 0.5 || wallProbability(mazeCell(&maze, x, 0).east) != 0.5 || wallProbability(mazeCell(&maze, x, 0).west) != 0.5) {
             TEST_FAIL("interior borders are 0.5");
             goto after_interior_borders;
         }
-        if (maze.cells[x][MAZE_HEIGHT - 1].north->exists != 0.5 || maze.cells[x][MAZE_HEIGHT - 1].east->exists != 0.5 || maze.cells[x][MAZE_HEIGHT - 1].west->exists != 0.5) {
+        if (wallProbability(mazeCell(&maze, x, MAZE_HEIGHT - 1).north) != 0.5 || wallProbability(mazeCell(&maze, x, MAZE_HEIGHT - 1).east) != 0.5 || wallProbability(mazeCell(&maze, x, MAZE_HEIGHT - 1).west) != 0.5) {
             TEST_FAIL("interior borders are 0.5");
             goto after_interior_borders;
         }
     }
     for (int y = 1; y < MAZE_WIDTH - 1; ++y) {
-        if (maze.cells[0][y].east->exists != 0.5 || maze.cells[0][y].north->exists != 0.5 || maze.cells[0][y].south->exists != 0.5) {
+        if (wallProbability(mazeCell(&maze, 0, y).east) != 0.5 || wallProbability(mazeCell(&maze, 0, y).north) != 0.5 || wallProbability(mazeCell(&maze, 0, y).south) != 0.5) {
             TEST_FAIL("interior borders are 0.5");
             goto after_interior_borders;
         }
-        if (maze.cells[MAZE_WIDTH - 1][y].west->exists != 0.5 || maze.cells[MAZE_WIDTH - 1][y].north->exists != 0.5 || maze.cells[MAZE_WIDTH - 1][y].south->exists != 0.5) {
+        if (wallProbability(mazeCell(&maze, MAZE_WIDTH - 1, y).west) != 0.5 || wallProbability(mazeCell(&maze, MAZE_WIDTH - 1, y).north) != 0.5 || wallProbability(mazeCell(&maze, MAZE_WIDTH - 1, y).south) != 0.5) {
             TEST_FAIL("interior borders are 0.5");
             goto after_interior_borders;
         }
     }
-    if (maze.cells[0][0].south->exists != 0.5 || maze.cells[0][0].east->exists != 0.5) {
+    if (wallProbability(mazeCell(&maze, 0, 0).south) != 0.5 || wallProbability(mazeCell(&maze, 0, 0).east) != 0.5) {
         TEST_FAIL("interior borders are 0.5");
         goto after_interior_borders;
     }
-    if (maze.cells[0][MAZE_HEIGHT - 1].north->exists != 0.5 || maze.cells[0][MAZE_HEIGHT - 1].east->exists != 0.5) {
+    if (wallProbability(mazeCell(&maze, 0, MAZE_HEIGHT - 1).north) != 0.5 || wallProbability(mazeCell(&maze, 0, MAZE_HEIGHT - 1).east) != 0.5) {
         TEST_FAIL("interior borders are 0.5");
         goto after_interior_borders;
     }
-    if (maze.cells[MAZE_WIDTH - 1][0].south->exists != 0.5 || maze.cells[MAZE_WIDTH - 1][0].west->exists != 0.5) {
+    if (wallProbability(mazeCell(&maze, MAZE_WIDTH - 1, 0).south) != 0.5 || wallProbability(mazeCell(&maze, MAZE_WIDTH - 1, 0).west) != 0.5) {
         TEST_FAIL("interior borders are 0.5");
         goto after_interior_borders;
     }
-    if (maze.cells[MAZE_WIDTH - 1][MAZE_HEIGHT - 1].north->exists != 0.5 || maze.cells[MAZE_WIDTH - 1][MAZE_HEIGHT - 1].west->exists != 0.5) {
+    if (wallProbability(mazeCell(&maze, MAZE_WIDTH - 1, MAZE_HEIGHT - 1).north) != 0.5 || wallProbability(mazeCell(&maze, MAZE_WIDTH - 1, MAZE_HEIGHT - 1).west) != 0.5) {
         TEST_FAIL("interior borders are 0.5");
         goto after_interior_borders;
     }
     TEST_PASS("interior borders are 0.5");
     after_interior_borders:
 
-    for (int i = 0; i < sizeof(maze.wall_buffer) / sizeof(maze.wall_buffer[0]); ++i) {
-        if (count_cell_references(&maze, maze.wall_buffer + i) > 2) {
+    for (int i = 0; i < NUM_WALLS; ++i) {
+        if (count_cell_references(&maze, mazeWallByNumber(&maze, i)) > 2) {
             TEST_FAIL("duplicated wall references");
             goto after_duplicated_walls;
         }
@@ -114,10 +114,10 @@ TEST_FUNC_BEGIN {
 
     for (int x = 1; x < MAZE_WIDTH - 1; ++x) {
         for (int y = 1; y < MAZE_HEIGHT - 1; ++y) {
-            if (maze.cells[x][y].north != maze.cells[x][y - 1].south ||
-                maze.cells[x][y].east != maze.cells[x + 1][y].west ||
-                maze.cells[x][y].south != maze.cells[x][y + 1].north ||
-                maze.cells[x][y].west != maze.cells[x - 1][y].east) {
+            if (mazeCell(&maze, x, y).north != mazeCell(&maze, x, y - 1).south ||
+                mazeCell(&maze, x, y).east != mazeCell(&maze, x + 1, y).west ||
+                mazeCell(&maze, x, y).south != mazeCell(&maze, x, y + 1).north ||
+                mazeCell(&maze, x, y).west != mazeCell(&maze, x - 1, y).east) {
                     TEST_FAIL("invalid wall references");
                     goto after_valid_walls;
                 }
@@ -126,24 +126,24 @@ TEST_FUNC_BEGIN {
     TEST_PASS("invalid wall references");
     after_valid_walls:
     for (int x = 0; x < MAZE_WIDTH; ++x) {
-        if (count_cell_references(&maze, maze.cells[x][0].north) != 1) {
+        if (count_cell_references(&maze, mazeCell(&maze, x, 0).north) != 1) {
             puts("---");
-            printf("%d, %d\n", x, count_cell_references(&maze, maze.cells[x][0].north));
+            printf("%d, %d\n", x, count_cell_references(&maze, mazeCell(&maze, x, 0).north));
             TEST_FAIL("invalid outer wall references");
             goto after_valid_outer_walls;
         }
-        if (count_cell_references(&maze, maze.cells[x][MAZE_HEIGHT - 1].south) != 1) {
+        if (count_cell_references(&maze, mazeCell(&maze, x, MAZE_HEIGHT - 1).south) != 1) {
             TEST_FAIL("invalid outer wall references");
             goto after_valid_outer_walls;
         }
     }
     for (int y = 0; y < MAZE_WIDTH; ++y) {
-        if (count_cell_references(&maze, maze.cells[0][y].west) != 1) {
+        if (count_cell_references(&maze, mazeCell(&maze, 0, y).west) != 1) {
             printf("%d\n", y);
             TEST_FAIL("invalid outer wall references");
             goto after_valid_outer_walls;
         }
-        if (count_cell_references(&maze, maze.cells[MAZE_WIDTH - 1][y].east) != 1) {
+        if (count_cell_references(&maze, mazeCell(&maze, MAZE_WIDTH - 1, y).east) != 1) {
             TEST_FAIL("invalid outer wall references");
             goto after_valid_outer_walls;
         }
@@ -151,8 +151,8 @@ TEST_FUNC_BEGIN {
     TEST_PASS("invalid outer wall references");
     after_valid_outer_walls:
 
-    for (int i = 0; i < sizeof(maze.wall_buffer) / sizeof(maze.wall_buffer[0]); ++i) {
-        if (count_cell_references(&maze, maze.wall_buffer + i) == 0) {
+    for (int i = 0; i < NUM_WALLS; ++i) {
+        if (count_cell_references(&maze, mazeWallByNumber(&maze, i)) == 0) {
             TEST_FAIL("memory waste");
             goto after_memory_waste;
         }
@@ -160,6 +160,114 @@ TEST_FUNC_BEGIN {
     TEST_PASS("memory waste");
     after_memory_waste:
 
+    for (int dir = NorthEast; dir <= NorthWest; ++dir) {
+        if (mazeWall(&maze, 1, 1, (Direction) dir) != NULL) {
+            TEST_FAIL("diagonal walls");
+            goto after_diagonal_walls;
+        }
+    }
+    TEST_PASS("diagonal walls");
+    after_diagonal_walls:
+
+    for (int log_odds = -WALL_LOG_ODDS_MAX; log_odds <= WALL_LOG_ODDS_MAX; ++log_odds) {
+        probabilistic_wall_t wall = { .log_odds = (int8_t) log_odds };
+        if (wallExists(&wall) != (wallProbability(&wall) > WALL_THRESHOLD) ||
+                !wallExists(&wall) != (wallProbability(&wall) < WALL_THRESHOLD)) {
+            printf("log odds: %d, probability: %f\n", log_odds, wallProbability(&wall));
+            TEST_FAIL("wall threshold");
+            goto after_wall_threshold;
+        }
+    }
+    TEST_PASS("wall threshold");
+    after_wall_threshold:
+
+    {
+        probabilistic_wall_t wall = { .log_odds = WALL_LOG_ODDS_CLAMP - 1 };
+        updateWallLogOdds(&wall, 100);
+        if (wall.log_odds != WALL_LOG_ODDS_CLAMP) {
+            TEST_FAIL("wall saturation");
+            goto after_wall_saturation;
+        }
+        updateWallLogOdds(&wall, -1000);
+        if (wall.log_odds != -WALL_LOG_ODDS_CLAMP) {
+            TEST_FAIL("wall saturation");
+            goto after_wall_saturation;
+        }
+        // Known walls stay known
+        probabilistic_wall_t border = { .log_odds = WALL_LOG_ODDS_MAX };
+        updateWallLogOdds(&border, -1000);
+        if (border.log_odds != WALL_LOG_ODDS_MAX || wallProbability(&border) != 1.0) {
+            TEST_FAIL("wall saturation");
+            goto after_wall_saturation;
+        }
+    }
+    TEST_PASS("wall saturation");
+    after_wall_saturation:
+
+    // However long a wall was seen, 3 contrary readings stop it existing, as with the old multiplicative update
+    {
+        probabilistic_wall_t wall = { .log_odds = 0 };
+        for (int i = 0; i < 1000; ++i) {
+            updateWallLogOdds(&wall, WALL_LOG_ODDS_UPDATE);
+        }
+        int readings = 0;
+        while (wallExists(&wall) && readings < 1000) {
+            updateWallLogOdds(&wall, -WALL_LOG_ODDS_UPDATE);
+            readings++;
+        }
+        if (readings != 3) {
+            printf("contrary readings: %d\n", readings);
+            TEST_FAIL("wrong wall recovery");
+            goto after_wrong_wall_recovery;
+        }
+    }
+    TEST_PASS("wrong wall recovery");
+    after_wrong_wall_recovery:
+
+    for (double probability = 0.0; probability <= 1.0; probability += 0.01) {
+        probabilistic_wall_t wall;
+        setWallProbability(&wall, probability);
+        // Within half a log odds step of the requested probability
+        double step = 0.5 / WALL_LOG_ODDS_SCALE * probability * (1.0 - probability);
+        if ((wall.log_odds > -WALL_LOG_ODDS_MAX && wall.log_odds < WALL_LOG_ODDS_MAX) &&
+                (wallProbability(&wall) > probability + step + 1e-9 || wallProbability(&wall) < probability - step - 1e-9)) {
+            printf("probability: %f, log odds: %d (%f)\n", probability, wall.log_odds, wallProbability(&wall));
+            TEST_FAIL("wall probability round trip");
+            goto after_wall_round_trip;
+        }
+    }
+    TEST_PASS("wall probability round trip");
+    after_wall_round_trip:
+
+    // A half-size, non-square grid: neighbors share walls and only the border starts out existing
+    {
+        typedef probabilistic_grid_t<32, 24> grid_t;
+        static grid_t grid;
+        initializeMaze(&grid);
+        int border = 0;
+        for (int n = 0; n < grid_t::num_walls; ++n) {
+            border += wallExists(mazeWallByNumber(&grid, n));
+        }
+        if (sizeof(grid) != grid_t::num_walls || border != 2 * (32 + 24)) {
+            TEST_FAIL("grid sizes");
+            goto after_grid_sizes;
+        }
+        for (int x = 0; x < 32; ++x) {
+            for (int y = 0; y < 24; ++y) {
+                if ((x + 1 < 32 && mazeWall(&grid, x, y, East) != mazeWall(&grid, x + 1, y, West)) ||
+                        (y + 1 < 24 && mazeWall(&grid, x, y, South) != mazeWall(&grid, x, y + 1, North)) ||
+                        wallExists(mazeWall(&grid, x, y, East)) != (x == 31) ||
+                        wallExists(mazeWall(&grid, x, y, South)) != (y == 23)) {
+                    printf("cell: [%d,%d]\n", x, y);
+                    TEST_FAIL("grid sizes");
+                    goto after_grid_sizes;
+                }
+            }
+        }
+    }
+    TEST_PASS("grid sizes");
+    after_grid_sizes:
+
     asm("nop;");
 } TEST_FUNC_END("probabilistic_maze_test")
 
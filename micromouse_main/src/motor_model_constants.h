@@ -0,0 +1,20 @@
+/* motor_model_constants.h
+ *
+ * Not fitted yet, the dummy model both wheels started with. Run
+ * control/identify_motors on a run logged with DEBUG_MOTORS to write
+ * the model of each wheel here.
+ */
+
+#ifndef _MOTOR_MODEL_CONSTANTS_H_
+#define _MOTOR_MODEL_CONSTANTS_H_
+
+
+#define LEFT_MOTOR_MODEL_DEADBAND    0.196078	// Output the wheel starts turning at
+#define LEFT_MOTOR_MODEL_BACK_EMF    0.0008	// Output per mm/s
+#define LEFT_MOTOR_MODEL_INERTIA     0.00016	// Output per mm/s^2
+#define RIGHT_MOTOR_MODEL_DEADBAND    0.196078	// Output the wheel starts turning at
+#define RIGHT_MOTOR_MODEL_BACK_EMF    0.0008	// Output per mm/s
+#define RIGHT_MOTOR_MODEL_INERTIA     0.00016	// Output per mm/s^2
+
+
+#endif //_MOTOR_MODEL_CONSTANTS_H_
@@ -1,69 +1,96 @@
-/* movement.cpp 
- * 
+/* movement.cpp
+ *
  * This file is used to calculate the speed to set the motors at to get closer to the next location
- * 
+ *
  * Model:
  * C: current_location - the current state of the robot
  * N: next_location - goal location, where we want to be
- * I: intermediate_location - Not always used, but the location we should travel to first before
- *      attempting to go to the next_location
- * v and ->: path of robot, goes down then over because the error in x is less than the error in y
- * 
+ * R: reference - a point that drives a motion profile along the path to N, which the robot follows
+ *
  * Axis Definition:
- * +--> +X                                      N.x
- * |                                             |
- * V        C                                    |
- * +Y       v                                    |
- *          v                                    |
- *          v                                    |
- *   - - - -v- - - - - - - - - - - - - - - - - - | - - - -
- *          v                                    |       ^
- *          v                                    |       OUTER_TOLERANCE_MM
- *          v                                    |       v
- *  --------I->->->->->->->->->->->->->->->->->->N-------- N.y
- *                                               |       ^
- *                                               |       OUTER_TOLERANCE_MM
- *                                               |       v
- *   - - - - - - - - - - - - - - - - - - - - - - | - - - -
+ * +--> +X
+ * |
+ * V        C
+ * +Y         \
+ *              \
+ *                R - - - - - - - - - - - - - - - - - - - - N
  *
  * Main ideas:
- * - Get to a point where you are within the goal tolerance for one axis before try to drive there
- * - Either call straightController() or turnController() each time based on what state we are determined to be in
- * - Once within tolerance for both x and y stop motors completely
- * 
+ * - Every straight and arc is a reference point moving along it, trackTrajectory follows that point with
+ *   the same law from every pose, so there are no states to switch between while driving
+ * - A straight's reference drives a motion profile from its start to its end, see motion_profile.h, an
+ *   arc's is the point of the circle closest to the robot going round at the arc's speed
+ * - Turns on the spot are commands of their own, turnController turns to the heading of the next straight
+ *   before it starts
+ *
  * */
 
 
+#include <math.h>
+
 #include "movement.h"
 #include "../types.h"
 #include "../settings.h"
+#include "../util/trig.h"
+#include "../util/conversions.h"
+#include "../util/motion_profile.h"
 #include "../abs.h"
 
-// Temp
-#include <stdio.h>
-
 
 // Globals
-gaussian_location_t prev_location;
-RobotState prev_state;
-Direction prev_direction;
+
+// Where the next command of the motion program starts, as planned
+double program_x;
+double program_y;
+Direction program_heading;
+
+// Seconds between calls, see setMovementTick
+double movement_tick = MOVEMENT_LOOP_TIME / 1000000.0;
+
+// The straight line calculateSpeed's reference drives along, see planTracking
+motion_profile_t tracking_profile;
+double tracking_profile_time;
+bool tracking_planned;
+trajectory_point_t tracking_start;
+double tracking_goal_x;
+double tracking_goal_y;
+
+// The straight driveStraight's reference drives along, see planStraight
+motion_profile_t straight_profile;
+double straight_profile_time;
+bool straight_planned;
+trajectory_point_t straight_start;
+Direction straight_dir;
+double straight_end_x;
+double straight_end_y;
+double straight_exit_speed;
+
+static const motion_limits_t straight_limits = {
+    .max_speed = STRAIGHT_PROFILE_STABLE_SPEED,
+    .max_accel = STRAIGHT_PROFILE_ACCEL,
+    .max_jerk = STRAIGHT_PROFILE_JERK
+};
 
 
 // Function Declarations
-bool canSwitchState(gaussian_location_t *current_location, gaussian_location_t *next_location);
-void getCurrentState(gaussian_location_t* current_location, gaussian_location_t* next_location,
-                        Direction *dir, RobotState *state);
-Direction chooseDirectionOutOfTolerance(double x_cte, double y_cte);
-Direction chooseDirectionWithinTolerance(double x_cte, double y_cte);
-void straightController(gaussian_location_t* current_location, gaussian_location_t* next_location,
-                            double* left_speed, double* right_speed, Direction dir, bool same_state);
-double calculateCTE(gaussian_location_t* cur, gaussian_location_t* next, Direction dir);
-double calculateThetaCTE(gaussian_location_t* cur, Direction dir, double cte);
-double calculateDistanceAway(gaussian_location_t* cur, gaussian_location_t* next, Direction dir);
-double straightSpeedProfile(double distance_away);
+void planTracking(gaussian_location_t* current_location, gaussian_location_t* next_location);
+bool driveSegment(gaussian_location_t* current_location, gaussian_location_t* next_location,
+                        Direction dir, double* left_speed, double* right_speed);
+bool driveStraight(gaussian_location_t* current_location, double end_x, double end_y, Direction dir,
+                        double entry_speed, double exit_speed, double* left_speed, double* right_speed);
+void planStraight(gaussian_location_t* current_location, double end_x, double end_y, Direction dir,
+                        double entry_speed, double exit_speed);
+double facingLine(gaussian_location_t* current_location, double theta);
+Direction commandHeading(motion_command_t* command);
+void advanceProgram(motion_command_t* command);
+void restartProgram(motion_program_t* program);
+int findCell(const cell_t* cells, int length, cell_t cell);
+void cutProgram(gaussian_location_t* current_location, motion_program_t* program);
+bool driveArc(gaussian_location_t* current_location, motion_command_t* command,
+                        double* left_speed, double* right_speed);
 
 void turnController(gaussian_location_t* current_location, double* left_speed,
-                            double* right_speed, Direction dir, bool same_state);
+                            double* right_speed, Direction dir);
 double calculateThetaError(gaussian_location_t* cur, Direction dir);
 double turnSpeedProfile(double thetaError);
 
@@ -71,8 +98,12 @@ double turnSpeedProfile(double thetaError);
 /*----------- Public Functions -----------*/
 
 void initializeMovement(gaussian_location_t* current_location) {
-    prev_location = *current_location;
-    prev_state = PERFECT;
+    tracking_planned = false;
+    straight_planned = false;
+}
+
+void setMovementTick(double seconds) {
+    movement_tick = seconds;
 }
 
 /* calculate speed
@@ -80,380 +111,479 @@ void initializeMovement(gaussian_location_t* current_location) {
  * - left_speed and right_speed should be passed in with the current respective speeds*/
 void calculateSpeed(gaussian_location_t* current_location, gaussian_location_t* next_location,
                         double* left_speed, double* right_speed) {
-    
-    RobotState current_state;
-    Direction direction;
 
-    // Get the new current state if we are allowed to check
-    if (canSwitchState(current_location, next_location)) {
-        getCurrentState(current_location, next_location, &direction, &current_state);
-    } else {
-        current_state = prev_state;
-        direction = prev_direction;
+    // Once the reference has stopped it can not pull the robot sideways, so start a new one if it is off
+    // the goal and stand still if not, the law's speeds are too small there for the motors anyway
+    bool stopped = tracking_planned && tracking_profile_time >= tracking_profile.duration;
+    bool at_goal = IS_BETWEEN_ERROR(current_location->x_mu, next_location->x_mu, INNER_TOLERANCE_MM) &&
+                   IS_BETWEEN_ERROR(current_location->y_mu, next_location->y_mu, INNER_TOLERANCE_MM);
+    if (!tracking_planned || next_location->x_mu != tracking_goal_x || next_location->y_mu != tracking_goal_y ||
+            (stopped && !at_goal)) {
+        planTracking(current_location, next_location);
+    } else if (stopped) {
+        *left_speed = 0;
+        *right_speed = 0;
+        return;
     }
 
-    bool same_state = (current_state == prev_state);
+    motion_sample_t sample;
+    sampleMotionProfile(&tracking_profile, tracking_profile_time, &sample);
+    trajectory_point_t reference = tracking_start;
+    double sin_theta, cos_theta;
+    sinCos(tracking_start.theta, &sin_theta, &cos_theta);
+    reference.x += cos_theta * sample.position;
+    reference.y += sin_theta * sample.position;
+    double facing = facingLine(current_location, tracking_start.theta);
+    reference.speed = sample.speed * facing;
+    tracking_profile_time += movement_tick * facing;
+
+    trackTrajectory(current_location, &reference, left_speed, right_speed);
+}
 
-    /* Bad Code - This is a hack and this is really bad code, but it might actually help with death spikes */
-    
-    // After get done turning, set theta to be perfectly aligned
-    if (current_state == OUT_XY_IN_THETA && prev_state == OUT_XY_OUT_THETA ||
-            current_state == IN_XY_IN_THETA && prev_state == IN_XY_OUT_THETA) {
-        
-        current_location->theta_mu = directionToRAD[direction];
-    }
+void trackTrajectory(gaussian_location_t* current_location, const trajectory_point_t* reference,
+                        double* left_speed, double* right_speed) {
 
-    /* end of Bad Code */
+    // The error in the robot's frame, x ahead and y to the side theta turns toward
+    double theta = current_location->theta_mu;
+    double dx = reference->x - current_location->x_mu;
+    double dy = reference->y - current_location->y_mu;
+    double sin_theta, cos_theta;
+    sinCos(theta, &sin_theta, &cos_theta);
+    double x_error = cos_theta * dx + sin_theta * dy;
+    double y_error = cos_theta * dy - sin_theta * dx;
+    double theta_error = angleDifference(reference->theta, theta);
+    double sin_error, cos_error;
+    sinCos(theta_error, &sin_error, &cos_error);
+
+    double speed = reference->speed * cos_error + TRACKING_K_X * x_error;
+    double turn_rate = reference->turn_rate + reference->speed * TRACKING_K_Y * y_error + TRACKING_K_THETA * theta_error;
+
+    // Saturate rather than switch, theta grows with the left wheel
+    speed = max(min(speed, (double) STRAIGHT_PROFILE_STABLE_SPEED), -1.0 * STRAIGHT_PROFILE_STABLE_SPEED);
+    double turn = turn_rate * WHEEL_BASE_LENGTH / 2;
+    turn = max(min(turn, (double) TURN_PROFILE_STABLE_SPEED), -1.0 * TURN_PROFILE_STABLE_SPEED);
+    *left_speed = speed + turn;
+    *right_speed = speed - turn;
+}
 
-    // printf("State : %d, Same: %d, Direction: %d\n", current_state, same_state, direction);
+/* calculate segment speed
+ * - Turns on the spot until theta is within INNER_TOLERANCE_RAD of dir, then drives the straight with
+ *   driveStraight */
+bool calculateSegmentSpeed(gaussian_location_t* current_location, gaussian_location_t* next_location,
+                        Direction dir, double* left_speed, double* right_speed) {
 
-    switch (current_state) {
-        default:
-        case PERFECT:
-            // Stop
-            *left_speed = 0;
-            *right_speed = 0;
-            break;
-
-        case OUT_XY_IN_THETA:
-            // Go Straight to get to within the tolerance
-
-            // We need to find the location that is on the same axis as the next_location
-            // in the direction we are being told to go
-            gaussian_location_t intermediate_location;
-
-            // To make sure that the axis for error doesn't drift
-            static double prev_axis_x; static double prev_axis_y;
-            double axis_x; double axis_y;
-            if (same_state) {
-                axis_x = prev_axis_x;
-                axis_y = prev_axis_y;
-            } else {
-                axis_x = prev_location.x_mu;
-                axis_y = prev_location.y_mu;
-            }
-            // printf("same state: %d, axis_x: %f, axis_y: %f direction: %d\n", same_state, axis_x, axis_y, direction);
-
-            // Direction does not depend on x, set to stay the same as previous location to keep same axis for cte
-            if (directionToXY[direction][0] == 0)
-                intermediate_location.x_mu = axis_x;
-            else // Direction does depend on x, project to axis by setting to next location
-                intermediate_location.x_mu = next_location->x_mu;
-
-            // Direction does not depend on y, set to stay the same as previous location to keep same axis for cte
-            if (directionToXY[direction][1] == 0)
-                intermediate_location.y_mu = axis_y;
-            else // Direction does depend on y, project to axis by setting to next location
-                intermediate_location.y_mu = next_location->y_mu;
-
-            // printf("i location: (%f, %f, %f)\n", intermediate_location.x_mu, intermediate_location.y_mu, intermediate_location.theta_mu);
-
-            straightController(current_location, &intermediate_location, left_speed, right_speed, direction, same_state);
-
-            prev_axis_x = axis_x;
-            prev_axis_y = axis_y;
-            break;
-
-        case OUT_XY_OUT_THETA:
-            
-            // Turn to get to within the tolerance of direction
-            turnController(current_location, left_speed, right_speed, direction, same_state);
-            break;
-
-        case IN_XY_IN_THETA:
-            
-            // Go Straight
-            straightController(current_location, next_location, left_speed, right_speed, direction, same_state);
-            break;
-            
-        case IN_XY_OUT_THETA:
-            
-            // Turn to get to within the tolerance of direction
-            turnController(current_location, left_speed, right_speed, direction, same_state);
-            break;
-    }
+    return driveSegment(current_location, next_location, dir, left_speed, right_speed);
+}
 
-    prev_location = *current_location;
-    prev_state = current_state;
-    prev_direction = direction;
+void startMotionProgram(motion_program_t* program) {
+    program_x = cellNumberToCoordinateDistance(program->start.x);
+    program_y = cellNumberToCoordinateDistance(program->start.y);
+    program_heading = program->start_heading;
+    straight_planned = false;
+    for (int i = 0; i < program->next_command; i++) {
+        advanceProgram(&program->commands[i]);
+    }
 }
 
-bool canSwitchState(gaussian_location_t *current_location, gaussian_location_t *next_location) {
+/* calculate program speed
+ * - A straight is driven along the line from where the last command ended as planned, not as
+ *   measured, so the errors of one command do not carry into the next
+ * - A command that is done hands the same control loop to the next one */
+bool calculateProgramSpeed(gaussian_location_t* current_location, motion_program_t* program,
+                        double* left_speed, double* right_speed) {
 
-    // Overall changes
-    double x_cte = next_location->x_mu - current_location->x_mu;
-    double y_cte = next_location->y_mu - current_location->y_mu;
+    while (program->next_command < program->num_commands) {
+        motion_command_t* command = &program->commands[program->next_command];
 
-    // Check for transition conditions
-    switch (prev_state) {
-        default:
-        case PERFECT:
-            return true;
-            break;
-
-        case OUT_XY_IN_THETA:
-            // To change states:
-            // either x or y needs to be within inner tolerance
-            if (abs(x_cte) < INNER_TOLERANCE_MM || abs(y_cte) < INNER_TOLERANCE_MM)
-                return true;
-            // or theta needs to be outside outer tolerance
-            if (prev_direction != East){
-                if (!IS_BETWEEN_ERROR(current_location->theta_mu, directionToRAD[prev_direction], OUTER_TOLERANCE_RAD))
-                    return true;
-            } else { // Special case because circles
-                if ( !(((current_location->theta_mu <= TWO_PI) && (current_location->theta_mu > TWO_PI - OUTER_TOLERANCE_RAD))
-                        || ((current_location->theta_mu < OUTER_TOLERANCE_RAD) && (current_location->theta_mu >= 0.0))))
-                    return true;
+        if (command->type == MOTION_STRAIGHT) {
+            // Up to where the arc after it starts
+            double length = command->cells * (double) (CELL_LENGTH + WALL_THICKNESS);
+            if (program->next_command + 1 < program->num_commands &&
+                    isArcCommand(&program->commands[program->next_command + 1])) {
+                length -= arcReach(&program->commands[program->next_command + 1]);
             }
-            break;
-
-        case OUT_XY_OUT_THETA:
-            // To change states:
-            // either x or y needs to be within inner tolerance 
-            if (abs(x_cte) < INNER_TOLERANCE_MM || abs(y_cte) < INNER_TOLERANCE_MM)
-                return true;
-            // or theta needs to be inside inner tolerance
-            if (prev_direction != East){
-                if (IS_BETWEEN_ERROR(current_location->theta_mu, directionToRAD[prev_direction], INNER_TOLERANCE_RAD))
-                    return true;
-            } else { // Special case because circles
-                if (((current_location->theta_mu <= TWO_PI) && (current_location->theta_mu > TWO_PI - INNER_TOLERANCE_RAD))
-                        || ((current_location->theta_mu < INNER_TOLERANCE_RAD) && (current_location->theta_mu >= 0.0)))
-                    return true;
+            double end_x = program_x + directionToXY[program_heading][0] * length;
+            double end_y = program_y + directionToXY[program_heading][1] * length;
+            if (!driveStraight(current_location, end_x, end_y, program_heading, command->entry_speed,
+                               command->exit_speed, left_speed, right_speed)) {
+                return false;
             }
-            break;
-
-        case IN_XY_IN_THETA:
-            // To change states:
-            // both x and y must be outside of outer tolerance
-            if (abs(x_cte) > OUTER_TOLERANCE_MM && abs(y_cte) > OUTER_TOLERANCE_MM)
-                return true;
-            // or both x and y must be within inner tolerance
-            if (abs(x_cte) < INNER_TOLERANCE_MM || abs(y_cte) < INNER_TOLERANCE_MM)
-                return true;
-            // or theta needs to be outside outer tolerance
-            if (prev_direction != East){
-                if (!IS_BETWEEN_ERROR(current_location->theta_mu, directionToRAD[prev_direction], OUTER_TOLERANCE_RAD))
-                    return true;
-            } else { // Special case because circles
-                if ( !(((current_location->theta_mu <= TWO_PI) && (current_location->theta_mu > TWO_PI - OUTER_TOLERANCE_RAD))
-                        || ((current_location->theta_mu < OUTER_TOLERANCE_RAD) && (current_location->theta_mu >= 0.0))))
-                    return true;
+        } else if (isArcCommand(command)) {
+            if (!driveArc(current_location, command, left_speed, right_speed)) {
+                return false;
             }
-            break;
-
-        case IN_XY_OUT_THETA:
-            // To change states:
-            // both x and y must be outside of outer tolerance
-            if (abs(x_cte) > OUTER_TOLERANCE_MM && abs(y_cte) > OUTER_TOLERANCE_MM)
-                return true;
-            // or both x and y must be within inner tolerance
-            if (abs(x_cte) < INNER_TOLERANCE_MM || abs(y_cte) < INNER_TOLERANCE_MM)
-                return true;
-            // or theta needs to be within inner tolerance
-            if (prev_direction != East){
-                if (IS_BETWEEN_ERROR(current_location->theta_mu, directionToRAD[prev_direction], INNER_TOLERANCE_RAD))
-                    return true;
-            } else { // Special case because circles
-                if (((current_location->theta_mu <= TWO_PI) && (current_location->theta_mu > TWO_PI - INNER_TOLERANCE_RAD))
-                        || ((current_location->theta_mu < INNER_TOLERANCE_RAD) && (current_location->theta_mu >= 0.0)))
-                    return true;
-            }
-            break;
-    }
-    return false;
-}
-
-
-void getCurrentState(gaussian_location_t* current_location, gaussian_location_t* next_location,
-                        Direction *dir, RobotState *state) {
-    
-    // Overall changes
-    double x_cte = next_location->x_mu - current_location->x_mu;
-    double y_cte = next_location->y_mu - current_location->y_mu;
-    
-    if (abs(x_cte) > OUTER_TOLERANCE_MM && abs(y_cte) > OUTER_TOLERANCE_MM) {
-        
-        // Determine the direction to go
-        *dir = chooseDirectionOutOfTolerance(x_cte, y_cte);
-
-        // Are we facing that direction?
-        if (IS_BETWEEN_ERROR(current_location->theta_mu, directionToRAD[*dir], OUTER_TOLERANCE_RAD)) {
-            *state = OUT_XY_IN_THETA;
         } else {
-            *state = OUT_XY_OUT_THETA;
+            // A straight right after the turn takes over within OUTER_TOLERANCE_RAD, trackTrajectory
+            // turns the rest of the way while it drives
+            Direction heading = commandHeading(command);
+            bool straight_next = program->next_command + 1 < program->num_commands &&
+                                 program->commands[program->next_command + 1].type == MOTION_STRAIGHT;
+            double tolerance = straight_next ? OUTER_TOLERANCE_RAD : INNER_TOLERANCE_RAD;
+            double theta_error = abs(angleDifference(directionToRAD[heading], (double) current_location->theta_mu));
+            if (theta_error > tolerance) {
+                turnController(current_location, left_speed, right_speed, heading);
+                return false;
+            }
         }
 
-    } else if (abs(x_cte) < OUTER_TOLERANCE_MM && abs(y_cte) < OUTER_TOLERANCE_MM) {
-        
-        *state = PERFECT;
+        advanceProgram(command);
+        program->next_command++;
+    }
 
-    } else {
+    *left_speed = 0;
+    *right_speed = 0;
+    return true;
+}
 
-        // Determine the direction to go
-        *dir = chooseDirectionWithinTolerance(x_cte, y_cte);
+void startStreamedProgram(motion_program_t* program, gaussian_location_t* current_location) {
+    cell_t start;
+    start.x = coordinateDistanceToCellNumber(current_location->x_mu);
+    start.y = coordinateDistanceToCellNumber(current_location->y_mu);
 
-        // Are we facing that direction?
-        if (*dir != East){
-            if (IS_BETWEEN_ERROR(current_location->theta_mu, directionToRAD[*dir], OUTER_TOLERANCE_RAD)) {
-                *state = IN_XY_IN_THETA;
-            } else {
-                *state = IN_XY_OUT_THETA;
-            }
-        } else { // Special case because circles
-            if (((current_location->theta_mu <= TWO_PI) && (current_location->theta_mu > TWO_PI - OUTER_TOLERANCE_RAD))
-                    || ((current_location->theta_mu < OUTER_TOLERANCE_RAD) && (current_location->theta_mu >= 0.0))) {
-                *state = IN_XY_IN_THETA;
-            } else {
-                *state = IN_XY_OUT_THETA;
-            }
+    Direction heading = North;
+    for (int dir = East; dir <= West; dir++) {
+        if (abs(angleDifference(directionToRAD[dir], (double) current_location->theta_mu)) <
+                abs(angleDifference(directionToRAD[heading], (double) current_location->theta_mu))) {
+            heading = (Direction) dir;
         }
     }
-}
 
-Direction chooseDirectionOutOfTolerance(double x_cte, double y_cte) {
-    if (abs(x_cte) < abs(y_cte)) 
-        return x_cte > 0 ? East : West;
-    else
-        return y_cte > 0 ? South : North;
+    initializeMotionProgram(program, start, heading);
+    program->turn_style = TURN_SEARCH_ARCS;
+    startMotionProgram(program);
 }
 
-Direction chooseDirectionWithinTolerance(double x_cte, double y_cte) {
-    if (abs(x_cte) < abs(y_cte)) 
-        return y_cte > 0 ? South : North;
-    else
-        return x_cte > 0 ? East : West;
-}
+/* calculate streamed speed
+ * - strategy hands out the next cell once the robot is in the one before it, half a cell before the
+ *   straight to there ends, so the straight is made longer or an arc is put at its end while it runs
+ * - Speed run arcs need the cells after the turn, which strategy does not hand out yet */
+bool calculateStreamedSpeed(gaussian_location_t* current_location, gaussian_location_t* next_location,
+                        motion_program_t* program, double* left_speed, double* right_speed) {
 
+    cell_t next_cell;
+    next_cell.x = coordinateDistanceToCellNumber(next_location->x_mu);
+    next_cell.y = coordinateDistanceToCellNumber(next_location->y_mu);
+    compilePath(program, &next_cell, 1);
 
-/* Controllers - tune in settings.h */
+    if (!calculateProgramSpeed(current_location, program, left_speed, right_speed)) {
+        return false;
+    }
+    restartProgram(program);
+    return true;
+}
 
-void straightController(gaussian_location_t* current_location, gaussian_location_t* next_location,
-                            double* left_speed, double* right_speed, Direction dir, bool same_state) {
-    
-    static double int_cte = 0;    // Integral error (Resets when same_state is false)
-    static double prev_cte = 0;   // Previous error (Resets when same_state is false)
+/* calculate lookahead speed
+ * - Every waypoint after the end of program is compiled into it, so a straight is as long as the
+ *   waypoints see it and only slows down for the turn at its end
+ * - When the end of program is not on the waypoints any more, strategy's route changed, the program
+ *   is cut back to where calculateStreamedSpeed would have got and carries on from there if it can */
+bool calculateLookaheadSpeed(gaussian_location_t* current_location, const waypoints_t* waypoints,
+                        motion_program_t* program, double* left_speed, double* right_speed) {
+
+    cell_t route[LOOKAHEAD_CELLS + 1];
+    int length = 0;
+    route[length++] = waypoints->from;
+    for (int i = 0; i < waypoints->count; i++) {
+        route[length++] = waypointAt(waypoints, i);
+    }
 
-    // Calculate the Cross Track Error (cte)
-    double cte = calculateCTE(current_location, next_location, dir);
-    // printf("CTE: %f\n", cte);
-    double d_cte; // derivative of cte
+    int end = findCell(route, length, program->end);
+    if (end < 0) {
+        cutProgram(current_location, program);
+        end = findCell(route, length, program->end);
+    }
+    if (end >= 0) {
+        compilePath(program, &route[end], length - end);
+    }
 
-    if (same_state) {
-        int_cte += cte;
-        d_cte = prev_cte - cte;
-    } else {
-        int_cte = cte;
-        d_cte = 0;
+    if (!calculateProgramSpeed(current_location, program, left_speed, right_speed)) {
+        return false;
     }
+    restartProgram(program);
+    return true;
+}
 
-    // How far off is theta
-    double theta_cte = calculateThetaCTE(current_location, dir, cte);
 
-    // The amount we should try to rotate to the left to get back to the correct location (PID)
-    double rotate_left = (-1 * STRAIGHT_TAU_P * cte) +
-                            (-1 * STRAIGHT_TAU_I * int_cte) +
-                            (-1 * STRAIGHT_TAU_D * d_cte) +
-                            (STRAIGHT_TAU_THETA * theta_cte);
+/*----------- Private Functions -----------*/
 
+/* Turns on the spot until theta is within INNER_TOLERANCE_RAD of dir, then drives to next_location with
+ * driveStraight from standing, without turning on the spot again */
+bool driveSegment(gaussian_location_t* current_location, gaussian_location_t* next_location,
+                        Direction dir, double* left_speed, double* right_speed) {
 
-    // Determine the base straight forward speed
-    double distance_away = calculateDistanceAway(current_location, next_location, dir);
-    
-    double base_speed = straightSpeedProfile(distance_away);
+    bool driving = straight_planned && straight_dir == dir && next_location->x_mu == straight_end_x &&
+                   next_location->y_mu == straight_end_y;
+    if (!driving && abs(angleDifference(directionToRAD[dir], (double) current_location->theta_mu)) > INNER_TOLERANCE_RAD) {
+        straight_planned = false;
+        turnController(current_location, left_speed, right_speed, dir);
+        return false;
+    }
+    return driveStraight(current_location, next_location->x_mu, next_location->y_mu, dir, 0, 0,
+                         left_speed, right_speed);
+}
 
-    // Set the speed the motors should be at
-    *left_speed = base_speed + rotate_left;
-    *right_speed = base_speed - rotate_left;
+/* Follows a reference along the straight along dir that ends at (end_x, end_y), from entry_speed
+ * - The straight is planned again, from where the reference is, when its end or exit_speed changes
+ * - With an exit_speed it is done once past the end, still driving at exit_speed
+ * - Without one it is done within INNER_TOLERANCE_MM of the end, once the reference has stopped there */
+bool driveStraight(gaussian_location_t* current_location, double end_x, double end_y, Direction dir,
+                        double entry_speed, double exit_speed, double* left_speed, double* right_speed) {
 
+    if (!straight_planned || dir != straight_dir || end_x != straight_end_x || end_y != straight_end_y ||
+            exit_speed != straight_exit_speed) {
+        planStraight(current_location, end_x, end_y, dir, entry_speed, exit_speed);
+    }
+    double sin_theta, cos_theta;
+    sinCos(straight_start.theta, &sin_theta, &cos_theta);
+
+    double distance_away = cos_theta * (end_x - current_location->x_mu) + sin_theta * (end_y - current_location->y_mu);
+    bool stopped = straight_profile_time >= straight_profile.duration;
+    if (exit_speed > 0 ? distance_away <= 0 : stopped && distance_away < INNER_TOLERANCE_MM) {
+        *left_speed = exit_speed;
+        *right_speed = exit_speed;
+        straight_planned = false;
+        return true;
+    }
+
+    // The speed that gets to where the reference is at the end of the tick
+    motion_sample_t now, after;
+    double facing = facingLine(current_location, straight_start.theta);
+    sampleMotionProfile(&straight_profile, straight_profile_time, &now);
+    straight_profile_time += movement_tick * facing;
+    sampleMotionProfile(&straight_profile, straight_profile_time, &after);
+
+    trajectory_point_t reference = straight_start;
+    reference.x += cos_theta * now.position;
+    reference.y += sin_theta * now.position;
+    reference.speed = movement_tick > 0 ? (after.position - now.position) / movement_tick : now.speed * facing;
+    trackTrajectory(current_location, &reference, left_speed, right_speed);
+    return false;
 }
 
-double calculateCTE(gaussian_location_t* cur, gaussian_location_t* next, Direction dir) {
+/* Start the reference of driveStraight on the line through the end along dir
+ * - A straight that is still running carries on from where its reference is, at its speed
+ * - A new one starts level with the robot at entry_speed */
+void planStraight(gaussian_location_t* current_location, double end_x, double end_y, Direction dir,
+                        double entry_speed, double exit_speed) {
+
+    double sin_theta, cos_theta;
+    sinCos(directionToRAD[dir], &sin_theta, &cos_theta);
+
+    double start_x, start_y;
+    if (straight_planned && dir == straight_dir) {
+        motion_sample_t sample;
+        sampleMotionProfile(&straight_profile, straight_profile_time, &sample);
+        start_x = straight_start.x + cos_theta * sample.position;
+        start_y = straight_start.y + sin_theta * sample.position;
+        entry_speed = sample.speed;
+    } else {
+        double along = cos_theta * (current_location->x_mu - end_x) + sin_theta * (current_location->y_mu - end_y);
+        start_x = end_x + cos_theta * along;
+        start_y = end_y + sin_theta * along;
+    }
 
-    switch (dir) {
+    double distance = cos_theta * (end_x - start_x) + sin_theta * (end_y - start_y);
+    planMotionProfile(&straight_limits, max(distance, 0.0), entry_speed, exit_speed, &straight_profile);
+    straight_profile_time = 0;
+
+    straight_start.x = start_x;
+    straight_start.y = start_y;
+    straight_start.theta = directionToRAD[dir];
+    straight_start.speed = 0;
+    straight_start.turn_rate = 0;
+    straight_dir = dir;
+    straight_end_x = end_x;
+    straight_end_y = end_y;
+    straight_exit_speed = exit_speed;
+    straight_planned = true;
+}
 
-        case North:  // North(0, -1) theta = 3*PI/2
-            return (cur->x_mu - next->x_mu);
-        
-        case East:   // East(1, 0)   theta = 0
-            return (cur->y_mu - next->y_mu);
+/* How much of a tick a reference moves on by, less the further the robot faces away from theta, the
+ * heading of its line, so it stands still past 90 degrees */
+double facingLine(gaussian_location_t* current_location, double theta) {
+    double sin_off, cos_off;
+    sinCos(angleDifference(theta, (double) current_location->theta_mu), &sin_off, &cos_off);
+    return max(cos_off, 0.0);
+}
 
-        case South:  // South(0, 1)  theta = PI/2
-            return -1 * (cur->x_mu - next->x_mu);
+/* Start the reference of calculateSpeed where the robot is, headed at next_location
+ * - It carries on at the speed of the last reference along the new line, so a goal that moves on
+ *   while driving does not stop the robot */
+void planTracking(gaussian_location_t* current_location, gaussian_location_t* next_location) {
+
+    double dx = next_location->x_mu - current_location->x_mu;
+    double dy = next_location->y_mu - current_location->y_mu;
+    double distance = sqrt(dx * dx + dy * dy);
+    double theta = distance > 0 ? wrapAngle(atan2(dy, dx)) : (double) current_location->theta_mu;
+
+    double entry_speed = 0;
+    if (tracking_planned) {
+        motion_sample_t sample;
+        sampleMotionProfile(&tracking_profile, tracking_profile_time, &sample);
+        double sin_turn, cos_turn;
+        sinCos(angleDifference(theta, tracking_start.theta), &sin_turn, &cos_turn);
+        entry_speed = sample.speed * max(cos_turn, 0.0);
+    }
+    planMotionProfile(&straight_limits, distance, entry_speed, 0, &tracking_profile);
+    tracking_profile_time = 0;
+
+    tracking_start.x = current_location->x_mu;
+    tracking_start.y = current_location->y_mu;
+    tracking_start.theta = theta;
+    tracking_start.speed = 0;
+    tracking_start.turn_rate = 0;
+    tracking_goal_x = next_location->x_mu;
+    tracking_goal_y = next_location->y_mu;
+    tracking_planned = true;
+}
 
-        case West:   // West(-1, 0)  theta = PI
-            return -1 * (cur->y_mu - next->y_mu);
-        
+/* Heading at the end of a turn command that starts facing program_heading */
+Direction commandHeading(motion_command_t* command) {
+    switch (command->type) {
+        case MOTION_TURN_RIGHT:
+        case MOTION_ARC_RIGHT:
+            return (Direction) ((program_heading + 1) % 4);
+        case MOTION_TURN_AROUND:
+        case MOTION_ARC_AROUND_LEFT:
+        case MOTION_ARC_AROUND_RIGHT:
+            return (Direction) ((program_heading + 2) % 4);
+        case MOTION_TURN_LEFT:
+        case MOTION_ARC_LEFT:
+            return (Direction) ((program_heading + 3) % 4);
         default:
-            return 0;
+            return program_heading;
     }
 }
 
-double calculateThetaCTE(gaussian_location_t* cur, Direction dir, double cte) {
+/* Move where the next command starts past command */
+void advanceProgram(motion_command_t* command) {
+    if (command->type == MOTION_STRAIGHT) {
+        double length = command->cells * (double) (CELL_LENGTH + WALL_THICKNESS);
+        program_x += directionToXY[program_heading][0] * length;
+        program_y += directionToXY[program_heading][1] * length;
+    } else {
+        if (command->type == MOTION_ARC_AROUND_LEFT || command->type == MOTION_ARC_AROUND_RIGHT) {
+            // Into the next cell over
+            int side = command->type == MOTION_ARC_AROUND_RIGHT ? 1 : 3;
+            Direction middle = (Direction) ((program_heading + side) % 4);
+            program_x += directionToXY[middle][0] * (double) (CELL_LENGTH + WALL_THICKNESS);
+            program_y += directionToXY[middle][1] * (double) (CELL_LENGTH + WALL_THICKNESS);
+        }
+        program_heading = commandHeading(command);
+    }
+}
 
-    double goal = directionToRAD[dir];
-    double theta_cte;
+/* Empty program to start over from its end, keeping its turn style */
+void restartProgram(motion_program_t* program) {
+    TurnStyle turn_style = program->turn_style;
+    initializeMotionProgram(program, program->end, program->end_heading);
+    program->turn_style = turn_style;
+    startMotionProgram(program);
+}
 
-    if (dir == East) {
-        // Special case
-        if (0 <= cur->theta_mu && cur->theta_mu <= PI) {
-            theta_cte = 0.0 - cur->theta_mu;
-        } else {
-            theta_cte = TWO_PI - cur->theta_mu;
+/* Index of cell in cells, -1 if it is not there */
+int findCell(const cell_t* cells, int length, cell_t cell) {
+    for (int i = 0; i < length; i++) {
+        if (cells[i].x == cell.x && cells[i].y == cell.y) {
+            return i;
         }
-
-    } else {
-        // Normal case
-        theta_cte = directionToRAD[dir] - cur->theta_mu;
     }
-    return theta_cte;
+    return -1;
 }
 
-double calculateDistanceAway(gaussian_location_t* cur, gaussian_location_t* next, Direction dir) {
+/* Cut program back to the running command and the first straight from there, which stops in the cell
+ * after the robot's if it is running and one cell after the turn if not
+ * - A program of turns only is left as it is, it does not leave its cell */
+void cutProgram(gaussian_location_t* current_location, motion_program_t* program) {
+    int straight = program->next_command;
+    while (straight < program->num_commands && program->commands[straight].type != MOTION_STRAIGHT) {
+        straight++;
+    }
+    if (straight >= program->num_commands) {
+        return;
+    }
 
-    switch (dir) {
+    // Where the straight starts, as planned
+    double running_x = program_x;
+    double running_y = program_y;
+    Direction running_heading = program_heading;
+    for (int i = program->next_command; i < straight; i++) {
+        advanceProgram(&program->commands[i]);
+    }
+    double start_x = program_x;
+    double start_y = program_y;
+    Direction dir = program_heading;
+    program_x = running_x;
+    program_y = running_y;
+    program_heading = running_heading;
+
+    int cells = 1;
+    if (straight == program->next_command) {
+        double along = directionToXY[dir][0] * (current_location->x_mu - start_x) +
+                       directionToXY[dir][1] * (current_location->y_mu - start_y);
+        cells = max((int) floor(along / (double) (CELL_LENGTH + WALL_THICKNESS) + 0.5), 0) + 1;
+    }
 
-        case North:  // North(0, -1) theta = 3*PI/2
-            return -1 * (next->y_mu - cur->y_mu);
-        
-        case East:   // East(1, 0)   theta = 0
-            return (next->x_mu - cur->x_mu);
+    motion_command_t* command = &program->commands[straight];
+    command->cells = min(command->cells, cells);
+    command->exit_speed = 0;
+    program->num_commands = straight + 1;
+    program->end.x = coordinateDistanceToCellNumber(start_x) + (int) directionToXY[dir][0] * command->cells;
+    program->end.y = coordinateDistanceToCellNumber(start_y) + (int) directionToXY[dir][1] * command->cells;
+    program->end_heading = dir;
+}
 
-        case South:  // South(0, 1)  theta = PI/2
-            return (next->y_mu - cur->y_mu);
+/* Drives along the circle of an arc command at its entry_speed, done once it has swept the whole turn
+ * - The arc starts arcReach back from the center of the corner cell, and its center is the radius to
+ *   the side of that
+ * - The reference is the point of the circle closest to the robot, going round it at entry_speed */
+bool driveArc(gaussian_location_t* current_location, motion_command_t* command,
+                        double* left_speed, double* right_speed) {
 
-        case West:   // West(-1, 0)  theta = PI
-            return -1 * (next->x_mu - cur->x_mu);
-        
-        default:
-            return 0;
+    double radius = arcReach(command);
+    double side = (command->type == MOTION_ARC_RIGHT || command->type == MOTION_ARC_AROUND_RIGHT) ? 1.0 : -1.0;
+    double sweep = (command->type == MOTION_ARC_LEFT || command->type == MOTION_ARC_RIGHT) ? HALF_PI : PI;
+    double start_theta = directionToRAD[program_heading];
+
+    double start_x = program_x - directionToXY[program_heading][0] * radius;
+    double start_y = program_y - directionToXY[program_heading][1] * radius;
+    double sin_start, cos_start;
+    sinCos(start_theta, &sin_start, &cos_start);
+    double center_x = start_x - side * radius * sin_start;
+    double center_y = start_y + side * radius * cos_start;
+
+    // Heading of the tangent to the circle where the robot is, and how far around it that is
+    double dx = current_location->x_mu - center_x;
+    double dy = current_location->y_mu - center_y;
+    double path_theta = wrapAngle(atan2(side * dx, -side * dy));
+    double swept = side * angleDifference(path_theta, start_theta);
+    if (swept < -HALF_PI) {
+        swept += TWO_PI;
     }
-}
 
-/*
- *                     SLOPE
- *                       v   Goal
- * STABLE_SPEED----------\    |
- *                         \  | 
- *                           \|-INTERCEPT 
- *                            |
- * ===========================|===========> distance_away
- */
-double straightSpeedProfile(double distance_away) {
-
-    // Implement the function in the block comment above
-    if (distance_away > 0) {
-        return min((STRAIGHT_PROFILE_SLOPE * distance_away) + STRAIGHT_PROFILE_INTERCEPT, STRAIGHT_PROFILE_STABLE_SPEED);
-    } else {
-        return max((STRAIGHT_PROFILE_SLOPE * distance_away) + STRAIGHT_PROFILE_INTERCEPT, -1 * STRAIGHT_PROFILE_STABLE_SPEED);
+    if (swept >= sweep) {
+        *left_speed = command->exit_speed;
+        *right_speed = command->exit_speed;
+        return true;
     }
+
+    double off_center = sqrt(dx * dx + dy * dy);
+    trajectory_point_t reference;
+    reference.x = off_center > 0 ? center_x + dx * radius / off_center : start_x;
+    reference.y = off_center > 0 ? center_y + dy * radius / off_center : start_y;
+    reference.theta = path_theta;
+    reference.speed = command->entry_speed;
+    reference.turn_rate = side * command->entry_speed / radius;
+    trackTrajectory(current_location, &reference, left_speed, right_speed);
+    return false;
 }
 
-// TODO: Everything below this
+
+/* Controllers - tune in settings.h */
 
 /* Turn toward the correct direction */
 void turnController(gaussian_location_t* current_location, double* left_speed,
-                            double* right_speed, Direction dir, bool same_state) {
+                            double* right_speed, Direction dir) {
 
     // Error between theta and the desired direction
     double thetaError = calculateThetaError(current_location, dir);
@@ -470,10 +600,7 @@ double calculateThetaError(gaussian_location_t* cur, Direction dir) {
     double thetaError = directionToRAD[dir] - cur->theta_mu;
 
     // limit final theta between 0 and 2 pi
-    while (thetaError < 0) { thetaError += TWO_PI; }
-    while (thetaError >= TWO_PI) { thetaError -= TWO_PI; }
-
-    return thetaError;
+    return wrapAngle(thetaError);
 }
 
 
@@ -6,25 +6,89 @@
 
 
 #include "../types.h"
+#include "../strategy/path_compiler.h"
 
 
 // Globals
-enum RobotState {
-    PERFECT,                    // Within tolerance for both x and y
-    OUT_XY_IN_THETA,            // Outside tolerance for one of x and y AND within tolerance for Theta
-    OUT_XY_OUT_THETA,           // Outside tolerance for one of x and y AND outside tolerance for Theta
-    IN_XY_IN_THETA,             // Within tolerance for one of x and y AND within tolerance for Theta
-    IN_XY_OUT_THETA             // Within tolerance for one of x and y AND outside tolerance for Theta
-};
+// A point moving along a path for trackTrajectory to follow
+typedef struct {
+    double x;                   // Where the point is in mm
+    double y;
+    double theta;               // Heading of the path there
+    double speed;               // Speed of the point along the path in mm/s
+    double turn_rate;           // Rate theta changes at in rad/s
+} trajectory_point_t;
 
 // Check is x is between y+e and y-e
 #define IS_BETWEEN_ERROR(x,y,e) (((x) < (y) + (e)) && ((x) > (y) - (e)))
 
 
+/* initialize movement
+ * Starts the controllers from current_location, stopped */
+void initializeMovement(gaussian_location_t* current_location);
+
+/* set movement tick
+ * Seconds between calls of the calculate*Speed functions, MOVEMENT_LOOP_TIME unless set
+ * - The straight line speed profile moves on by this much each call */
+void setMovementTick(double seconds);
+
 /* calculate speed
  * Calculate the speed to set the motors to given the current_location and the next_location
- * - left_speed and right_speed should be passed in with the current respective speeds*/
+ * - left_speed and right_speed should be passed in with the current respective speeds
+ * - trackTrajectory behind a reference point that drives a straight line motion profile from where the
+ *   robot was when next_location changed to next_location
+ * - The reference waits while the robot faces away from the line, so the robot turns toward it first */
 void calculateSpeed(gaussian_location_t* current_location, gaussian_location_t* next_location,
                         double* left_speed, double* right_speed);
 
+/* track trajectory
+ * Calculate the speed to follow reference, one nonlinear law of the error in the robot's frame for
+ * every pose with no states to switch between
+ * - The speed closes the error ahead, the turn rate the heading error and, while the reference moves,
+ *   the error to the side */
+void trackTrajectory(gaussian_location_t* current_location, const trajectory_point_t* reference,
+                        double* left_speed, double* right_speed);
+
+/* calculate segment speed
+ * Calculate the speed to drive the straight line along dir to next_location, turning on the spot to
+ * dir first, dir can be one of the diagonals
+ * - The straight is a reference point driving a motion profile along it, followed with trackTrajectory
+ * - Returns true once within INNER_TOLERANCE_MM of next_location along dir, with both speeds set to 0 */
+bool calculateSegmentSpeed(gaussian_location_t* current_location, gaussian_location_t* next_location,
+                        Direction dir, double* left_speed, double* right_speed);
+
+/* start motion program
+ * Runs program from its next command, starting from the center of program->start facing program->start_heading */
+void startMotionProgram(motion_program_t* program);
+
+/* calculate program speed
+ * Calculate the speed to run the next command of program, moving on to the one after as each is done
+ * - Commands can be appended to program while it runs
+ * - Straights and arcs are followed with trackTrajectory, only turns on the spot use turnController
+ * - Arcs are driven without stopping, from the end of the straight before them to the start of the one after
+ * - Returns true, with both speeds set to 0, once every command of program is done */
+bool calculateProgramSpeed(gaussian_location_t* current_location, motion_program_t* program,
+                        double* left_speed, double* right_speed);
+
+/* start streamed program
+ * Empties program to run the cells strategy hands out from the cell of current_location, facing the
+ * direction closest to its theta, turning along search arcs */
+void startStreamedProgram(motion_program_t* program, gaussian_location_t* current_location);
+
+/* calculate streamed speed
+ * Appends the cell of next_location to program and runs it with calculateProgramSpeed, so a straight
+ * strategy carries on with is driven through without stopping in each cell
+ * - Returns true, with both speeds set to 0, while standing at the end of program, which then starts
+ *   over from there so it never fills up */
+bool calculateStreamedSpeed(gaussian_location_t* current_location, gaussian_location_t* next_location,
+                        motion_program_t* program, double* left_speed, double* right_speed);
+
+/* calculate lookahead speed
+ * Appends the waypoints strategyLookahead keeps to program and runs it with calculateProgramSpeed, so
+ * the robot only slows down where the waypoints turn, start program with startStreamedProgram
+ * - Returns true, with both speeds set to 0, while standing at the end of program, which then starts
+ *   over from there so it never fills up */
+bool calculateLookaheadSpeed(gaussian_location_t* current_location, const waypoints_t* waypoints,
+                        motion_program_t* program, double* left_speed, double* right_speed);
+
 #endif //_MOVEMENT_H_
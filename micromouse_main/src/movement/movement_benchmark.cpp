@@ -0,0 +1,492 @@
+#ifndef ARDUINO
+#include <math.h>
+#include "movement.h"
+#include "../strategy/speed_run.h"
+#include "../strategy/path_compiler.h"
+#include "../strategy/strategy_test_data.h"
+#include "../localization/localization.h"
+#include "../util/conversions.h"
+#include "../util/motion_profile.h"
+#include "../benchmark.h"
+#include "../settings.h"
+#include "../types.h"
+
+
+#define TIME_STEP (double)(CONTROL_LOOP_TIME/1000000.0)  // in sec
+#define MAX_SEGMENT_STEPS 100000
+#define RAMP_PROFILE_SLOPE 3        // straightSpeedProfile before motion profiles, speed = SLOPE * distance_away
+#define GRID_POSES 10               // Start poses along x, y and theta, as movement_test's "Test other positions"
+#define GRID_MAX_STEPS 1000
+
+
+/* Seconds of control loops for calculateSegmentSpeed to drive path from the start cell facing East,
+ * with the motors following the speeds exactly, -1 if a segment never finishes */
+double simulatePath(const speed_run_path_t* path) {
+    initializeLocalization();
+    robot_location.x_mu = cellNumberToCoordinateDistance(INIT_CELL_X);
+    robot_location.y_mu = cellNumberToCoordinateDistance(INIT_CELL_Y);
+    robot_location.theta_mu = directionToRAD[East];
+    initializeMovement(&robot_location);
+
+    int steps = 0;
+    for (int i = 0; i < path->num_segments; i++) {
+        gaussian_location_t next_location;
+        next_location.x_mu = latticeNumberToCoordinateDistance(path->segments[i].end.x);
+        next_location.y_mu = latticeNumberToCoordinateDistance(path->segments[i].end.y);
+
+        double left_speed, right_speed;
+        int segment_steps = 0;
+        while (!calculateSegmentSpeed(&robot_location, &next_location, path->segments[i].heading,
+                                      &left_speed, &right_speed)) {
+            localizeMotionStep(TIME_STEP * left_speed, TIME_STEP * right_speed);
+            if (++segment_steps > MAX_SEGMENT_STEPS) {
+                return -1;
+            }
+        }
+        steps += segment_steps;
+    }
+    return steps * TIME_STEP;
+}
+
+/* Planned and simulated times of the speed run on maze_string, with and without diagonals */
+void printDiagonalSpeedRun(const char* name, const char** maze_string) {
+    static probabilistic_maze_t maze;
+    static speed_run_path_t orthogonal_path;
+    static speed_run_path_t diagonal_path;
+    static cell_t cells[MAZE_WIDTH * MAZE_HEIGHT];
+    cell_t start = { .x = INIT_CELL_X, .y = INIT_CELL_Y };
+
+    initializeMaze(&maze);
+    readInMaze(maze_string, &maze);
+    cell_t goal = cells[floodRoute(&maze, start, cells) - 1];
+    planSpeedRun(&maze, start, East, goal, false, &orthogonal_path);
+    planSpeedRun(&maze, start, East, goal, true, &diagonal_path);
+
+    double orthogonal_time = simulatePath(&orthogonal_path);
+    double diagonal_time = simulatePath(&diagonal_path);
+    printf("%-10s\t%5d\t%8.2f\t%8.2f\t%5d\t%8.2f\t%8.2f\t%6.1f%%\n", name,
+            orthogonal_path.num_segments, orthogonal_path.time, orthogonal_time,
+            diagonal_path.num_segments, diagonal_path.time, diagonal_time,
+            100.0 * (orthogonal_time - diagonal_time) / orthogonal_time);
+}
+
+/* How a straight segment went, from the speeds of the left wheel */
+typedef struct {
+    double time;
+    double peak_accel;      // mm/s^2
+    double peak_jerk;       // mm/s^3
+} segment_run_t;
+
+/* Add the speed of the next control loop to run */
+void addSegmentSpeed(double speed, double* prev_speed, double* prev_accel, segment_run_t* run) {
+    double accel = (speed - *prev_speed) / TIME_STEP;
+    run->peak_accel = fmax(run->peak_accel, fabs(accel));
+    run->peak_jerk = fmax(run->peak_jerk, fabs(accel - *prev_accel) / TIME_STEP);
+    *prev_speed = speed;
+    *prev_accel = accel;
+}
+
+/* A segment of distance mm from standing with the old ramp, min(STABLE_SPEED, SLOPE * distance_away),
+ * and the motors following it exactly */
+void simulateRampSegment(double distance, segment_run_t* run) {
+    *run = (segment_run_t) {};
+    double prev_speed = 0, prev_accel = 0;
+    int steps = 0;
+    while (distance >= INNER_TOLERANCE_MM && steps < MAX_SEGMENT_STEPS) {
+        double speed = fmin(RAMP_PROFILE_SLOPE * distance, (double) STRAIGHT_PROFILE_STABLE_SPEED);
+        addSegmentSpeed(speed, &prev_speed, &prev_accel, run);
+        distance -= TIME_STEP * speed;
+        steps++;
+    }
+    addSegmentSpeed(0, &prev_speed, &prev_accel, run);
+    run->time = steps * TIME_STEP;
+}
+
+/* A segment of distance mm from standing facing East with calculateSegmentSpeed */
+void simulateProfileSegment(double distance, segment_run_t* run) {
+    *run = (segment_run_t) {};
+    initializeLocalization();
+    robot_location.x_mu = cellNumberToCoordinateDistance(INIT_CELL_X);
+    robot_location.y_mu = cellNumberToCoordinateDistance(INIT_CELL_Y);
+    robot_location.theta_mu = directionToRAD[East];
+    initializeMovement(&robot_location);
+
+    gaussian_location_t next_location = robot_location;
+    next_location.x_mu += distance;
+    double left_speed, right_speed, prev_speed = 0, prev_accel = 0;
+    int steps = 0;
+    while (!calculateSegmentSpeed(&robot_location, &next_location, East, &left_speed, &right_speed) &&
+            steps < MAX_SEGMENT_STEPS) {
+        addSegmentSpeed(left_speed, &prev_speed, &prev_accel, run);
+        localizeMotionStep(TIME_STEP * left_speed, TIME_STEP * right_speed);
+        steps++;
+    }
+    addSegmentSpeed(0, &prev_speed, &prev_accel, run);
+    run->time = steps * TIME_STEP;
+}
+
+/* Old ramp vs motion profile for a straight of cells from standing, and the trapezoid the profile would be
+ * without its jerk limit */
+void printStraightSegment(int cells) {
+    motion_limits_t trapezoid = { .max_speed = STRAIGHT_PROFILE_STABLE_SPEED, .max_accel = STRAIGHT_PROFILE_ACCEL,
+                                  .max_jerk = 0 };
+    motion_profile_t profile;
+    double distance = cells * CELL_PITCH;
+    planMotionProfile(&trapezoid, distance, 0, 0, &profile);
+
+    segment_run_t ramp, s_curve;
+    simulateRampSegment(distance, &ramp);
+    simulateProfileSegment(distance, &s_curve);
+    printf("%5d\t%7.3f\t%8.0f\t%8.0f\t%7.3f\t%7.3f\t%8.0f\t%8.0f\t%7.3f\t%6.1f%%\n", cells,
+            ramp.time, ramp.peak_accel, ramp.peak_jerk, s_curve.time, straightTravelTime(distance),
+            s_curve.peak_accel, s_curve.peak_jerk, profile.duration, 100.0 * (ramp.time - s_curve.time) / ramp.time);
+}
+
+/* Simulated run of one way of driving a route
+ *  - arrive: seconds until within OUTER_TOLERANCE_MM of the goal in x and y, where calculateSpeed stops
+ *  - stop: seconds until it reports being done, -1 if it never does
+ *  - loop_ns: host CPU time of the movement (and strategy) calls per control loop */
+typedef struct {
+    double arrive;
+    double stop;
+    double loop_ns;
+} route_run_t;
+
+void startRouteRun(cell_t start, Direction heading, route_run_t* run) {
+    initializeLocalization();
+    robot_location.x_mu = cellNumberToCoordinateDistance(start.x);
+    robot_location.y_mu = cellNumberToCoordinateDistance(start.y);
+    robot_location.theta_mu = directionToRAD[heading];
+    initializeMovement(&robot_location);
+    run->arrive = -1;
+    run->stop = -1;
+    run->loop_ns = 0;
+}
+
+void checkArrival(cell_t goal, int steps, route_run_t* run) {
+    if (run->arrive < 0 &&
+            IS_BETWEEN_ERROR(robot_location.x_mu, cellNumberToCoordinateDistance(goal.x), OUTER_TOLERANCE_MM) &&
+            IS_BETWEEN_ERROR(robot_location.y_mu, cellNumberToCoordinateDistance(goal.y), OUTER_TOLERANCE_MM)) {
+        run->arrive = steps * TIME_STEP;
+    }
+}
+
+/* mm the straight profile takes to stop from STRAIGHT_PROFILE_STABLE_SPEED */
+double stoppingDistance() {
+    motion_limits_t limits = { .max_speed = STRAIGHT_PROFILE_STABLE_SPEED, .max_accel = STRAIGHT_PROFILE_ACCEL,
+                               .max_jerk = STRAIGHT_PROFILE_JERK };
+    motion_profile_t profile;
+    planMotionProfile(&limits, 10 * CELL_PITCH, STRAIGHT_PROFILE_STABLE_SPEED, 0, &profile);
+    return profile.distance - profile.position[4];
+}
+
+typedef void (*speed_controller_t)(gaussian_location_t*, gaussian_location_t*, double*, double*);
+
+// The program calculateStreamedProgramSpeed runs, started over by simulateWaypoints
+motion_program_t streamed_program;
+
+/* calculateStreamedSpeed with streamed_program */
+void calculateStreamedProgramSpeed(gaussian_location_t* current_location, gaussian_location_t* next_location,
+                        double* left_speed, double* right_speed) {
+    calculateStreamedSpeed(current_location, next_location, &streamed_program, left_speed, right_speed);
+}
+
+/* Drive the flood route of maze to goal the way movement_loop does, done once it stands still in goal
+ *  - One cell at a time with strategy() and controller, or with strategyLookahead() and
+ *    calculateLookaheadSpeed if controller is NULL */
+void simulateWaypoints(probabilistic_maze_t* maze, cell_t goal, speed_controller_t controller, route_run_t* run) {
+    cell_t start = { .x = INIT_CELL_X, .y = INIT_CELL_Y };
+    startRouteRun(start, East, run);
+    startStreamedProgram(&streamed_program, &robot_location);
+    initializeStrategy();
+    setGoalCells(&goal, 1);
+
+    static waypoints_t waypoints;
+    waypoints.count = 0;
+    gaussian_location_t next_location;
+    double left_speed = 0, right_speed = 0;
+    int steps;
+    for (steps = 0; steps < MAX_SEGMENT_STEPS; steps++) {
+        double start_ns = benchNowNs();
+        if (controller == NULL) {
+            strategyLookahead(&robot_location, maze, &waypoints);
+            calculateLookaheadSpeed(&robot_location, &waypoints, &streamed_program, &left_speed, &right_speed);
+        } else {
+            strategy(&robot_location, maze, &next_location);
+            controller(&robot_location, &next_location, &left_speed, &right_speed);
+        }
+        run->loop_ns += benchNowNs() - start_ns;
+
+        checkArrival(goal, steps, run);
+        if (left_speed == 0 && right_speed == 0 &&
+                coordinateDistanceToCellNumber(robot_location.x_mu) == goal.x &&
+                coordinateDistanceToCellNumber(robot_location.y_mu) == goal.y) {
+            run->stop = steps * TIME_STEP;
+            break;
+        }
+        localizeMotionStep(TIME_STEP * left_speed, TIME_STEP * right_speed);
+    }
+    run->loop_ns /= steps + 1;
+    initializeStrategy();
+}
+
+/* Run program with calculateProgramSpeed */
+void simulateProgram(motion_program_t* program, route_run_t* run) {
+    startRouteRun(program->start, program->start_heading, run);
+    startMotionProgram(program);
+
+    double left_speed, right_speed;
+    int steps;
+    for (steps = 0; steps < MAX_SEGMENT_STEPS; steps++) {
+        double start_ns = benchNowNs();
+        bool done = calculateProgramSpeed(&robot_location, program, &left_speed, &right_speed);
+        run->loop_ns += benchNowNs() - start_ns;
+
+        checkArrival(program->end, steps, run);
+        if (done) {
+            run->stop = steps * TIME_STEP;
+            break;
+        }
+        localizeMotionStep(TIME_STEP * left_speed, TIME_STEP * right_speed);
+    }
+    run->loop_ns /= steps + 1;
+}
+
+/* Simulated times of the flood route of maze_string, cell by cell with calculateSpeed, streamed into a
+ * motion program as strategy hands out the cells, and compiled into one up front with speed run arcs */
+void printMotionProgramRun(const char* name, const char** maze_string) {
+    static probabilistic_maze_t maze;
+    static cell_t cells[MAZE_WIDTH * MAZE_HEIGHT];
+    static motion_program_t program;
+    cell_t start = { .x = INIT_CELL_X, .y = INIT_CELL_Y };
+
+    initializeMaze(&maze);
+    readInMaze(maze_string, &maze);
+    int length = floodRoute(&maze, start, cells);
+    initializeMotionProgram(&program, start, East);
+    program.turn_style = TURN_SPEED_RUN_ARCS;
+    compilePath(&program, cells, length);
+
+    route_run_t cell_by_cell, streamed, compiled;
+    simulateWaypoints(&maze, program.end, calculateSpeed, &cell_by_cell);
+    simulateWaypoints(&maze, program.end, calculateStreamedProgramSpeed, &streamed);
+    simulateProgram(&program, &compiled);
+    printf("%-10s\t%5d\t%7.2f\t%7.0f\t%7.2f\t%7.0f\t%6.1f%%\t%7.2f\n", name, length,
+            cell_by_cell.stop, cell_by_cell.loop_ns, streamed.stop, streamed.loop_ns,
+            100.0 * (cell_by_cell.stop - streamed.stop) / cell_by_cell.stop, compiled.stop);
+}
+
+/* Simulated time of cells as a motion program with each style of turns */
+void printTurnStyleRun(const char* name, const cell_t* cells, int length) {
+    static motion_program_t program;
+    TurnStyle styles[] = { TURN_IN_PLACE, TURN_SEARCH_ARCS, TURN_SPEED_RUN_ARCS };
+    route_run_t runs[3];
+    int num_commands[3];
+
+    for (int s = 0; s < 3; s++) {
+        initializeMotionProgram(&program, cells[0], East);
+        program.turn_style = styles[s];
+        compilePath(&program, cells, length);
+        simulateProgram(&program, &runs[s]);
+        num_commands[s] = program.num_commands;
+    }
+    printf("%-10s\t%5d\t%7.2f\t%5d\t%7.2f\t%6.1f%%\t%5d\t%7.2f\t%6.1f%%\n", name, num_commands[0], runs[0].stop,
+            num_commands[1], runs[1].stop, 100.0 * (runs[0].stop - runs[1].stop) / runs[0].stop,
+            num_commands[2], runs[2].stop, 100.0 * (runs[0].stop - runs[2].stop) / runs[0].stop);
+}
+
+/* printTurnStyleRun of the flood route of maze_string */
+void printTurnStyleMazeRun(const char* name, const char** maze_string) {
+    static probabilistic_maze_t maze;
+    static cell_t cells[MAZE_WIDTH * MAZE_HEIGHT];
+    cell_t start = { .x = INIT_CELL_X, .y = INIT_CELL_Y };
+
+    initializeMaze(&maze);
+    readInMaze(maze_string, &maze);
+    printTurnStyleRun(name, cells, floodRoute(&maze, start, cells));
+}
+
+/* Over every start pose of the grid, of one controller
+ *  - arrive: seconds until within OUTER_TOLERANCE_MM of the goal in x and y
+ *  - settle: seconds until within INNER_TOLERANCE_MM for good, at most GRID_MAX_STEPS
+ *  - cte: mm off the straight line from the start pose to the goal
+ *  - spike: change of a wheel speed from one control loop to the next in mm/s */
+typedef struct {
+    double arrive_sum, arrive_max;
+    double settle_sum, settle_max;
+    double cte_sum, cte_max;
+    double spike_max;
+    int missed;             // Poses that never got within OUTER_TOLERANCE_MM
+} grid_run_t;
+
+void simulateGridPose(speed_controller_t controller, gaussian_location_t* goal, grid_run_t* run) {
+    initializeMovement(&robot_location);
+    double start_x = robot_location.x_mu, start_y = robot_location.y_mu;
+    double line_x = goal->x_mu - start_x, line_y = goal->y_mu - start_y;
+    double line_length = sqrt(line_x * line_x + line_y * line_y);
+
+    double arrive = -1, settle = 0, cte = 0, spike = 0;
+    double left_speed = 0, right_speed = 0;
+    for (int steps = 0; steps < GRID_MAX_STEPS; steps++) {
+        double prev_left = left_speed, prev_right = right_speed;
+        controller(&robot_location, goal, &left_speed, &right_speed);
+        spike = fmax(spike, fmax(fabs(left_speed - prev_left), fabs(right_speed - prev_right)));
+        localizeMotionStep(TIME_STEP * left_speed, TIME_STEP * right_speed);
+
+        double x_error = robot_location.x_mu - goal->x_mu, y_error = robot_location.y_mu - goal->y_mu;
+        if (arrive < 0 && fabs(x_error) < OUTER_TOLERANCE_MM && fabs(y_error) < OUTER_TOLERANCE_MM) {
+            arrive = (steps + 1) * TIME_STEP;
+        }
+        if (fabs(x_error) >= INNER_TOLERANCE_MM || fabs(y_error) >= INNER_TOLERANCE_MM) {
+            settle = (steps + 1) * TIME_STEP;
+        }
+        if (line_length > 0) {
+            double off = ((robot_location.x_mu - start_x) * line_y - (robot_location.y_mu - start_y) * line_x) /
+                         line_length;
+            cte = fmax(cte, fabs(off));
+        }
+    }
+
+    if (arrive < 0) {
+        run->missed++;
+        arrive = GRID_MAX_STEPS * TIME_STEP;
+    }
+    run->arrive_sum += arrive;
+    run->arrive_max = fmax(run->arrive_max, arrive);
+    run->settle_sum += settle;
+    run->settle_max = fmax(run->settle_max, settle);
+    run->cte_sum += cte;
+    run->cte_max = fmax(run->cte_max, cte);
+    run->spike_max = fmax(run->spike_max, spike);
+}
+
+/* movement_test's grid of start poses to the center of cell (1, 1) with controller */
+void printGridRun(const char* name, speed_controller_t controller) {
+    grid_run_t run = {};
+    gaussian_location_t goal;
+    goal.x_mu = cellNumberToCoordinateDistance(1);
+    goal.y_mu = cellNumberToCoordinateDistance(1);
+    double chunk_xy = (cellNumberToCoordinateDistance(2) - cellNumberToCoordinateDistance(0)) / GRID_POSES;
+    double chunk_theta = TWO_PI / GRID_POSES;
+
+    double start_ns = benchNowNs();
+    for (int x = 0; x < GRID_POSES; x++) {
+        for (int y = 0; y < GRID_POSES; y++) {
+            for (int theta = 0; theta < GRID_POSES; theta++) {
+                initializeLocalization();
+                robot_location.x_mu = cellNumberToCoordinateDistance(0) + chunk_xy * x;
+                robot_location.y_mu = cellNumberToCoordinateDistance(0) + chunk_xy * y;
+                robot_location.theta_mu = chunk_theta * theta;
+                simulateGridPose(controller, &goal, &run);
+            }
+        }
+    }
+    double poses = GRID_POSES * GRID_POSES * GRID_POSES;
+    double loop_ns = (benchNowNs() - start_ns) / (poses * GRID_MAX_STEPS);
+
+    printf("%-14s\t%5.2f\t%5.2f\t%5.2f\t%5.2f\t%6.1f\t%6.1f\t%6.1f\t%6d\t%6.0f\n", name,
+            run.arrive_sum / poses, run.arrive_max, run.settle_sum / poses, run.settle_max,
+            run.cte_sum / poses, run.cte_max, run.spike_max, run.missed, loop_ns);
+}
+
+/* Simulated times of the flood route of maze_string to goal, with one waypoint, streamed and with lookahead */
+void printLookaheadRun(const char* name, const char** maze_string, cell_t goal) {
+    static probabilistic_maze_t maze;
+    initializeMaze(&maze);
+    readInMaze(maze_string, &maze);
+
+    route_run_t single, streamed, lookahead;
+    simulateWaypoints(&maze, goal, calculateSpeed, &single);
+    simulateWaypoints(&maze, goal, calculateStreamedProgramSpeed, &streamed);
+    simulateWaypoints(&maze, goal, NULL, &lookahead);
+    printf("%-10s\t%7.2f\t%7.0f\t%7.2f\t%7.0f\t%7.2f\t%7.0f\t%6.1f%%\t%6.1f%%\n", name,
+            single.stop, single.loop_ns, streamed.stop, streamed.loop_ns, lookahead.stop, lookahead.loop_ns,
+            100.0 * (single.stop - lookahead.stop) / single.stop, 100.0 * (streamed.stop - lookahead.stop) / streamed.stop);
+}
+
+
+BENCH_FUNC_BEGIN {
+
+    initializeStrategy();
+    setMovementTick(TIME_STEP);
+
+    BENCH_SECTION("Straight segment from standing, old ramp on distance_away vs motion profile, simulated time (s) "
+                  "and peaks of the commanded speed");
+    printf("STABLE_SPEED %d mm/s, ramp SLOPE %d /s, profile ACCEL %d mm/s^2, JERK %d mm/s^3, control loop %.0f ms\n",
+            STRAIGHT_PROFILE_STABLE_SPEED, RAMP_PROFILE_SLOPE, STRAIGHT_PROFILE_ACCEL, STRAIGHT_PROFILE_JERK,
+            TIME_STEP * 1000);
+    printf("     \t   ramp\t\t\t\t   S-curve\t\t\t\t\t   trapezoid\n");
+    printf("cells\t   time\t   accel\t    jerk\t   time\tplanned\t   accel\t    jerk\tplanned\t  saved\n");
+    for (int cells = 1; cells <= 8; cells *= 2) {
+        printStraightSegment(cells);
+    }
+    printStraightSegment(15);
+
+    BENCH_SECTION("Speed run with and without diagonal segments, planned and simulated time (s)");
+    printf("diagonals clear the posts: %s (ROBOT_WIDTH %.1f mm, DIAGONAL_CLEARANCE_MM %.1f mm), SPEED_RUN_DIAGONALS %s\n",
+            diagonalsClearPosts() ? "yes" : "no", (double) ROBOT_WIDTH, (double) DIAGONAL_CLEARANCE_MM,
+            SPEED_RUN_DIAGONALS ? "on" : "off");
+    printf("          \t   orthogonal\t\t\t   diagonal\n");
+    printf("maze      \t segs\t planned\tsimulated\t segs\t planned\tsimulated\t  saved\n");
+    printDiagonalSpeedRun("empty", empty_string);
+    printDiagonalSpeedRun("spiral", spiral_string);
+    printDiagonalSpeedRun("loop", loop_string);
+    printDiagonalSpeedRun("actual", actual_string);
+    printDiagonalSpeedRun("staircase", staircase_string);
+
+    BENCH_SECTION("Flood route one cell at a time (strategy + calculateSpeed) vs streamed into a motion program "
+                  "(strategy + calculateStreamedSpeed), simulated time (s) to stop in the goal and CPU per control "
+                  "loop (ns)");
+    printf("          \t\t   cell by cell\t   streamed\t\t\t   compiled\n");
+    printf("maze      \tcells\t   stop\t   loop\t   stop\t   loop\t  saved\t   stop\n");
+    printMotionProgramRun("empty", empty_string);
+    printMotionProgramRun("spiral", spiral_string);
+    printMotionProgramRun("loop", loop_string);
+    printMotionProgramRun("actual", actual_string);
+    printMotionProgramRun("staircase", staircase_string);
+
+    BENCH_SECTION("calculateSpeed from the start pose grid of movement_test to cell (1, 1), "
+                  "simulated time (s), cross track error (mm) off the straight line there, largest step of a wheel "
+                  "speed (mm/s) and simulated loop (ns)");
+    printf("%d x %d x %d poses, %d control loops each\n", GRID_POSES, GRID_POSES, GRID_POSES, GRID_MAX_STEPS);
+    printf("              \t   arrive\t   settle\t   cross track\n");
+    printf("controller    \t mean\t  max\t mean\t  max\t  mean\t   max\t spike\tmissed\t  loop\n");
+    printGridRun("tracking", calculateSpeed);
+
+    BENCH_SECTION("Turns on the spot vs along search arcs vs along speed run arcs, simulated time (s) of a motion "
+                  "program");
+    printf("arcs at %.0f mm/s (search) and %.0f mm/s (large), ARC_LATERAL_ACCEL %d mm/s^2\n",
+            arcSpeed((CELL_LENGTH + WALL_THICKNESS) / 2.0), arcSpeed(CELL_LENGTH + WALL_THICKNESS), ARC_LATERAL_ACCEL);
+    printf("          \t   on the spot\t   search arcs\t\t\t   speed run arcs\n");
+    printf("route     \t cmds\t   stop\t cmds\t   stop\t  saved\t cmds\t   stop\t  saved\n");
+    cell_t corner[] = { { 0, 0 }, { 1, 0 }, { 2, 0 }, { 2, 1 }, { 2, 2 } };
+    cell_t u_turn[] = { { 0, 0 }, { 1, 0 }, { 2, 0 }, { 2, 1 }, { 1, 1 }, { 0, 1 } };
+    cell_t zigzag[] = { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 2, 1 }, { 2, 2 }, { 3, 2 }, { 3, 3 } };
+    printTurnStyleRun("corner", corner, 5);
+    printTurnStyleRun("u-turn", u_turn, 6);
+    printTurnStyleRun("zigzag", zigzag, 7);
+    printTurnStyleMazeRun("empty", empty_string);
+    printTurnStyleMazeRun("spiral", spiral_string);
+    printTurnStyleMazeRun("loop", loop_string);
+    printTurnStyleMazeRun("actual", actual_string);
+    printTurnStyleMazeRun("staircase", staircase_string);
+
+    BENCH_SECTION("One waypoint (strategy + calculateSpeed) vs streamed (strategy + calculateStreamedSpeed) vs "
+                  "LOOKAHEAD_CELLS waypoints (strategyLookahead + calculateLookaheadSpeed), simulated time (s) to stop "
+                  "in the goal and CPU per control loop (ns)");
+    printf("LOOKAHEAD_CELLS %d, stopping from STABLE_SPEED takes %.1f mm\n", LOOKAHEAD_CELLS,
+            stoppingDistance());
+    printf("          \t   one waypoint\t   streamed\t\t   lookahead\t\t   saved over\n");
+    printf("maze      \t   stop\t   loop\t   stop\t   loop\t   stop\t   loop\t    one\tstreamed\n");
+    cell_t straight_goal = { .x = INIT_CELL_X + 10, .y = INIT_CELL_Y };
+    cell_t goal = { .x = GOAL_CELL_X, .y = GOAL_CELL_Y };
+    printLookaheadRun("10 cells", empty_string, straight_goal);
+    printLookaheadRun("empty", empty_string, goal);
+    printLookaheadRun("spiral", spiral_string, goal);
+    printLookaheadRun("loop", loop_string, goal);
+    printLookaheadRun("actual", actual_string, goal);
+    printLookaheadRun("staircase", staircase_string, goal);
+
+} BENCH_FUNC_END("movement_benchmark")
+
+#endif // ARDUINO
@@ -15,6 +15,17 @@ using namespace std;
 #define TIME_STEP (double)(CONTROL_LOOP_TIME/1000000.0)  // in sec
 
 
+// Where the simulated robot is, moved exactly by the wheels whichever filter localization runs
+gaussian_location_t robot_pose;
+
+/* Move robot_pose by the distance each wheel travelled */
+void moveRobot(double left_distance, double right_distance) {
+    gaussian_location_t motion;
+    calculateMotion(&motion, left_distance, right_distance);
+    addMotion(&robot_pose, &motion, &robot_pose);
+}
+
+
 bool goTo(gaussian_location_t* final_loc, int max_steps, bool debug) {
     
     double left_speed;
@@ -34,21 +45,21 @@ bool goTo(gaussian_location_t* final_loc, int max_steps, bool debug) {
         
         printf("Start,");
         printf("\t%f,\t%f,", 0.0, 0.0);
-        printf("\t%f,\t%f,\t%f;\n", robot_location.x_mu, robot_location.y_mu, robot_location.theta_mu);
+        printf("\t%f,\t%f,\t%f;\n", robot_pose.x_mu, robot_pose.y_mu, robot_pose.theta_mu);
     }
 
     // While not at final location
     do {
 
-        calculateSpeed(&robot_location, final_loc, &left_speed, &right_speed);
+        calculateSpeed(&robot_pose, final_loc, &left_speed, &right_speed);
         left_q.push(left_speed); right_q.push(right_speed);
 
-        localizeMotionStep(TIME_STEP * left_q.front(), TIME_STEP * right_q.front());
+        moveRobot(TIME_STEP * left_q.front(), TIME_STEP * right_q.front());
 
         if (debug) {
             printf("%d,", steps);
             printf("\t%f,\t%f,", left_q.front(), right_q.front());
-            printf("\t%f,\t%f,\t%f;\n", robot_location.x_mu, robot_location.y_mu, robot_location.theta_mu);
+            printf("\t%f,\t%f,\t%f;\n", robot_pose.x_mu, robot_pose.y_mu, robot_pose.theta_mu);
         }
 
         left_q.pop(); right_q.pop();
@@ -59,24 +70,68 @@ bool goTo(gaussian_location_t* final_loc, int max_steps, bool debug) {
             break;
         }
     } while(true);
-    // } while (!IS_BETWEEN_ERROR(robot_location.x_mu, final_loc->x_mu, OUTER_TOLERANCE_MM) ||
-             //          !IS_BETWEEN_ERROR(robot_location.y_mu, final_loc->y_mu, OUTER_TOLERANCE_MM));
+    // } while (!IS_BETWEEN_ERROR(robot_pose.x_mu, final_loc->x_mu, OUTER_TOLERANCE_MM) ||
+             //          !IS_BETWEEN_ERROR(robot_pose.y_mu, final_loc->y_mu, OUTER_TOLERANCE_MM));
 
     // if not at goal
-    if ( !IS_BETWEEN_ERROR(robot_location.x_mu, final_loc->x_mu, OUTER_TOLERANCE_MM) ||
-         !IS_BETWEEN_ERROR(robot_location.y_mu, final_loc->y_mu, OUTER_TOLERANCE_MM) )
+    if ( !IS_BETWEEN_ERROR(robot_pose.x_mu, final_loc->x_mu, OUTER_TOLERANCE_MM) ||
+         !IS_BETWEEN_ERROR(robot_pose.y_mu, final_loc->y_mu, OUTER_TOLERANCE_MM) )
             return false;
     
     return true;
 }
 
+/* Drive one segment with calculateSegmentSpeed, true if it ends within OUTER_TOLERANCE_MM of final_loc */
+bool goAlong(gaussian_location_t* final_loc, Direction dir, int max_steps) {
+
+    double left_speed;
+    double right_speed;
+
+    for (int steps = 0; steps < max_steps; steps++) {
+        if (calculateSegmentSpeed(&robot_pose, final_loc, dir, &left_speed, &right_speed)) {
+            double x_error = robot_pose.x_mu - final_loc->x_mu;
+            double y_error = robot_pose.y_mu - final_loc->y_mu;
+            return sqrt(x_error * x_error + y_error * y_error) < OUTER_TOLERANCE_MM;
+        }
+        moveRobot(TIME_STEP * left_speed, TIME_STEP * right_speed);
+    }
+    return false;
+}
+
+/* Run program from the center of its start cell, true if it ends within OUTER_TOLERANCE_MM of its end cell
+ * - slowest, if not NULL, is set to the slowest the robot drove forward before the end */
+bool runProgram(motion_program_t* program, int max_steps, double* slowest) {
+
+    double left_speed;
+    double right_speed;
+
+    robot_pose.x_mu = cellNumberToCoordinateDistance(program->start.x);
+    robot_pose.y_mu = cellNumberToCoordinateDistance(program->start.y);
+    robot_pose.theta_mu = directionToRAD[program->start_heading];
+    startMotionProgram(program);
+
+    for (int steps = 0; steps < max_steps; steps++) {
+        if (calculateProgramSpeed(&robot_pose, program, &left_speed, &right_speed)) {
+            double x_error = robot_pose.x_mu - cellNumberToCoordinateDistance(program->end.x);
+            double y_error = robot_pose.y_mu - cellNumberToCoordinateDistance(program->end.y);
+            return sqrt(x_error * x_error + y_error * y_error) < OUTER_TOLERANCE_MM;
+        }
+        if (slowest != NULL && (steps == 0 || (left_speed + right_speed) / 2 < *slowest)) {
+            *slowest = (left_speed + right_speed) / 2;
+        }
+        moveRobot(TIME_STEP * left_speed, TIME_STEP * right_speed);
+    }
+    return false;
+}
+
 
 TEST_FUNC_BEGIN {
 
-    // gaussian_location_t robot_location; // Use localization's robot_location instead
     gaussian_location_t final_loc;
 
     initializeLocalization();
+    robot_pose = robot_location;
+    setMovementTick(TIME_STEP);
 
     int max_steps;
 
@@ -86,9 +141,9 @@ TEST_FUNC_BEGIN {
     max_steps = 100;
 
     // Initial location
-    robot_location.x_mu = 100;
-    robot_location.y_mu = 100;
-    robot_location.theta_mu = directionToRAD[East];
+    robot_pose.x_mu = 100;
+    robot_pose.y_mu = 100;
+    robot_pose.theta_mu = directionToRAD[East];
 
     // Final location
     final_loc.x_mu = 100;
@@ -106,9 +161,9 @@ TEST_FUNC_BEGIN {
     max_steps = 200;
 
     // Initial location
-    robot_location.x_mu = cellNumberToCoordinateDistance(0);
-    robot_location.y_mu = cellNumberToCoordinateDistance(0);
-    robot_location.theta_mu = directionToRAD[East];
+    robot_pose.x_mu = cellNumberToCoordinateDistance(0);
+    robot_pose.y_mu = cellNumberToCoordinateDistance(0);
+    robot_pose.theta_mu = directionToRAD[East];
 
     // Final location
     final_loc.x_mu = cellNumberToCoordinateDistance(1);
@@ -126,9 +181,9 @@ TEST_FUNC_BEGIN {
     max_steps = 2500;
 
     // Initial location
-    robot_location.x_mu = cellNumberToCoordinateDistance(0);
-    robot_location.y_mu = cellNumberToCoordinateDistance(0) + 5;
-    robot_location.theta_mu = directionToRAD[East];
+    robot_pose.x_mu = cellNumberToCoordinateDistance(0);
+    robot_pose.y_mu = cellNumberToCoordinateDistance(0) + 5;
+    robot_pose.theta_mu = directionToRAD[East];
 
     // Final location
     final_loc.x_mu = cellNumberToCoordinateDistance(10);
@@ -146,9 +201,9 @@ TEST_FUNC_BEGIN {
     max_steps = 1000;
 
     // Initial location
-    robot_location.x_mu = cellNumberToCoordinateDistance(0);
-    robot_location.y_mu = cellNumberToCoordinateDistance(0);
-    robot_location.theta_mu = directionToRAD[South];
+    robot_pose.x_mu = cellNumberToCoordinateDistance(0);
+    robot_pose.y_mu = cellNumberToCoordinateDistance(0);
+    robot_pose.theta_mu = directionToRAD[South];
     
     // Final location
     final_loc.x_mu = cellNumberToCoordinateDistance(1);
@@ -177,14 +232,14 @@ TEST_FUNC_BEGIN {
             for (int theta = 0; theta < MOV_NUM_TESTS; theta++) {
 
                 // Setup test
-                robot_location.x_mu = cellNumberToCoordinateDistance(0) + chunk_xy * x;
-                robot_location.y_mu = cellNumberToCoordinateDistance(0) + chunk_xy * y;
-                robot_location.theta_mu = chunk_theta * theta;
+                robot_pose.x_mu = cellNumberToCoordinateDistance(0) + chunk_xy * x;
+                robot_pose.y_mu = cellNumberToCoordinateDistance(0) + chunk_xy * y;
+                robot_pose.theta_mu = chunk_theta * theta;
                 
                 if (!goTo(&final_loc, max_steps, false)) {
                     TEST_FAIL("Test other positions");
                     // printf("x: %d, y: %d, theta; %d\n", x, y, theta);
-                    // printf("robot_location: (%f , %f, %f)\n", robot_location.x_mu, robot_location.y_mu, robot_location.theta_mu);
+                    // printf("robot_pose: (%f , %f, %f)\n", robot_pose.x_mu, robot_pose.y_mu, robot_pose.theta_mu);
                     goto after_other_test;
                 }
             }
@@ -194,6 +249,190 @@ TEST_FUNC_BEGIN {
     TEST_PASS("Test other positions");
     after_other_test: ;
 
+
+/* Test diagonal segments, from the middle of a wall along each diagonal, starting off by a bit */
+
+    max_steps = 2000;
+
+    for (int dir = NorthEast; dir <= NorthWest; dir++) {
+
+        // Start in the middle of the east wall of cell (7, 7), facing East
+        robot_pose.x_mu = latticeNumberToCoordinateDistance(16);
+        robot_pose.y_mu = latticeNumberToCoordinateDistance(15) + 3;
+        robot_pose.theta_mu = directionToRAD[East];
+
+        // Three diagonal steps of the half cell lattice away
+        final_loc.x_mu = latticeNumberToCoordinateDistance(16 + 3 * (int) directionToXY[dir][0]);
+        final_loc.y_mu = latticeNumberToCoordinateDistance(15 + 3 * (int) directionToXY[dir][1]);
+
+        if (!goAlong(&final_loc, (Direction) dir, max_steps)) {
+            TEST_FAIL("Test diagonal segments");
+            goto after_diagonal_test;
+        }
+    }
+
+    TEST_PASS("Test diagonal segments");
+    after_diagonal_test: ;
+
+
+/* Test lookahead, the robot drives through the waypoints without slowing down before the turn and stops at the last */
+    {
+        static motion_program_t program;
+        static waypoints_t waypoints;
+        waypoints.front = LOOKAHEAD_CELLS - 2;      // Wrap around the ring
+        waypoints.count = 0;
+        waypoints.from = (cell_t) { .x = 0, .y = 0 };
+        for (int x = 1; x <= 4; x++) {
+            waypoints.cells[(waypoints.front + waypoints.count++) % LOOKAHEAD_CELLS] = (cell_t) { .x = x, .y = 0 };
+        }
+        waypoints.cells[(waypoints.front + waypoints.count++) % LOOKAHEAD_CELLS] = (cell_t) { .x = 4, .y = 1 };
+
+        robot_pose.x_mu = cellNumberToCoordinateDistance(0);
+        robot_pose.y_mu = cellNumberToCoordinateDistance(0);
+        robot_pose.theta_mu = directionToRAD[East];
+        initializeMovement(&robot_pose);
+        startStreamedProgram(&program, &robot_pose);
+
+        double left_speed, right_speed, slowest = STRAIGHT_PROFILE_STABLE_SPEED;
+        bool done = false;
+        for (int steps = 0; steps < 2000 && !done; steps++) {
+            done = calculateLookaheadSpeed(&robot_pose, &waypoints, &program, &left_speed, &right_speed);
+            if (steps > 0 && coordinateDistanceToCellNumber(robot_pose.y_mu) == 0) {
+                slowest = min(slowest, (left_speed + right_speed) / 2);
+            }
+            moveRobot(TIME_STEP * left_speed, TIME_STEP * right_speed);
+        }
+
+        if (!done || slowest <= 0 ||
+                !IS_BETWEEN_ERROR(robot_pose.x_mu, cellNumberToCoordinateDistance(4), OUTER_TOLERANCE_MM) ||
+                !IS_BETWEEN_ERROR(robot_pose.y_mu, cellNumberToCoordinateDistance(1), OUTER_TOLERANCE_MM))
+            TEST_FAIL("Test lookahead");
+        else
+            TEST_PASS("Test lookahead");
+    }
+
+
+/* Test lookahead when the route changes, the straight is cut back to the cell after the robot's */
+    {
+        static motion_program_t program;
+        static waypoints_t waypoints;
+        waypoints.front = 0;
+        waypoints.count = 0;
+        waypoints.from = (cell_t) { .x = 0, .y = 0 };
+        for (int x = 1; x <= 6; x++) {
+            waypoints.cells[waypoints.count++] = (cell_t) { .x = x, .y = 0 };
+        }
+
+        robot_pose.x_mu = cellNumberToCoordinateDistance(0);
+        robot_pose.y_mu = cellNumberToCoordinateDistance(0);
+        robot_pose.theta_mu = directionToRAD[East];
+        initializeMovement(&robot_pose);
+        startStreamedProgram(&program, &robot_pose);
+
+        double left_speed, right_speed;
+        bool done = false;
+        for (int steps = 0; steps < 2000 && !done; steps++) {
+            if (waypoints.from.x == 0 && coordinateDistanceToCellNumber(robot_pose.x_mu) == 2) {
+                // A wall turns the route South from (2, 0), which the robot is past the middle of
+                waypoints.count = 0;
+                waypoints.from = (cell_t) { .x = 2, .y = 0 };
+                waypoints.cells[waypoints.count++] = (cell_t) { .x = 2, .y = 1 };
+            }
+            done = calculateLookaheadSpeed(&robot_pose, &waypoints, &program, &left_speed, &right_speed);
+            moveRobot(TIME_STEP * left_speed, TIME_STEP * right_speed);
+        }
+
+        if (!done || program.start.x != 3 || program.start.y != 0 ||
+                !IS_BETWEEN_ERROR(robot_pose.x_mu, cellNumberToCoordinateDistance(3), OUTER_TOLERANCE_MM) ||
+                !IS_BETWEEN_ERROR(robot_pose.y_mu, cellNumberToCoordinateDistance(0), OUTER_TOLERANCE_MM))
+            TEST_FAIL("Test lookahead route change");
+        else
+            TEST_PASS("Test lookahead route change");
+    }
+
+
+/* Test a motion program with every kind of turn */
+    {
+        static motion_program_t program;
+        cell_t start = { .x = 0, .y = 0 };
+        cell_t path[] = { { 0, 0 }, { 1, 0 }, { 2, 0 }, { 2, 1 }, { 1, 1 }, { 0, 1 }, { 0, 2 }, { 0, 1 } };
+
+        initializeMotionProgram(&program, start, East);
+        compilePath(&program, path, 8);
+
+        if (!runProgram(&program, 10000, NULL) || program.next_command != program.num_commands)
+            TEST_FAIL("Test motion program");
+        else
+            TEST_PASS("Test motion program");
+    }
+
+
+/* Test a program of arcs, from standing to standing without stopping on the way */
+    {
+        static motion_program_t program;
+        cell_t start = { .x = 0, .y = 0 };
+        cell_t path[] = { { 0, 0 }, { 1, 0 }, { 2, 0 }, { 3, 0 }, { 3, 1 }, { 2, 1 }, { 1, 1 }, { 1, 2 }, { 1, 3 },
+                          { 2, 3 }, { 2, 2 } };
+        TurnStyle styles[] = { TURN_SEARCH_ARCS, TURN_SPEED_RUN_ARCS };
+
+        for (int s = 0; s < 2; s++) {
+            initializeMotionProgram(&program, start, East);
+            program.turn_style = styles[s];
+            compilePath(&program, path, 11);
+
+            double slowest;
+            if (!runProgram(&program, 10000, &slowest) || program.next_command != program.num_commands ||
+                    slowest <= 0) {
+                TEST_FAIL("Test motion program with arcs");
+                goto after_arc_program_test;
+            }
+        }
+    }
+
+    TEST_PASS("Test motion program with arcs");
+    after_arc_program_test: ;
+
+
+/* Test streaming cells into a program the way strategy hands them out, the cell after the robot's */
+    {
+        static motion_program_t program;
+        cell_t path[] = { { 0, 0 }, { 1, 0 }, { 2, 0 }, { 3, 0 }, { 3, 1 }, { 2, 1 }, { 1, 1 }, { 1, 2 }, { 1, 3 },
+                          { 2, 3 }, { 2, 2 } };
+
+        robot_pose.x_mu = cellNumberToCoordinateDistance(0);
+        robot_pose.y_mu = cellNumberToCoordinateDistance(0);
+        robot_pose.theta_mu = directionToRAD[East];
+        initializeMovement(&robot_pose);
+        startStreamedProgram(&program, &robot_pose);
+
+        double left_speed, right_speed, slowest = STRAIGHT_PROFILE_STABLE_SPEED;
+        int reached = 0;
+        bool done = false;
+        for (int steps = 0; steps < 10000 && !done; steps++) {
+            cell_t robot_cell = { .x = coordinateDistanceToCellNumber(robot_pose.x_mu),
+                                  .y = coordinateDistanceToCellNumber(robot_pose.y_mu) };
+            if (reached + 1 < 11 && robot_cell.x == path[reached + 1].x && robot_cell.y == path[reached + 1].y) {
+                reached++;
+            }
+            gaussian_location_t next_location;
+            next_location.x_mu = cellNumberToCoordinateDistance(path[min(reached + 1, 10)].x);
+            next_location.y_mu = cellNumberToCoordinateDistance(path[min(reached + 1, 10)].y);
+
+            done = calculateStreamedSpeed(&robot_pose, &next_location, &program, &left_speed, &right_speed);
+            if (steps > 0 && reached < 10) {
+                slowest = min(slowest, (left_speed + right_speed) / 2);
+            }
+            moveRobot(TIME_STEP * left_speed, TIME_STEP * right_speed);
+        }
+
+        if (!done || slowest <= 0 || program.num_commands != 0 || program.start.x != 2 || program.start.y != 2 ||
+                !IS_BETWEEN_ERROR(robot_pose.x_mu, cellNumberToCoordinateDistance(2), OUTER_TOLERANCE_MM) ||
+                !IS_BETWEEN_ERROR(robot_pose.y_mu, cellNumberToCoordinateDistance(2), OUTER_TOLERANCE_MM))
+            TEST_FAIL("Test streamed motion program");
+        else
+            TEST_PASS("Test streamed motion program");
+    }
+
 } TEST_FUNC_END("strategy_test")
 
 #endif // ARDUINO
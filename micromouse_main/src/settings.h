@@ -10,6 +10,7 @@
 //#define DEBUG_TIMER
 //#define DEBUG_SENSORS
 //#define DEBUG_ENCODERS
+//#define DEBUG_MOTORS     // Log for control/identify_motors
 //#define DEBUG_LOCALIZE_MOTION
 //#define DEBUG_LOCALIZE_MAPPING
 //#define DEBUG_LOCALIZE_MEASURE
@@ -18,6 +19,7 @@
 
 // General
 #define SETUP_TIME 2000     // Milliseconds to wait befor starting to run
+#define TRIG_LOOKUP_TABLE   // Use the interpolated sine table in util/trig.h instead of libm, comment out to use libm
 
 // Maze Specifications
 #define MAZE_SIZE       16          // If square, the length each side of the maze
@@ -33,8 +35,15 @@
 #define SENSOR_X_OFFSET         32.5        // Distance from center of robot to side sensors on local x axis
 #define SENSOR_Y_OFFSET         35.0        // Distance from center of robot to side sensors on local y axis
 #define SENSOR_FRONT_OFFSET     46.0        // Distance from center of robot to front sensor along x axis
+#define ROBOT_WIDTH             100.0       // Width of the robot body in mm, dummy value, measure it before turning on SPEED_RUN_DIAGONALS
 
 // Localization
+#define LOCATION_TYPE       double  // Numeric type of location_t: double or float (see util/numeric_policy.h)
+
+#define EKF_FILTER          0
+#define PARTICLE_FILTER     1
+#define LOCALIZATION_FILTER EKF_FILTER  // Filter that tracks robot_location: EKF_FILTER or PARTICLE_FILTER
+
 #define INIT_X_MU           84.0
 #define INIT_X_SIGMA        20.0
 #define INIT_XY_SIGMA       0
@@ -46,43 +55,57 @@
 #define ENCODER_VARIANCE_BASE   2.0
 #define ENCODER_VARIANCE_PER_MM 0.2
 
-#define X_VARIANCE      1   //dummy value
-#define Y_VARIANCE      1   //dummy value
-#define THETA_VARIANCE  1   //dummy value
+#define X_VARIANCE      1       // Scale of the encoder variance along x
+#define Y_VARIANCE      1       // Scale of the encoder variance along y
+#define THETA_VARIANCE  0.00001 // Scale of the encoder variance in theta (mm^2 to rad^2)
+
+#define RANGE_SENSOR_VARIANCE   4.0     // Variance of a distance sensor reading (in mm^2)
+#define EKF_GATE                9.0     // Squared number of standard deviations at which a sensor reading is rejected
+
+#define NUM_PARTICLES                   64      // Size of the particle pool with PARTICLE_FILTER
+#define PARTICLE_SEED                   1       // Seed of the particles' random numbers, not 0
+#define PARTICLE_RANGE_VARIANCE         25.0    // Variance of a distance sensor reading seen by a particle (in mm^2)
+#define PARTICLE_MISS_LOG_LIKELIHOOD    -4.5    // Log likelihood of a reading with no known wall near it
+#define PARTICLE_RESAMPLE_RATIO         0.5     // Resample when the effective number of particles drops below this part of the pool
 
 #define TOO_FAR_DISTANCE    250     // the distance that of walls that we update given a TOO_FAR measurement (in mm)
 #define TOO_CLOSE_DISTANCE  10      // the distance that of walls that we update given a TOO_CLOSE measurement (in mm)
 
 #define WALL_HIT_THRESHOLD  40.0    // The plus or minus amount for a measurement that should result in the increase of a walls exists
-#define WALL_UPDATE_AMOUNT  0.05    // The amount to increase or decrease a wall's probability of existing
-#define WALL_UPDATE         0.9     // The amount to multiply by to increase or decrease a wall's probability of existing
+#define WALL_LOG_ODDS_UPDATE 3      // The amount to add to or subtract from a wall's log odds of existing (1/16 nats, see probabilistic_maze.h)
 #define WALL_HIT_AREA_WIDTH 0.9     // the central percentage of area that counts if hit
-
-#define SENSOR_LOCATION_WEIGHT 0.3  // The higher this value, the more we trust our sensor's input
+#define MAPPING_MIN_TURN_RADIUS 45.0    // Map off the axes only while driving along a curve at least this wide (in mm), not turning on the spot
 
 // Strategy
 #define INIT_CELL_X     0       // Initial Cell x coordinate
 #define INIT_CELL_Y     0       // Initial Cell y coordinate
-#define GOAL_CELL_X     7       // Goal cell x coordinate
-#define GOAL_CELL_Y     7       // Goal cell y coordinate
+#define GOAL_CELL_X     7       // Goal cell x coordinate, the top left of the goal square
+#define GOAL_CELL_Y     7       // Goal cell y coordinate, the top left of the goal square
+#define GOAL_SIZE       2       // The goal is the GOAL_SIZE x GOAL_SIZE square of cells from the goal cell
 #define WALL_THRESHOLD  0.75    // Probability that we believe that a wall actually exists
 #define MAX_VALUE       999     // Maximum value that can be in values
+#define DIAGONAL_CLEARANCE_MM 3.0   // Room to leave between the robot and the wall posts on a diagonal, in mm
+#define SPEED_RUN_DIAGONALS false   // Plan speed runs with diagonal segments, off while ROBOT_WIDTH is a dummy as diagonalsClearPosts is only as good as it
+#define EXPLORATION_LOOKS 40    // Calls of strategyExplore in its target after which exploration takes the walls there as known
+#define LOOKAHEAD_CELLS 8       // Number of cells ahead strategyLookahead keeps in its waypoints
 
 // Movement
-#define MOVEMENT_LOOP_TIME 50000    // Delay between the start of each movement_loop call in milliseconds
+#define MOVEMENT_LOOP_TIME 50000    // Delay between the start of each movement_loop call in microseconds
 
 #define INNER_TOLERANCE_MM    10            //dummy value (in mm)
 #define INNER_TOLERANCE_RAD   radians(3)    //dummy value (in radians)
 #define OUTER_TOLERANCE_MM    40            //dummy value (in mm)
 #define OUTER_TOLERANCE_RAD   radians(15)   //dummy value (in radians)
 
-#define STRAIGHT_TAU_P      2.0
-#define STRAIGHT_TAU_I      0.001
-#define STRAIGHT_TAU_D      1.5
-#define STRAIGHT_TAU_THETA  20.0
 #define STRAIGHT_PROFILE_STABLE_SPEED  75   // Straightline speed
-#define STRAIGHT_PROFILE_SLOPE         3    // dummy value
-#define STRAIGHT_PROFILE_INTERCEPT     0    // dummy value
+#define STRAIGHT_PROFILE_ACCEL         500  // Straightline acceleration limit in mm/s^2
+#define STRAIGHT_PROFILE_JERK          5000 // Straightline jerk limit in mm/s^3, 0 for none
+
+#define ARC_LATERAL_ACCEL   1000    // Sideways acceleration limit on an arc in mm/s^2
+
+#define TRACKING_K_X        4.0     // Speed added per mm the reference is ahead, in 1/s
+#define TRACKING_K_Y        0.0007  // Turn rate per mm the reference is to the side and mm/s of its speed, in 1/mm^2
+#define TRACKING_K_THETA    4.0     // Turn rate per radian off the reference heading, in 1/s
 
 #define TURN_TAU_P      0                   // unused
 #define TURN_TAU_I      0                   // unused
@@ -96,6 +119,8 @@
 #define MOTOR_TAU_P         0.015   // Proportional Gain
 #define MOTOR_TAU_I         0.001   // Integral Gain
 #define INT_BOUND           500     // Integral Bound
+#define MOTOR_FEEDFORWARD   false   // Add the output control/motor_model.h needs for the set speed and acceleration, true once identify_motors has written the model of these motors
+#include "motor_model_constants.h"  // The model of each wheel, written by control/identify_motors
 #define MAX_SPEED           250     // Maximum possible speed
 #define MIN_SPEED           50      // Minimum possible speed
 
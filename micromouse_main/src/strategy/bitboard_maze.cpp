@@ -0,0 +1,102 @@
+/* bitboard_maze.cpp */
+
+
+#include "bitboard_maze.h"
+#include "../settings.h"
+
+
+/* Threshold every wall of maze_state into bitboard */
+void buildBitboardMaze(probabilistic_maze_t* maze_state, bitboard_maze_t* bitboard) {
+    for (int y = 0; y < MAZE_HEIGHT; y++) {
+        bitboard_row_t east = 0;
+        bitboard_row_t south = 0;
+        for (int x = 0; x < MAZE_WIDTH; x++) {
+            // The border walls are never open, even if the maze says so
+            if (x < MAZE_WIDTH - 1 && !wallExists(mazeWall(maze_state, x, y, East))) {
+                east |= (bitboard_row_t) 1 << x;
+            }
+            if (y < MAZE_HEIGHT - 1 && !wallExists(mazeWall(maze_state, x, y, South))) {
+                south |= (bitboard_row_t) 1 << x;
+            }
+        }
+        bitboard->open_east[y] = east;
+        bitboard->open_south[y] = south;
+    }
+}
+
+/* Set to_values of every cell in row y of bits to value */
+static inline void setRowValues(int to_values[MAZE_WIDTH][MAZE_HEIGHT], int y, unsigned int bits, int value) {
+    while (bits) {
+        to_values[__builtin_ctz(bits)][y] = value;
+        bits &= bits - 1;
+    }
+}
+
+/* bitboard floodfill
+ * Sets values to the number of steps from cell plus value, the same values as floodfill()
+ *  - Each layer is found from the last with shifts and masks, only the rows next to the
+ *    last layer are visited
+ *  - Every cell is written once, there is no reset of values */
+void bitboardFloodfill(bitboard_maze_t* bitboard, cell_t cell, int value) {
+    bitboardFloodfillCells(bitboard, &cell, 1, value, values);
+}
+
+void bitboardFloodfillCells(bitboard_maze_t* bitboard, const cell_t* cells, int num_cells, int value,
+                            int to_values[MAZE_WIDTH][MAZE_HEIGHT]) {
+
+    bitboard_row_t visited[MAZE_HEIGHT] = { 0 };
+    bitboard_row_t frontier[MAZE_HEIGHT] = { 0 };
+
+    // Every cell starts in the first layer
+    int first_row = MAZE_HEIGHT;
+    int last_row = -1;
+    for (int i = 0; i < num_cells; i++) {
+        frontier[cells[i].y] |= (bitboard_row_t) 1 << cells[i].x;
+        visited[cells[i].y] = frontier[cells[i].y];
+        if (cells[i].y < first_row) first_row = cells[i].y;
+        if (cells[i].y > last_row) last_row = cells[i].y;
+    }
+
+    while (first_row <= last_row) {
+
+        for (int y = first_row; y <= last_row; y++) {
+            setRowValues(to_values, y, frontier[y], value);
+        }
+        value++;
+
+        // Rows the next layer can reach, one more on each side
+        int from = first_row > 0 ? first_row - 1 : 0;
+        int to = last_row < MAZE_HEIGHT - 1 ? last_row + 1 : MAZE_HEIGHT - 1;
+
+        bitboard_row_t next[MAZE_HEIGHT];
+        for (int y = from; y <= to; y++) {
+            bitboard_row_t row = frontier[y];
+            bitboard_row_t reach = ((row & bitboard->open_east[y]) << 1) |     // East
+                                   ((row >> 1) & bitboard->open_east[y]);      // West
+            if (y > 0) {
+                reach |= frontier[y - 1] & bitboard->open_south[y - 1];       // South from the row above
+            }
+            if (y < MAZE_HEIGHT - 1) {
+                reach |= frontier[y + 1] & bitboard->open_south[y];           // North from the row below
+            }
+            next[y] = reach & ~visited[y];
+        }
+
+        // The last layer is all inside from..to, so this replaces it
+        first_row = MAZE_HEIGHT;
+        last_row = -1;
+        for (int y = from; y <= to; y++) {
+            frontier[y] = next[y];
+            visited[y] |= next[y];
+            if (next[y]) {
+                if (y < first_row) first_row = y;
+                last_row = y;
+            }
+        }
+    }
+
+    // Everything not reached
+    for (int y = 0; y < MAZE_HEIGHT; y++) {
+        setRowValues(to_values, y, (bitboard_row_t) ~visited[y] & (bitboard_row_t) ((1UL << MAZE_WIDTH) - 1), MAX_VALUE);
+    }
+}
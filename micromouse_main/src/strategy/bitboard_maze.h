@@ -0,0 +1,58 @@
+/* bitboard_maze.h
+ *
+ * The thresholded maze as bitboards: one bit per cell, one word per
+ * row of cells, bit x of row y is cell [x,y]. A wall is open when
+ * wallExists() is false for it.
+ *
+ *      open_east[y]:   bit x set if [x,y] and [x+1,y] are connected
+ *      open_south[y]:  bit x set if [x,y] and [x,y+1] are connected
+ *
+ * The border is never open, so shifting a row never carries a bit out
+ * of the maze. bitboardFloodfill() moves a whole BFS layer at a time
+ * with shifts and masks instead of popping one cell at a time.
+ */
+
+#ifndef _BITBOARD_MAZE_H_
+#define _BITBOARD_MAZE_H_
+
+#include <stdint.h>
+
+#include "strategy.h"
+#include "../settings.h"
+#include "../localization/probabilistic_maze.h"
+
+
+typedef uint16_t bitboard_row_t;
+
+static_assert(MAZE_WIDTH <= 16, "bitboard_row_t holds one bit per cell of a row");
+
+typedef struct {
+    bitboard_row_t open_east[MAZE_HEIGHT];
+    bitboard_row_t open_south[MAZE_HEIGHT];
+} bitboard_maze_t;
+
+
+/* Threshold every wall of maze_state into bitboard */
+void buildBitboardMaze(probabilistic_maze_t* maze_state, bitboard_maze_t* bitboard);
+
+/* bitboard floodfill
+ * Sets values to the number of steps from cell plus value, the same values as floodfill()
+ *  - Cells that can not be reached are MAX_VALUE */
+void bitboardFloodfill(bitboard_maze_t* bitboard, cell_t cell, int value);
+
+/* bitboardFloodfill from every one of cells at once, into to_values instead of values */
+void bitboardFloodfillCells(bitboard_maze_t* bitboard, const cell_t* cells, int num_cells, int value,
+                            int to_values[MAZE_WIDTH][MAZE_HEIGHT]);
+
+/* Is the dir side of cell open in bitboard */
+inline bool bitboardOpen(const bitboard_maze_t* bitboard, cell_t cell, Direction dir) {
+    switch (dir) {
+        case North: return cell.y > 0 && (bitboard->open_south[cell.y - 1] >> cell.x & 1);
+        case East:  return bitboard->open_east[cell.y] >> cell.x & 1;
+        case South: return bitboard->open_south[cell.y] >> cell.x & 1;
+        default:    return cell.x > 0 && (bitboard->open_east[cell.y] >> (cell.x - 1) & 1);
+    }
+}
+
+
+#endif //_BITBOARD_MAZE_H_
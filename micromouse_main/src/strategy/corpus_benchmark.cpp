@@ -0,0 +1,137 @@
+#ifndef ARDUINO
+/* corpus_benchmark
+ * Explore and speed run every maze of a corpus with strategy(), on 1, 2, 4, ... threads up to every core
+ *
+ *   ./corpus_benchmark [corpus] [threads]
+ *
+ * Without a corpus CORPUS_MAZES generated mazes are used, see maze_generator.h.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "corpus_runner.h"
+#include "maze_file.h"
+#include "maze_generator.h"
+#include "../benchmark.h"
+#include "../settings.h"
+
+
+#define CORPUS_MAZES 20000          // Generated mazes when no corpus is given
+#define CORPUS_LOOP_PERCENT 10      // Loops in the generated mazes, see generateMaze
+
+
+/* The p-th percentile of sorted, 0 <= p <= 100 */
+template <typename T>
+T percentile(const std::vector<T>& sorted, double p) {
+    return sorted[(size_t) (p / 100.0 * (sorted.size() - 1) + 0.5)];
+}
+
+/* One line of min, percentiles, max and mean of a field of every solved run */
+void printRunDistribution(const char* name, const maze_run_t* runs, int num_runs, int maze_run_t::* field) {
+    std::vector<int> sorted;
+    double sum = 0.0;
+    for (int m = 0; m < num_runs; m++) {
+        if (runs[m].solved) {
+            sorted.push_back(runs[m].*field);
+            sum += runs[m].*field;
+        }
+    }
+    if (sorted.empty()) {
+        printf("%-16s\tno mazes solved\n", name);
+        return;
+    }
+    std::sort(sorted.begin(), sorted.end());
+    printf("%-16s\t%6d\t%6d\t%6d\t%6d\t%6d\t%6d\t%8.1f\n", name, sorted.front(), percentile(sorted, 10),
+            percentile(sorted, 50), percentile(sorted, 90), percentile(sorted, 99), sorted.back(),
+            sum / sorted.size());
+}
+
+/* One line of percentiles of the decision times of a run */
+void printLatency(int threads, const latency_histogram_t* latency) {
+    printf("%7d\t%10.0f\t%8.0f\t%8.0f\t%8.0f\t%8.0f\t%8.0f\n", threads, latency->sum_ns / latency->total,
+            latencyPercentile(latency, 50), latencyPercentile(latency, 90), latencyPercentile(latency, 99),
+            latencyPercentile(latency, 99.9), latency->max_ns);
+}
+
+
+int main(int argc, char** argv) {
+    int max_threads = argc > 2 ? atoi(argv[2]) : (int) std::thread::hardware_concurrency();
+    if (max_threads < 1) {
+        max_threads = 1;
+    }
+
+    maze_corpus_t corpus;
+    if (argc > 1) {
+        if (!openMazeCorpus(argv[1], &corpus)) {
+            fprintf(stderr, "could not map %s as a %dx%d corpus\n", argv[1], MAZE_WIDTH, MAZE_HEIGHT);
+            return 1;
+        }
+        printf("%d mazes from %s\n", corpus.num_mazes, argv[1]);
+    } else {
+        char path[] = "/tmp/corpus_benchmark_XXXXXX";
+        close(mkstemp(path));
+        bool opened = writeMazeCorpus(path, 2024, CORPUS_MAZES, CORPUS_LOOP_PERCENT) && openMazeCorpus(path, &corpus);
+        unlink(path);   // The mapping keeps it until it is closed
+        if (!opened) {
+            fprintf(stderr, "could not write a corpus to %s\n", path);
+            return 1;
+        }
+        printf("%d generated %dx%d mazes, %d%% loops\n", corpus.num_mazes, MAZE_WIDTH, MAZE_HEIGHT,
+                CORPUS_LOOP_PERCENT);
+    }
+
+    std::vector<maze_run_t> runs(corpus.num_mazes);
+    static latency_histogram_t latency;
+    corpus_run_t result;
+
+    BENCH_SECTION("Throughput, without timing decisions");
+    printf("threads\tseconds\t    mazes/s\tspeedup\tsteals\n");
+    double one_thread_seconds = 0.0;
+    for (int threads = 1; ; threads = threads * 2 < max_threads ? threads * 2 : max_threads) {
+        runCorpus(&corpus, threads, runs.data(), NULL, &result);
+        if (threads == 1) {
+            one_thread_seconds = result.seconds;
+        }
+        printf("%7d\t%7.3f\t%11.0f\t%7.2f\t%6d\n", threads, result.seconds, corpus.num_mazes / result.seconds,
+                one_thread_seconds / result.seconds, result.steals);
+        if (threads == max_threads) {
+            break;
+        }
+    }
+
+    BENCH_SECTION("Per maze, steps are cells moved, a turn is any change of heading");
+    int solved = 0;
+    for (int m = 0; m < corpus.num_mazes; m++) {
+        solved += runs[m].solved;
+    }
+    printf("%d of %d mazes solved\n", solved, corpus.num_mazes);
+    printf("                \t   min\t   p10\t   p50\t   p90\t   p99\t   max\t    mean\n");
+    printRunDistribution("explore steps", runs.data(), corpus.num_mazes, &maze_run_t::explore_steps);
+    printRunDistribution("explore turns", runs.data(), corpus.num_mazes, &maze_run_t::explore_turns);
+    printRunDistribution("speed run steps", runs.data(), corpus.num_mazes, &maze_run_t::speed_run_steps);
+    printRunDistribution("speed run turns", runs.data(), corpus.num_mazes, &maze_run_t::speed_run_turns);
+    printRunDistribution("decisions", runs.data(), corpus.num_mazes, &maze_run_t::decisions);
+
+    BENCH_SECTION("Decision latency, ns per strategy() call");
+    printf("threads\t      mean\t     p50\t     p90\t     p99\t   p99.9\t     max\t(percentiles within %.0f%%)\n",
+            (exp2(0.5 / LATENCY_BUCKETS_PER_OCTAVE) - 1.0) * 100.0);
+    runCorpus(&corpus, 1, runs.data(), &latency, &result);
+    printLatency(1, &latency);
+    if (max_threads > 1) {
+        runCorpus(&corpus, max_threads, runs.data(), &latency, &result);
+        printLatency(max_threads, &latency);
+    }
+
+    closeMazeCorpus(&corpus);
+    printf("\n[\033[36mDONE\033[0m] corpus_benchmark\n");
+    return 0;
+}
+
+#endif // ARDUINO
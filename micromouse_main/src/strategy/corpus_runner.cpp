@@ -0,0 +1,307 @@
+/* corpus_runner.cpp */
+
+#ifndef ARDUINO
+
+#include <math.h>
+#include <stdlib.h>
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "corpus_runner.h"
+#include "../benchmark.h"
+#include "../settings.h"
+#include "../types.h"
+
+
+void convertLocationToCell(gaussian_location_t* location, cell_t* to_return);
+void convertCellToLocation(cell_t* cell, gaussian_location_t* to_return);
+
+
+/* Copy the four walls of cell from truth into maze, the way the sensors would see them */
+static void seeCell(probabilistic_maze_t* truth, probabilistic_maze_t* maze, cell_t cell) {
+    for (int dir = North; dir <= West; dir++) {
+        mazeWall(maze, cell.x, cell.y, (Direction) dir)->log_odds =
+            mazeWall(truth, cell.x, cell.y, (Direction) dir)->log_odds;
+    }
+}
+
+/* Heading of a one cell move from cell to next */
+static Direction moveDirection(cell_t cell, cell_t next) {
+    if (next.y < cell.y) return North;
+    if (next.x > cell.x) return East;
+    if (next.y > cell.y) return South;
+    return West;
+}
+
+/* Drive from cell with strategy() until it stays in the same cell, seeing the walls of each cell on the way
+ *  - cell and heading end where the robot stopped, steps, turns and decisions are added to
+ *  - Returns false if it took more than MAX_LEG_STEPS */
+static bool runLeg(strategy_context_t* context, probabilistic_maze_t* truth, probabilistic_maze_t* maze,
+                   cell_t* cell, Direction* heading, int* steps, int* turns, int* decisions,
+                   latency_histogram_t* latency) {
+    gaussian_location_t location, next_location;
+    for (int step = 0; step <= MAX_LEG_STEPS; step++) {
+        seeCell(truth, maze, *cell);
+        convertCellToLocation(cell, &location);
+
+        double start = latency != NULL ? benchNowNs() : 0.0;
+        strategy(context, &location, maze, &next_location);
+        if (latency != NULL) {
+            addLatency(latency, benchNowNs() - start);
+        }
+        (*decisions)++;
+
+        cell_t next;
+        convertLocationToCell(&next_location, &next);
+        if (next.x == cell->x && next.y == cell->y) {
+            return true;
+        }
+        Direction dir = moveDirection(*cell, next);
+        *turns += dir != *heading;
+        *heading = dir;
+        (*steps)++;
+        *cell = next;
+    }
+    return false;
+}
+
+/* Cells along the segments of path and changes of heading between them, starting facing heading */
+static void countSpeedRun(const speed_run_path_t* path, lattice_point_t start, Direction heading, int* steps,
+                          int* turns) {
+    *steps = 0;
+    *turns = 0;
+    lattice_point_t point = start;
+    for (int i = 0; i < path->num_segments; i++) {
+        const speed_run_segment_t* segment = &path->segments[i];
+        *steps += (abs(segment->end.x - point.x) + abs(segment->end.y - point.y)) / 2;
+        *turns += segment->heading != heading;
+        heading = segment->heading;
+        point = segment->end;
+    }
+}
+
+/* run maze
+ * Explore truth from the start with context and strategy(), then plan the speed run
+ *  - The robot starts facing East, like planSpeedRun's start */
+bool runMaze(strategy_context_t* context, speed_run_search_t* search, probabilistic_maze_t* truth,
+             probabilistic_maze_t* maze, maze_run_t* run, latency_histogram_t* latency) {
+    const cell_t start = { .x = INIT_CELL_X, .y = INIT_CELL_Y };
+
+    initializeMaze(maze);
+    initializeStrategy(context);
+    *run = (maze_run_t) {};
+
+    cell_t cell = start;
+    Direction heading = East;
+    bool solved = runLeg(context, truth, maze, &cell, &heading, &run->explore_steps, &run->explore_turns,
+                         &run->decisions, latency) && isGoalCell(context, cell);
+
+    setStrategyTarget(context, TARGET_START);
+    solved = solved && runLeg(context, truth, maze, &cell, &heading, &run->explore_steps, &run->explore_turns,
+                              &run->decisions, latency) && cell.x == start.x && cell.y == start.y;
+
+    setStrategyTarget(context, TARGET_GOAL);
+
+    // Walls never seen are still unknown, a speed run can not count on them being open
+    probabilistic_maze_t seen = *maze;
+    for (int n = 0; n < NUM_WALLS; n++) {
+        probabilistic_wall_t* wall = mazeWallByNumber(&seen, n);
+        if (wall->log_odds == 0) {
+            wall->log_odds = WALL_LOG_ODDS_MAX;
+        }
+    }
+
+    bool planned = false;
+    double best_time = 0.0;
+    speed_run_path_t path;
+    const lattice_point_t start_point = { .x = 2 * start.x + 1, .y = 2 * start.y + 1 };
+    for (int i = 0; solved && i < context->goal_set.num_cells; i++) {
+        if (planSpeedRun(search, &seen, start, East, context->goal_set.cells[i], SPEED_RUN_DIAGONALS, &path) &&
+                (!planned || path.time < best_time)) {
+            countSpeedRun(&path, start_point, East, &run->speed_run_steps, &run->speed_run_turns);
+            best_time = path.time;
+            planned = true;
+        }
+    }
+
+    solved = solved && planned;
+    run->solved = solved;
+    return solved;
+}
+
+
+/* One thread's share of the corpus, mazes [next, end) are left, the owner takes from next and
+ * thieves from end */
+typedef struct {
+    std::mutex lock;            // Held to change next or end
+    std::atomic<int> next;
+    std::atomic<int> end;
+} runner_share_t;
+
+/* Take up to RUNNER_CHUNK_MAZES mazes from the front of share into [*first, *last), false if it is empty */
+static bool takeMazes(runner_share_t* share, int* first, int* last) {
+    std::lock_guard<std::mutex> guard(share->lock);
+    int next = share->next, end = share->end;
+    if (next >= end) {
+        return false;
+    }
+    *first = next;
+    *last = next + RUNNER_CHUNK_MAZES < end ? next + RUNNER_CHUNK_MAZES : end;
+    share->next = *last;
+    return true;
+}
+
+/* Move the back half of the share with the most mazes left to share, false if every share is empty */
+static bool stealMazes(runner_share_t* shares, int num_shares, runner_share_t* share) {
+    while (true) {
+        int victim = -1, most = 0;
+        for (int i = 0; i < num_shares; i++) {
+            // A peek without the lock to pick a victim, checked again under its lock
+            int left = shares[i].end - shares[i].next;
+            if (&shares[i] != share && left > most) {
+                victim = i;
+                most = left;
+            }
+        }
+        if (victim < 0) {
+            return false;
+        }
+
+        int first, last;
+        {
+            std::lock_guard<std::mutex> guard(shares[victim].lock);
+            int left = shares[victim].end - shares[victim].next;
+            if (left <= 0) {
+                continue;
+            }
+            last = shares[victim].end;
+            first = last - (left + 1) / 2;
+            shares[victim].end = first;
+        }
+        std::lock_guard<std::mutex> guard(share->lock);
+        share->next = first;
+        share->end = last;
+        return true;
+    }
+}
+
+/* run corpus
+ * runMaze() on every maze of corpus with num_threads threads, runs[i] gets maze i */
+void runCorpus(const maze_corpus_t* corpus, int num_threads, maze_run_t* runs, latency_histogram_t* latency,
+               corpus_run_t* result) {
+    if (num_threads < 1) {
+        num_threads = 1;
+    }
+    std::vector<runner_share_t> shares(num_threads);
+    std::vector<latency_histogram_t> thread_latency(num_threads);
+    std::vector<speed_run_search_t> searches(num_threads);
+    std::atomic<int> steals(0);
+
+    // Even shares to start with, stealing evens out the mazes that take longer
+    for (int t = 0; t < num_threads; t++) {
+        shares[t].next = (int) ((long) corpus->num_mazes * t / num_threads);
+        shares[t].end = (int) ((long) corpus->num_mazes * (t + 1) / num_threads);
+    }
+
+    double start = benchNowNs();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t]() {
+            strategy_context_t context;
+            probabilistic_maze_t truth, maze;
+            latency_histogram_t* thread_histogram = latency != NULL ? &thread_latency[t] : NULL;
+            if (thread_histogram != NULL) {
+                clearLatency(thread_histogram);
+            }
+
+            int first, last;
+            while (true) {
+                if (!takeMazes(&shares[t], &first, &last)) {
+                    if (!stealMazes(shares.data(), num_threads, &shares[t])) {
+                        break;
+                    }
+                    steals++;
+                    continue;
+                }
+                for (int m = first; m < last; m++) {
+                    decodeMaz(corpusMaze(corpus, m), &truth);
+                    runMaze(&context, &searches[t], &truth, &maze, &runs[m], thread_histogram);
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    result->num_threads = num_threads;
+    result->steals = steals;
+    result->seconds = (benchNowNs() - start) / 1e9;
+
+    if (latency != NULL) {
+        clearLatency(latency);
+        for (int t = 0; t < num_threads; t++) {
+            mergeLatency(latency, &thread_latency[t]);
+        }
+    }
+}
+
+
+/* Empty latency */
+void clearLatency(latency_histogram_t* latency) {
+    for (int b = 0; b < LATENCY_OCTAVES * LATENCY_BUCKETS_PER_OCTAVE; b++) {
+        latency->counts[b] = 0;
+    }
+    latency->total = 0;
+    latency->sum_ns = 0.0;
+    latency->max_ns = 0.0;
+}
+
+/* Add a decision that took ns to latency, times under 1 ns go in the first bucket and times past the
+ * last bucket in the last */
+void addLatency(latency_histogram_t* latency, double ns) {
+    int bucket = ns > 1.0 ? (int) (log2(ns) * LATENCY_BUCKETS_PER_OCTAVE) : 0;
+    if (bucket >= LATENCY_OCTAVES * LATENCY_BUCKETS_PER_OCTAVE) {
+        bucket = LATENCY_OCTAVES * LATENCY_BUCKETS_PER_OCTAVE - 1;
+    }
+    latency->counts[bucket]++;
+    latency->total++;
+    latency->sum_ns += ns;
+    if (ns > latency->max_ns) {
+        latency->max_ns = ns;
+    }
+}
+
+/* Add every decision of from to latency */
+void mergeLatency(latency_histogram_t* latency, const latency_histogram_t* from) {
+    for (int b = 0; b < LATENCY_OCTAVES * LATENCY_BUCKETS_PER_OCTAVE; b++) {
+        latency->counts[b] += from->counts[b];
+    }
+    latency->total += from->total;
+    latency->sum_ns += from->sum_ns;
+    if (from->max_ns > latency->max_ns) {
+        latency->max_ns = from->max_ns;
+    }
+}
+
+/* The p-th percentile of latency in ns, the middle of its bucket */
+double latencyPercentile(const latency_histogram_t* latency, double p) {
+    if (latency->total == 0) {
+        return 0.0;
+    }
+    // The rank of the percentile, counted from 1
+    unsigned long rank = (unsigned long) (p / 100.0 * (latency->total - 1)) + 1;
+    unsigned long seen = 0;
+    for (int b = 0; b < LATENCY_OCTAVES * LATENCY_BUCKETS_PER_OCTAVE; b++) {
+        seen += latency->counts[b];
+        if (seen >= rank) {
+            return exp2((b + 0.5) / LATENCY_BUCKETS_PER_OCTAVE);
+        }
+    }
+    return latency->max_ns;
+}
+
+#endif // ARDUINO
@@ -0,0 +1,94 @@
+/* corpus_runner.h
+ *
+ * Runs of strategy() on whole maze corpora, for host benchmarks.
+ *
+ * runMaze() puts the robot at the start of a maze it knows nothing
+ * about and drives it one cell at a time with strategy(), seeing the
+ * four walls of every cell it is in from the real maze:
+ *  - Exploration: to the goal, then back to the start
+ *  - Speed run: planSpeedRun() from the start to the fastest goal cell
+ *    over the walls it saw, the ones it did not see closed
+ *
+ * runCorpus() does that for every maze of a corpus on as many threads
+ * as asked. Each thread has a strategy_context_t of its own and takes
+ * mazes from its own share of the corpus, a thread that runs out
+ * steals half of what is left of the busiest other share.
+ */
+
+#ifndef _CORPUS_RUNNER_H_
+#define _CORPUS_RUNNER_H_
+
+#ifndef ARDUINO
+
+#include "strategy.h"
+#include "speed_run.h"
+#include "maze_file.h"
+#include "../settings.h"
+#include "../localization/probabilistic_maze.h"
+
+
+#define MAX_LEG_STEPS (4 * MAZE_WIDTH * MAZE_HEIGHT)    // A leg longer than this is lost
+#define RUNNER_CHUNK_MAZES 8                           // Mazes a thread takes from its share at a time
+
+#define LATENCY_BUCKETS_PER_OCTAVE 16                   // Histogram buckets are 2^(1/16), about 4.4%, wide
+#define LATENCY_OCTAVES 28                              // Up to 2^28 ns, a quarter of a second
+
+
+/* What one maze took, steps are cells moved and turns are changes of heading (a U turn is one) */
+typedef struct {
+    int explore_steps;          // To the goal and back
+    int explore_turns;
+    int speed_run_steps;        // Along the segments of the planned speed run
+    int speed_run_turns;
+    int decisions;              // strategy() calls, one per cell plus the last one of each exploration leg
+    bool solved;                // Every leg ended where it should
+} maze_run_t;
+
+/* Decision times, as a histogram so threads can keep their own and add them up after
+ *  - Bucket b holds times from 2^(b / LATENCY_BUCKETS_PER_OCTAVE) ns up to the next bucket */
+typedef struct {
+    unsigned long counts[LATENCY_OCTAVES * LATENCY_BUCKETS_PER_OCTAVE];
+    unsigned long total;
+    double sum_ns;
+    double max_ns;
+} latency_histogram_t;
+
+/* What runCorpus() did */
+typedef struct {
+    int num_threads;
+    int steals;                 // Times a thread took mazes from another's share
+    double seconds;             // Wall clock, threads started to threads joined
+} corpus_run_t;
+
+
+/* run maze
+ * Explore truth from the start with context and strategy(), then plan the speed run with search, see
+ * corpus_runner.h
+ *  - maze is the robot's, it starts unknown and ends with the walls that were seen
+ *  - The time of every strategy() call is added to latency if it is not NULL
+ *  - Returns run->solved */
+bool runMaze(strategy_context_t* context, speed_run_search_t* search, probabilistic_maze_t* truth,
+             probabilistic_maze_t* maze, maze_run_t* run, latency_histogram_t* latency);
+
+/* run corpus
+ * runMaze() on every maze of corpus with num_threads threads, runs[i] gets maze i
+ *  - latency is set to the time of every decision of every maze if it is not NULL */
+void runCorpus(const maze_corpus_t* corpus, int num_threads, maze_run_t* runs, latency_histogram_t* latency,
+               corpus_run_t* result);
+
+/* Empty latency */
+void clearLatency(latency_histogram_t* latency);
+
+/* Add a decision that took ns to latency */
+void addLatency(latency_histogram_t* latency, double ns);
+
+/* Add every decision of from to latency */
+void mergeLatency(latency_histogram_t* latency, const latency_histogram_t* from);
+
+/* The p-th percentile of latency in ns (the middle of its bucket), 0 <= p <= 100, 0 if it is empty */
+double latencyPercentile(const latency_histogram_t* latency, double p);
+
+
+#endif // ARDUINO
+
+#endif //_CORPUS_RUNNER_H_
@@ -0,0 +1,197 @@
+/* exploration.cpp */
+
+
+#include "exploration.h"
+#include "bitboard_maze.h"
+#include "../types.h"
+#include "../settings.h"
+
+
+// Function Declarations
+void buildBoundBitboards(exploration_t* exploration, probabilistic_maze_t* maze_state,
+                         bitboard_maze_t* optimistic, bitboard_maze_t* pessimistic);
+bool hasUnknownWall(exploration_t* exploration, cell_t cell);
+void markCellKnown(exploration_t* exploration, cell_t cell);
+cell_t stepDownhill(const bitboard_maze_t* bitboard, int distances[MAZE_WIDTH][MAZE_HEIGHT], cell_t cell);
+void convertLocationToCell(gaussian_location_t* location, cell_t* to_return);
+void convertCellToLocation(cell_t* cell, gaussian_location_t* to_return);
+
+// Globals
+/* Cell offsets in each Direction */
+const int exploration_step[4][2] = { { 0, -1 }, { 1, 0 }, { 0, 1 }, { -1, 0 } };
+
+
+/*----------- Public Functions -----------*/
+
+void initializeExploration(exploration_t* exploration) {
+    for (int n = 0; n < NUM_WALLS; n++) {
+        exploration->known[n] = false;
+    }
+    exploration->mode = EXPLORE_SEARCH;
+    exploration->lower_bound = 0;
+    exploration->upper_bound = MAX_VALUE;
+    exploration->target_looks = 0;
+}
+
+void updateKnownWalls(exploration_t* exploration, probabilistic_maze_t* maze_state) {
+    for (int n = 0; n < NUM_WALLS; n++) {
+        int log_odds = mazeWallByNumber(maze_state, n)->log_odds;
+        if (log_odds >= WALL_LOG_ODDS_THRESHOLD || log_odds <= -WALL_LOG_ODDS_THRESHOLD) {
+            exploration->known[n] = true;
+        }
+    }
+}
+
+/* choose exploration cell
+ * - Candidates are cells with from_start + to_goal equal to the lower bound, on an optimistic
+ *   shortest path, and an unknown wall; the target is the nearest by optimistic steps, the one
+ *   closest to the goal of those
+ * - Every move goes through a wall of robot_cell, which the robot has seen */
+cell_t chooseExplorationCell(exploration_t* exploration, probabilistic_maze_t* maze_state, cell_t robot_cell) {
+    return chooseExplorationCell(&strategy_context, exploration, maze_state, robot_cell);
+}
+
+cell_t chooseExplorationCell(strategy_context_t* context, exploration_t* exploration, probabilistic_maze_t* maze_state,
+                             cell_t robot_cell) {
+
+    bitboard_maze_t* optimistic = &exploration->optimistic;
+    bitboard_maze_t* pessimistic = &exploration->pessimistic;
+    int (*to_goal)[MAZE_HEIGHT] = exploration->to_goal;
+    int (*from_start)[MAZE_HEIGHT] = exploration->from_start;
+    int (*to_target)[MAZE_HEIGHT] = exploration->to_target;
+    goal_set_t* goals = &context->goal_set;
+    cell_t start = { .x = INIT_CELL_X, .y = INIT_CELL_Y };
+
+    buildBoundBitboards(exploration, maze_state, optimistic, pessimistic);
+
+    if (exploration->mode == EXPLORE_SEARCH) {
+        bitboardFloodfillCells(optimistic, goals->cells, goals->num_cells, 0, to_goal);
+        bitboardFloodfillCells(pessimistic, goals->cells, goals->num_cells, 0, to_target);
+        exploration->lower_bound = to_goal[start.x][start.y];
+        exploration->upper_bound = to_target[start.x][start.y];
+
+        // Also done if the goal can not be reached, there is nothing left to find
+        if (exploration->lower_bound == exploration->upper_bound || exploration->lower_bound == MAX_VALUE) {
+            exploration->mode = EXPLORE_RETURN;
+        }
+    }
+
+    if (exploration->mode == EXPLORE_SEARCH) {
+        bitboardFloodfillCells(optimistic, &start, 1, 0, from_start);
+        bitboardFloodfillCells(optimistic, &robot_cell, 1, 0, to_target);
+
+        cell_t target = robot_cell;
+        int target_distance = MAX_VALUE;
+        for (int x = 0; x < MAZE_WIDTH; x++) {
+            for (int y = 0; y < MAZE_HEIGHT; y++) {
+                cell_t cell = { .x = x, .y = y };
+                if (from_start[x][y] + to_goal[x][y] != exploration->lower_bound ||
+                        !hasUnknownWall(exploration, cell)) {
+                    continue;
+                }
+                if (to_target[x][y] < target_distance ||
+                        (to_target[x][y] == target_distance && to_goal[x][y] < to_goal[target.x][target.y])) {
+                    target = cell;
+                    target_distance = to_target[x][y];
+                }
+            }
+        }
+
+        // Standing in the target, its walls are as sure as the sensors make them after EXPLORATION_LOOKS
+        if (target.x != robot_cell.x || target.y != robot_cell.y) {
+            exploration->target_looks = 0;
+        } else if (++exploration->target_looks >= EXPLORATION_LOOKS) {
+            markCellKnown(exploration, robot_cell);
+            exploration->target_looks = 0;
+            return chooseExplorationCell(context, exploration, maze_state, robot_cell);
+        }
+
+        bitboardFloodfillCells(optimistic, &target, 1, 0, to_target);
+        return stepDownhill(optimistic, to_target, robot_cell);
+    }
+
+    // Back to the start along walls that are known to be open
+    if (robot_cell.x == start.x && robot_cell.y == start.y) {
+        exploration->mode = EXPLORE_DONE;
+    }
+    if (exploration->mode == EXPLORE_DONE) {
+        return robot_cell;
+    }
+    bitboardFloodfillCells(pessimistic, &start, 1, 0, to_target);
+    return stepDownhill(pessimistic, to_target, robot_cell);
+}
+
+void strategyExplore(gaussian_location_t* robot_location, probabilistic_maze_t* maze_state,
+                     exploration_t* exploration, gaussian_location_t* next_location) {
+    strategyExplore(&strategy_context, robot_location, maze_state, exploration, next_location);
+}
+
+void strategyExplore(strategy_context_t* context, gaussian_location_t* robot_location,
+                     probabilistic_maze_t* maze_state, exploration_t* exploration,
+                     gaussian_location_t* next_location) {
+
+    cell_t robot_cell;
+    convertLocationToCell(robot_location, &robot_cell);
+
+    updateKnownWalls(exploration, maze_state);
+    cell_t next_cell = chooseExplorationCell(context, exploration, maze_state, robot_cell);
+
+    convertCellToLocation(&next_cell, next_location);
+}
+
+
+/*----------- Private Functions -----------*/
+
+/* Open walls of the optimistic (unknown is open) and pessimistic (unknown is closed) mazes */
+void buildBoundBitboards(exploration_t* exploration, probabilistic_maze_t* maze_state,
+                         bitboard_maze_t* optimistic, bitboard_maze_t* pessimistic) {
+    for (int y = 0; y < MAZE_HEIGHT; y++) {
+        bitboard_row_t east[2] = { 0, 0 };
+        bitboard_row_t south[2] = { 0, 0 };
+        for (int x = 0; x < MAZE_WIDTH; x++) {
+            if (x < MAZE_WIDTH - 1) {
+                bool known = exploration->known[NUM_HORIZONTAL_WALLS + verticalWallIndex(x + 1, y)];
+                bool exists = wallExists(mazeWall(maze_state, x, y, East));
+                east[0] |= (bitboard_row_t) (!(known && exists)) << x;
+                east[1] |= (bitboard_row_t) (known && !exists) << x;
+            }
+            if (y < MAZE_HEIGHT - 1) {
+                bool known = exploration->known[horizontalWallIndex(x, y + 1)];
+                bool exists = wallExists(mazeWall(maze_state, x, y, South));
+                south[0] |= (bitboard_row_t) (!(known && exists)) << x;
+                south[1] |= (bitboard_row_t) (known && !exists) << x;
+            }
+        }
+        optimistic->open_east[y] = east[0];
+        optimistic->open_south[y] = south[0];
+        pessimistic->open_east[y] = east[1];
+        pessimistic->open_south[y] = south[1];
+    }
+}
+
+bool hasUnknownWall(exploration_t* exploration, cell_t cell) {
+    return !exploration->known[horizontalWallIndex(cell.x, cell.y)] ||
+           !exploration->known[horizontalWallIndex(cell.x, cell.y + 1)] ||
+           !exploration->known[NUM_HORIZONTAL_WALLS + verticalWallIndex(cell.x, cell.y)] ||
+           !exploration->known[NUM_HORIZONTAL_WALLS + verticalWallIndex(cell.x + 1, cell.y)];
+}
+
+/* The four walls of cell become known */
+void markCellKnown(exploration_t* exploration, cell_t cell) {
+    exploration->known[horizontalWallIndex(cell.x, cell.y)] = true;
+    exploration->known[horizontalWallIndex(cell.x, cell.y + 1)] = true;
+    exploration->known[NUM_HORIZONTAL_WALLS + verticalWallIndex(cell.x, cell.y)] = true;
+    exploration->known[NUM_HORIZONTAL_WALLS + verticalWallIndex(cell.x + 1, cell.y)] = true;
+}
+
+/* The first open neighbor of cell one step closer by distances, cell itself if there is none */
+cell_t stepDownhill(const bitboard_maze_t* bitboard, int distances[MAZE_WIDTH][MAZE_HEIGHT], cell_t cell) {
+    for (int dir = North; dir <= West; dir++) {
+        cell_t next = { .x = cell.x + exploration_step[dir][0], .y = cell.y + exploration_step[dir][1] };
+        if (bitboardOpen(bitboard, cell, (Direction) dir) &&
+                distances[next.x][next.y] == distances[cell.x][cell.y] - 1) {
+            return next;
+        }
+    }
+    return cell;
+}
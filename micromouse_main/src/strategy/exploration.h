@@ -0,0 +1,78 @@
+/* exploration.h
+ *
+ * Search run that knows when to stop. Every wall is either known (seen
+ * by the robot) or unknown, and two floodfills from the goal bound the
+ * length of the shortest path from the start:
+ *
+ *      optimistic:  unknown walls are open,   a lower bound
+ *      pessimistic: unknown walls are closed, an upper bound, a path
+ *                   the robot has seen all of
+ *
+ * While the bounds differ some optimistic shortest path still has an
+ * unknown wall on it. The robot goes to the nearest cell on one of those
+ * paths with an unknown wall. Once the bounds agree the pessimistic path
+ * is a proven shortest path, and the robot goes back to the start.
+ *
+ * A wall the sensors never make sure of would keep its cell the target
+ * for good, so once the robot has been in the target for
+ * EXPLORATION_LOOKS calls the walls of the cell are taken as known, the
+ * way wallExists() has them then.
+ */
+
+#ifndef _EXPLORATION_H_
+#define _EXPLORATION_H_
+
+#include "strategy.h"
+#include "bitboard_maze.h"
+#include "../types.h"
+#include "../settings.h"
+#include "../localization/probabilistic_maze.h"
+
+
+enum ExplorationMode {
+    EXPLORE_SEARCH,     // Looking at candidate shortest paths
+    EXPLORE_RETURN,     // Shortest path proven, going back to the start
+    EXPLORE_DONE        // Back at the start
+};
+
+typedef struct {
+    bool known[NUM_WALLS];      // Walls seen, by wall number (see mazeWallByNumber)
+    ExplorationMode mode;
+    int lower_bound;            // Steps from the start to the goal with unknown walls open
+    int upper_bound;            // Steps from the start to the goal with unknown walls closed, MAX_VALUE if none
+    int target_looks;           // Calls in a row the robot has been in the target
+
+    // Scratch of chooseExplorationCell
+    bitboard_maze_t optimistic;
+    bitboard_maze_t pessimistic;
+    int to_goal[MAZE_WIDTH][MAZE_HEIGHT];
+    int from_start[MAZE_WIDTH][MAZE_HEIGHT];
+    int to_target[MAZE_WIDTH][MAZE_HEIGHT];
+} exploration_t;
+
+
+/* initialize exploration
+ * Every wall is unknown, searching from the start */
+void initializeExploration(exploration_t* exploration);
+
+/* update known walls
+ * Walls of maze_state that wallExists() is sure of either way become known, and stay known */
+void updateKnownWalls(exploration_t* exploration, probabilistic_maze_t* maze_state);
+
+/* choose exploration cell
+ * The neighbor of robot_cell to go to next, robot_cell itself once EXPLORE_DONE, updates the mode and bounds
+ *  - The goal is the goal set of context, strategy_context's without one */
+cell_t chooseExplorationCell(exploration_t* exploration, probabilistic_maze_t* maze_state, cell_t robot_cell);
+cell_t chooseExplorationCell(strategy_context_t* context, exploration_t* exploration, probabilistic_maze_t* maze_state,
+                             cell_t robot_cell);
+
+/* strategy explore
+ * Given the robots location and the state of the maze calculate the next location to go to while exploring */
+void strategyExplore(gaussian_location_t* robot_location, probabilistic_maze_t* robot_maze_state,
+                     exploration_t* exploration, gaussian_location_t* next_location);
+void strategyExplore(strategy_context_t* context, gaussian_location_t* robot_location,
+                     probabilistic_maze_t* robot_maze_state, exploration_t* exploration,
+                     gaussian_location_t* next_location);
+
+
+#endif //_EXPLORATION_H_
@@ -0,0 +1,95 @@
+/* floodfill.h
+ *
+ * The queue floodfill for a maze of any size. floodfillCells() runs
+ * it on the robot's maze with values and discovered from strategy.cpp,
+ * host code can run it on probabilistic_grid_t<W, H> mazes of other
+ * sizes with a floodfill_grid_t<W, H> of their own.
+ *
+ * Not included from strategy.h, util/queue.h clashes with std::queue
+ * where both are in scope.
+ */
+
+#ifndef _FLOODFILL_H_
+#define _FLOODFILL_H_
+
+#include "strategy.h"
+#include "../settings.h"
+#include "../util/queue.h"
+#include "../localization/probabilistic_maze.h"
+
+
+/* The floodfill state of a W by H maze */
+template <int W, int H>
+struct floodfill_grid_t {
+    // Value of cells that can not be reached, MAX_VALUE unless a path can be longer than that
+    static constexpr int max_value = W * H > MAX_VALUE ? W * H : MAX_VALUE;
+
+    int values[W][H];
+    bool discovered[W][H];
+};
+
+
+template <int W, int H>
+inline bool isCellInGrid(cell_t cell) {
+    return cell.x >= 0 && cell.x < W && cell.y >= 0 && cell.y < H;
+}
+
+/* Queue next, the dir neighbor of cell, if it has not been queued yet and the wall between them is open */
+template <int W, int H>
+inline void floodfillVisit(probabilistic_grid_t<W, H>* maze_state, cell_t cell, Direction dir, cell_t next,
+                           bool discovered[W][H], queue<cell_t, W * H>* q) {
+    if (isCellInGrid<W, H>(next) && !discovered[next.x][next.y] &&
+            !wallExists(mazeWall(maze_state, cell.x, cell.y, dir))) {
+        discovered[next.x][next.y] = true;
+        q->push(next);
+    }
+}
+
+/* floodfill grid
+ * Breadth first search from every one of cells at once, each cell of values gets the steps to the
+ * closest of them plus value, floodfill_grid_t<W, H>::max_value if there is no way there
+ *  - discovered is scratch, the cells the search has queued */
+template <int W, int H>
+void floodfillGrid(probabilistic_grid_t<W, H>* maze_state, const cell_t* cells, int num_cells, int value,
+                   int values[W][H], bool discovered[W][H]) {
+
+    for (int x = 0; x < W; x++) {
+        for (int y = 0; y < H; y++) {
+            values[x][y] = floodfill_grid_t<W, H>::max_value;
+            discovered[x][y] = false;
+        }
+    }
+
+    // One queue, a layer of the search is what is in it when the layer starts (swapping two queues
+    // would copy them every layer, which is most of the time on large grids)
+    queue<cell_t, W * H> q(cell_t { .x = 0, .y = 0 });
+
+    for (int i = 0; i < num_cells; i++) {
+        if (isCellInGrid<W, H>(cells[i]) && !discovered[cells[i].x][cells[i].y]) {
+            discovered[cells[i].x][cells[i].y] = true;
+            q.push(cells[i]);
+        }
+    }
+
+    for (; !q.empty(); value++) {
+        for (int layer = q.size(); layer > 0; layer--) {
+            cell_t cell = q.pop();
+            values[cell.x][cell.y] = value;
+
+            // If we haven't been there and we can get there, go there
+            floodfillVisit(maze_state, cell, North, cell_t { .x = cell.x, .y = cell.y - 1 }, discovered, &q);
+            floodfillVisit(maze_state, cell, East, cell_t { .x = cell.x + 1, .y = cell.y }, discovered, &q);
+            floodfillVisit(maze_state, cell, South, cell_t { .x = cell.x, .y = cell.y + 1 }, discovered, &q);
+            floodfillVisit(maze_state, cell, West, cell_t { .x = cell.x - 1, .y = cell.y }, discovered, &q);
+        }
+    }
+}
+
+template <int W, int H>
+void floodfillGrid(probabilistic_grid_t<W, H>* maze_state, const cell_t* cells, int num_cells, int value,
+                   floodfill_grid_t<W, H>* grid) {
+    floodfillGrid(maze_state, cells, num_cells, value, grid->values, grid->discovered);
+}
+
+
+#endif //_FLOODFILL_H_
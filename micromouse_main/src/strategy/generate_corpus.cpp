@@ -0,0 +1,33 @@
+#ifndef ARDUINO
+/* generate_corpus
+ * Write a .maz corpus of generated mazes for the benchmarks
+ *
+ *   ./generate_corpus <path> <mazes> [seed] [loop percent]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "maze_generator.h"
+#include "../settings.h"
+
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s <path> <mazes> [seed] [loop percent]\n", argv[0]);
+        return 2;
+    }
+    int num_mazes = atoi(argv[2]);
+    unsigned int seed = argc > 3 ? (unsigned int) strtoul(argv[3], NULL, 0) : 1;
+    int loop_percent = argc > 4 ? atoi(argv[4]) : 0;
+
+    if (num_mazes <= 0 || !writeMazeCorpus(argv[1], seed, num_mazes, loop_percent)) {
+        fprintf(stderr, "could not write %d mazes to %s\n", num_mazes, argv[1]);
+        return 1;
+    }
+    printf("%d %dx%d mazes (seed %u, %d%% loops) written to %s\n", num_mazes, MAZE_WIDTH, MAZE_HEIGHT,
+            seed, loop_percent, argv[1]);
+    return 0;
+}
+
+#endif // ARDUINO
@@ -0,0 +1,176 @@
+/* maze_file.cpp */
+
+#ifndef ARDUINO
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "maze_file.h"
+#include "../settings.h"
+
+
+/* Set wall to exist or not, as a file says for certain */
+void setFileWall(probabilistic_wall_t* wall, bool exists) {
+    wall->log_odds = exists ? WALL_LOG_ODDS_MAX : -WALL_LOG_ODDS_MAX;
+}
+
+/* load maz file
+ * Read the MAZ_FILE_BYTES byte .maz file at path into maze */
+bool loadMazFile(const char* path, probabilistic_maze_t* maze) {
+    uint8_t bytes[MAZ_FILE_BYTES + 1];
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        return false;
+    }
+    size_t read = fread(bytes, 1, sizeof(bytes), file);
+    fclose(file);
+    if (read != MAZ_FILE_BYTES) {
+        return false;
+    }
+    decodeMaz(bytes, maze);
+    return true;
+}
+
+/* save maz file
+ * Write maze to path as a .maz file */
+bool saveMazFile(const char* path, probabilistic_maze_t* maze) {
+    uint8_t bytes[MAZ_FILE_BYTES];
+    encodeMaz(maze, bytes);
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) {
+        return false;
+    }
+    bool written = fwrite(bytes, 1, MAZ_FILE_BYTES, file) == MAZ_FILE_BYTES;
+    return fclose(file) == 0 && written;
+}
+
+/* parse maze text
+ * Set the walls of maze from the text drawing of a MAZE_WIDTH by MAZE_HEIGHT maze
+ *  - Line l of the drawing is y = MAZE_HEIGHT - 1 - l / 2 here, the top line is the south border */
+bool parseMazeText(const char* text, probabilistic_maze_t* maze) {
+    initializeMaze(maze);
+
+    const char* line = text;
+    for (int l = 0; l <= 2 * MAZE_HEIGHT; l++) {
+        int length = 0;
+        while (line[length] != '\0' && line[length] != '\n' && line[length] != '\r') {
+            length++;
+        }
+        int y = MAZE_HEIGHT - 1 - l / 2;
+
+        if (l % 2 == 0) {
+            // Posts and the walls between rows, every post has to be there
+            if (length < 4 * MAZE_WIDTH + 1) {
+                return false;
+            }
+            for (int x = 0; x < MAZE_WIDTH; x++) {
+                if (line[4 * x] == ' ' || line[4 * x + 4] == ' ') {
+                    return false;
+                }
+                if (l > 0 && l < 2 * MAZE_HEIGHT) {
+                    setFileWall(mazeWall(maze, x, y, South), line[4 * x + 2] == '-');
+                }
+            }
+        } else {
+            // The walls between columns, trailing spaces may be left off
+            for (int x = 1; x < MAZE_WIDTH; x++) {
+                setFileWall(mazeWall(maze, x, y, West), 4 * x < length && line[4 * x] == '|');
+            }
+        }
+
+        if (line[length] == '\0' && l < 2 * MAZE_HEIGHT) {
+            return false;
+        }
+        line += length;
+        if (*line == '\r') line++;
+        if (*line == '\n') line++;
+    }
+    return true;
+}
+
+/* format maze text
+ * The text drawing of maze, a wall is drawn where wallExists() */
+void formatMazeText(probabilistic_maze_t* maze, char* text) {
+    for (int l = 0; l <= 2 * MAZE_HEIGHT; l++) {
+        int y = MAZE_HEIGHT - 1 - l / 2;
+        if (l % 2 == 0) {
+            for (int x = 0; x < MAZE_WIDTH; x++) {
+                bool wall = l == 0 ? wallExists(mazeWall(maze, x, MAZE_HEIGHT - 1, South))
+                                   : wallExists(mazeWall(maze, x, y + 1, North));
+                *text++ = 'o';
+                memcpy(text, wall ? "---" : "   ", 3);
+                text += 3;
+            }
+            *text++ = 'o';
+        } else {
+            for (int x = 0; x < MAZE_WIDTH; x++) {
+                *text++ = wallExists(mazeWall(maze, x, y, West)) ? '|' : ' ';
+                memcpy(text, "   ", 3);
+                text += 3;
+            }
+            *text++ = wallExists(mazeWall(maze, MAZE_WIDTH - 1, y, East)) ? '|' : ' ';
+        }
+        *text++ = '\n';
+    }
+    *text = '\0';
+}
+
+/* load maze text file
+ * Read the text drawing at path into maze */
+bool loadMazeTextFile(const char* path, probabilistic_maze_t* maze) {
+    // Room for "\r\n" line ends and a little more, anything past the drawing is ignored
+    static char text[2 * MAZE_TEXT_BYTES];
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        return false;
+    }
+    size_t read = fread(text, 1, sizeof(text) - 1, file);
+    fclose(file);
+    text[read] = '\0';
+    return parseMazeText(text, maze);
+}
+
+/* open maze corpus
+ * Map the corpus at path into memory read only */
+bool openMazeCorpus(const char* path, maze_corpus_t* corpus) {
+    corpus->data = NULL;
+    corpus->size = 0;
+    corpus->num_mazes = 0;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat status;
+    if (fstat(fd, &status) != 0 || status.st_size <= 0 || status.st_size % MAZ_FILE_BYTES != 0) {
+        close(fd);
+        return false;
+    }
+    void* data = mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // The mapping keeps the file open
+    if (data == MAP_FAILED) {
+        return false;
+    }
+    madvise(data, status.st_size, MADV_SEQUENTIAL);
+
+    corpus->data = (const uint8_t*) data;
+    corpus->size = status.st_size;
+    corpus->num_mazes = status.st_size / MAZ_FILE_BYTES;
+    return true;
+}
+
+/* Unmap a corpus opened with openMazeCorpus */
+void closeMazeCorpus(maze_corpus_t* corpus) {
+    if (corpus->data != NULL) {
+        munmap((void*) corpus->data, corpus->size);
+    }
+    corpus->data = NULL;
+    corpus->size = 0;
+    corpus->num_mazes = 0;
+}
+
+#endif // ARDUINO
@@ -0,0 +1,142 @@
+/* maze_file.h
+ *
+ * Mazes from files, for host tests and benchmarks.
+ *
+ * .maz binary: one byte per cell, W * H bytes, the cell at x, y
+ * (y counted up from the start row) is byte x * H + y. The low four
+ * bits are its walls, MAZ_NORTH, MAZ_EAST, MAZ_SOUTH and MAZ_WEST. A
+ * wall is there if either cell beside it has it.
+ *
+ * Text: the usual drawing with 'o' (or '+' or '.') posts, "---" for
+ * walls between rows and '|' for walls between columns, the start row
+ * at the bottom. Anything inside a cell (S, G, numbers) is ignored.
+ *
+ *      o---o---o
+ *      |       |
+ *      o   o---o
+ *      | S |   |
+ *      o---o---o
+ *
+ * Both put the start row at the bottom and count y up, here y counts
+ * down from the start row (North is y - 1), so the maze is flipped
+ * top to bottom: a file's north wall is the South wall here. The
+ * start stays at (0, 0) and every route keeps its length and turns.
+ *
+ * A corpus is .maz files of MAZE_WIDTH by MAZE_HEIGHT back to back
+ * (cat *.maz > corpus). openMazeCorpus() maps it into memory and
+ * corpusMaze() points into the mapping, nothing is copied or parsed
+ * until decodeMaz() fills a maze from it.
+ */
+
+#ifndef _MAZE_FILE_H_
+#define _MAZE_FILE_H_
+
+#ifndef ARDUINO
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../settings.h"
+#include "../localization/probabilistic_maze.h"
+
+
+#define MAZ_NORTH 0x1
+#define MAZ_EAST  0x2
+#define MAZ_SOUTH 0x4
+#define MAZ_WEST  0x8
+
+#define MAZ_FILE_BYTES (MAZE_WIDTH * MAZE_HEIGHT)
+
+/* Longest text drawing of a MAZE_WIDTH by MAZE_HEIGHT maze, with a line feed on every line and the terminator */
+#define MAZE_TEXT_BYTES ((4 * MAZE_WIDTH + 2) * (2 * MAZE_HEIGHT + 1) + 1)
+
+
+typedef struct {
+    const uint8_t* data;    // num_mazes * MAZ_FILE_BYTES bytes, read only
+    size_t size;
+    int num_mazes;
+} maze_corpus_t;
+
+
+/* decode maz
+ * Set every wall of maze from the .maz bytes of a W by H maze, walls are exactly 1.0 or 0.0 */
+template <int W, int H>
+void decodeMaz(const uint8_t* bytes, probabilistic_grid_t<W, H>* maze) {
+    for (int x = 0; x < W; x++) {
+        for (int y = 0; y < H; y++) {
+            // A wall is there if either cell beside it says so, worked out with bit operations since
+            // walls are as good as random to the branch predictor
+            int here = bytes[x * H + y];
+            int above = y > 0 ? bytes[x * H + y - 1] : 0;
+            int left = x > 0 ? bytes[(x - 1) * H + y] : 0;
+            int north = ((here >> 2) | above) & 1;          // MAZ_SOUTH here or MAZ_NORTH above
+            int west = ((here >> 3) | (left >> 1)) & 1;     // MAZ_WEST here or MAZ_EAST to the left
+            mazeWall(maze, x, y, North)->log_odds = (2 * north - 1) * WALL_LOG_ODDS_MAX;
+            mazeWall(maze, x, y, West)->log_odds = (2 * west - 1) * WALL_LOG_ODDS_MAX;
+        }
+    }
+    // The border is a wall whatever the file says
+    for (int x = 0; x < W; x++) {
+        mazeWall(maze, x, 0, North)->log_odds = WALL_LOG_ODDS_MAX;
+        mazeWall(maze, x, H - 1, South)->log_odds = WALL_LOG_ODDS_MAX;
+    }
+    for (int y = 0; y < H; y++) {
+        mazeWall(maze, 0, y, West)->log_odds = WALL_LOG_ODDS_MAX;
+        mazeWall(maze, W - 1, y, East)->log_odds = WALL_LOG_ODDS_MAX;
+    }
+}
+
+/* encode maz
+ * The .maz bytes of maze, a wall is set where wallExists() */
+template <int W, int H>
+void encodeMaz(probabilistic_grid_t<W, H>* maze, uint8_t* bytes) {
+    for (int x = 0; x < W; x++) {
+        for (int y = 0; y < H; y++) {
+            bytes[x * H + y] = (wallExists(mazeWall(maze, x, y, North)) ? MAZ_SOUTH : 0) |
+                               (wallExists(mazeWall(maze, x, y, East)) ? MAZ_EAST : 0) |
+                               (wallExists(mazeWall(maze, x, y, South)) ? MAZ_NORTH : 0) |
+                               (wallExists(mazeWall(maze, x, y, West)) ? MAZ_WEST : 0);
+        }
+    }
+}
+
+/* load maz file
+ * Read the MAZ_FILE_BYTES byte .maz file at path into maze
+ *  - Returns false if it can not be read or is not MAZ_FILE_BYTES long */
+bool loadMazFile(const char* path, probabilistic_maze_t* maze);
+
+/* save maz file
+ * Write maze to path as a .maz file, returns false if it can not be written */
+bool saveMazFile(const char* path, probabilistic_maze_t* maze);
+
+/* parse maze text
+ * Set the walls of maze from the text drawing of a MAZE_WIDTH by MAZE_HEIGHT maze
+ *  - Lines can end in "\n" or "\r\n", lines after the drawing are ignored
+ *  - Returns false, leaving maze partly set, if text is not that size */
+bool parseMazeText(const char* text, probabilistic_maze_t* maze);
+
+/* format maze text
+ * The text drawing of maze, a wall is drawn where wallExists(), text holds MAZE_TEXT_BYTES */
+void formatMazeText(probabilistic_maze_t* maze, char* text);
+
+/* load maze text file
+ * Read the text drawing at path into maze, returns false if it can not be read or parsed */
+bool loadMazeTextFile(const char* path, probabilistic_maze_t* maze);
+
+/* open maze corpus
+ * Map the corpus at path into memory read only
+ *  - Returns false if it can not be mapped or is not a whole number of mazes */
+bool openMazeCorpus(const char* path, maze_corpus_t* corpus);
+
+/* Unmap a corpus opened with openMazeCorpus */
+void closeMazeCorpus(maze_corpus_t* corpus);
+
+/* The .maz bytes of maze i of corpus, in the mapping */
+inline const uint8_t* corpusMaze(const maze_corpus_t* corpus, int i) {
+    return corpus->data + (size_t) i * MAZ_FILE_BYTES;
+}
+
+
+#endif // ARDUINO
+
+#endif //_MAZE_FILE_H_
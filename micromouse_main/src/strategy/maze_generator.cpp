@@ -0,0 +1,38 @@
+/* maze_generator.cpp */
+
+#ifndef ARDUINO
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "maze_generator.h"
+#include "maze_file.h"
+#include "../settings.h"
+
+
+#define CORPUS_WRITE_MAZES 256     // Mazes encoded per write
+
+
+/* write maze corpus
+ * Write num_mazes mazes from generateMaze to path as a .maz corpus */
+bool writeMazeCorpus(const char* path, unsigned int corpus_seed, int num_mazes, int loop_percent) {
+    static probabilistic_maze_t maze;
+    static uint8_t bytes[CORPUS_WRITE_MAZES * MAZ_FILE_BYTES];
+
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) {
+        return false;
+    }
+    bool written = true;
+    for (int first = 0; first < num_mazes && written; first += CORPUS_WRITE_MAZES) {
+        int count = num_mazes - first < CORPUS_WRITE_MAZES ? num_mazes - first : CORPUS_WRITE_MAZES;
+        for (int i = 0; i < count; i++) {
+            generateMaze(&maze, corpusMazeSeed(corpus_seed, first + i), loop_percent);
+            encodeMaz(&maze, &bytes[i * MAZ_FILE_BYTES]);
+        }
+        written = fwrite(bytes, MAZ_FILE_BYTES, count, file) == (size_t) count;
+    }
+    return fclose(file) == 0 && written;
+}
+
+#endif // ARDUINO
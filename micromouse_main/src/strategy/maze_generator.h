@@ -0,0 +1,242 @@
+/* maze_generator.h
+ *
+ * Random mazes of any size for host tests and benchmarks, the same
+ * maze for the same seed on every machine.
+ *
+ * generateMaze() carves a perfect maze (one way between any two
+ * cells) with a depth first search from the start, then takes out
+ * loop_percent of the walls left to make loops. Both follow the
+ * competition rules, checked by checkMazeRules():
+ *  - The goal is the center 2x2 (the center cell on odd sizes), open
+ *    inside, with a single entrance
+ *  - The start cell (0, 0) has a wall on its East side
+ *  - Every post touches at least one wall, except the one in the
+ *    middle of the goal
+ *  - Every cell can be reached from the start
+ *
+ * writeMazeCorpus() writes generated mazes as a .maz corpus, see
+ * maze_file.h. Maze i of a corpus only depends on the corpus seed and
+ * i, so any part of a corpus can be made again on its own.
+ */
+
+#ifndef _MAZE_GENERATOR_H_
+#define _MAZE_GENERATOR_H_
+
+#ifndef ARDUINO
+
+#include "strategy.h"
+#include "../settings.h"
+#include "../localization/probabilistic_maze.h"
+
+
+/* The next of the generator's random numbers, from 0 to n - 1 */
+inline int mazeRandom(unsigned int* seed, int n) {
+    *seed = *seed * 1103515245 + 12345;
+    return (int) ((*seed >> 16) % n);
+}
+
+/* Seed of maze i of a corpus, mixed so neighboring mazes do not start from neighboring seeds */
+inline unsigned int corpusMazeSeed(unsigned int corpus_seed, int i) {
+    unsigned int seed = corpus_seed ^ ((unsigned int) i * 0x9E3779B9u);
+    seed ^= seed >> 16;
+    seed *= 0x85EBCA6Bu;
+    seed ^= seed >> 13;
+    seed *= 0xC2B2AE35u;
+    return seed ^ (seed >> 16);
+}
+
+/* First and last goal column (or row) of a maze size cells across */
+constexpr int goalFirst(int size) {
+    return (size - 1) / 2;
+}
+
+constexpr int goalLast(int size) {
+    return size / 2;
+}
+
+template <int W, int H>
+inline bool isGridGoalCell(int x, int y) {
+    return x >= goalFirst(W) && x <= goalLast(W) && y >= goalFirst(H) && y <= goalLast(H);
+}
+
+/* Walls touching post [px,py], the top left corner of cell [px,py], 0 <= px <= W and 0 <= py <= H */
+template <int W, int H>
+int postWalls(const probabilistic_grid_t<W, H>* maze, int px, int py) {
+    int walls = 0;
+    if (px > 0) walls += wallExists(&maze->horizontal_walls[horizontalWallIndex<W>(px - 1, py)]);
+    if (px < W) walls += wallExists(&maze->horizontal_walls[horizontalWallIndex<W>(px, py)]);
+    if (py > 0) walls += wallExists(&maze->vertical_walls[verticalWallIndex<W>(px, py - 1)]);
+    if (py < H) walls += wallExists(&maze->vertical_walls[verticalWallIndex<W>(px, py)]);
+    return walls;
+}
+
+/* Is [px,py] the post in the middle of the goal, the one post with no walls */
+template <int W, int H>
+inline bool isGoalPost(int px, int py) {
+    return goalFirst(W) != goalLast(W) && goalFirst(H) != goalLast(H) && px == goalLast(W) && py == goalLast(H);
+}
+
+/* generate maze
+ * Make maze a random maze from seed that follows the competition rules, perfect if loop_percent is 0,
+ * otherwise each wall that can go (not around the goal, not the start's East wall and not the last
+ * wall on a post) is taken out with a chance of loop_percent in 100 */
+template <int W, int H>
+void generateMaze(probabilistic_grid_t<W, H>* maze, unsigned int seed, int loop_percent) {
+    const int step[4][2] = { { 0, -1 }, { 1, 0 }, { 0, 1 }, { -1, 0 } };
+    bool visited[W * H];
+    int stack[W * H];
+
+    for (int n = 0; n < probabilistic_grid_t<W, H>::num_walls; n++) {
+        mazeWallByNumber(maze, n)->log_odds = WALL_LOG_ODDS_MAX;
+    }
+    for (int x = 0; x < W; x++) {
+        for (int y = 0; y < H; y++) {
+            // The goal is carved separately, the search goes around it
+            visited[y * W + x] = isGridGoalCell<W, H>(x, y);
+            if (isGridGoalCell<W, H>(x, y) && isGridGoalCell<W, H>(x + 1, y)) {
+                mazeWall(maze, x, y, East)->log_odds = -WALL_LOG_ODDS_MAX;
+            }
+            if (isGridGoalCell<W, H>(x, y) && isGridGoalCell<W, H>(x, y + 1)) {
+                mazeWall(maze, x, y, South)->log_odds = -WALL_LOG_ODDS_MAX;
+            }
+        }
+    }
+
+    // Depth first search from the start, never through the start's East wall
+    int top = 0;
+    stack[top++] = 0;
+    visited[0] = true;
+    while (top > 0) {
+        int cell = stack[top - 1];
+        int x = cell % W, y = cell / W;
+        int open[4];
+        int num_open = 0;
+        for (int dir = North; dir <= West; dir++) {
+            int nx = x + step[dir][0], ny = y + step[dir][1];
+            if (nx >= 0 && nx < W && ny >= 0 && ny < H && !visited[ny * W + nx] &&
+                    !(x == 0 && y == 0 && dir == East)) {
+                open[num_open++] = dir;
+            }
+        }
+        if (num_open == 0) {
+            top--;
+            continue;
+        }
+        int dir = open[num_open == 1 ? 0 : mazeRandom(&seed, num_open)];
+        mazeWall(maze, x, y, (Direction) dir)->log_odds = -WALL_LOG_ODDS_MAX;
+        int next = (y + step[dir][1]) * W + x + step[dir][0];
+        visited[next] = true;
+        stack[top++] = next;
+    }
+
+    // One way into the goal, through any of the walls around it
+    const int goal_width = goalLast(W) - goalFirst(W) + 1;
+    const int goal_height = goalLast(H) - goalFirst(H) + 1;
+    int entrance = mazeRandom(&seed, 2 * (goal_width + goal_height));
+    if (entrance < goal_width) {
+        mazeWall(maze, goalFirst(W) + entrance, goalFirst(H), North)->log_odds = -WALL_LOG_ODDS_MAX;
+    } else if ((entrance -= goal_width) < goal_width) {
+        mazeWall(maze, goalFirst(W) + entrance, goalLast(H), South)->log_odds = -WALL_LOG_ODDS_MAX;
+    } else if ((entrance -= goal_width) < goal_height) {
+        mazeWall(maze, goalFirst(W), goalFirst(H) + entrance, West)->log_odds = -WALL_LOG_ODDS_MAX;
+    } else {
+        entrance -= goal_height;
+        mazeWall(maze, goalLast(W), goalFirst(H) + entrance, East)->log_odds = -WALL_LOG_ODDS_MAX;
+    }
+
+    if (loop_percent <= 0) {
+        return;
+    }
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            // The East and South walls of each cell, the ones between two cells
+            for (int dir = East; dir <= South; dir++) {
+                int nx = x + step[dir][0], ny = y + step[dir][1];
+                probabilistic_wall_t* wall = mazeWall(maze, x, y, (Direction) dir);
+                if (nx >= W || ny >= H || !wallExists(wall) || (x == 0 && y == 0 && dir == East) ||
+                        isGridGoalCell<W, H>(x, y) != isGridGoalCell<W, H>(nx, ny) ||
+                        mazeRandom(&seed, 100) >= loop_percent) {
+                    continue;
+                }
+                // The posts at either end of the wall
+                int px1 = dir == East ? x + 1 : x, py1 = dir == East ? y : y + 1;
+                int px2 = x + 1, py2 = y + 1;
+                if (postWalls(maze, px1, py1) > 1 && postWalls(maze, px2, py2) > 1) {
+                    wall->log_odds = -WALL_LOG_ODDS_MAX;
+                }
+            }
+        }
+    }
+}
+
+/* check maze rules
+ * True if maze follows the rules generateMaze() does */
+template <int W, int H>
+bool checkMazeRules(probabilistic_grid_t<W, H>* maze) {
+    const int step[4][2] = { { 0, -1 }, { 1, 0 }, { 0, 1 }, { -1, 0 } };
+
+    if (!wallExists(mazeWall(maze, 0, 0, East))) {
+        return false;
+    }
+    for (int px = 0; px <= W; px++) {
+        for (int py = 0; py <= H; py++) {
+            if ((postWalls(maze, px, py) == 0) != isGoalPost<W, H>(px, py)) {
+                return false;
+            }
+        }
+    }
+
+    // Open inside the goal, one open wall out of it
+    int entrances = 0;
+    for (int x = 0; x < W; x++) {
+        for (int y = 0; y < H; y++) {
+            if (!isGridGoalCell<W, H>(x, y)) {
+                continue;
+            }
+            for (int dir = North; dir <= West; dir++) {
+                bool open = !wallExists(mazeWall(maze, x, y, (Direction) dir));
+                if (isGridGoalCell<W, H>(x + step[dir][0], y + step[dir][1])) {
+                    if (!open) return false;
+                } else {
+                    entrances += open;
+                }
+            }
+        }
+    }
+    if (entrances != 1) {
+        return false;
+    }
+
+    // Every cell reachable from the start
+    bool reached[W * H];
+    int stack[W * H];
+    int top = 0, num_reached = 1;
+    for (int i = 0; i < W * H; i++) {
+        reached[i] = false;
+    }
+    reached[0] = true;
+    stack[top++] = 0;
+    while (top > 0) {
+        int cell = stack[--top];
+        int x = cell % W, y = cell / W;
+        for (int dir = North; dir <= West; dir++) {
+            int next = (y + step[dir][1]) * W + x + step[dir][0];
+            if (!wallExists(mazeWall(maze, x, y, (Direction) dir)) && !reached[next]) {
+                reached[next] = true;
+                stack[top++] = next;
+                num_reached++;
+            }
+        }
+    }
+    return num_reached == W * H;
+}
+
+/* write maze corpus
+ * Write num_mazes MAZE_WIDTH by MAZE_HEIGHT mazes from generateMaze(corpusMazeSeed(corpus_seed, i),
+ * loop_percent) to path as a .maz corpus, returns false if it can not be written */
+bool writeMazeCorpus(const char* path, unsigned int corpus_seed, int num_mazes, int loop_percent);
+
+
+#endif // ARDUINO
+
+#endif //_MAZE_GENERATOR_H_
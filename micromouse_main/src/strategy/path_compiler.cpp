@@ -0,0 +1,173 @@
+/* path_compiler.cpp */
+
+
+#include <math.h>
+
+#include "path_compiler.h"
+#include "../types.h"
+#include "../settings.h"
+
+
+#define HALF_CELL_PITCH ((CELL_LENGTH + WALL_THICKNESS) / 2.0)
+
+
+// Function Declarations
+bool stepDirection(cell_t from, cell_t to, Direction* dir);
+int runLength(const cell_t* cells, int i, int length, Direction dir);
+bool appendTurn(motion_program_t* program, bool right, int run);
+bool appendCommand(motion_program_t* program, MotionCommandType type, int cells);
+
+
+/*----------- Public Functions -----------*/
+
+void initializeMotionProgram(motion_program_t* program, cell_t start, Direction heading) {
+    program->num_commands = 0;
+    program->next_command = 0;
+    program->start = start;
+    program->start_heading = heading;
+    program->end = start;
+    program->end_heading = heading;
+    program->turn_style = TURN_IN_PLACE;
+}
+
+bool compilePath(motion_program_t* program, const cell_t* cells, int length) {
+
+    motion_program_t before = *program;
+    int first = (length > 0 && cells[0].x == program->end.x && cells[0].y == program->end.y) ? 1 : 0;
+
+    for (int i = first; i < length; i++) {
+        Direction dir;
+        if (!stepDirection(program->end, cells[i], &dir)) {
+            *program = before;
+            return false;
+        }
+
+        // Turns are a quarter turn to the right for every step of the Direction enum
+        int turn = (dir - program->end_heading + 4) % 4;
+        bool fits = true;
+        if (turn == 1 || turn == 3) {
+            fits = appendTurn(program, turn == 1, runLength(cells, i, length, dir));
+        } else if (turn == 2) {
+            fits = appendCommand(program, MOTION_TURN_AROUND, 0);
+        }
+
+        // Carry on with the last straight unless movement is already past it
+        int last = program->num_commands - 1;
+        if (turn == 0 && last >= program->next_command && program->commands[last].type == MOTION_STRAIGHT) {
+            program->commands[last].cells++;
+        } else if (fits && appendCommand(program, MOTION_STRAIGHT, 1)) {
+            if (last >= 0 && isArcCommand(&program->commands[last])) {
+                program->commands[last + 1].entry_speed = program->commands[last].exit_speed;
+            }
+        } else {
+            fits = false;
+        }
+
+        if (!fits) {
+            *program = before;
+            return false;
+        }
+        program->end = cells[i];
+        program->end_heading = dir;
+    }
+    return true;
+}
+
+bool isArcCommand(const motion_command_t* command) {
+    return command->type == MOTION_ARC_LEFT || command->type == MOTION_ARC_RIGHT ||
+           command->type == MOTION_ARC_AROUND_LEFT || command->type == MOTION_ARC_AROUND_RIGHT;
+}
+
+double arcReach(const motion_command_t* command) {
+    return command->cells * HALF_CELL_PITCH;
+}
+
+double arcSpeed(double radius) {
+    return fmin((double) STRAIGHT_PROFILE_STABLE_SPEED, sqrt(ARC_LATERAL_ACCEL * radius));
+}
+
+
+/*----------- Private Functions -----------*/
+
+bool stepDirection(cell_t from, cell_t to, Direction* dir) {
+    int dx = to.x - from.x;
+    int dy = to.y - from.y;
+    if (dx == 0 && dy == -1) {
+        *dir = North;
+    } else if (dx == 1 && dy == 0) {
+        *dir = East;
+    } else if (dx == 0 && dy == 1) {
+        *dir = South;
+    } else if (dx == -1 && dy == 0) {
+        *dir = West;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/* Cells from cells[i] on that keep going in dir, at least 1 */
+int runLength(const cell_t* cells, int i, int length, Direction dir) {
+    int run = 1;
+    Direction next;
+    while (i + run < length && stepDirection(cells[i + run - 1], cells[i + run], &next) && next == dir) {
+        run++;
+    }
+    return run;
+}
+
+/* Append a quarter turn after the last straight, as the widest arc that fits if the robot is still moving
+ * into it, on the spot if not
+ * - run is how many cells the path goes on for after the turn as far as it is known, a large arc needs
+ *   two so there is room to stop past it */
+bool appendTurn(motion_program_t* program, bool right, int run) {
+    int last = program->num_commands - 1;
+    if (program->turn_style == TURN_IN_PLACE || last < program->next_command ||
+            program->commands[last].type != MOTION_STRAIGHT) {
+        return appendCommand(program, right ? MOTION_TURN_RIGHT : MOTION_TURN_LEFT, 0);
+    }
+    motion_command_t* straight = &program->commands[last];
+    motion_command_t* before = last > 0 ? &program->commands[last - 1] : NULL;
+
+    // A search arc the same way one cell back that has not started yet becomes an around arc
+    MotionCommandType same_way = right ? MOTION_ARC_RIGHT : MOTION_ARC_LEFT;
+    if (straight->cells == 1 && last - 1 >= program->next_command && before->type == same_way && before->cells == 1) {
+        before->type = right ? MOTION_ARC_AROUND_RIGHT : MOTION_ARC_AROUND_LEFT;
+        program->num_commands--;
+        return true;
+    }
+
+    // What is left of the straight past the arc before it
+    double room = straight->cells * 2 * HALF_CELL_PITCH -
+                  (before != NULL && isArcCommand(before) ? arcReach(before) : 0);
+    int radius;
+    if (program->turn_style == TURN_SPEED_RUN_ARCS && room >= 2 * HALF_CELL_PITCH && run >= 2) {
+        radius = 2;
+    } else if (room >= HALF_CELL_PITCH) {
+        radius = 1;
+    } else {
+        return appendCommand(program, right ? MOTION_TURN_RIGHT : MOTION_TURN_LEFT, 0);
+    }
+
+    if (!appendCommand(program, same_way, radius)) {
+        return false;
+    }
+    double speed = arcSpeed(radius * HALF_CELL_PITCH);
+    program->commands[last + 1].entry_speed = speed;
+    program->commands[last + 1].exit_speed = speed;
+    straight->exit_speed = speed;
+    return true;
+}
+
+/* Every straight starts and ends standing still unless it is next to an arc */
+bool appendCommand(motion_program_t* program, MotionCommandType type, int cells) {
+    if (program->num_commands >= MAX_MOTION_COMMANDS) {
+        return false;
+    }
+    motion_command_t* command = &program->commands[program->num_commands++];
+    command->type = type;
+    command->cells = cells;
+    command->entry_speed = 0;
+    command->exit_speed = 0;
+    return true;
+}
@@ -0,0 +1,94 @@
+/* path_compiler.h
+ *
+ * Compiles a path of neighboring cells into a motion program: a short list
+ * of commands for movement to run one after the other instead of one cell
+ * center at a time. A run of cells in one direction is a single straight,
+ * so the robot holds its speed to the end of it.
+ *
+ *      cells (0,0) (1,0) (2,0) (2,1) (2,2)  facing East
+ *      ->  STRAIGHT 2, TURN_RIGHT, STRAIGHT 2
+ *
+ * Commands can be appended while movement runs the program, a path that
+ * carries on in the direction of a straight that is still running makes
+ * that straight longer.
+ *
+ * With arcs a turn between two straights is driven along a circle without
+ * stopping. The arc starts a reach back from the center of the corner cell
+ * and ends a reach past it, and the straights on either side are that much
+ * shorter:
+ *
+ *      search arc      radius and reach half a cell pitch, wall middle to wall middle
+ *      large arc       radius and reach a cell pitch, cell center to cell center
+ *      around arc      two search arcs the same way with the one cell between
+ *                      them, 180 degrees into the next row or column
+ *
+ * Turns from standing and dead ends stay on the spot.
+ */
+
+#ifndef _PATH_COMPILER_H_
+#define _PATH_COMPILER_H_
+
+#include "strategy.h"
+#include "../types.h"
+#include "../settings.h"
+
+
+#define MAX_MOTION_COMMANDS (MAZE_WIDTH * MAZE_HEIGHT * 2)
+
+enum MotionCommandType {
+    MOTION_STRAIGHT,        // Drive cells cell pitches along the heading
+    MOTION_TURN_LEFT,       // Turn 90 degrees left on the spot
+    MOTION_TURN_RIGHT,      // Turn 90 degrees right on the spot
+    MOTION_TURN_AROUND,     // Turn 180 degrees on the spot
+    MOTION_ARC_LEFT,        // Turn 90 degrees left along an arc of radius cells half cell pitches
+    MOTION_ARC_RIGHT,       // Turn 90 degrees right along an arc of radius cells half cell pitches
+    MOTION_ARC_AROUND_LEFT, // Turn 180 degrees left along an arc of half a cell pitch, one cell to the left
+    MOTION_ARC_AROUND_RIGHT // Turn 180 degrees right along an arc of half a cell pitch, one cell to the right
+};
+
+enum TurnStyle {
+    TURN_IN_PLACE,          // Every turn stops and turns on the spot
+    TURN_SEARCH_ARCS,       // Search and around arcs wherever the robot is moving into the turn
+    TURN_SPEED_RUN_ARCS     // Large arcs where the straights on both sides are long enough, search arcs elsewhere
+};
+
+typedef struct {
+    MotionCommandType type;
+    int cells;              // Number of cells of a MOTION_STRAIGHT, radius of an arc in half cell pitches
+    float entry_speed;      // Speed at the start of a MOTION_STRAIGHT or arc in mm/s
+    float exit_speed;       // Speed to pass the end of a MOTION_STRAIGHT or arc at in mm/s, 0 to stop there
+} motion_command_t;
+
+typedef struct {
+    motion_command_t commands[MAX_MOTION_COMMANDS];
+    int num_commands;
+    int next_command;       // Next command to run, kept by calculateProgramSpeed
+    cell_t start;           // Cell and heading the program starts from
+    Direction start_heading;
+    cell_t end;             // Cell and heading after the last command
+    Direction end_heading;
+    TurnStyle turn_style;   // How compilePath turns, TURN_IN_PLACE unless set after initializeMotionProgram
+} motion_program_t;
+
+
+/* initialize motion program
+ * Empties program, to start in the center of start facing heading */
+void initializeMotionProgram(motion_program_t* program, cell_t start, Direction heading);
+
+/* compile path
+ * Appends the commands to drive cells[0..length-1] from the end of program, cells[0] can be that end
+ * - Returns false, leaving program as it was, if the cells are not neighbors or do not fit */
+bool compilePath(motion_program_t* program, const cell_t* cells, int length);
+
+/* Is command one of the arcs */
+bool isArcCommand(const motion_command_t* command);
+
+/* mm an arc command reaches back from the center of the corner cell, and forward past it */
+double arcReach(const motion_command_t* command);
+
+/* Speed to drive an arc of radius mm at, STRAIGHT_PROFILE_STABLE_SPEED or slower to keep the
+ * sideways acceleration within ARC_LATERAL_ACCEL */
+double arcSpeed(double radius);
+
+
+#endif //_PATH_COMPILER_H_
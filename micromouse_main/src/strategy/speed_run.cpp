@@ -0,0 +1,411 @@
+/* speed_run.cpp */
+
+
+#include <math.h>
+
+#include "speed_run.h"
+#include "../settings.h"
+#include "../util/motion_profile.h"
+#include "../abs.h"
+
+
+#define NO_NODE 0xFFFF
+#define STRAIGHT_REFERENCE_MM (MAZE_WIDTH * MAZE_HEIGHT * CELL_PITCH)  // Longer than any straight in the maze
+
+// Function Declarations
+int speedRunNode(lattice_point_t point, int heading);
+void speedRunNodePoint(int node, lattice_point_t* point, int* heading);
+bool latticeOpen(probabilistic_maze_t* maze_state, lattice_point_t point);
+double segmentLength(lattice_point_t from, lattice_point_t to);
+int octantTurn(int from_heading, int to_heading);
+double turnTimeBetween(int from_heading, int to_heading);
+double remainingTime(lattice_point_t point, lattice_point_t goal);
+static void relaxNode(speed_run_search_t* search, int node, float time, int parent, float priority);
+static int popNode(speed_run_search_t* search);
+static void siftUp(speed_run_search_t* search, int i);
+static void siftDown(speed_run_search_t* search, int i);
+
+// Globals
+const int lattice_step[NUM_DIRECTIONS][2] = { { 0, -1 }, { 1, 0 }, { 0, 1 }, { -1, 0 },
+                                               { 1, -1 }, { 1, 1 }, { -1, 1 }, { -1, -1 } };
+const int heading_octant[NUM_DIRECTIONS] = { 6, 0, 2, 4, 7, 1, 3, 5 };   // Multiples of PI/4 from East
+const motion_limits_t straight_limits = {
+    .max_speed = STRAIGHT_PROFILE_STABLE_SPEED,
+    .max_accel = STRAIGHT_PROFILE_ACCEL,
+    .max_jerk = STRAIGHT_PROFILE_JERK
+};
+
+#ifndef ARDUINO
+/* The search of planSpeedRun without one, host only, see speed_run.h for its size */
+static speed_run_search_t speed_run_search;
+#endif
+
+/* A straight long enough to cruise at STABLE_SPEED, planned once at start up so the search can read
+ * it from any thread */
+typedef struct {
+    motion_profile_t profile;
+    double shortest_cruise;     // Shortest distance that gets to STABLE_SPEED
+} straight_reference_t;
+
+static straight_reference_t planStraightReference(void) {
+    straight_reference_t reference;
+    planMotionProfile(&straight_limits, STRAIGHT_REFERENCE_MM, 0, 0, &reference.profile);
+    const motion_profile_t* profile = &reference.profile;
+    reference.shortest_cruise = profile->time[3] > 0 ? profile->position[3] + (profile->distance - profile->position[4])
+                                                     : INFINITY;
+    return reference;
+}
+
+static const straight_reference_t straight_reference = planStraightReference();
+
+
+/*----------- Public Functions -----------*/
+
+/*
+ * The reference of a segment drives a motion profile from standing to a stop at distance, the robot is done
+ * once the profile has stopped within INNER_TOLERANCE_MM of the end
+ * - A profile that gets to STABLE_SPEED only cruises longer for a longer distance, so those times are
+ *   worked out from straight_reference, the search asks for a lot of them
+ */
+double straightTravelTime(double distance) {
+    if (distance < INNER_TOLERANCE_MM) {
+        return 0;
+    }
+    const motion_profile_t* reference = &straight_reference.profile;
+    if (distance >= straight_reference.shortest_cruise && distance <= STRAIGHT_REFERENCE_MM) {
+        return reference->duration - (STRAIGHT_REFERENCE_MM - distance) / reference->peak_speed;
+    }
+
+    motion_profile_t profile;
+    planMotionProfile(&straight_limits, distance, 0, 0, &profile);
+    return profile.duration;
+}
+
+/*
+ * turnSpeedProfile is the speed of each wheel, in opposite directions, so the robot turns at
+ * 2 * speed / WHEEL_BASE_LENGTH, the same shape as the straight profile in angle
+ */
+double turnTravelTime(double angle) {
+    double rate = 2.0 / WHEEL_BASE_LENGTH;      // rad/s per mm/s of each wheel
+    double slope = TURN_PROFILE_SLOPE;
+    double intercept = TURN_PROFILE_INTERCEPT;
+    double stable_speed = TURN_PROFILE_STABLE_SPEED;
+    double slow_down = (stable_speed - intercept) / slope;
+
+    double time = 0;
+    if (angle > slow_down) {
+        time += (angle - slow_down) / (rate * stable_speed);
+        angle = slow_down;
+    }
+    if (angle > INNER_TOLERANCE_RAD) {
+        time += log((slope * angle + intercept) / (slope * INNER_TOLERANCE_RAD + intercept)) / (rate * slope);
+    }
+    return time;
+}
+
+double predictRunTime(const cell_t* cells, int length, Direction heading) {
+    double cell_time = CELL_PITCH / (double) STRAIGHT_PROFILE_STABLE_SPEED;
+    double stop_time = straightTravelTime(CELL_PITCH) - cell_time;
+
+    double time = 0;
+    bool moving = false;
+    for (int i = 0; i + 1 < length; i++) {
+        cell_t from = cells[i];
+        cell_t to = cells[i + 1];
+        Direction dir = to.y < from.y ? North : to.x > from.x ? East : to.y > from.y ? South : West;
+        if (dir != heading) {
+            time += (moving ? stop_time : 0) + turnTimeBetween(heading, dir);
+            heading = dir;
+            moving = false;
+        }
+        time += cell_time;
+        moving = true;
+    }
+    return time + (moving ? stop_time : 0);
+}
+
+double predictPathTime(const speed_run_path_t* path, lattice_point_t start, Direction heading) {
+    double time = 0;
+    for (int i = 0; i < path->num_segments; i++) {
+        const speed_run_segment_t* segment = &path->segments[i];
+        time += turnTimeBetween(heading, segment->heading) + straightTravelTime(segmentLength(start, segment->end));
+        start = segment->end;
+        heading = segment->heading;
+    }
+    return time;
+}
+
+/* The diagonal passes a post CELL_PITCH / (2 * sqrt(2)) from its center line, the post reaches
+ * WALL_THICKNESS / sqrt(2) of that back toward it. The walls on the post are no closer */
+bool diagonalsClearPosts(void) {
+    double post_distance = (CELL_PITCH / 2.0 - WALL_THICKNESS) * M_SQRT1_2;
+    return post_distance - ROBOT_WIDTH / 2.0 >= DIAGONAL_CLEARANCE_MM;
+}
+
+/* planSpeedRun
+ * - Each step of the search turns on the spot (except the first) and drives straight to a stop,
+ *   costing turnTravelTime + straightTravelTime, so a straight is never split up by a stop
+ * - The heuristic is the straight time for the octile distance to the goal, a lower bound as long
+ *   as a turn takes longer than the time a stop saves */
+#ifndef ARDUINO
+bool planSpeedRun(probabilistic_maze_t* maze_state, cell_t start, Direction heading, cell_t goal,
+                  bool diagonals, speed_run_path_t* path) {
+    return planSpeedRun(&speed_run_search, maze_state, start, heading, goal, diagonals, path);
+}
+#endif // ARDUINO
+
+bool planSpeedRun(speed_run_search_t* search, probabilistic_maze_t* maze_state, cell_t start, Direction heading,
+                  cell_t goal, bool diagonals, speed_run_path_t* path) {
+
+    int num_headings = diagonals && diagonalsClearPosts() ? NUM_DIRECTIONS : 4;
+    double turn_times[5];
+    for (int k = 0; k <= 4; k++) {
+        turn_times[k] = turnTravelTime(k * PI / 4);
+    }
+    lattice_point_t goal_point = { .x = 2 * goal.x + 1, .y = 2 * goal.y + 1 };
+    lattice_point_t start_point = { .x = 2 * start.x + 1, .y = 2 * start.y + 1 };
+
+    for (int i = 0; i < NUM_SPEED_RUN_NODES; i++) {
+        search->time[i] = INFINITY;
+        search->heap_index[i] = NO_NODE;
+    }
+    search->heap_size = 0;
+
+    int start_node = speedRunNode(start_point, heading);
+    relaxNode(search, start_node, 0, NO_NODE, remainingTime(start_point, goal_point));
+
+    int end_node = -1;
+    while (search->heap_size > 0) {
+        int node = popNode(search);
+        lattice_point_t point;
+        int node_heading;
+        speedRunNodePoint(node, &point, &node_heading);
+        if (point.x == goal_point.x && point.y == goal_point.y) {
+            end_node = node;
+            break;
+        }
+
+        for (int next_heading = 0; next_heading < num_headings; next_heading++) {
+            if ((next_heading == node_heading && node != start_node) || speedRunNode(point, next_heading) < 0) {
+                continue;
+            }
+            double turn_time = turn_times[octantTurn(node_heading, next_heading)];
+            double step_length = (CELL_PITCH / 2.0) * (next_heading >= 4 ? M_SQRT2 : 1.0);
+
+            // Every stop along the straight from here
+            lattice_point_t end = point;
+            for (int steps = 1; ; steps++) {
+                end.x += lattice_step[next_heading][0];
+                end.y += lattice_step[next_heading][1];
+                if (!latticeOpen(maze_state, end)) {
+                    break;
+                }
+                int next = speedRunNode(end, next_heading);
+                if (next < 0) {
+                    continue;
+                }
+                float time = search->time[node] + turn_time + straightTravelTime(steps * step_length);
+                if (time < search->time[next]) {
+                    relaxNode(search, next, time, node, time + remainingTime(end, goal_point));
+                }
+            }
+        }
+    }
+
+    path->num_segments = 0;
+    if (end_node < 0) {
+        path->time = INFINITY;
+        return false;
+    }
+
+    // Walk back to the start, then reverse
+    for (int node = end_node; node != start_node; node = search->parent[node]) {
+        speed_run_segment_t* segment = &path->segments[path->num_segments++];
+        int segment_heading;
+        speedRunNodePoint(node, &segment->end, &segment_heading);
+        segment->heading = (Direction) segment_heading;
+    }
+    for (int i = 0, j = path->num_segments - 1; i < j; i++, j--) {
+        speed_run_segment_t temp = path->segments[i];
+        path->segments[i] = path->segments[j];
+        path->segments[j] = temp;
+    }
+
+    // The search adds up floats, the time of the route is worth the doubles
+    path->time = predictPathTime(path, start_point, heading);
+    return true;
+}
+
+
+/*----------- Private Functions -----------*/
+
+/* Node of a stop at point facing heading, -1 if there is none */
+int speedRunNode(lattice_point_t point, int heading) {
+    if (point.x <= 0 || point.x >= 2 * MAZE_WIDTH || point.y <= 0 || point.y >= 2 * MAZE_HEIGHT) {
+        return -1;
+    }
+    bool odd_x = point.x & 1;
+    bool odd_y = point.y & 1;
+
+    if (odd_x && odd_y) {
+        // Center of a cell
+        if (heading >= 4) {
+            return -1;
+        }
+        return ((point.y / 2) * MAZE_WIDTH + point.x / 2) * 4 + heading;
+    }
+    if (!odd_x && !odd_y) {
+        // Wall post
+        return -1;
+    }
+
+    int slot;
+    if (heading >= 4) {
+        slot = heading - 2;
+    } else if (odd_x) {
+        slot = heading == North ? 0 : heading == South ? 1 : -1;
+    } else {
+        slot = heading == East ? 0 : heading == West ? 1 : -1;
+    }
+    if (slot < 0) {
+        return -1;
+    }
+
+    if (odd_x) {
+        // Middle of a horizontal wall
+        return NUM_CENTER_NODES + ((point.y / 2 - 1) * MAZE_WIDTH + point.x / 2) * 6 + slot;
+    }
+    // Middle of a vertical wall
+    return NUM_CENTER_NODES + NUM_HORIZONTAL_WALL_NODES +
+           ((point.y / 2) * (MAZE_WIDTH - 1) + point.x / 2 - 1) * 6 + slot;
+}
+
+void speedRunNodePoint(int node, lattice_point_t* point, int* heading) {
+    if (node < NUM_CENTER_NODES) {
+        *heading = node & 3;
+        point->x = 2 * ((node >> 2) % MAZE_WIDTH) + 1;
+        point->y = 2 * ((node >> 2) / MAZE_WIDTH) + 1;
+        return;
+    }
+
+    node -= NUM_CENTER_NODES;
+    bool horizontal = node < NUM_HORIZONTAL_WALL_NODES;
+    if (!horizontal) {
+        node -= NUM_HORIZONTAL_WALL_NODES;
+    }
+    int slot = node % 6;
+    int wall = node / 6;
+
+    if (horizontal) {
+        point->x = 2 * (wall % MAZE_WIDTH) + 1;
+        point->y = 2 * (wall / MAZE_WIDTH + 1);
+        *heading = slot == 0 ? North : slot == 1 ? South : slot + 2;
+    } else {
+        point->x = 2 * (wall % (MAZE_WIDTH - 1) + 1);
+        point->y = 2 * (wall / (MAZE_WIDTH - 1)) + 1;
+        *heading = slot == 0 ? East : slot == 1 ? West : slot + 2;
+    }
+}
+
+/* If the robot can be at point: the center of a cell or the middle of an open wall inside the maze */
+bool latticeOpen(probabilistic_maze_t* maze_state, lattice_point_t point) {
+    if (point.x <= 0 || point.x >= 2 * MAZE_WIDTH || point.y <= 0 || point.y >= 2 * MAZE_HEIGHT) {
+        return false;
+    }
+    bool odd_x = point.x & 1;
+    bool odd_y = point.y & 1;
+    if (odd_x && odd_y) {
+        return true;
+    }
+    if (odd_x) {
+        return !wallExists(mazeWall(maze_state, point.x / 2, point.y / 2, North));
+    }
+    if (odd_y) {
+        return !wallExists(mazeWall(maze_state, point.x / 2, point.y / 2, West));
+    }
+    return false;
+}
+
+/* mm along a straight or diagonal line of the lattice */
+double segmentLength(lattice_point_t from, lattice_point_t to) {
+    int steps = max(abs(to.x - from.x), abs(to.y - from.y));
+    bool diagonal = to.x != from.x && to.y != from.y;
+    return steps * (CELL_PITCH / 2.0) * (diagonal ? M_SQRT2 : 1.0);
+}
+
+/* Smallest turn between two headings in multiples of PI/4, 0 to 4 */
+int octantTurn(int from_heading, int to_heading) {
+    int turn = (heading_octant[to_heading] - heading_octant[from_heading]) & 7;
+    return turn > 4 ? 8 - turn : turn;
+}
+
+double turnTimeBetween(int from_heading, int to_heading) {
+    return turnTravelTime(octantTurn(from_heading, to_heading) * PI / 4);
+}
+
+/* Time to drive straight to goal along the octile distance */
+double remainingTime(lattice_point_t point, lattice_point_t goal) {
+    int dx = abs(goal.x - point.x);
+    int dy = abs(goal.y - point.y);
+    int diagonal = min(dx, dy);
+    double length = ((max(dx, dy) - diagonal) + diagonal * M_SQRT2) * (CELL_PITCH / 2.0);
+    return straightTravelTime(length);
+}
+
+static void relaxNode(speed_run_search_t* search, int node, float time, int parent, float priority) {
+    search->time[node] = time;
+    search->parent[node] = parent;
+    search->priority[node] = priority;
+    if (search->heap_index[node] == NO_NODE) {
+        search->heap[search->heap_size] = node;
+        search->heap_index[node] = search->heap_size;
+        search->heap_size++;
+    }
+    siftUp(search, search->heap_index[node]);
+}
+
+static int popNode(speed_run_search_t* search) {
+    int top = search->heap[0];
+    search->heap_size--;
+    search->heap[0] = search->heap[search->heap_size];
+    search->heap_index[search->heap[0]] = 0;
+    search->heap_index[top] = NO_NODE;
+    if (search->heap_size > 0) {
+        siftDown(search, 0);
+    }
+    return top;
+}
+
+static void siftUp(speed_run_search_t* search, int i) {
+    uint16_t node = search->heap[i];
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (search->priority[search->heap[parent]] <= search->priority[node]) {
+            break;
+        }
+        search->heap[i] = search->heap[parent];
+        search->heap_index[search->heap[i]] = i;
+        i = parent;
+    }
+    search->heap[i] = node;
+    search->heap_index[node] = i;
+}
+
+static void siftDown(speed_run_search_t* search, int i) {
+    uint16_t node = search->heap[i];
+    while (2 * i + 1 < search->heap_size) {
+        int child = 2 * i + 1;
+        if (child + 1 < search->heap_size &&
+                search->priority[search->heap[child + 1]] < search->priority[search->heap[child]]) {
+            child++;
+        }
+        if (search->priority[node] <= search->priority[search->heap[child]]) {
+            break;
+        }
+        search->heap[i] = search->heap[child];
+        search->heap_index[search->heap[i]] = i;
+        i = child;
+    }
+    search->heap[i] = node;
+    search->heap_index[node] = i;
+}
@@ -0,0 +1,106 @@
+/* speed_run.h
+ *
+ * Time optimal route for the speed run. A route is a list of straight
+ * segments, each costed as a stop, a turn on the spot and a straight.
+ * That is how movement drives a segment from standing, between moving
+ * straights the path compiler drives turns along arcs (path_compiler.h),
+ * so the time is an upper bound there. The segments go between points of
+ * a half cell lattice: the centers of the cells and the middles of the
+ * walls between them. Diagonal segments go from the middle of one open
+ * wall to the next, past the wall posts, which cuts a staircase of cells
+ * into one straight line.
+ *
+ * The travel times are worked out from the motion profile movement's
+ * straights follow and in closed form from turnSpeedProfile, with the
+ * STRAIGHT_PROFILE_* and TURN_PROFILE_* values in settings.h, and the
+ * speed PID assumed to track the profile.
+ *
+ * The search needs NUM_SPEED_RUN_NODES * 14 bytes of scratch, 55 KB for a
+ * 16x16 maze, more than half of the Due's 96 KB of RAM. Only host code
+ * has planSpeedRun without a search, which uses one kept in
+ * speed_run.cpp; the robot would have to find room for the search next
+ * to strategy_context and the motion program and pass it in. Host code
+ * that plans on several threads gives each its own.
+ */
+
+#ifndef _SPEED_RUN_H_
+#define _SPEED_RUN_H_
+
+#include <stdint.h>
+
+#include "strategy.h"
+#include "../types.h"
+#include "../settings.h"
+#include "../localization/probabilistic_maze.h"
+
+
+#define CELL_PITCH (CELL_LENGTH + WALL_THICKNESS)   // Distance between the centers of neighboring cells in mm
+#define MAX_SPEED_RUN_SEGMENTS (MAZE_WIDTH * MAZE_HEIGHT * 2)
+
+/* Search nodes are a stop at a lattice point facing a heading:
+ *  - the center of a cell with one of the four directions
+ *  - the middle of a wall with the two directions through it or one of the four diagonals */
+#define NUM_CENTER_NODES (MAZE_WIDTH * MAZE_HEIGHT * 4)
+#define NUM_HORIZONTAL_WALL_NODES (MAZE_WIDTH * (MAZE_HEIGHT - 1) * 6)
+#define NUM_VERTICAL_WALL_NODES ((MAZE_WIDTH - 1) * MAZE_HEIGHT * 6)
+#define NUM_SPEED_RUN_NODES (NUM_CENTER_NODES + NUM_HORIZONTAL_WALL_NODES + NUM_VERTICAL_WALL_NODES)
+
+/* Point on the half cell lattice, in CELL_PITCH / 2 from the top left of the maze
+ *  - Both odd is the center of cell (x / 2, y / 2), one even is the middle of a wall,
+ *    see latticeNumberToCoordinateDistance */
+typedef struct {
+    int x;
+    int y;
+} lattice_point_t;
+
+/* Turn on the spot to heading, then drive straight to end and stop */
+typedef struct {
+    lattice_point_t end;
+    Direction heading;
+} speed_run_segment_t;
+
+typedef struct {
+    speed_run_segment_t segments[MAX_SPEED_RUN_SEGMENTS];
+    int num_segments;
+    double time;                                // Predicted run time in seconds
+} speed_run_path_t;
+
+/* A* state per node, floats and 16 bit indices keep it at 14 bytes a node */
+typedef struct {
+    float time[NUM_SPEED_RUN_NODES];
+    float priority[NUM_SPEED_RUN_NODES];
+    uint16_t parent[NUM_SPEED_RUN_NODES];
+    uint16_t heap_index[NUM_SPEED_RUN_NODES];   // Position in heap, NO_NODE if not in it
+    uint16_t heap[NUM_SPEED_RUN_NODES];         // Binary min heap of nodes by priority
+    int heap_size;
+} speed_run_search_t;
+
+
+/* Seconds for calculateSegmentSpeed to go distance mm from standing and stop within INNER_TOLERANCE_MM */
+double straightTravelTime(double distance);
+
+/* Seconds for turnController to turn angle radians on the spot and stop within INNER_TOLERANCE_RAD */
+double turnTravelTime(double angle);
+
+/* Predicted seconds to drive cells[0..length-1] starting still, facing heading, and stopping at the end */
+double predictRunTime(const cell_t* cells, int length, Direction heading);
+
+/* Predicted seconds to drive the segments of path from start, facing heading */
+double predictPathTime(const speed_run_path_t* path, lattice_point_t start, Direction heading);
+
+/* True if a diagonal segment passes the wall posts with DIAGONAL_CLEARANCE_MM to spare
+ * - Only as good as ROBOT_WIDTH, robot code passes SPEED_RUN_DIAGONALS as diagonals until it is measured */
+bool diagonalsClearPosts(void);
+
+/* A* for the fastest route from the center of start to the center of goal, walls by wallExists
+ * - diagonals allows diagonal segments, if diagonalsClearPosts()
+ * - Returns false if goal can not be reached */
+#ifndef ARDUINO
+bool planSpeedRun(probabilistic_maze_t* maze_state, cell_t start, Direction heading, cell_t goal,
+                  bool diagonals, speed_run_path_t* path);
+#endif
+bool planSpeedRun(speed_run_search_t* search, probabilistic_maze_t* maze_state, cell_t start, Direction heading,
+                  cell_t goal, bool diagonals, speed_run_path_t* path);
+
+
+#endif //_SPEED_RUN_H_
@@ -3,6 +3,8 @@
 
 
 #include "strategy.h"
+#include "bitboard_maze.h"
+#include "floodfill.h"
 #include "../types.h"
 #include "../settings.h"
 #include "../util/queue.h"
@@ -13,67 +15,144 @@
 
 #define IS_CELL_OUT_OF_BOUNDS(cell) ((cell).x < 0 || (cell).x >= (MAZE_WIDTH) || (cell).y < 0 || (cell).y >= (MAZE_HEIGHT))
 
-/* Simple representation of a cell
- *  - For use with probabilistic_maze_t */
-typedef struct {
-   int x;
-   int y;
-} cell_t;
-
-
 // Function declarations
-void floodfill(probabilistic_maze_t* maze_state, cell_t cell, int value);
+bool updateValues(strategy_context_t* context, probabilistic_maze_t* maze_state);
+int targetCells(strategy_context_t* context, cell_t* cells);
+bool isFloodSource(strategy_context_t* context, cell_t cell);
+void setFloodSources(strategy_context_t* context, const cell_t* cells, int num_cells);
 void convertLocationToCell(gaussian_location_t* location, cell_t* to_return);
 void convertCellToLocation(cell_t* cell, gaussian_location_t* to_return);
-cell_t chooseNextCell(probabilistic_maze_t* robot_maze_state, cell_t* robot_cell);
-void resetValues(void);
-void setAllDiscoveredToFalse(void);
+void resetValues(strategy_context_t* context);
+void setAllDiscoveredToFalse(strategy_context_t* context);
+void recordKnownWalls(strategy_context_t* context, probabilistic_maze_t* maze_state);
+bool openNeighbor(probabilistic_maze_t* maze_state, cell_t cell, Direction dir, cell_t* next);
+bool invalidateCell(strategy_context_t* context, probabilistic_maze_t* maze_state, cell_t cell);
+bool wallCells(int wall_number, cell_t* a, cell_t* b);
+bool queueUpdate(strategy_context_t* context, cell_t cell);
+cell_t nextUpdate(strategy_context_t* context);
 
 
 // Global declarations
-cell_t goal_cell = {
-    .x = GOAL_CELL_X,
-    .y = GOAL_CELL_Y
-};
 
-/* The number of steps away from the goal based on the floodfill algorithm */
-int values[MAZE_WIDTH][MAZE_HEIGHT];
+/* The robot's strategy, the goal is the GOAL_SIZE square unless setGoalCells changes it */
+strategy_context_t strategy_context;
+
+int (&values)[MAZE_WIDTH][MAZE_HEIGHT] = strategy_context.values;
+goal_set_t& goal_set = strategy_context.goal_set;
 
-/* Keeps track of which cells have been discovered already */
-bool discovered[MAZE_WIDTH][MAZE_HEIGHT];
+/* Cell offsets in each Direction */
+const int direction_step[4][2] = { { 0, -1 }, { 1, 0 }, { 0, 1 }, { -1, 0 } };
 
 
 /* initialize strategy
  * Initializes the maze solving algorithm */
 void initializeStrategy(void) {
+    initializeStrategy(&strategy_context);
+}
+
+void initializeStrategy(strategy_context_t* context) {
+
+    resetValues(context);
+    setAllDiscoveredToFalse(context);
+    context->flooded = false;
+    context->num_flood_sources = 0;
+    context->num_invalidated = 0;
+    context->update_front = 0;
+    context->update_count = 0;
+    for (int x = 0; x < MAZE_WIDTH; x++) {
+        for (int y = 0; y < MAZE_HEIGHT; y++) {
+            context->invalidated[x][y] = false;
+            context->queued[x][y] = false;
+        }
+    }
+
+    context->goal_set.num_cells = 0;
+    for (int x = GOAL_CELL_X; x < GOAL_CELL_X + GOAL_SIZE; x++) {
+        for (int y = GOAL_CELL_Y; y < GOAL_CELL_Y + GOAL_SIZE; y++) {
+            context->goal_set.cells[context->goal_set.num_cells++] = (cell_t) { .x = x, .y = y };
+        }
+    }
+    context->target = TARGET_GOAL;
+    context->prev_next_cell = (cell_t) { .x = INIT_CELL_X, .y = INIT_CELL_Y };
+}
+
+/* set goal cells
+ * The goal becomes cells[0..num_cells-1], at most MAX_GOAL_CELLS of them */
+void setGoalCells(const cell_t* cells, int num_cells) {
+    setGoalCells(&strategy_context, cells, num_cells);
+}
+
+void setGoalCells(strategy_context_t* context, const cell_t* cells, int num_cells) {
+    context->goal_set.num_cells = 0;
+    for (int i = 0; i < num_cells && i < MAX_GOAL_CELLS; i++) {
+        context->goal_set.cells[context->goal_set.num_cells++] = cells[i];
+    }
+}
 
-    resetValues();
-    setAllDiscoveredToFalse();
+/* is goal cell
+ * True if cell is one of the goal cells */
+bool isGoalCell(cell_t cell) {
+    return isGoalCell(&strategy_context, cell);
+}
+
+bool isGoalCell(strategy_context_t* context, cell_t cell) {
+    for (int i = 0; i < context->goal_set.num_cells; i++) {
+        if (context->goal_set.cells[i].x == cell.x && context->goal_set.cells[i].y == cell.y) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* set strategy target
+ * Where strategy() and strategyLookahead() go, values are flooded again from there on the next call */
+void setStrategyTarget(StrategyTarget target) {
+    setStrategyTarget(&strategy_context, target);
+}
+
+void setStrategyTarget(strategy_context_t* context, StrategyTarget target) {
+    context->target = target;
+}
+
+/* The cells of the current target, returns how many */
+int targetCells(strategy_context_t* context, cell_t* cells) {
+    if (context->target == TARGET_START) {
+        cells[0] = (cell_t) { .x = INIT_CELL_X, .y = INIT_CELL_Y };
+        return 1;
+    }
+    for (int i = 0; i < context->goal_set.num_cells; i++) {
+        cells[i] = context->goal_set.cells[i];
+    }
+    return context->goal_set.num_cells;
 }
 
 /* strategy
  * Given the robots location and the state of the maze calculate the next location to go to */
 void strategy(gaussian_location_t* robot_location, probabilistic_maze_t* maze_state, gaussian_location_t* next_location) {
+    strategy(&strategy_context, robot_location, maze_state, next_location);
+}
 
-    static cell_t prev_next_cell;
+void strategy(strategy_context_t* context, gaussian_location_t* robot_location, probabilistic_maze_t* maze_state,
+              gaussian_location_t* next_location) {
 
     // Get the current cell
     cell_t robot_cell;
     convertLocationToCell(robot_location, &robot_cell);
 
-    // Update values by floodfill
-    floodfill(maze_state, goal_cell, 0);
+    updateValues(context, maze_state);
 
     // Choose the lowest valued cell we can go to
-    cell_t next_cell = chooseNextCell(maze_state, &robot_cell);
+    cell_t next_cell = chooseNextCell(context, maze_state, &robot_cell);
 
-    if (prev_next_cell.x == next_cell.x && prev_next_cell.y == next_cell.y) {
+    #ifdef ARDUINO
+    if (context->prev_next_cell.x == next_cell.x && context->prev_next_cell.y == next_cell.y) {
         toggleLED(2);
         if (robot_cell.x == next_cell.x && robot_cell.y == next_cell.y) {
             setHighLED(1);
         }
     }
-    prev_next_cell = next_cell;
+    #endif
+    context->prev_next_cell = next_cell;
 
     #ifdef DEBUG_STRATEGY
         Serial.print("DEBUG_STRATEGY: next_cell 2: (");
@@ -87,84 +166,104 @@ void strategy(gaussian_location_t* robot_location, probabilistic_maze_t* maze_st
     convertCellToLocation(&next_cell, next_location);
 }
 
-/* floodfill
- * Implements the floodfill algorithm on the 2d-array values with breadth first search
- * Values should be set to numbers higher than possible to have */
-void floodfill(probabilistic_maze_t* maze_state, cell_t cell, int value) {
-
-    // Reset everything
-    resetValues();
-    setAllDiscoveredToFalse();
-
-    queue<cell_t, MAZE_WIDTH * MAZE_HEIGHT> q(cell_t {
-        .x = 0,
-        .y = 0
-    });
-    queue<cell_t, MAZE_WIDTH * MAZE_HEIGHT> next_q(cell_t {
-        .x = 0,
-        .y = 0
-    });
+/* strategy lookahead
+ * - Drops the waypoints up to the robot's cell, then adds cells after the last one with chooseNextCell
+ * - Starts over from the robot's cell when values changed or the robot left the waypoints */
+void strategyLookahead(gaussian_location_t* robot_location, probabilistic_maze_t* maze_state, waypoints_t* waypoints) {
+    strategyLookahead(&strategy_context, robot_location, maze_state, waypoints);
+}
 
-    discovered[cell.x][cell.y] = true;
+void strategyLookahead(strategy_context_t* context, gaussian_location_t* robot_location,
+                       probabilistic_maze_t* maze_state, waypoints_t* waypoints) {
 
-    q.push(cell);
+    cell_t robot_cell;
+    convertLocationToCell(robot_location, &robot_cell);
 
-    while (!q.empty() || !next_q.empty()) {
+    bool changed = updateValues(context, maze_state);
 
-        if (q.empty()) {
-            swap(q, next_q);
-            value++;
+    int reached = -1;
+    for (int i = 0; i < waypoints->count; i++) {
+        cell_t cell = waypointAt(waypoints, i);
+        if (cell.x == robot_cell.x && cell.y == robot_cell.y) {
+            reached = i;
+            break;
         }
+    }
 
-        cell = q.pop();
+    if (reached >= 0 && !changed) {
+        waypoints->front = (waypoints->front + reached + 1) % LOOKAHEAD_CELLS;
+        waypoints->count -= reached + 1;
+        waypoints->from = robot_cell;
+    } else if (changed || waypoints->from.x != robot_cell.x || waypoints->from.y != robot_cell.y) {
+        waypoints->front = 0;
+        waypoints->count = 0;
+        waypoints->from = robot_cell;
+    }
 
-        // Update the cell
-        if (IS_CELL_OUT_OF_BOUNDS(cell)) {
-            continue;
-        }
-        values[cell.x][cell.y] = value;
-
-        // For each direction, east(-1, 0), north(0, -1), west(1, 0), south(0, 1)
-        // if we haven't been there and we can get there, go there
-        cell_t next;
-
-        // Check North(0, -1)
-        next.x = cell.x; next.y = cell.y-1;
-        if (!IS_CELL_OUT_OF_BOUNDS(next)) {
-            if (!discovered[next.x][next.y] && maze_state->cells[cell.x][cell.y].north->exists < WALL_THRESHOLD) {
-                discovered[next.x][next.y] = true;
-                next_q.push(next);
-            }
+    cell_t last = waypoints->count > 0 ? waypointAt(waypoints, waypoints->count - 1) : waypoints->from;
+    while (waypoints->count < LOOKAHEAD_CELLS) {
+        cell_t next = chooseNextCell(context, maze_state, &last);
+        if (next.x == last.x && next.y == last.y) {
+            break;
         }
+        waypoints->cells[(waypoints->front + waypoints->count++) % LOOKAHEAD_CELLS] = next;
+        last = next;
+    }
+}
 
-        // Check East(1, 0)
-        next.x = cell.x+1; next.y = cell.y;
-        if (!IS_CELL_OUT_OF_BOUNDS(next)) {
-            if (!discovered[next.x][next.y] && maze_state->cells[cell.x][cell.y].east->exists < WALL_THRESHOLD) {
-                discovered[next.x][next.y] = true;
-                next_q.push(next);
-            }
-        }
+/* Update values by floodfill, after the first one only repair values around walls that changed
+ *  - Returns true if values may have changed */
+bool updateValues(strategy_context_t* context, probabilistic_maze_t* maze_state) {
 
-        // Check South(0, 1)
-        next.x = cell.x; next.y = cell.y+1;
-        if (!IS_CELL_OUT_OF_BOUNDS(next)) {
-            if (!discovered[next.x][next.y] && maze_state->cells[cell.x][cell.y].south->exists < WALL_THRESHOLD) {
-                discovered[next.x][next.y] = true;
-                next_q.push(next);
-            }
-        }
+    cell_t target[MAX_GOAL_CELLS];
+    int num_target = targetCells(context, target);
+    bool same_target = context->flooded && num_target == context->num_flood_sources;
+    for (int i = 0; i < num_target && same_target; i++) {
+        same_target = isFloodSource(context, target[i]);
+    }
 
-        // Check West(-1, 0)
-        next.x = cell.x-1; next.y = cell.y;
-        if (!IS_CELL_OUT_OF_BOUNDS(next)) {
-            if (!discovered[next.x][next.y] && maze_state->cells[cell.x][cell.y].west->exists < WALL_THRESHOLD) {
-                discovered[next.x][next.y] = true;
-                next_q.push(next);
-            }
-        }
+    if (!same_target) {
+        // Same values as floodfill, the bitboard flood is faster
+        bitboard_maze_t bitboard;
+        buildBitboardMaze(maze_state, &bitboard);
+        bitboardFloodfillCells(&bitboard, target, num_target, 0, context->values);
+        recordKnownWalls(context, maze_state);
+        setFloodSources(context, target, num_target);
+        return true;
     }
-    
+
+    int num_changed = findChangedWalls(context, maze_state, context->changed_walls);
+    if (num_changed > 0) {
+        updateFloodfill(context, maze_state, context->changed_walls, num_changed);
+        return true;
+    }
+    return false;
+}
+
+/* floodfill
+ * Implements the floodfill algorithm on the 2d-array values with breadth first search
+ * Values should be set to numbers higher than possible to have */
+void floodfill(probabilistic_maze_t* maze_state, cell_t cell, int value) {
+    floodfillCells(&strategy_context, maze_state, &cell, 1, value);
+}
+
+void floodfill(strategy_context_t* context, probabilistic_maze_t* maze_state, cell_t cell, int value) {
+    floodfillCells(context, maze_state, &cell, 1, value);
+}
+
+/* floodfill cells
+ * floodfill from every one of cells at once, each cell gets the steps to the closest of them plus value */
+void floodfillCells(probabilistic_maze_t* maze_state, const cell_t* cells, int num_cells, int value) {
+    floodfillCells(&strategy_context, maze_state, cells, num_cells, value);
+}
+
+void floodfillCells(strategy_context_t* context, probabilistic_maze_t* maze_state, const cell_t* cells, int num_cells,
+                    int value) {
+
+    recordKnownWalls(context, maze_state);
+    setFloodSources(context, cells, num_cells);
+    floodfillGrid(maze_state, cells, num_cells, value, context->values, context->discovered);
+
     // // Print out the maze for debugging
     // printf("\n");
     // for (int i=0; i<MAZE_WIDTH; i++){
@@ -187,19 +286,19 @@ void floodfill(probabilistic_maze_t* maze_state, cell_t cell, int value) {
         Serial.println("DEBUG_STRATEGY: ");
         for (int i=0; i<MAZE_WIDTH; i++){
             for (int j=0; j<MAZE_HEIGHT; j++){
-                if (values[i][j] <10){
+                if (context->values[i][j] <10){
                     Serial.print("  ");
-                    Serial.print(values[i][j]);
+                    Serial.print(context->values[i][j]);
                     Serial.print("  |");
                 }
-                else if (values[i][j] < 100){
+                else if (context->values[i][j] < 100){
                     Serial.print(" ");
-                    Serial.print(values[i][j]);
+                    Serial.print(context->values[i][j]);
                     Serial.print("  |");
                 }
                 else{
                     Serial.print(" ");
-                    Serial.print(values[i][j]);
+                    Serial.print(context->values[i][j]);
                     Serial.print(" |");
                 }
             }
@@ -209,6 +308,215 @@ void floodfill(probabilistic_maze_t* maze_state, cell_t cell, int value) {
     #endif
 }
 
+/* Find the walls whose wallExists() changed since values was computed
+ *  - Fills changed_walls with their wall numbers (see mazeWallByNumber) and returns how many,
+ *    changed_walls must have room for NUM_WALLS
+ *  - The returned walls are recorded as known, pass them to updateFloodfill */
+int findChangedWalls(probabilistic_maze_t* maze_state, int* changed_walls) {
+    return findChangedWalls(&strategy_context, maze_state, changed_walls);
+}
+
+int findChangedWalls(strategy_context_t* context, probabilistic_maze_t* maze_state, int* changed_walls) {
+    int count = 0;
+    for (int n = 0; n < NUM_WALLS; n++) {
+        bool exists = wallExists(mazeWallByNumber(maze_state, n));
+        if (exists != context->known_walls[n]) {
+            context->known_walls[n] = exists;
+            changed_walls[count++] = n;
+        }
+    }
+    return count;
+}
+
+/* updateFloodfill
+ * Repairs values after the walls in changed_walls changed, giving the same values as a new floodfill
+ * from the same cell
+ *  - Closed walls: cells whose every shortest path went through the wall are invalidated, spreading
+ *    to the cells that only had paths through those
+ *  - Opened walls and the invalidated cells are then relaxed outward from their valid neighbors
+ *  - Only the cells around the changed walls are visited */
+void updateFloodfill(probabilistic_maze_t* maze_state, const int* changed_walls, int num_changed) {
+    updateFloodfill(&strategy_context, maze_state, changed_walls, num_changed);
+}
+
+void updateFloodfill(strategy_context_t* context, probabilistic_maze_t* maze_state, const int* changed_walls,
+                     int num_changed) {
+
+    context->num_invalidated = 0;
+    bool queued_all = true;
+
+    // Closed walls first, either side may have lost its shortest path (the farther one, unless an
+    // earlier wall already invalidated the other)
+    cell_t a, b;
+    for (int i = 0; i < num_changed; i++) {
+        if (context->known_walls[changed_walls[i]] && wallCells(changed_walls[i], &a, &b)) {
+            queued_all &= invalidateCell(context, maze_state, a);
+            queued_all &= invalidateCell(context, maze_state, b);
+        }
+    }
+
+    // Opened walls, either side may now be closer through the other
+    for (int i = 0; i < num_changed; i++) {
+        if (!context->known_walls[changed_walls[i]] && wallCells(changed_walls[i], &a, &b)) {
+            queued_all &= queueUpdate(context, a);
+            queued_all &= queueUpdate(context, b);
+        }
+    }
+
+    // Invalidated cells start over from their valid neighbors
+    for (int i = 0; i < context->num_invalidated; i++) {
+        cell_t cell = context->invalidated_cells[i];
+        for (int dir = North; dir <= West; dir++) {
+            cell_t next;
+            if (openNeighbor(maze_state, cell, (Direction) dir, &next) && context->values[next.x][next.y] != MAX_VALUE) {
+                queued_all &= queueUpdate(context, next);
+            }
+        }
+    }
+    for (int i = 0; i < context->num_invalidated; i++) {
+        context->invalidated[context->invalidated_cells[i].x][context->invalidated_cells[i].y] = false;
+    }
+
+    // Relax outward until no value drops, a cell can be queued again once it has been popped
+    while (queued_all && context->update_count > 0) {
+        cell_t cell = nextUpdate(context);
+
+        if (context->values[cell.x][cell.y] == MAX_VALUE) {
+            continue;
+        }
+        for (int dir = North; dir <= West; dir++) {
+            cell_t next;
+            if (openNeighbor(maze_state, cell, (Direction) dir, &next) &&
+                    context->values[cell.x][cell.y] + 1 < context->values[next.x][next.y]) {
+                context->values[next.x][next.y] = context->values[cell.x][cell.y] + 1;
+                queued_all &= queueUpdate(context, next);
+            }
+        }
+    }
+
+    // A cell the queue had no room for would keep a stale value, flood again from the sources instead
+    if (!queued_all && context->num_flood_sources > 0) {
+        while (context->update_count > 0) {
+            nextUpdate(context);
+        }
+        cell_t sources[MAX_GOAL_CELLS];
+        int num_sources = context->num_flood_sources;
+        for (int i = 0; i < num_sources; i++) {
+            sources[i] = context->flood_sources[i];
+        }
+        floodfillCells(context, maze_state, sources, num_sources, context->values[sources[0].x][sources[0].y]);
+    }
+}
+
+/* Invalidate cell if no open neighbor is one step closer, then the neighbors it was the only support for
+ *  - Invalidated cells are set to MAX_VALUE, marked in invalidated and added to invalidated_cells
+ *  - Uses update_queue and leaves it empty, false if a cell did not fit in it */
+bool invalidateCell(strategy_context_t* context, probabilistic_maze_t* maze_state, cell_t cell) {
+
+    bool queued_all = queueUpdate(context, cell);
+
+    while (context->update_count > 0) {
+        cell = nextUpdate(context);
+        int value = context->values[cell.x][cell.y];
+
+        if (context->invalidated[cell.x][cell.y] || value == MAX_VALUE || isFloodSource(context, cell)) {
+            continue;
+        }
+
+        // Still supported by another neighbor
+        bool supported = false;
+        for (int dir = North; dir <= West && !supported; dir++) {
+            cell_t next;
+            supported = openNeighbor(maze_state, cell, (Direction) dir, &next) &&
+                        !context->invalidated[next.x][next.y] && context->values[next.x][next.y] == value - 1;
+        }
+        if (supported) {
+            continue;
+        }
+
+        context->invalidated[cell.x][cell.y] = true;
+        context->invalidated_cells[context->num_invalidated++] = cell;
+        context->values[cell.x][cell.y] = MAX_VALUE;
+
+        // Neighbors that may have been supported by this cell
+        for (int dir = North; dir <= West; dir++) {
+            cell_t next;
+            if (openNeighbor(maze_state, cell, (Direction) dir, &next) && context->values[next.x][next.y] == value + 1) {
+                queued_all &= queueUpdate(context, next);
+            }
+        }
+    }
+    return queued_all;
+}
+
+/* The two cells on either side of wall number wall_number, false for a wall on the border */
+bool wallCells(int wall_number, cell_t* a, cell_t* b) {
+    int n = wall_number;
+    if (n < NUM_HORIZONTAL_WALLS) {
+        b->x = n % MAZE_WIDTH; b->y = n / MAZE_WIDTH;
+        a->x = b->x; a->y = b->y - 1;
+    } else {
+        n -= NUM_HORIZONTAL_WALLS;
+        b->x = n % (MAZE_WIDTH + 1); b->y = n / (MAZE_WIDTH + 1);
+        a->x = b->x - 1; a->y = b->y;
+    }
+    return !IS_CELL_OUT_OF_BOUNDS(*a) && !IS_CELL_OUT_OF_BOUNDS(*b);
+}
+
+/* Add cell to the back of update_queue unless it is already waiting there, false if there is no room */
+bool queueUpdate(strategy_context_t* context, cell_t cell) {
+    if (context->queued[cell.x][cell.y]) {
+        return true;
+    }
+    if (context->update_count == MAZE_WIDTH * MAZE_HEIGHT) {
+        return false;
+    }
+    context->queued[cell.x][cell.y] = true;
+    context->update_queue[(context->update_front + context->update_count++) % (MAZE_WIDTH * MAZE_HEIGHT)] = cell;
+    return true;
+}
+
+/* Take the cell at the front of update_queue, which must not be empty */
+cell_t nextUpdate(strategy_context_t* context) {
+    cell_t cell = context->update_queue[context->update_front];
+    context->update_front = (context->update_front + 1) % (MAZE_WIDTH * MAZE_HEIGHT);
+    context->update_count--;
+    context->queued[cell.x][cell.y] = false;
+    return cell;
+}
+
+/* Is cell one of the cells values was flooded from */
+bool isFloodSource(strategy_context_t* context, cell_t cell) {
+    for (int i = 0; i < context->num_flood_sources; i++) {
+        if (context->flood_sources[i].x == cell.x && context->flood_sources[i].y == cell.y) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void setFloodSources(strategy_context_t* context, const cell_t* cells, int num_cells) {
+    context->num_flood_sources = 0;
+    for (int i = 0; i < num_cells && i < MAX_GOAL_CELLS; i++) {
+        context->flood_sources[context->num_flood_sources++] = cells[i];
+    }
+    context->flooded = true;
+}
+
+/* Is there a cell in dir of cell without a wall between them, if so set next to it */
+bool openNeighbor(probabilistic_maze_t* maze_state, cell_t cell, Direction dir, cell_t* next) {
+    next->x = cell.x + direction_step[dir][0];
+    next->y = cell.y + direction_step[dir][1];
+    return !IS_CELL_OUT_OF_BOUNDS(*next) && !wallExists(mazeWall(maze_state, cell.x, cell.y, dir));
+}
+
+/* Record wallExists() of every wall as known_walls */
+void recordKnownWalls(strategy_context_t* context, probabilistic_maze_t* maze_state) {
+    for (int n = 0; n < NUM_WALLS; n++) {
+        context->known_walls[n] = wallExists(mazeWallByNumber(maze_state, n));
+    }
+}
+
 /* Uses the mean location to determine the cell this location is in */
 void convertLocationToCell(gaussian_location_t* location, cell_t* to_return) {
     to_return->x = (int) (location->x_mu / (WALL_THICKNESS + CELL_LENGTH));
@@ -223,6 +531,10 @@ void convertCellToLocation(cell_t* cell, gaussian_location_t* to_return) {
 
 /* Return the next cell that we can go to with the lowest value */
 cell_t chooseNextCell(probabilistic_maze_t* robot_maze_state, cell_t* robot_cell) {
+    return chooseNextCell(&strategy_context, robot_maze_state, robot_cell);
+}
+
+cell_t chooseNextCell(strategy_context_t* context, probabilistic_maze_t* robot_maze_state, cell_t* robot_cell) {
 
     int x = robot_cell->x;
     int y = robot_cell->y;
@@ -242,38 +554,39 @@ cell_t chooseNextCell(probabilistic_maze_t* robot_maze_state, cell_t* robot_cell
 
     // Check each direction and save the lowest valued direction that we can go to
 
-    if (robot_cell->x == goal_cell.x && robot_cell->y == goal_cell.y) {
+    // Arrived at any of the cells values was flooded from
+    if (isFloodSource(context, *robot_cell)) {
         return next_cell;
     }
     
     // Check North(0, -1)
-    if (values[x][y - 1] < lowest_value && robot_maze_state->cells[x][y].north->exists < WALL_THRESHOLD) {
+    if (context->values[x][y - 1] < lowest_value && !wallExists(mazeWall(robot_maze_state, x, y, North))) {
         // Choose North
-        lowest_value = values[x][y - 1];
+        lowest_value = context->values[x][y - 1];
         next_cell.x = x;
         next_cell.y = y - 1;
     }
 
     // Check East(1, 0)
-    if (values[x + 1][y] < lowest_value && robot_maze_state->cells[x][y].east->exists < WALL_THRESHOLD) {
+    if (context->values[x + 1][y] < lowest_value && !wallExists(mazeWall(robot_maze_state, x, y, East))) {
         // Choose East
-        lowest_value = values[x + 1][y];
+        lowest_value = context->values[x + 1][y];
         next_cell.x = x + 1;
         next_cell.y = y;
     }
 
     // Check South(0, 1)
-    if (values[x][y + 1] < lowest_value && robot_maze_state->cells[x][y].south->exists < WALL_THRESHOLD) {
+    if (context->values[x][y + 1] < lowest_value && !wallExists(mazeWall(robot_maze_state, x, y, South))) {
         // Choose South
-        lowest_value = values[x][y + 1];
+        lowest_value = context->values[x][y + 1];
         next_cell.x = x;
         next_cell.y = y + 1;
     }
 
     // Check West(-1, 0)
-    if (values[x - 1][y] < lowest_value && robot_maze_state->cells[x][y].west->exists < WALL_THRESHOLD) {
+    if (context->values[x - 1][y] < lowest_value && !wallExists(mazeWall(robot_maze_state, x, y, West))) {
         // Choose West
-        lowest_value = values[x - 1][y];
+        lowest_value = context->values[x - 1][y];
         next_cell.x = x - 1;
         next_cell.y = y;
     }
@@ -282,18 +595,18 @@ cell_t chooseNextCell(probabilistic_maze_t* robot_maze_state, cell_t* robot_cell
 }
 
 /* Resets Values 2d-array back MAX_VALUE */
-void resetValues(void) {
+void resetValues(strategy_context_t* context) {
     for (int x = 0; x < MAZE_WIDTH; x++) {
         for (int y = 0; y < MAZE_HEIGHT; y++) {
-            values[x][y] = MAX_VALUE;
+            context->values[x][y] = MAX_VALUE;
         }
     }
 }
 
-void setAllDiscoveredToFalse(void){
+void setAllDiscoveredToFalse(strategy_context_t* context){
     for (int i=0; i<MAZE_WIDTH; i++){
         for (int j=0; j<MAZE_HEIGHT; j++){
-            discovered[i][j] = false;
+            context->discovered[i][j] = false;
         }
     }
 }
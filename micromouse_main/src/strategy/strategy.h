@@ -5,16 +5,141 @@
 #define _STRATEGY_H_
 
 #include "../types.h"
+#include "../settings.h"
 #include "../localization/probabilistic_maze.h"
 
 
+/* Simple representation of a cell
+ *  - For use with probabilistic_maze_t */
+typedef struct {
+   int x;
+   int y;
+} cell_t;
+
+#define MAX_GOAL_CELLS (GOAL_SIZE * GOAL_SIZE)
+
+/* Cells that all count as the goal, any of them is an arrival */
+typedef struct {
+    cell_t cells[MAX_GOAL_CELLS];
+    int num_cells;
+} goal_set_t;
+
+enum StrategyTarget {
+    TARGET_GOAL,        // Any cell of the goal set
+    TARGET_START        // Back to (INIT_CELL_X, INIT_CELL_Y)
+};
+
+/* The next cells on the way to the goal, a ring buffer filled by strategyLookahead
+ *  - from is the cell the robot was in, the first waypoint is the cell after it */
+typedef struct {
+    cell_t cells[LOOKAHEAD_CELLS];
+    int front;
+    int count;
+    cell_t from;
+} waypoints_t;
+
+/* The i-th waypoint, 0 is the next cell to go to */
+static inline cell_t waypointAt(const waypoints_t* waypoints, int i) {
+    return waypoints->cells[(waypoints->front + i) % LOOKAHEAD_CELLS];
+}
+
+
+/* Everything strategy() keeps from one call to the next, one per robot (or per maze a host
+ * benchmark runs at the same time)
+ *  - The functions without a context use strategy_context, the robot's */
+typedef struct {
+    goal_set_t goal_set;                                // See setGoalCells
+    StrategyTarget target;                              // See setStrategyTarget
+
+    int values[MAZE_WIDTH][MAZE_HEIGHT];                // Steps to the flood sources
+    bool discovered[MAZE_WIDTH][MAZE_HEIGHT];           // Scratch of floodfill, the cells it has queued
+    bool known_walls[NUM_WALLS];                        // wallExists() of every wall as values was computed with
+
+    cell_t flood_sources[MAX_GOAL_CELLS];               // The cells the last floodfill started from
+    int num_flood_sources;
+    bool flooded;
+
+    // Scratch of updateFloodfill: cells that lost their path to the flood sources, cells waiting in
+    // the queue (each at most once, see queued), walls found by findChangedWalls
+    bool invalidated[MAZE_WIDTH][MAZE_HEIGHT];
+    bool queued[MAZE_WIDTH][MAZE_HEIGHT];
+    cell_t invalidated_cells[MAZE_WIDTH * MAZE_HEIGHT];
+    int num_invalidated;
+    cell_t update_queue[MAZE_WIDTH * MAZE_HEIGHT];
+    int update_front;
+    int update_count;
+    int changed_walls[NUM_WALLS];
+
+    cell_t prev_next_cell;                              // What strategy() chose last time
+} strategy_context_t;
+
+/* The robot's strategy */
+extern strategy_context_t strategy_context;
+
+
 /* initialize strategy
- * Initializes the maze solving algorithm */
+ * Initializes the maze solving algorithm, with the GOAL_SIZE square at (GOAL_CELL_X, GOAL_CELL_Y) as the goal */
 void initializeStrategy(void);
+void initializeStrategy(strategy_context_t* context);
+
+/* set goal cells
+ * The goal becomes cells[0..num_cells-1], at most MAX_GOAL_CELLS of them */
+void setGoalCells(const cell_t* cells, int num_cells);
+void setGoalCells(strategy_context_t* context, const cell_t* cells, int num_cells);
+
+/* is goal cell
+ * True if cell is one of the goal cells */
+bool isGoalCell(cell_t cell);
+bool isGoalCell(strategy_context_t* context, cell_t cell);
+
+/* set strategy target
+ * Where strategy() and strategyLookahead() go, values are flooded again from there on the next call */
+void setStrategyTarget(StrategyTarget target);
+void setStrategyTarget(strategy_context_t* context, StrategyTarget target);
 
 /* strategy
  * Given the robots location and the state of the maze calculate the next location to go to */
 void strategy(gaussian_location_t* robot_location, probabilistic_maze_t* robot_maze_state, gaussian_location_t* next_location);
+void strategy(strategy_context_t* context, gaussian_location_t* robot_location, probabilistic_maze_t* robot_maze_state,
+              gaussian_location_t* next_location);
+
+/* strategy lookahead
+ * Given the robots location and the state of the maze keep waypoints filled with the next
+ * LOOKAHEAD_CELLS cells to go to, fewer if the goal is closer
+ * - Start waypoints with count 0 */
+void strategyLookahead(gaussian_location_t* robot_location, probabilistic_maze_t* robot_maze_state, waypoints_t* waypoints);
+void strategyLookahead(strategy_context_t* context, gaussian_location_t* robot_location,
+                       probabilistic_maze_t* robot_maze_state, waypoints_t* waypoints);
+
+
+/*----------- Private Functions -----------*/
+
+/* The number of steps away from the goal based on the floodfill algorithm, strategy_context.values */
+extern int (&values)[MAZE_WIDTH][MAZE_HEIGHT];
+
+/* The cells of the goal, strategy_context.goal_set, see setGoalCells */
+extern goal_set_t& goal_set;
+
+void floodfill(probabilistic_maze_t* maze_state, cell_t cell, int value);
+void floodfill(strategy_context_t* context, probabilistic_maze_t* maze_state, cell_t cell, int value);
+
+/* floodfill from every one of cells at once (at most MAX_GOAL_CELLS), chooseNextCell stops at any of them */
+void floodfillCells(probabilistic_maze_t* maze_state, const cell_t* cells, int num_cells, int value);
+void floodfillCells(strategy_context_t* context, probabilistic_maze_t* maze_state, const cell_t* cells, int num_cells,
+                    int value);
+
+/* Walls (by wall number, see mazeWallByNumber) whose wallExists() changed since values was computed,
+ * changed_walls needs room for NUM_WALLS, returns the number found */
+int findChangedWalls(probabilistic_maze_t* maze_state, int* changed_walls);
+int findChangedWalls(strategy_context_t* context, probabilistic_maze_t* maze_state, int* changed_walls);
+
+/* Repair values for the walls found by findChangedWalls, the same result as a new floodfill */
+void updateFloodfill(probabilistic_maze_t* maze_state, const int* changed_walls, int num_changed);
+void updateFloodfill(strategy_context_t* context, probabilistic_maze_t* maze_state, const int* changed_walls,
+                     int num_changed);
+
+cell_t chooseNextCell(probabilistic_maze_t* robot_maze_state, cell_t* robot_cell);
+cell_t chooseNextCell(strategy_context_t* context, probabilistic_maze_t* robot_maze_state, cell_t* robot_cell);
 
 
 #endif //_STRATEGY_H_
@@ -0,0 +1,647 @@
+#ifndef ARDUINO
+#include "strategy.h"
+#include "floodfill.h"
+#include "maze_file.h"
+#include "maze_generator.h"
+#include "strategy_test_data.h"
+#include "bitboard_maze.h"
+#include "speed_run.h"
+#include "exploration.h"
+#include "../benchmark.h"
+#include "../settings.h"
+#include "../types.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+
+#define FLOODFILL_REPETITIONS 500
+#define FLOODFILL_RUNS 5    // Best of
+#define IDLE_TICKS 2000
+#define PLAN_REPETITIONS 200
+#define RANDOM_MAZES 200            // Random mazes for the speed run comparison
+#define RANDOM_WALL_PERCENT 30      // Chance of each interior wall in a random maze
+#define CORPUS_MAZES 10000          // Generated mazes in the corpus file
+#define CORPUS_LOOP_PERCENT 10      // Loops in the corpus mazes, see generateMaze
+#define GENERATED_MAZES 200000     // Mazes per generator timing of the robot's maze size
+#define GRID_FLOOD_CELLS 2000000    // Cells flooded per timing of a grid size, so every size takes about as long
+
+// Cortex-M3 (Arduino Due, 84 MHz) cycle estimates for bitboardFloodfill, counted from the loop bodies
+#define DUE_CLOCK_MHZ 84.0
+#define M3_CYCLES_PER_ROW 20       // 7 loads, ~9 ALU ops, 2 stores and the branches of one reach + update
+#define M3_CYCLES_PER_LAYER 12     // Row range bookkeeping and loop setup
+#define M3_CYCLES_PER_CELL 6       // rbit + clz, the store to values and clearing the bit
+
+
+/* ns per floodfill from the goal cell on maze_string, best of FLOODFILL_RUNS */
+double benchmarkFloodfill(const char** maze_string) {
+    static probabilistic_maze_t maze;
+    initializeMaze(&maze);
+    readInMaze(maze_string, &maze);
+
+    cell_t goal = { .x = GOAL_CELL_X, .y = GOAL_CELL_Y };
+
+    double best_ns = 0.0;
+    for (int run = 0; run < FLOODFILL_RUNS; run++) {
+        double start = benchNowNs();
+        for (int r = 0; r < FLOODFILL_REPETITIONS; r++) {
+            floodfill(&maze, goal, 0);
+            benchKeep(values);
+        }
+        double ns = (benchNowNs() - start) / FLOODFILL_REPETITIONS;
+        if (run == 0 || ns < best_ns) best_ns = ns;
+    }
+    return best_ns;
+}
+
+/* ns for the queue floodfill, buildBitboardMaze + bitboardFloodfill and bitboardFloodfill alone
+ * from the goal cell of maze_string, best of FLOODFILL_RUNS */
+typedef struct {
+    double queue_ns;
+    double build_and_flood_ns;
+    double flood_ns;
+    int layers;         // BFS layers from the goal
+    int rows_visited;   // Rows the reach loop went over, summed over the layers
+} bitboard_benchmark_t;
+
+bitboard_benchmark_t benchmarkBitboardFloodfill(const char** maze_string) {
+    static probabilistic_maze_t maze;
+    bitboard_maze_t bitboard;
+    bitboard_benchmark_t result = { 0.0, 0.0, 0.0, 0, 0 };
+    initializeMaze(&maze);
+    readInMaze(maze_string, &maze);
+    cell_t goal = { .x = GOAL_CELL_X, .y = GOAL_CELL_Y };
+
+    result.queue_ns = benchmarkFloodfill(maze_string);
+    for (int run = 0; run < FLOODFILL_RUNS; run++) {
+        double start = benchNowNs();
+        for (int r = 0; r < FLOODFILL_REPETITIONS; r++) {
+            buildBitboardMaze(&maze, &bitboard);
+            bitboardFloodfill(&bitboard, goal, 0);
+            benchKeep(values);
+        }
+        double build_and_flood_ns = (benchNowNs() - start) / FLOODFILL_REPETITIONS;
+
+        start = benchNowNs();
+        for (int r = 0; r < FLOODFILL_REPETITIONS; r++) {
+            bitboardFloodfill(&bitboard, goal, 0);
+            benchKeep(values);
+        }
+        double flood_ns = (benchNowNs() - start) / FLOODFILL_REPETITIONS;
+
+        if (run == 0 || build_and_flood_ns < result.build_and_flood_ns) result.build_and_flood_ns = build_and_flood_ns;
+        if (run == 0 || flood_ns < result.flood_ns) result.flood_ns = flood_ns;
+    }
+
+    // Recover the work done per layer from the values: the reach loop visits the rows of the layer
+    // and one more on each side
+    for (int layer = 0; ; layer++) {
+        int first_row = MAZE_HEIGHT, last_row = -1;
+        for (int x = 0; x < MAZE_WIDTH; x++) {
+            for (int y = 0; y < MAZE_HEIGHT; y++) {
+                if (values[x][y] == layer) {
+                    if (y < first_row) first_row = y;
+                    if (y > last_row) last_row = y;
+                }
+            }
+        }
+        if (last_row < 0) {
+            break;
+        }
+        int from = first_row > 0 ? first_row - 1 : 0;
+        int to = last_row < MAZE_HEIGHT - 1 ? last_row + 1 : MAZE_HEIGHT - 1;
+        result.layers++;
+        result.rows_visited += to - from + 1;
+    }
+    return result;
+}
+
+void printBitboardFloodfill(const char* name, const char** maze_string) {
+    bitboard_benchmark_t result = benchmarkBitboardFloodfill(maze_string);
+    long m3_cycles = (long) result.rows_visited * M3_CYCLES_PER_ROW + (long) result.layers * M3_CYCLES_PER_LAYER +
+                     (long) MAZE_WIDTH * MAZE_HEIGHT * M3_CYCLES_PER_CELL;
+    printf("%-8s\t%8.1f\t%8.1f\t%8.1f\t%7.1f\t%6d\t%6d\t%9ld\t%7.1f\n", name, result.queue_ns,
+            result.build_and_flood_ns, result.flood_ns, result.queue_ns / result.flood_ns, result.layers,
+            result.rows_visited, m3_cycles, m3_cycles / DUE_CLOCK_MHZ);
+}
+
+/* Cost per strategy tick of keeping values up to date, full floodfill vs updateFloodfill */
+typedef struct {
+    double full_ns;             // floodfill every tick
+    double incremental_ns;      // findChangedWalls + updateFloodfill
+    double idle_ns;             // findChangedWalls on a tick where no wall crossed WALL_THRESHOLD
+    int walls_revealed;
+} incremental_benchmark_t;
+
+/* Reveals the walls of maze_string one per tick in a shuffled order, starting from a maze with only
+ * the border known, and times keeping values up to date each tick, best of FLOODFILL_RUNS */
+incremental_benchmark_t benchmarkIncrementalFloodfill(const char** maze_string) {
+    static probabilistic_maze_t target;
+    static probabilistic_maze_t maze;
+    static int reveal[NUM_WALLS];
+    static int changed_walls[NUM_WALLS];
+    incremental_benchmark_t result = { 0.0, 0.0, 0.0, 0 };
+    cell_t goal = { .x = GOAL_CELL_X, .y = GOAL_CELL_Y };
+
+    // The walls that exist in the maze but are not known at the start
+    initializeMaze(&target);
+    readInMaze(maze_string, &target);
+    initializeMaze(&maze);
+    int count = 0;
+    for (int n = 0; n < NUM_WALLS; n++) {
+        if (wallExists(mazeWallByNumber(&target, n)) != wallExists(mazeWallByNumber(&maze, n))) {
+            reveal[count++] = n;
+        }
+    }
+    unsigned int seed = 12345;
+    for (int i = count - 1; i > 0; i--) {
+        seed = seed * 1103515245 + 12345;
+        int j = (seed >> 8) % (i + 1);
+        int temp = reveal[i]; reveal[i] = reveal[j]; reveal[j] = temp;
+    }
+    result.walls_revealed = count;
+
+    for (int run = 0; run < FLOODFILL_RUNS; run++) {
+        initializeMaze(&maze);
+        floodfill(&maze, goal, 0);
+        double start = benchNowNs();
+        for (int i = 0; i < count; i++) {
+            *mazeWallByNumber(&maze, reveal[i]) = *mazeWallByNumber(&target, reveal[i]);
+            floodfill(&maze, goal, 0);
+            benchKeep(values);
+        }
+        double full_ns = (benchNowNs() - start) / count;
+
+        initializeMaze(&maze);
+        floodfill(&maze, goal, 0);
+        start = benchNowNs();
+        for (int i = 0; i < count; i++) {
+            *mazeWallByNumber(&maze, reveal[i]) = *mazeWallByNumber(&target, reveal[i]);
+            int num_changed = findChangedWalls(&maze, changed_walls);
+            updateFloodfill(&maze, changed_walls, num_changed);
+            benchKeep(values);
+        }
+        double incremental_ns = (benchNowNs() - start) / count;
+
+        start = benchNowNs();
+        for (int i = 0; i < IDLE_TICKS; i++) {
+            int num_changed = findChangedWalls(&maze, changed_walls);
+            if (num_changed > 0) {
+                updateFloodfill(&maze, changed_walls, num_changed);
+            }
+            benchKeep(values);
+        }
+        double idle_ns = (benchNowNs() - start) / IDLE_TICKS;
+
+        if (run == 0 || full_ns < result.full_ns) result.full_ns = full_ns;
+        if (run == 0 || incremental_ns < result.incremental_ns) result.incremental_ns = incremental_ns;
+        if (run == 0 || idle_ns < result.idle_ns) result.idle_ns = idle_ns;
+    }
+    return result;
+}
+
+void printIncrementalFloodfill(const char* name, const char** maze_string) {
+    incremental_benchmark_t result = benchmarkIncrementalFloodfill(maze_string);
+    printf("%-8s\t%6d\t%12.1f\t%12.1f\t%8.1f\t%12.1f\n", name, result.walls_revealed, result.full_ns,
+            result.incremental_ns, result.full_ns / result.incremental_ns, result.idle_ns);
+}
+
+/* Number of heading changes along cells starting with heading */
+int countTurns(const cell_t* cells, int length, Direction heading) {
+    int turns = 0;
+    for (int i = 0; i + 1 < length; i++) {
+        Direction dir = cells[i + 1].y < cells[i].y ? North : cells[i + 1].x > cells[i].x ? East :
+                        cells[i + 1].y > cells[i].y ? South : West;
+        if (dir != heading) {
+            turns++;
+            heading = dir;
+        }
+    }
+    return turns;
+}
+
+/* Predicted run time and planning cost of the floodfill route and the planSpeedRun route from the
+ * start to the goal set of maze_string, best of FLOODFILL_RUNS */
+void printSpeedRun(const char* name, const char** maze_string) {
+    static probabilistic_maze_t maze;
+    static cell_t flood_cells[MAZE_WIDTH * MAZE_HEIGHT];
+    static speed_run_path_t path;
+    cell_t start = { .x = INIT_CELL_X, .y = INIT_CELL_Y };
+    initializeMaze(&maze);
+    readInMaze(maze_string, &maze);
+
+    // Both go to the goal cell the floodfill route gets to first
+    int flood_length = floodRoute(&maze, start, flood_cells);
+    cell_t goal = flood_cells[flood_length - 1];
+    double flood_us = 0.0, plan_us = 0.0;
+    for (int run = 0; run < FLOODFILL_RUNS; run++) {
+        double start_ns = benchNowNs();
+        for (int r = 0; r < PLAN_REPETITIONS; r++) {
+            flood_length = floodRoute(&maze, start, flood_cells);
+            benchKeep(flood_cells);
+        }
+        double us = (benchNowNs() - start_ns) / PLAN_REPETITIONS / 1000.0;
+        if (run == 0 || us < flood_us) flood_us = us;
+
+        start_ns = benchNowNs();
+        for (int r = 0; r < PLAN_REPETITIONS; r++) {
+            planSpeedRun(&maze, start, East, goal, false, &path);
+            benchKeep(path);
+        }
+        us = (benchNowNs() - start_ns) / PLAN_REPETITIONS / 1000.0;
+        if (run == 0 || us < plan_us) plan_us = us;
+    }
+
+    double flood_time = predictRunTime(flood_cells, flood_length, East);
+    printf("%-8s\t%5d\t%5d\t%7.2f\t%7.1f\t%5d\t%7.2f\t%7.1f\t%6.1f%%\n", name,
+            flood_length - 1, countTurns(flood_cells, flood_length, East), flood_time, flood_us,
+            path.num_segments, path.time, plan_us,
+            100.0 * (flood_time - path.time) / flood_time);
+}
+
+/* The same comparison averaged over RANDOM_MAZES mazes with random interior walls, skipping those
+ * where the goal can not be reached */
+void printRandomSpeedRuns(void) {
+    static probabilistic_maze_t maze;
+    static cell_t flood_cells[MAZE_WIDTH * MAZE_HEIGHT];
+    static speed_run_path_t path;
+    cell_t start = { .x = INIT_CELL_X, .y = INIT_CELL_Y };
+
+    unsigned int seed = 2024;
+    int mazes = 0, flood_turns = 0, plan_segments = 0, better = 0;
+    double flood_time = 0.0, plan_time = 0.0, flood_us = 0.0, plan_us = 0.0, best_saved = 0.0;
+    for (int m = 0; m < RANDOM_MAZES; m++) {
+        randomMaze(&maze, &seed, RANDOM_WALL_PERCENT);
+
+        double start_ns = benchNowNs();
+        int flood_length = floodRoute(&maze, start, flood_cells);
+        double us = (benchNowNs() - start_ns) / 1000.0;
+        cell_t goal = flood_cells[flood_length - 1];
+        if (!isGoalCell(goal)) {
+            continue;
+        }
+        flood_us += us;
+        start_ns = benchNowNs();
+        planSpeedRun(&maze, start, East, goal, false, &path);
+        plan_us += (benchNowNs() - start_ns) / 1000.0;
+
+        double time = predictRunTime(flood_cells, flood_length, East);
+        double saved = (time - path.time) / time;
+        flood_time += time;
+        plan_time += path.time;
+        flood_turns += countTurns(flood_cells, flood_length, East);
+        plan_segments += path.num_segments;
+        if (saved > 1e-6) better++;
+        if (saved > best_saved) best_saved = saved;
+        mazes++;
+    }
+
+    printf("random  \t%d solvable mazes of %d, planSpeedRun faster on %d, by %.1f%% at most\n",
+            mazes, RANDOM_MAZES, better, 100.0 * best_saved);
+    printf("average \t     \t%5.1f\t%7.2f\t%7.1f\t%5.1f\t%7.2f\t%7.1f\t%6.1f%%\n",
+            (double) flood_turns / mazes, flood_time / mazes, flood_us / mazes,
+            (double) plan_segments / mazes, plan_time / mazes, plan_us / mazes,
+            100.0 * (flood_time - plan_time) / flood_time);
+}
+
+typedef struct {
+    int shortest;           // Steps of the shortest path from the start to the goal
+    int cells_visited;
+    int search_moves;       // Moves until the shortest path was proven
+    int moves;              // Moves until back at the start
+    int greedy_moves;       // Moves of the floodfill strategy to first reach the goal
+    bool greedy_proven;     // Whether the walls seen by then prove a shortest path
+} exploration_benchmark_t;
+
+/* Steps from the start to the goal with the walls of found that were not seen closed */
+int knownShortestPath(probabilistic_maze_t* found, exploration_t* exploration) {
+    static probabilistic_maze_t known_maze;
+    static cell_t cells[MAZE_WIDTH * MAZE_HEIGHT];
+    cell_t start = { .x = INIT_CELL_X, .y = INIT_CELL_Y };
+
+    known_maze = *found;
+    for (int n = 0; n < NUM_WALLS; n++) {
+        if (!exploration->known[n]) {
+            setWallProbability(mazeWallByNumber(&known_maze, n), 1.0);
+        }
+    }
+    int length = floodRoute(&known_maze, start, cells);
+    return isGoalCell(cells[length - 1]) ? length - 1 : MAX_VALUE;
+}
+
+/* Explore truth until the shortest path is proven, and drive the floodfill strategy to the goal
+ * seeing walls the same way, the search run it replaces */
+exploration_benchmark_t benchmarkExploration(probabilistic_maze_t* truth) {
+    static probabilistic_maze_t found;
+    static exploration_t exploration;
+    static cell_t cells[MAZE_WIDTH * MAZE_HEIGHT];
+    cell_t start = { .x = INIT_CELL_X, .y = INIT_CELL_Y };
+    exploration_benchmark_t result;
+
+    result.shortest = floodRoute(truth, start, cells) - 1;
+    result.moves = exploreMaze(truth, &found, &exploration, &result.search_moves, &result.cells_visited);
+
+    initializeMaze(&found);
+    initializeExploration(&exploration);
+    cell_t cell = start;
+    result.greedy_moves = 0;
+    while (!isGoalCell(cell) && result.greedy_moves < 4 * MAZE_WIDTH * MAZE_HEIGHT) {
+        revealCell(truth, &found, cell);
+        updateKnownWalls(&exploration, &found);
+        floodfillCells(&found, goal_set.cells, goal_set.num_cells, 0);
+        cell = chooseNextCell(&found, &cell);
+        result.greedy_moves++;
+    }
+    revealCell(truth, &found, cell);
+    updateKnownWalls(&exploration, &found);
+    result.greedy_proven = knownShortestPath(&found, &exploration) == result.shortest;
+    return result;
+}
+
+void printExploration(const char* name, const char** maze_string) {
+    static probabilistic_maze_t truth;
+    initializeMaze(&truth);
+    readInMaze(maze_string, &truth);
+
+    exploration_benchmark_t result = benchmarkExploration(&truth);
+    printf("%-8s\t%5d\t%5d\t%5d\t%5d\t%7.1f\t%5d\t%s\n", name,
+            result.shortest, result.cells_visited, result.search_moves, result.moves - result.search_moves,
+            result.moves * CELL_PITCH / 1000.0, result.greedy_moves, result.greedy_proven ? "yes" : "no");
+}
+
+/* The same averaged over RANDOM_MAZES random mazes, skipping those where the goal can not be reached */
+void printRandomExplorations(void) {
+    static probabilistic_maze_t truth;
+    static cell_t cells[MAZE_WIDTH * MAZE_HEIGHT];
+    cell_t start = { .x = INIT_CELL_X, .y = INIT_CELL_Y };
+
+    unsigned int seed = 2024;
+    int mazes = 0, failed = 0, proven = 0;
+    double shortest = 0, cells_visited = 0, search_moves = 0, moves = 0, greedy_moves = 0, ns = 0;
+    for (int m = 0; m < RANDOM_MAZES; m++) {
+        randomMaze(&truth, &seed, RANDOM_WALL_PERCENT);
+        if (!isGoalCell(cells[floodRoute(&truth, start, cells) - 1])) {
+            continue;
+        }
+
+        double start_ns = benchNowNs();
+        exploration_benchmark_t result = benchmarkExploration(&truth);
+        ns += benchNowNs() - start_ns;
+        if (result.moves < 0) {
+            failed++;
+            continue;
+        }
+        shortest += result.shortest;
+        cells_visited += result.cells_visited;
+        search_moves += result.search_moves;
+        moves += result.moves;
+        greedy_moves += result.greedy_moves;
+        proven += result.greedy_proven;
+        mazes++;
+    }
+
+    printf("random  \t%d solvable mazes of %d, %d did not finish, the goal run alone proves the shortest path in %d\n",
+            mazes + failed, RANDOM_MAZES, failed, proven);
+    printf("average \t%5.1f\t%5.1f\t%5.1f\t%5.1f\t%7.1f\t%5.1f\n",
+            shortest / mazes, cells_visited / mazes, search_moves / mazes, (moves - search_moves) / mazes,
+            moves / mazes * CELL_PITCH / 1000.0, greedy_moves / mazes);
+    printf("cpu     \t%.1f us per exploration and goal run\n", ns / (mazes + failed) / 1000.0);
+}
+
+/* Time and memory of floodfillGrid on an open and a random W by H maze from the center 2x2, best of
+ * FLOODFILL_RUNS, and the same per cell, which stays flat if the floodfill is linear in the maze size */
+template <int W, int H>
+void printGridFloodfill(void) {
+    static probabilistic_grid_t<W, H> open_maze;
+    static probabilistic_grid_t<W, H> random_maze;
+    static floodfill_grid_t<W, H> grid;
+    cell_t center[] = { { W / 2 - 1, H / 2 - 1 }, { W / 2, H / 2 - 1 }, { W / 2 - 1, H / 2 }, { W / 2, H / 2 } };
+    const int repetitions = GRID_FLOOD_CELLS / (W * H) > 0 ? GRID_FLOOD_CELLS / (W * H) : 1;
+
+    unsigned int seed = 2024;
+    randomMaze(&open_maze, &seed, 0);
+    randomMaze(&random_maze, &seed, RANDOM_WALL_PERCENT);
+
+    double ns[2];
+    probabilistic_grid_t<W, H>* mazes[2] = { &open_maze, &random_maze };
+    for (int m = 0; m < 2; m++) {
+        for (int run = 0; run < FLOODFILL_RUNS; run++) {
+            double start = benchNowNs();
+            for (int r = 0; r < repetitions; r++) {
+                floodfillGrid(mazes[m], center, 4, 0, &grid);
+                benchKeep(grid);
+            }
+            double run_ns = (benchNowNs() - start) / repetitions;
+            if (run == 0 || run_ns < ns[m]) ns[m] = run_ns;
+        }
+    }
+
+    printf("%3dx%-3d\t%8u\t%8u\t%8u\t%10.1f\t%6.2f\t%10.1f\t%6.2f\n", W, H,
+            (unsigned int) sizeof(probabilistic_grid_t<W, H>), (unsigned int) sizeof(floodfill_grid_t<W, H>),
+            (unsigned int) sizeof(queue<cell_t, W * H>),
+            ns[0] / 1000.0, ns[0] / (W * H), ns[1] / 1000.0, ns[1] / (W * H));
+}
+
+/* Write CORPUS_MAZES generated mazes with CORPUS_LOOP_PERCENT loops to a corpus file, map it and time
+ * going through it: decoding each maze from the mapping, parsing the same maze from its text drawing,
+ * and decoding, flooding from the goal set and planning the speed run of each, the loop a corpus-wide
+ * benchmark would run */
+void printCorpusBenchmark(void) {
+    static probabilistic_maze_t maze;
+    static char text[MAZE_TEXT_BYTES];
+    static speed_run_path_t path;
+    static cell_t cells[MAZE_WIDTH * MAZE_HEIGHT];
+    char file_path[] = "/tmp/strategy_benchmark_XXXXXX";
+    cell_t start = { .x = INIT_CELL_X, .y = INIT_CELL_Y };
+
+    close(mkstemp(file_path));
+    if (!writeMazeCorpus(file_path, 2024, CORPUS_MAZES, CORPUS_LOOP_PERCENT)) {
+        printf("could not write %s\n", file_path);
+        unlink(file_path);
+        return;
+    }
+
+    maze_corpus_t corpus;
+    double start_ns = benchNowNs();
+    bool opened = openMazeCorpus(file_path, &corpus);
+    double open_us = (benchNowNs() - start_ns) / 1000.0;
+    unlink(file_path);
+    if (!opened) {
+        printf("could not map %s\n", file_path);
+        return;
+    }
+
+    double decode_ns = 0.0;
+    for (int run = 0; run < FLOODFILL_RUNS; run++) {
+        start_ns = benchNowNs();
+        for (int m = 0; m < corpus.num_mazes; m++) {
+            decodeMaz(corpusMaze(&corpus, m), &maze);
+            benchKeep(maze);
+        }
+        double ns = (benchNowNs() - start_ns) / corpus.num_mazes;
+        if (run == 0 || ns < decode_ns) decode_ns = ns;
+    }
+
+    double parse_ns = 0.0;
+    for (int m = 0; m < corpus.num_mazes; m++) {
+        decodeMaz(corpusMaze(&corpus, m), &maze);
+        formatMazeText(&maze, text);
+        start_ns = benchNowNs();
+        parseMazeText(text, &maze);
+        parse_ns += benchNowNs() - start_ns;
+        benchKeep(maze);
+    }
+    parse_ns /= corpus.num_mazes;
+
+    int solvable = 0;
+    double stream_decode_ns = 0.0, flood_ns = 0.0, plan_ns = 0.0;
+    for (int m = 0; m < corpus.num_mazes; m++) {
+        double decode_start = benchNowNs();
+        decodeMaz(corpusMaze(&corpus, m), &maze);
+        double flood_start = benchNowNs();
+        int length = floodRoute(&maze, start, cells);
+        double plan_start = benchNowNs();
+        if (isGoalCell(cells[length - 1])) {
+            planSpeedRun(&maze, start, East, cells[length - 1], false, &path);
+            solvable++;
+        }
+        double end = benchNowNs();
+        benchKeep(path);
+        stream_decode_ns += flood_start - decode_start;
+        flood_ns += plan_start - flood_start;
+        plan_ns += end - plan_start;
+    }
+    int num_mazes = corpus.num_mazes;
+    closeMazeCorpus(&corpus);
+
+    double total_ns = stream_decode_ns + flood_ns + plan_ns;
+    printf("corpus  	%d mazes, %u KB, mapped in %.1f us\n", num_mazes,
+            (unsigned int) (num_mazes * MAZ_FILE_BYTES / 1024), open_us);
+    printf("load    	%.0f ns/maze decoding .maz bytes from the mapping, %.0f ns/maze parsing text (%.1fx)\n",
+            decode_ns, parse_ns, parse_ns / decode_ns);
+    printf("stream  	%d solvable, %.1f us/maze: decode %.1f%%, floodfill route %.1f%%, planSpeedRun %.1f%%, "
+            "%.0f mazes/s\n", solvable, total_ns / num_mazes / 1000.0, 100.0 * stream_decode_ns / total_ns,
+            100.0 * flood_ns / total_ns, 100.0 * plan_ns / total_ns, num_mazes / (total_ns / 1e9));
+}
+
+/* Generation rate of W by H mazes with loop_percent loops, and for the robot's maze size the average
+ * shortest path from the start to the goal and how many walls are open */
+template <int W, int H>
+void printMazeGenerator(int loop_percent) {
+    static probabilistic_grid_t<W, H> maze;
+    static cell_t cells[MAZE_WIDTH * MAZE_HEIGHT];
+    const int num_mazes = GENERATED_MAZES * MAZE_WIDTH * MAZE_HEIGHT / (W * H);
+
+    double start_ns = benchNowNs();
+    for (int m = 0; m < num_mazes; m++) {
+        generateMaze(&maze, corpusMazeSeed(2024, m), loop_percent);
+        benchKeep(maze);
+    }
+    double ns = (benchNowNs() - start_ns) / num_mazes;
+
+    printf("%3dx%-3d\t%5d%%\t%8.2f\t%10.2f", W, H, loop_percent, ns / 1000.0, 60e9 / ns / 1e6);
+    if (W == MAZE_WIDTH && H == MAZE_HEIGHT) {
+        cell_t start = { .x = INIT_CELL_X, .y = INIT_CELL_Y };
+        int shortest = 0, open = 0, checked = 1000;
+        for (int m = 0; m < checked; m++) {
+            generateMaze(&maze, corpusMazeSeed(2024, m), loop_percent);
+            shortest += floodRoute((probabilistic_maze_t*) &maze, start, cells) - 1;
+            for (int n = 0; n < maze.num_walls; n++) {
+                open += !wallExists(mazeWallByNumber(&maze, n));
+            }
+        }
+        printf("\t%7.1f\t%7.1f", (double) shortest / checked, (double) open / checked);
+    }
+    printf("\n");
+}
+
+/* Mazes per minute of writeMazeCorpus to a file */
+void printCorpusGenerator(int num_mazes, int loop_percent) {
+    char path[] = "/tmp/strategy_benchmark_XXXXXX";
+    close(mkstemp(path));
+    double start_ns = benchNowNs();
+    bool written = writeMazeCorpus(path, 2024, num_mazes, loop_percent);
+    double ns = (benchNowNs() - start_ns) / num_mazes;
+    unlink(path);
+    printf("corpus  \t%5d%%\t%8.2f\t%10.2f\t%d mazes to a file%s\n", loop_percent, ns / 1000.0, 60e9 / ns / 1e6,
+            num_mazes, written ? "" : ", could not write");
+}
+
+
+BENCH_FUNC_BEGIN {
+
+    initializeStrategy();
+
+    BENCH_SECTION("Maze memory");
+    printf("sizeof(probabilistic_maze_t): %u bytes\n", (unsigned int) sizeof(probabilistic_maze_t));
+    printf("with four wall pointers per cell it would take %u bytes (%u with 4 byte pointers on the Due)\n",
+            (unsigned int) (sizeof(probabilistic_maze_t) + MAZE_WIDTH * MAZE_HEIGHT * 4 * sizeof(void*)),
+            (unsigned int) (sizeof(probabilistic_maze_t) + MAZE_WIDTH * MAZE_HEIGHT * 4 * 4));
+
+    BENCH_SECTION("floodfill per maze");
+    printf("maze    \tns/floodfill\n");
+    printf("empty   \t%12.1f\n", benchmarkFloodfill(empty_string));
+    printf("spiral  \t%12.1f\n", benchmarkFloodfill(spiral_string));
+    printf("loop    \t%12.1f\n", benchmarkFloodfill(loop_string));
+    printf("actual  \t%12.1f\n", benchmarkFloodfill(actual_string));
+
+    BENCH_SECTION("floodfillGrid by maze size, memory (bytes) and time from the center 2x2 (us, ns per cell)");
+    printf("        \t    maze\t  values\t   queue\t   open\t\t\t   random %d%% walls\n", RANDOM_WALL_PERCENT);
+    printf("size    \t        \t+ discov\t (stack)\t        us\tns/cell\t        us\tns/cell\n");
+    printGridFloodfill<16, 16>();
+    printGridFloodfill<32, 32>();
+    printGridFloodfill<64, 64>();
+    printGridFloodfill<128, 128>();
+    printGridFloodfill<256, 256>();
+
+    BENCH_SECTION("Queue floodfill vs bitboard floodfill (ns), with a Cortex-M3 estimate for the bitboard flood");
+    printf("maze    \t   queue\t   build\t   flood\tspeedup\tlayers\t  rows\tM3 cycles\tM3 us\n");
+    printBitboardFloodfill("empty", empty_string);
+    printBitboardFloodfill("spiral", spiral_string);
+    printBitboardFloodfill("loop", loop_string);
+    printBitboardFloodfill("actual", actual_string);
+
+    BENCH_SECTION("Keeping values up to date per strategy tick, one wall revealed per tick (ns/tick)");
+    printf("maze    \t walls\t        full\t incremental\t speedup\t no change\n");
+    printIncrementalFloodfill("spiral", spiral_string);
+    printIncrementalFloodfill("loop", loop_string);
+    printIncrementalFloodfill("actual", actual_string);
+
+
+    BENCH_SECTION("Speed run: floodfill route vs planSpeedRun without diagonals, predicted run time (s) and planning time (us)");
+    printf("        \t   floodfill route\t\t\t   planSpeedRun\n");
+    printf("maze    \tcells\tturns\t   time\t    cpu\t segs\t   time\t    cpu\t  saved\n");
+    printSpeedRun("empty", empty_string);
+    printSpeedRun("spiral", spiral_string);
+    printSpeedRun("loop", loop_string);
+    printSpeedRun("actual", actual_string);
+    printRandomSpeedRuns();
+
+    BENCH_SECTION("Exploration until the optimistic and pessimistic floodfills agree, then back to the start, "
+                  "vs the floodfill strategy's first run to the goal");
+    printf("        \t     \t   exploration\t\t\t\t   goal run\n");
+    printf("maze    \tshort\tcells\tsearch\treturn\tdist(m)\tmoves\tproven\n");
+    printExploration("empty", empty_string);
+    printExploration("spiral", spiral_string);
+    printExploration("loop", loop_string);
+    printExploration("actual", actual_string);
+    printExploration("stairs", staircase_string);
+    printRandomExplorations();
+
+    BENCH_SECTION("Maze generator, time per maze (us) and mazes per minute (millions), with the shortest "
+                  "path and open walls of the robot's maze size");
+    printf("size    \t loops\t us/maze\tM mazes/min\tshortest\t   open\n");
+    printMazeGenerator<MAZE_WIDTH, MAZE_HEIGHT>(0);
+    printMazeGenerator<MAZE_WIDTH, MAZE_HEIGHT>(10);
+    printMazeGenerator<MAZE_WIDTH, MAZE_HEIGHT>(30);
+    printMazeGenerator<32, 32>(0);
+    printMazeGenerator<32, 32>(10);
+    printMazeGenerator<256, 256>(0);
+    printCorpusGenerator(GENERATED_MAZES, 10);
+
+    BENCH_SECTION("Maze corpus: loading from a memory-mapped .maz corpus and streaming it through the planner");
+    printCorpusBenchmark();
+
+} BENCH_FUNC_END("strategy_benchmark")
+
+#endif // ARDUINO
@@ -1,39 +1,387 @@
 #ifndef ARDUINO
 #include "strategy.h"
+#include "floodfill.h"
+#include "maze_file.h"
+#include "maze_generator.h"
+#include "corpus_runner.h"
 #include "strategy_test_data.h"
+#include "bitboard_maze.h"
+#include "speed_run.h"
+#include "path_compiler.h"
+#include "exploration.h"
 #include "../testing.h"
 #include "../settings.h"
 #include "../types.h"
 #include "../util/conversions.h"
 
+#include <stdlib.h>
+#include <unistd.h>
 
-void readInMaze(const char** maze_string, probabilistic_maze_t* maze) {
-
-    int i2 = 0;
-    for (int i = 1; i < size; i+=2) {
-        int j2 = 0;
-        for (int j = 1; j < size; j+=2) {
-            
-            // North(0, -1)
-            if (maze_string[i][j-1] == 'X') maze->cells[i2][j2].north->exists = 1.0;
-            else maze->cells[i2][j2].north->exists = 0.0;
-            
-            // East(1, 0)
-            if (maze_string[i+1][j] == 'X') maze->cells[i2][j2].east->exists = 1.0;
-            else maze->cells[i2][j2].east->exists = 0.0;
-            
-            // South(0, 1)
-            if (maze_string[i][j+1] == 'X') maze->cells[i2][j2].south->exists = 1.0;
-            else maze->cells[i2][j2].south->exists = 0.0;
-            
-            // West(-1, 0)
-            if (maze_string[i-1][j] == 'X') maze->cells[i2][j2].west->exists = 1.0;
-            else maze->cells[i2][j2].west->exists = 0.0;
-            
-            j2++;
-        }
-        i2++;
+
+#define INCREMENTAL_BATCHES 300     // Batches of random wall changes per maze
+#define INCREMENTAL_BATCH_SIZE 6    // Up to this many walls changed per batch
+#define SPEED_RUN_TIME_TOLERANCE 1e-3   // Seconds, planSpeedRun adds up times in floats
+#define RUNNER_MAZES 60             // Mazes in the corpus runner test
+
+/* True once location is in any of the goal cells */
+bool atGoal(gaussian_location_t* location) {
+    cell_t cell = { .x = coordinateDistanceToCellNumber(location->x_mu),
+                    .y = coordinateDistanceToCellNumber(location->y_mu) };
+    return isGoalCell(cell);
+}
+
+/* Makes random batches of interior walls appear or disappear in the maze read from maze_string, and
+ * checks after each batch that updateFloodfill gives the same values as a full floodfill */
+bool checkIncrementalFloodfill(const char** maze_string, unsigned int seed) {
+    static probabilistic_maze_t maze;
+    static int changed_walls[NUM_WALLS];
+    static int incremental_values[MAZE_WIDTH][MAZE_HEIGHT];
+    cell_t goal = { .x = GOAL_CELL_X, .y = GOAL_CELL_Y };
+
+    initializeMaze(&maze);
+    readInMaze(maze_string, &maze);
+    floodfill(&maze, goal, 0);
+
+    for (int batch = 0; batch < INCREMENTAL_BATCHES; batch++) {
+        seed = seed * 1103515245 + 12345;
+        int batch_size = 1 + (seed >> 16) % INCREMENTAL_BATCH_SIZE;
+        for (int i = 0; i < batch_size; i++) {
+            seed = seed * 1103515245 + 12345;
+            int x = (seed >> 8) % MAZE_WIDTH;
+            int y = (seed >> 12) % MAZE_HEIGHT;
+            Direction dir = (Direction) ((seed >> 20) % 4);
+
+            // Leave the border alone, it is always a wall
+            if ((dir == North && y == 0) || (dir == South && y == MAZE_HEIGHT - 1) ||
+                    (dir == West && x == 0) || (dir == East && x == MAZE_WIDTH - 1)) {
+                continue;
+            }
+            probabilistic_wall_t* wall = mazeWall(&maze, x, y, dir);
+            setWallProbability(wall, wallExists(wall) ? 0.0 : 1.0);
+        }
+
+        int num_changed = findChangedWalls(&maze, changed_walls);
+        updateFloodfill(&maze, changed_walls, num_changed);
+        for (int x = 0; x < MAZE_WIDTH; x++) {
+            for (int y = 0; y < MAZE_HEIGHT; y++) {
+                incremental_values[x][y] = values[x][y];
+                if (strategy_context.queued[x][y] || strategy_context.invalidated[x][y]) {
+                    printf("Batch %d, cell (%d, %d) left queued or invalidated\n", batch, x, y);
+                    return false;
+                }
+            }
+        }
+        if (strategy_context.update_count != 0) {
+            printf("Batch %d, %d cells left in the queue\n", batch, strategy_context.update_count);
+            return false;
+        }
+
+        floodfill(&maze, goal, 0);
+        for (int x = 0; x < MAZE_WIDTH; x++) {
+            for (int y = 0; y < MAZE_HEIGHT; y++) {
+                if (values[x][y] != incremental_values[x][y]) {
+                    printf("Batch %d, cell (%d, %d): incremental %d, full %d\n", batch, x, y,
+                            incremental_values[x][y], values[x][y]);
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+/* Checks bitboardFloodfill gives the same values as floodfill from every goal cell of the maze
+ * read from maze_string, with a few walls left unknown so some cells can not be reached */
+bool checkBitboardFloodfill(const char** maze_string) {
+    static probabilistic_maze_t maze;
+    static int queue_values[MAZE_WIDTH][MAZE_HEIGHT];
+    bitboard_maze_t bitboard;
+
+    initializeMaze(&maze);
+    readInMaze(maze_string, &maze);
+
+    // Close off cell [3,3] completely
+    setWallProbability(mazeWall(&maze, 3, 3, North), 1.0);
+    setWallProbability(mazeWall(&maze, 3, 3, East), 1.0);
+    setWallProbability(mazeWall(&maze, 3, 3, South), 1.0);
+    setWallProbability(mazeWall(&maze, 3, 3, West), 1.0);
+
+    buildBitboardMaze(&maze, &bitboard);
+
+    for (int gx = 0; gx < MAZE_WIDTH; gx++) {
+        for (int gy = 0; gy < MAZE_HEIGHT; gy++) {
+            cell_t goal = { .x = gx, .y = gy };
+            floodfill(&maze, goal, 0);
+            for (int x = 0; x < MAZE_WIDTH; x++) {
+                for (int y = 0; y < MAZE_HEIGHT; y++) {
+                    queue_values[x][y] = values[x][y];
+                    values[x][y] = -1;
+                }
+            }
+
+            bitboardFloodfill(&bitboard, goal, 0);
+            for (int x = 0; x < MAZE_WIDTH; x++) {
+                for (int y = 0; y < MAZE_HEIGHT; y++) {
+                    if (values[x][y] != queue_values[x][y]) {
+                        printf("Goal (%d, %d), cell (%d, %d): bitboard %d, floodfill %d\n", gx, gy, x, y,
+                                values[x][y], queue_values[x][y]);
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+/* Steps through the segments of path from the start cell and checks every lattice point on the way is
+ * the center of a cell or the middle of an open wall, and the last segment ends on the goal */
+bool checkSegments(probabilistic_maze_t* maze, const speed_run_path_t* path, cell_t goal) {
+    const int step[8][2] = { { 0, -1 }, { 1, 0 }, { 0, 1 }, { -1, 0 }, { 1, -1 }, { 1, 1 }, { -1, 1 }, { -1, -1 } };
+    lattice_point_t point = { .x = 2 * INIT_CELL_X + 1, .y = 2 * INIT_CELL_Y + 1 };
+
+    for (int i = 0; i < path->num_segments; i++) {
+        const speed_run_segment_t* segment = &path->segments[i];
+        int steps = 0;
+        while (point.x != segment->end.x || point.y != segment->end.y) {
+            point.x += step[segment->heading][0];
+            point.y += step[segment->heading][1];
+            if (++steps > 2 * MAZE_SIZE || point.x <= 0 || point.x >= 2 * MAZE_WIDTH ||
+                    point.y <= 0 || point.y >= 2 * MAZE_HEIGHT) {
+                return false;
+            }
+            bool odd_x = point.x & 1;
+            bool odd_y = point.y & 1;
+            if ((!odd_x && !odd_y) ||
+                    (odd_x && !odd_y && wallExists(mazeWall(maze, point.x / 2, point.y / 2, North))) ||
+                    (!odd_x && odd_y && wallExists(mazeWall(maze, point.x / 2, point.y / 2, West)))) {
+                return false;
+            }
+        }
+    }
+    return point.x == 2 * goal.x + 1 && point.y == 2 * goal.y + 1;
+}
+
+/* Plans the speed run on the maze read from maze_string to the goal cell the floodfill route ends in and
+ * checks the route is open, its time is what predictPathTime gives it, and it is no slower than the
+ * floodfill route, or the orthogonal route when diagonals are on */
+bool checkSpeedRun(const char** maze_string, bool diagonals, speed_run_path_t* path) {
+    static probabilistic_maze_t maze;
+    static cell_t flood_cells[MAZE_WIDTH * MAZE_HEIGHT];
+    static speed_run_path_t orthogonal_path;
+    cell_t start = { .x = INIT_CELL_X, .y = INIT_CELL_Y };
+    lattice_point_t start_point = { .x = 2 * INIT_CELL_X + 1, .y = 2 * INIT_CELL_Y + 1 };
+
+    initializeMaze(&maze);
+    readInMaze(maze_string, &maze);
+    int flood_length = floodRoute(&maze, start, flood_cells);
+    cell_t goal = flood_cells[flood_length - 1];
+    if (!isGoalCell(goal)) {
+        return false;
+    }
+    if (!planSpeedRun(&maze, start, East, goal, diagonals, path) || !checkSegments(&maze, path, goal)) {
+        return false;
+    }
+    if (fabs(path->time - predictPathTime(path, start_point, East)) > SPEED_RUN_TIME_TOLERANCE) {
+        return false;
+    }
+
+    if (path->time > predictRunTime(flood_cells, flood_length, East) + SPEED_RUN_TIME_TOLERANCE) {
+        return false;
+    }
+    if (diagonals) {
+        planSpeedRun(&maze, start, East, goal, false, &orthogonal_path);
+        return path->time <= orthogonal_path.time + SPEED_RUN_TIME_TOLERANCE;
+    }
+    return true;
+}
+
+/* Explore maze_string, true if it ends back at the start with the bounds equal to the shortest path */
+bool checkExploration(const char** maze_string) {
+    static probabilistic_maze_t truth;
+    static probabilistic_maze_t found;
+    static exploration_t exploration;
+    static cell_t cells[MAZE_WIDTH * MAZE_HEIGHT];
+    cell_t start = { .x = INIT_CELL_X, .y = INIT_CELL_Y };
+
+    initializeMaze(&truth);
+    readInMaze(maze_string, &truth);
+    int shortest = floodRoute(&truth, start, cells) - 1;
+
+    int search_moves, cells_visited;
+    int moves = exploreMaze(&truth, &found, &exploration, &search_moves, &cells_visited);
+    if (moves < 0 || exploration.mode != EXPLORE_DONE ||
+            exploration.lower_bound != shortest || exploration.upper_bound != shortest) {
+        return false;
+    }
+
+    // With the walls it never saw closed, the path the robot found is as short as the real one
+    for (int n = 0; n < NUM_WALLS; n++) {
+        if (!exploration.known[n]) {
+            setWallProbability(mazeWallByNumber(&found, n), 1.0);
+        }
+    }
+    return floodRoute(&found, start, cells) - 1 == shortest;
+}
+
+/* Runs strategy() from location until it stays in the same cell, returns how many cells it moved,
+ * -1 if it is still going after MAZE_SIZE moves */
+int strategyMoves(probabilistic_maze_t* maze, gaussian_location_t* location) {
+    gaussian_location_t next_location;
+    for (int moves = 0; moves <= MAZE_SIZE; moves++) {
+        strategy(location, maze, &next_location);
+        if (coordinateDistanceToCellNumber(next_location.x_mu) == coordinateDistanceToCellNumber(location->x_mu) &&
+                coordinateDistanceToCellNumber(next_location.y_mu) == coordinateDistanceToCellNumber(location->y_mu)) {
+            return moves;
+        }
+        *location = next_location;
+    }
+    return -1;
+}
+
+/* The goal set floods from all its cells at once, so every value is the smallest of the single floods */
+bool checkGoalSetFloodfill(const char** maze_string) {
+    static probabilistic_maze_t maze;
+    static int smallest[MAZE_WIDTH][MAZE_HEIGHT];
+
+    initializeMaze(&maze);
+    readInMaze(maze_string, &maze);
+    for (int x = 0; x < MAZE_WIDTH; x++) {
+        for (int y = 0; y < MAZE_HEIGHT; y++) {
+            smallest[x][y] = MAX_VALUE;
+        }
+    }
+    for (int i = 0; i < goal_set.num_cells; i++) {
+        floodfill(&maze, goal_set.cells[i], 0);
+        for (int x = 0; x < MAZE_WIDTH; x++) {
+            for (int y = 0; y < MAZE_HEIGHT; y++) {
+                smallest[x][y] = min(smallest[x][y], values[x][y]);
+            }
+        }
+    }
+
+    floodfillCells(&maze, goal_set.cells, goal_set.num_cells, 0);
+    for (int x = 0; x < MAZE_WIDTH; x++) {
+        for (int y = 0; y < MAZE_HEIGHT; y++) {
+            if (values[x][y] != smallest[x][y]) {
+                return false;
+            }
+        }
     }
+    return true;
+}
+
+/* True if wallExists() is the same for every wall of a and b */
+bool sameWalls(probabilistic_maze_t* a, probabilistic_maze_t* b) {
+    for (int n = 0; n < NUM_WALLS; n++) {
+        if (wallExists(mazeWallByNumber(a, n)) != wallExists(mazeWallByNumber(b, n))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Round trips the maze read from maze_string through .maz bytes and through its text drawing, with
+ * the start cell marked and "\r\n" line ends in the drawing */
+bool checkMazeFormats(const char** maze_string) {
+    static probabilistic_maze_t maze;
+    static probabilistic_maze_t loaded;
+    static uint8_t bytes[MAZ_FILE_BYTES];
+    static char text[MAZE_TEXT_BYTES];
+    static char crlf_text[2 * MAZE_TEXT_BYTES];
+
+    initializeMaze(&maze);
+    readInMaze(maze_string, &maze);
+    encodeMaz(&maze, bytes);
+    initializeMaze(&loaded);
+    decodeMaz(bytes, &loaded);
+    if (!sameWalls(&maze, &loaded)) {
+        return false;
+    }
+
+    formatMazeText(&maze, text);
+    text[(4 * MAZE_WIDTH + 2) * (2 * MAZE_HEIGHT - 1) + 2] = 'S';
+    int length = 0;
+    for (const char* c = text; *c != '\0'; c++) {
+        if (*c == '\n') crlf_text[length++] = '\r';
+        crlf_text[length++] = *c;
+    }
+    crlf_text[length] = '\0';
+    return parseMazeText(crlf_text, &loaded) && sameWalls(&maze, &loaded);
+}
+
+/* Generates mazes of size W by H from a few seeds, true if they keep to the rules, come out the same
+ * from the same seed, and have one more open wall than a tree of the cells needs for every loop */
+template <int W, int H>
+bool checkGeneratedMazes(int loop_percent) {
+    static probabilistic_grid_t<W, H> maze;
+    static probabilistic_grid_t<W, H> again;
+    const int goal_cells = (goalLast(W) - goalFirst(W) + 1) * (goalLast(H) - goalFirst(H) + 1);
+    const int goal_walls = goal_cells == 4 ? 4 : goal_cells - 1;    // Open walls inside the goal
+    const int perfect_open = (W * H - goal_cells) + goal_walls;      // Tree of the cells and the goal
+
+    for (unsigned int seed = 1; seed <= 20; seed++) {
+        generateMaze(&maze, seed, loop_percent);
+        generateMaze(&again, seed, loop_percent);
+        int open = 0;
+        for (int n = 0; n < maze.num_walls; n++) {
+            open += !wallExists(mazeWallByNumber(&maze, n));
+            if (wallExists(mazeWallByNumber(&maze, n)) != wallExists(mazeWallByNumber(&again, n))) {
+                return false;
+            }
+        }
+        if (!checkMazeRules(&maze) || (loop_percent == 0 ? open != perfect_open : open <= perfect_open)) {
+            printf("%dx%d, seed %u, %d%% loops: %d open walls\n", W, H, seed, loop_percent, open);
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Same steps, turns and decisions */
+bool sameRun(const maze_run_t* a, const maze_run_t* b) {
+    return a->explore_steps == b->explore_steps && a->explore_turns == b->explore_turns &&
+           a->speed_run_steps == b->speed_run_steps && a->speed_run_turns == b->speed_run_turns &&
+           a->decisions == b->decisions && a->solved == b->solved;
+}
+
+/* Runs a generated corpus one maze at a time on the robot's context, then with runCorpus on 1 and 4
+ * threads, true if every maze is solved the same way each time */
+bool checkCorpusRuns(void) {
+    static probabilistic_maze_t truth;
+    static probabilistic_maze_t maze;
+    static speed_run_search_t search;
+    static maze_run_t expected[RUNNER_MAZES];
+    static maze_run_t runs[RUNNER_MAZES];
+    char path[] = "/tmp/strategy_test_XXXXXX";
+    maze_corpus_t corpus;
+
+    close(mkstemp(path));
+    bool ok = writeMazeCorpus(path, 11, RUNNER_MAZES, 20) && openMazeCorpus(path, &corpus);
+    unlink(path);
+    if (!ok) {
+        return false;
+    }
+
+    for (int m = 0; ok && m < RUNNER_MAZES; m++) {
+        decodeMaz(corpusMaze(&corpus, m), &truth);
+        ok = runMaze(&strategy_context, &search, &truth, &maze, &expected[m], NULL);
+    }
+    for (int threads = 1; ok && threads <= 4; threads += 3) {
+        corpus_run_t result;
+        static latency_histogram_t latency;
+        runCorpus(&corpus, threads, runs, &latency, &result);
+
+        unsigned long decisions = 0;
+        for (int m = 0; ok && m < RUNNER_MAZES; m++) {
+            ok = sameRun(&runs[m], &expected[m]);
+            decisions += runs[m].decisions;
+        }
+        ok = ok && latency.total == decisions;
+    }
+    closeMazeCorpus(&corpus);
+    initializeStrategy();
+    return ok;
 }
 
 
@@ -61,8 +409,7 @@ TEST_FUNC_BEGIN {
     readInMaze(empty_string, &robot_maze);
 
     // While not at goal
-    while (location.x_mu != (cellNumberToCoordinateDistance(GOAL_CELL_X)) ||
-            location.y_mu != (cellNumberToCoordinateDistance(GOAL_CELL_Y)))
+    while (!atGoal(&location))
     {
         // printf("Step: %d,\tX: %d,\tY: %d\n", steps, coordinateDistanceToCellNumber(location.x_mu), coordinateDistanceToCellNumber(location.y_mu));
 
@@ -98,8 +445,7 @@ TEST_FUNC_BEGIN {
     readInMaze(spiral_string, &robot_maze);
 
     // While not at goal
-    while (location.x_mu != (cellNumberToCoordinateDistance(GOAL_CELL_X)) ||
-            location.y_mu != (cellNumberToCoordinateDistance(GOAL_CELL_Y)))
+    while (!atGoal(&location))
     {
         // printf("Step: %d,\tX: %d,\tY: %d\n", steps, coordinateDistanceToCellNumber(location.x_mu), coordinateDistanceToCellNumber(location.y_mu));
 
@@ -135,8 +481,7 @@ TEST_FUNC_BEGIN {
     readInMaze(loop_string, &robot_maze);
 
     // While not at goal
-    while (location.x_mu != (cellNumberToCoordinateDistance(GOAL_CELL_X)) ||
-            location.y_mu != (cellNumberToCoordinateDistance(GOAL_CELL_Y)))
+    while (!atGoal(&location))
     {
         // printf("Step: %d,\tX: %d,\tY: %d\n", steps, coordinateDistanceToCellNumber(location.x_mu), coordinateDistanceToCellNumber(location.y_mu));
 
@@ -172,8 +517,7 @@ TEST_FUNC_BEGIN {
     readInMaze(actual_string, &robot_maze);
 
     // While not at goal
-    while (location.x_mu != (cellNumberToCoordinateDistance(GOAL_CELL_X)) ||
-            location.y_mu != (cellNumberToCoordinateDistance(GOAL_CELL_Y)))
+    while (!atGoal(&location))
     {
         // printf("Step: %d,\tX: %d,\tY: %d\n", steps, coordinateDistanceToCellNumber(location.x_mu), coordinateDistanceToCellNumber(location.y_mu));
 
@@ -197,6 +541,483 @@ TEST_FUNC_BEGIN {
     after_actual_solve:
     ;
 
+    // Test incremental floodfill against the full floodfill
+    if (!checkIncrementalFloodfill(empty_string, 1) || !checkIncrementalFloodfill(spiral_string, 2) ||
+            !checkIncrementalFloodfill(loop_string, 3) || !checkIncrementalFloodfill(actual_string, 4)) {
+        TEST_FAIL("Incremental floodfill");
+        goto after_incremental_floodfill;
+    }
+
+    TEST_PASS("Incremental floodfill");
+    after_incremental_floodfill:
+    ;
+
+    // Test bitboard floodfill against floodfill
+    if (!checkBitboardFloodfill(empty_string) || !checkBitboardFloodfill(spiral_string) ||
+            !checkBitboardFloodfill(loop_string) || !checkBitboardFloodfill(actual_string)) {
+        TEST_FAIL("Bitboard floodfill");
+        goto after_bitboard_floodfill;
+    }
+
+    TEST_PASS("Bitboard floodfill");
+    after_bitboard_floodfill:
+    ;
+
+    // Test the speed run planner, on the empty maze the fastest route has a single turn
+    {
+        static speed_run_path_t path;
+        if (!checkSpeedRun(spiral_string, false, &path) || !checkSpeedRun(loop_string, false, &path) ||
+                !checkSpeedRun(actual_string, false, &path) || !checkSpeedRun(staircase_string, false, &path) ||
+                !checkSpeedRun(empty_string, false, &path)) {
+            TEST_FAIL("Speed run planner");
+            goto after_speed_run;
+        }
+
+        double one_turn_time = straightTravelTime(GOAL_CELL_X * CELL_PITCH) + turnTravelTime(HALF_PI) +
+                               straightTravelTime(GOAL_CELL_Y * CELL_PITCH);
+        if (path.num_segments != 2 || fabs(path.time - one_turn_time) > SPEED_RUN_TIME_TOLERANCE) {
+            TEST_FAIL("Speed run planner");
+            goto after_speed_run;
+        }
+    }
+
+    TEST_PASS("Speed run planner");
+    after_speed_run:
+    ;
+
+    // Test diagonal segments, the staircase is one diagonal between two half cells
+    // - With the dummy ROBOT_WIDTH, whatever SPEED_RUN_DIAGONALS is
+    {
+        static speed_run_path_t path;
+        if (!diagonalsClearPosts() ||
+                !checkSpeedRun(spiral_string, true, &path) || !checkSpeedRun(loop_string, true, &path) ||
+                !checkSpeedRun(actual_string, true, &path) || !checkSpeedRun(empty_string, true, &path) ||
+                !checkSpeedRun(staircase_string, true, &path)) {
+            TEST_FAIL("Diagonal speed run");
+            goto after_diagonal_speed_run;
+        }
+
+        double staircase_time = 2 * straightTravelTime(CELL_PITCH / 2.0) + 2 * turnTravelTime(PI / 4) +
+                                straightTravelTime((2 * GOAL_CELL_X - 1) * CELL_PITCH / 2.0 * M_SQRT2);
+        if (path.num_segments != 3 || path.segments[1].heading != SouthEast ||
+                fabs(path.time - staircase_time) > SPEED_RUN_TIME_TOLERANCE) {
+            TEST_FAIL("Diagonal speed run");
+            goto after_diagonal_speed_run;
+        }
+    }
+
+    TEST_PASS("Diagonal speed run");
+    after_diagonal_speed_run:
+    ;
+
+    // Test the path compiler, straights are merged and carry on when more of the path comes in
+    {
+        static motion_program_t program;
+        cell_t start = { .x = 0, .y = 0 };
+        cell_t path[] = { { 0, 0 }, { 1, 0 }, { 2, 0 }, { 2, 1 }, { 2, 2 }, { 1, 2 } };
+        cell_t more[] = { { 0, 2 } };
+        cell_t back[] = { { 1, 2 } };
+        cell_t jump[] = { { 5, 5 } };
+
+        initializeMotionProgram(&program, start, East);
+        if (!compilePath(&program, path, 6) || program.num_commands != 5 ||
+                program.commands[0].type != MOTION_STRAIGHT || program.commands[0].cells != 2 ||
+                program.commands[1].type != MOTION_TURN_RIGHT ||
+                program.commands[2].type != MOTION_STRAIGHT || program.commands[2].cells != 2 ||
+                program.commands[3].type != MOTION_TURN_RIGHT ||
+                program.commands[4].type != MOTION_STRAIGHT || program.commands[4].cells != 1) {
+            TEST_FAIL("Path compiler");
+            goto after_path_compiler;
+        }
+
+        // Still running the last straight, so it gets longer
+        program.next_command = 4;
+        if (!compilePath(&program, more, 1) || program.num_commands != 5 || program.commands[4].cells != 2) {
+            TEST_FAIL("Path compiler");
+            goto after_path_compiler;
+        }
+
+        // Not neighbors, nothing changes
+        if (compilePath(&program, jump, 1) || program.num_commands != 5 ||
+                program.end.x != 0 || program.end.y != 2 || program.end_heading != West) {
+            TEST_FAIL("Path compiler");
+            goto after_path_compiler;
+        }
+
+        program.next_command = 5;
+        if (!compilePath(&program, back, 1) || program.num_commands != 7 ||
+                program.commands[5].type != MOTION_TURN_AROUND || program.commands[6].cells != 1) {
+            TEST_FAIL("Path compiler");
+            goto after_path_compiler;
+        }
+
+        // Every move of a flood route, in as many straights as it has runs of one direction
+        static cell_t cells[MAZE_WIDTH * MAZE_HEIGHT];
+        static probabilistic_maze_t maze;
+        initializeMaze(&maze);
+        readInMaze(actual_string, &maze);
+        int length = floodRoute(&maze, start, cells);
+        initializeMotionProgram(&program, start, East);
+        if (!compilePath(&program, cells, length)) {
+            TEST_FAIL("Path compiler");
+            goto after_path_compiler;
+        }
+        int moved = 0;
+        for (int i = 0; i < program.num_commands; i++) {
+            if (program.commands[i].type == MOTION_STRAIGHT) {
+                moved += program.commands[i].cells;
+                if (i > 0 && program.commands[i - 1].type == MOTION_STRAIGHT) {
+                    TEST_FAIL("Path compiler");
+                    goto after_path_compiler;
+                }
+            }
+        }
+        if (moved != length - 1 || program.end.x != cells[length - 1].x || program.end.y != cells[length - 1].y) {
+            TEST_FAIL("Path compiler");
+            goto after_path_compiler;
+        }
+    }
+
+    TEST_PASS("Path compiler");
+    after_path_compiler:
+    ;
+
+    // Test the path compiler's arcs, a turn from standing stays on the spot
+    {
+        static motion_program_t program;
+        cell_t start = { .x = 0, .y = 0 };
+        cell_t path[] = { { 0, 0 }, { 1, 0 }, { 2, 0 }, { 2, 1 }, { 2, 2 }, { 1, 2 } };
+        cell_t around[] = { { 0, 0 }, { 1, 0 }, { 2, 0 }, { 2, 1 }, { 1, 1 }, { 0, 1 } };
+        cell_t standing[] = { { 0, 0 }, { 0, 1 }, { 0, 2 } };
+        float search_speed = arcSpeed((CELL_LENGTH + WALL_THICKNESS) / 2.0);
+
+        initializeMotionProgram(&program, start, East);
+        program.turn_style = TURN_SEARCH_ARCS;
+        if (!compilePath(&program, path, 6) || program.num_commands != 5 ||
+                program.commands[0].exit_speed != search_speed ||
+                program.commands[1].type != MOTION_ARC_RIGHT || program.commands[1].cells != 1 ||
+                program.commands[2].entry_speed != search_speed || program.commands[2].exit_speed != search_speed ||
+                program.commands[3].type != MOTION_ARC_RIGHT || program.commands[3].cells != 1 ||
+                program.commands[4].exit_speed != 0) {
+            TEST_FAIL("Path compiler arcs");
+            goto after_path_compiler_arcs;
+        }
+
+        // Only the first turn has a long enough straight after it for a large arc
+        initializeMotionProgram(&program, start, East);
+        program.turn_style = TURN_SPEED_RUN_ARCS;
+        if (!compilePath(&program, path, 6) || program.num_commands != 5 ||
+                program.commands[1].type != MOTION_ARC_RIGHT || program.commands[1].cells != 2 ||
+                program.commands[3].type != MOTION_ARC_RIGHT || program.commands[3].cells != 1) {
+            TEST_FAIL("Path compiler arcs");
+            goto after_path_compiler_arcs;
+        }
+
+        initializeMotionProgram(&program, start, East);
+        program.turn_style = TURN_SEARCH_ARCS;
+        if (!compilePath(&program, around, 6) || program.num_commands != 3 ||
+                program.commands[1].type != MOTION_ARC_AROUND_RIGHT || program.commands[2].cells != 2 ||
+                program.end.x != 0 || program.end.y != 1 || program.end_heading != West) {
+            TEST_FAIL("Path compiler arcs");
+            goto after_path_compiler_arcs;
+        }
+
+        initializeMotionProgram(&program, start, East);
+        program.turn_style = TURN_SEARCH_ARCS;
+        if (!compilePath(&program, standing, 3) || program.num_commands != 2 ||
+                program.commands[0].type != MOTION_TURN_RIGHT || program.commands[1].cells != 2) {
+            TEST_FAIL("Path compiler arcs");
+            goto after_path_compiler_arcs;
+        }
+    }
+
+    TEST_PASS("Path compiler arcs");
+    after_path_compiler_arcs:
+    ;
+
+    // Test the lookahead waypoints, they follow the flood route and move along with the robot
+    {
+        static probabilistic_maze_t maze;
+        static cell_t cells[MAZE_WIDTH * MAZE_HEIGHT];
+        static waypoints_t waypoints;
+        cell_t start = { .x = INIT_CELL_X, .y = INIT_CELL_Y };
+        gaussian_location_t robot;
+
+        initializeMaze(&maze);
+        readInMaze(actual_string, &maze);
+        int length = floodRoute(&maze, start, cells);
+
+        initializeStrategy();
+        waypoints.count = 0;
+        for (int at = 0; at < length; at += 3) {
+            robot.x_mu = cellNumberToCoordinateDistance(cells[at].x);
+            robot.y_mu = cellNumberToCoordinateDistance(cells[at].y);
+            strategyLookahead(&robot, &maze, &waypoints);
+
+            int expected = min(LOOKAHEAD_CELLS, length - 1 - at);
+            if (waypoints.from.x != cells[at].x || waypoints.from.y != cells[at].y || waypoints.count != expected) {
+                TEST_FAIL("Strategy lookahead");
+                goto after_lookahead;
+            }
+            for (int i = 0; i < waypoints.count; i++) {
+                cell_t cell = waypointAt(&waypoints, i);
+                if (cell.x != cells[at + 1 + i].x || cell.y != cells[at + 1 + i].y) {
+                    TEST_FAIL("Strategy lookahead");
+                    goto after_lookahead;
+                }
+            }
+        }
+
+        // Off the route it starts over from the robot's cell
+        cell_t off = { .x = 0, .y = 1 };
+        robot.x_mu = cellNumberToCoordinateDistance(off.x);
+        robot.y_mu = cellNumberToCoordinateDistance(off.y);
+        strategyLookahead(&robot, &maze, &waypoints);
+        cell_t next = chooseNextCell(&maze, &off);
+        if (waypoints.from.x != off.x || waypoints.from.y != off.y ||
+                waypointAt(&waypoints, 0).x != next.x || waypointAt(&waypoints, 0).y != next.y) {
+            TEST_FAIL("Strategy lookahead");
+            goto after_lookahead;
+        }
+    }
+
+    TEST_PASS("Strategy lookahead");
+    after_lookahead:
+    ;
+
+    // Test exploring until the shortest path is proven
+    if (!checkExploration(empty_string) || !checkExploration(spiral_string) || !checkExploration(loop_string) ||
+            !checkExploration(actual_string) || !checkExploration(staircase_string)) {
+        TEST_FAIL("Exploration");
+    } else {
+        TEST_PASS("Exploration");
+    }
+
+    // Test a wall of the start that the sensors never make sure of, exploration takes it as it is
+    // after EXPLORATION_LOOKS calls in the start instead of staying there for good
+    {
+        static probabilistic_maze_t truth;
+        static probabilistic_maze_t found;
+        static exploration_t exploration;
+        static strategy_context_t context;
+        cell_t start = { .x = INIT_CELL_X, .y = INIT_CELL_Y };
+
+        initializeStrategy(&context);
+        initializeMaze(&truth);
+        readInMaze(empty_string, &truth);
+        initializeMaze(&found);
+        initializeExploration(&exploration);
+
+        Direction open = North;
+        for (int dir = North; dir <= West; dir++) {
+            if (!wallExists(mazeWall(&truth, start.x, start.y, (Direction) dir))) {
+                open = (Direction) dir;
+            }
+        }
+        probabilistic_wall_t* unsure = mazeWall(&found, start.x, start.y, open);
+
+        cell_t cell = start;
+        for (int calls = 0; calls < 4 * MAZE_WIDTH * MAZE_HEIGHT + EXPLORATION_LOOKS; calls++) {
+            revealCell(&truth, &found, cell);
+            setWallProbability(unsure, 0.5);
+            updateKnownWalls(&exploration, &found);
+            cell = chooseExplorationCell(&context, &exploration, &found, cell);
+            if (exploration.mode == EXPLORE_DONE) {
+                break;
+            }
+        }
+
+        if (exploration.mode != EXPLORE_DONE || exploration.lower_bound != exploration.upper_bound) {
+            TEST_FAIL("Exploration target that stays unsure");
+        } else {
+            TEST_PASS("Exploration target that stays unsure");
+        }
+    }
+
+    // Test the goal set, with the top left goal cell closed off from the start side the robot
+    // stops in the first goal cell it gets to, and comes back the same way to the start
+    {
+        static probabilistic_maze_t maze;
+        initializeStrategy();
+        if (!checkGoalSetFloodfill(actual_string) || !checkGoalSetFloodfill(spiral_string) ||
+                !checkGoalSetFloodfill(loop_string)) {
+            TEST_FAIL("Goal set");
+            goto after_goal_set;
+        }
+
+        initializeMaze(&maze);
+        readInMaze(empty_string, &maze);
+        setWallProbability(mazeWall(&maze, GOAL_CELL_X, GOAL_CELL_Y, North), 1.0);
+        setWallProbability(mazeWall(&maze, GOAL_CELL_X, GOAL_CELL_Y, West), 1.0);
+
+        gaussian_location_t robot;
+        robot.x_mu = INIT_X_MU;
+        robot.y_mu = INIT_Y_MU;
+        int to_goal = strategyMoves(&maze, &robot);
+        int shortest = GOAL_CELL_X + GOAL_CELL_Y + 1 - INIT_CELL_X - INIT_CELL_Y;
+        if (to_goal != shortest || !atGoal(&robot)) {
+            TEST_FAIL("Goal set");
+            goto after_goal_set;
+        }
+
+        setStrategyTarget(TARGET_START);
+        int to_start = strategyMoves(&maze, &robot);
+        if (to_start != shortest || coordinateDistanceToCellNumber(robot.x_mu) != INIT_CELL_X ||
+                coordinateDistanceToCellNumber(robot.y_mu) != INIT_CELL_Y) {
+            TEST_FAIL("Goal set");
+            goto after_goal_set;
+        }
+        initializeStrategy();
+    }
+
+    TEST_PASS("Goal set");
+    after_goal_set:
+    ;
+
+    // Test the floodfill on a half-size maze, with the center 2x2 as the goal every value is the
+    // Manhattan distance to it, and a closed off cell can not be reached
+    {
+        static probabilistic_grid_t<32, 32> maze;
+        static floodfill_grid_t<32, 32> grid;
+        cell_t center[] = { { 15, 15 }, { 16, 15 }, { 15, 16 }, { 16, 16 } };
+        initializeMaze(&maze);
+        for (int n = 0; n < maze.num_walls; n++) {
+            if (!wallExists(mazeWallByNumber(&maze, n))) {
+                setWallProbability(mazeWallByNumber(&maze, n), 0.0);
+            }
+        }
+        setWallProbability(mazeWall(&maze, 0, 31, North), 1.0);
+        setWallProbability(mazeWall(&maze, 0, 31, East), 1.0);
+
+        floodfillGrid(&maze, center, 4, 0, &grid);
+        for (int x = 0; x < 32; x++) {
+            for (int y = 0; y < 32; y++) {
+                int expected = (x == 0 && y == 31) ? grid.max_value :
+                               (x < 15 ? 15 - x : x > 16 ? x - 16 : 0) + (y < 15 ? 15 - y : y > 16 ? y - 16 : 0);
+                if (grid.values[x][y] != expected) {
+                    printf("Cell (%d, %d): %d, expected %d\n", x, y, grid.values[x][y], expected);
+                    TEST_FAIL("Half-size floodfill");
+                    goto after_half_size;
+                }
+            }
+        }
+        if (grid.max_value != 32 * 32) {
+            TEST_FAIL("Half-size floodfill");
+            goto after_half_size;
+        }
+    }
+
+    TEST_PASS("Half-size floodfill");
+    after_half_size:
+    ;
+
+    // Test the maze files, the start cell of a .maz file (walled on all but its north side) is (0, 0)
+    // with only its south side open, and a corpus is mazes back to back
+    {
+        static probabilistic_maze_t maze;
+        static probabilistic_maze_t loaded;
+        static uint8_t bytes[MAZ_FILE_BYTES];
+        char path[] = "/tmp/strategy_test_XXXXXX";
+        maze_corpus_t corpus;
+
+        for (int i = 0; i < MAZ_FILE_BYTES; i++) {
+            bytes[i] = 0;
+        }
+        bytes[0] = MAZ_EAST | MAZ_SOUTH | MAZ_WEST;
+        decodeMaz(bytes, &maze);
+        if (!wallExists(mazeWall(&maze, 0, 0, North)) || !wallExists(mazeWall(&maze, 0, 0, East)) ||
+                wallExists(mazeWall(&maze, 0, 0, South)) || wallExists(mazeWall(&maze, 1, 1, North))) {
+            TEST_FAIL("Maze files");
+            goto after_maze_files;
+        }
+
+        if (!checkMazeFormats(empty_string) || !checkMazeFormats(spiral_string) ||
+                !checkMazeFormats(loop_string) || !checkMazeFormats(actual_string)) {
+            TEST_FAIL("Maze files");
+            goto after_maze_files;
+        }
+
+        int fd = mkstemp(path);
+        unsigned int seed = 99;
+        for (int m = 0; m < 3; m++) {
+            randomMaze(&maze, &seed, 40);
+            encodeMaz(&maze, bytes);
+            if (fd < 0 || write(fd, bytes, MAZ_FILE_BYTES) != MAZ_FILE_BYTES) {
+                TEST_FAIL("Maze files");
+                goto after_maze_files;
+            }
+        }
+        close(fd);
+
+        seed = 99;
+        bool corpus_ok = openMazeCorpus(path, &corpus) && corpus.num_mazes == 3 &&
+                         corpusMaze(&corpus, 2) == corpus.data + 2 * MAZ_FILE_BYTES;
+        for (int m = 0; corpus_ok && m < corpus.num_mazes; m++) {
+            randomMaze(&maze, &seed, 40);
+            decodeMaz(corpusMaze(&corpus, m), &loaded);
+            corpus_ok = sameWalls(&maze, &loaded);
+        }
+        closeMazeCorpus(&corpus);
+
+        // Not a whole number of mazes
+        truncate(path, MAZ_FILE_BYTES + 1);
+        corpus_ok = corpus_ok && !openMazeCorpus(path, &corpus) && !loadMazFile(path, &loaded);
+        unlink(path);
+        if (!corpus_ok) {
+            TEST_FAIL("Maze files");
+            goto after_maze_files;
+        }
+    }
+
+    TEST_PASS("Maze files");
+    after_maze_files:
+    ;
+
+    // Test the maze generator on the robot's maze, a half-size maze and an odd sized one, and that
+    // corpus mazes can be made again from their seed
+    {
+        static probabilistic_maze_t maze;
+        static probabilistic_maze_t loaded;
+        char path[] = "/tmp/strategy_test_XXXXXX";
+        maze_corpus_t corpus;
+
+        if (!checkGeneratedMazes<MAZE_WIDTH, MAZE_HEIGHT>(0) || !checkGeneratedMazes<MAZE_WIDTH, MAZE_HEIGHT>(30) ||
+                !checkGeneratedMazes<32, 32>(0) || !checkGeneratedMazes<32, 32>(10) ||
+                !checkGeneratedMazes<9, 7>(0) || !checkGeneratedMazes<9, 7>(50)) {
+            TEST_FAIL("Maze generator");
+            goto after_maze_generator;
+        }
+
+        close(mkstemp(path));
+        bool corpus_ok = writeMazeCorpus(path, 7, 5, 20) && openMazeCorpus(path, &corpus) && corpus.num_mazes == 5;
+        for (int m = 0; corpus_ok && m < corpus.num_mazes; m++) {
+            generateMaze(&maze, corpusMazeSeed(7, m), 20);
+            decodeMaz(corpusMaze(&corpus, m), &loaded);
+            corpus_ok = sameWalls(&maze, &loaded) && checkMazeRules(&loaded);
+        }
+        closeMazeCorpus(&corpus);
+        unlink(path);
+        if (!corpus_ok) {
+            TEST_FAIL("Maze generator");
+            goto after_maze_generator;
+        }
+    }
+
+    TEST_PASS("Maze generator");
+    after_maze_generator:
+    ;
+
+    // Test that strategy contexts are independent: a corpus run on several threads at once gives the
+    // same steps, turns and decisions for every maze as one maze at a time
+    if (!checkCorpusRuns()) {
+        TEST_FAIL("Corpus runner");
+        goto after_corpus_runner;
+    }
+
+    TEST_PASS("Corpus runner");
+    after_corpus_runner:
+    ;
+
 } TEST_FUNC_END("strategy_test")
 
 #endif // ARDUINO
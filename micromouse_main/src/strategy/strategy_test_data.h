@@ -4,6 +4,11 @@
 #define _STRATEGY_TEST_DATA_H_
 
 
+#include "strategy.h"
+#include "exploration.h"
+#include "../localization/probabilistic_maze.h"
+
+
 #define size 16*2+1
 
 
@@ -154,4 +159,151 @@ const char* actual_string[size] = {
     "XXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX"
 };
 
+
+/* Staircase from the start to the goal, and an L shaped corridor of the same length */
+const char* staircase_string[size] = {
+    "XXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX",
+    "X               XXXXXXXXXXXXXXXXX",
+    "X XXXXXXXXXXXXX XXXXXXXXXXXXXXXXX",
+    "X   XXXXXXXXXXX XXXXXXXXXXXXXXXXX",
+    "XXX XXXXXXXXXXX XXXXXXXXXXXXXXXXX",
+    "XXX   XXXXXXXXX XXXXXXXXXXXXXXXXX",
+    "XXXXX XXXXXXXXX XXXXXXXXXXXXXXXXX",
+    "XXXXX   XXXXXXX XXXXXXXXXXXXXXXXX",
+    "XXXXXXX XXXXXXX XXXXXXXXXXXXXXXXX",
+    "XXXXXXX   XXXXX XXXXXXXXXXXXXXXXX",
+    "XXXXXXXXX XXXXX XXXXXXXXXXXXXXXXX",
+    "XXXXXXXXX   XXX XXXXXXXXXXXXXXXXX",
+    "XXXXXXXXXXX XXX XXXXXXXXXXXXXXXXX",
+    "XXXXXXXXXXX   X XXXXXXXXXXXXXXXXX",
+    "XXXXXXXXXXXXX X XXXXXXXXXXXXXXXXX",
+    "XXXXXXXXXXXXX   XXXXXXXXXXXXXXXXX",
+    "XXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX",
+    "XXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX",
+    "XXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX",
+    "XXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX",
+    "XXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX",
+    "XXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX",
+    "XXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX",
+    "XXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX",
+    "XXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX",
+    "XXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX",
+    "XXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX",
+    "XXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX",
+    "XXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX",
+    "XXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX",
+    "XXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX",
+    "XXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX",
+    "XXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX"
+};
+
+/* Read a maze drawn with 'X' walls into maze, every wall is set to 1.0 or 0.0 */
+inline void readInMaze(const char** maze_string, probabilistic_maze_t* maze) {
+
+    int i2 = 0;
+    for (int i = 1; i < size; i+=2) {
+        int j2 = 0;
+        for (int j = 1; j < size; j+=2) {
+            
+            // North(0, -1)
+            if (maze_string[i][j-1] == 'X') setWallProbability(mazeWall(maze, i2, j2, North), 1.0);
+            else setWallProbability(mazeWall(maze, i2, j2, North), 0.0);
+            
+            // East(1, 0)
+            if (maze_string[i+1][j] == 'X') setWallProbability(mazeWall(maze, i2, j2, East), 1.0);
+            else setWallProbability(mazeWall(maze, i2, j2, East), 0.0);
+            
+            // South(0, 1)
+            if (maze_string[i][j+1] == 'X') setWallProbability(mazeWall(maze, i2, j2, South), 1.0);
+            else setWallProbability(mazeWall(maze, i2, j2, South), 0.0);
+            
+            // West(-1, 0)
+            if (maze_string[i-1][j] == 'X') setWallProbability(mazeWall(maze, i2, j2, West), 1.0);
+            else setWallProbability(mazeWall(maze, i2, j2, West), 0.0);
+            
+            j2++;
+        }
+        i2++;
+    }
+}
+
+/* Cells chooseNextCell goes through from start to the goal set after a floodfill, both included,
+ * cells needs room for every cell of the maze, returns the number of cells */
+inline int floodRoute(probabilistic_maze_t* maze, cell_t start, cell_t* cells) {
+    floodfillCells(maze, goal_set.cells, goal_set.num_cells, 0);
+
+    int length = 0;
+    cell_t cell = start;
+    cells[length++] = cell;
+    while (length < MAZE_WIDTH * MAZE_HEIGHT) {
+        cell_t next = chooseNextCell(maze, &cell);
+        if (next.x == cell.x && next.y == cell.y) {
+            break;
+        }
+        cell = next;
+        cells[length++] = cell;
+    }
+    return length;
+}
+
+/* Empty maze with each interior wall present with a chance of wall_percent in 100, from seed */
+template <int W, int H>
+void randomMaze(probabilistic_grid_t<W, H>* maze, unsigned int* seed, int wall_percent) {
+    initializeMaze(maze);
+    for (int n = 0; n < probabilistic_grid_t<W, H>::num_walls; n++) {
+        *seed = *seed * 1103515245 + 12345;
+        probabilistic_wall_t* wall = mazeWallByNumber(maze, n);
+        if (!wallExists(wall)) {
+            setWallProbability(wall, (int) ((*seed >> 8) % 100) < wall_percent ? 1.0 : 0.0);
+        }
+    }
+}
+
+/* Copy the four walls of cell from truth into maze, the way the sensors would see them */
+inline void revealCell(probabilistic_maze_t* truth, probabilistic_maze_t* maze, cell_t cell) {
+    for (int dir = North; dir <= West; dir++) {
+        bool exists = wallExists(mazeWall(truth, cell.x, cell.y, (Direction) dir));
+        setWallProbability(mazeWall(maze, cell.x, cell.y, (Direction) dir), exists ? 1.0 : 0.0);
+    }
+}
+
+/* Explore truth from the start with chooseExplorationCell until EXPLORE_DONE, seeing the walls of
+ * each cell the robot is in, maze is what the robot found
+ *  - search_moves gets the moves until the bounds agreed, cells_visited the different cells
+ *  - Returns the number of moves, -1 if it takes more than any exploration should */
+int exploreMaze(probabilistic_maze_t* truth, probabilistic_maze_t* maze, exploration_t* exploration,
+                int* search_moves, int* cells_visited) {
+    static bool visited[MAZE_WIDTH][MAZE_HEIGHT];
+    for (int x = 0; x < MAZE_WIDTH; x++) {
+        for (int y = 0; y < MAZE_HEIGHT; y++) {
+            visited[x][y] = false;
+        }
+    }
+    initializeMaze(maze);
+    initializeExploration(exploration);
+
+    cell_t cell = { .x = INIT_CELL_X, .y = INIT_CELL_Y };
+    *search_moves = 0;
+    *cells_visited = 0;
+    for (int moves = 0; moves < 4 * MAZE_WIDTH * MAZE_HEIGHT; moves++) {
+        if (!visited[cell.x][cell.y]) {
+            visited[cell.x][cell.y] = true;
+            (*cells_visited)++;
+        }
+        revealCell(truth, maze, cell);
+        updateKnownWalls(exploration, maze);
+
+        cell_t next = chooseExplorationCell(exploration, maze, cell);
+        if (exploration->mode == EXPLORE_SEARCH) {
+            *search_moves = moves + 1;
+        }
+        if (exploration->mode == EXPLORE_DONE) {
+            return moves;
+        }
+        cell = next;
+    }
+    return -1;
+}
+
+
 #endif //_STRATEGY_TEST_DATA_H_
@@ -19,3 +19,8 @@ int coordinateDistanceToCellNumber(double coordinateDistance) {
 double cellNumberToCoordinateDistance(int cellNumber) {
     return (double)((cellNumber * (WALL_THICKNESS + CELL_LENGTH)) + (CELL_LENGTH / 2));
 }
+
+/* Convert a half cell lattice number to a coordinate distance measured in mm */
+double latticeNumberToCoordinateDistance(int latticeNumber) {
+    return (double)(latticeNumber * (WALL_THICKNESS + CELL_LENGTH)) / 2 - (WALL_THICKNESS / 2.0);
+}
@@ -17,5 +17,9 @@ int coordinateDistanceToCellNumber(double coordinateDistance);
 /* Convert a cell number to a coordinate distance measured in mm that is the center of the cell */
 double cellNumberToCoordinateDistance(int cellNumber);
 
+/* Convert a half cell lattice number to a coordinate distance measured in mm
+ * - Odd numbers are the centers of cells, even numbers the middle of the walls between them */
+double latticeNumberToCoordinateDistance(int latticeNumber);
+
 
 #endif //_CONVERSIONS_H_
@@ -3,6 +3,7 @@
 #include "direction.h"
 #include "../settings.h"
 
-double directionToRAD[4] = { 3*PI/2, 0, PI/2, PI };
-double directionToXY[4][2] = { { 0, -1 }, { 1, 0 }, { 0, 1 }, { -1, 0 } };
+double directionToRAD[NUM_DIRECTIONS] = { 3*PI/2, 0, PI/2, PI, 7*PI/4, PI/4, 3*PI/4, 5*PI/4 };
+double directionToXY[NUM_DIRECTIONS][2] = { { 0, -1 }, { 1, 0 }, { 0, 1 }, { -1, 0 },
+                                            { 1, -1 }, { 1, 1 }, { -1, 1 }, { -1, -1 } };
 
@@ -10,11 +10,19 @@ enum Direction {
     East,   // East(1, 0)   theta = 0
     South,  // South(0, 1)  theta = PI/2
     West,   // West(-1, 0)  theta = PI
+
+    // Diagonals, only for driving, walls are only found by the four above
+    NorthEast,  // NorthEast(1, -1)  theta = 7*PI/4
+    SouthEast,  // SouthEast(1, 1)   theta = PI/4
+    SouthWest,  // SouthWest(-1, 1)  theta = 3*PI/4
+    NorthWest,  // NorthWest(-1, -1) theta = 5*PI/4
 };
 
-extern double directionToRAD[4];
+#define NUM_DIRECTIONS 8
+
+extern double directionToRAD[NUM_DIRECTIONS];
 
-extern double directionToXY[4][2];
+extern double directionToXY[NUM_DIRECTIONS][2];
 
 
 #endif //_DIRECTION_H_
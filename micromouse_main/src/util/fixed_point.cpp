@@ -0,0 +1,45 @@
+/* fixed_point.cpp */
+
+
+#include "fixed_point.h"
+#include "../settings.h"
+
+
+#define Q16_16_PI       q16_16_t(PI)
+#define Q16_16_HALF_PI  q16_16_t(HALF_PI)
+#define Q16_16_TWO_PI   q16_16_t(TWO_PI)
+
+#define Q2_30(value)    ((int64_t) ((value) * (1L << 30) + 0.5))
+
+
+/* Sine by range reduction to [-pi/2, pi/2] and a 9th order Taylor polynomial
+ *  - Truncation error is below 4e-6, about a quarter of the output resolution */
+q16_16_t sin(q16_16_t angle) {
+
+    // Reduce to (-pi, pi]
+    int32_t r = angle.raw % Q16_16_TWO_PI.raw;
+    if (r > Q16_16_PI.raw) r -= Q16_16_TWO_PI.raw;
+    if (r <= -Q16_16_PI.raw) r += Q16_16_TWO_PI.raw;
+
+    // Reflect into [-pi/2, pi/2] using sin(pi - x) = sin(x)
+    if (r > Q16_16_HALF_PI.raw) r = Q16_16_PI.raw - r;
+    if (r < -Q16_16_HALF_PI.raw) r = -Q16_16_PI.raw - r;
+
+    // Evaluate in Q2.30 so the small high order coefficients keep their precision
+    int64_t x = (int64_t) r << (30 - Q16_16_FRACTION_BITS);
+    int64_t x2 = (x * x) >> 30;
+
+    // x - x^3/3! + x^5/5! - x^7/7! + x^9/9! in Horner form
+    int64_t poly = Q2_30(1.0 / 362880);
+    poly = Q2_30(1.0 / 5040) - ((x2 * poly) >> 30);
+    poly = Q2_30(1.0 / 120) - ((x2 * poly) >> 30);
+    poly = Q2_30(1.0 / 6) - ((x2 * poly) >> 30);
+    poly = Q2_30(1.0) - ((x2 * poly) >> 30);
+
+    int64_t result = (x * poly) >> 30;
+    return q16_16_t::fromRaw((int32_t) ((result + (1 << (29 - Q16_16_FRACTION_BITS))) >> (30 - Q16_16_FRACTION_BITS)));
+}
+
+q16_16_t cos(q16_16_t angle) {
+    return sin(angle + Q16_16_HALF_PI);
+}
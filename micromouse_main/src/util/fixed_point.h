@@ -0,0 +1,103 @@
+/* fixed_point.h
+ *
+ * Q16.16 signed fixed point number. The Due's SAM3X has no FPU,
+ * so every double operation is emulated in software; this type
+ * keeps the arithmetic in 32-bit integers instead.
+ *
+ * Range is about +/-32768 with a resolution of 1/65536, which is
+ * plenty for positions in mm inside a 16x16 maze. Multiplication
+ * and division saturate instead of wrapping around.
+ */
+
+#ifndef _FIXED_POINT_H_
+#define _FIXED_POINT_H_
+
+#include <stdint.h>
+
+
+#define Q16_16_FRACTION_BITS    16
+#define Q16_16_ONE              ((int32_t)1 << Q16_16_FRACTION_BITS)
+
+
+class q16_16_t {
+    public:
+        constexpr q16_16_t() : raw(0) {
+        }
+
+        constexpr q16_16_t(int value) : raw((int32_t)(value * Q16_16_ONE)) {
+        }
+
+        constexpr q16_16_t(double value) : raw((int32_t)(value * Q16_16_ONE + (value >= 0 ? 0.5 : -0.5))) {
+        }
+
+        /* Build a number directly from its Q16.16 representation */
+        static constexpr q16_16_t fromRaw(int32_t raw) {
+            return q16_16_t(raw, raw_tag());
+        }
+
+        constexpr double toDouble() const {
+            return (double) raw / Q16_16_ONE;
+        }
+
+        constexpr float toFloat() const {
+            return (float) raw / Q16_16_ONE;
+        }
+
+        /* Rounds toward negative infinity */
+        constexpr int toInt() const {
+            return raw >> Q16_16_FRACTION_BITS;
+        }
+
+        friend constexpr q16_16_t operator+(q16_16_t a, q16_16_t b) {
+            return q16_16_t::fromRaw(a.raw + b.raw);
+        }
+
+        friend constexpr q16_16_t operator-(q16_16_t a, q16_16_t b) {
+            return q16_16_t::fromRaw(a.raw - b.raw);
+        }
+
+        friend constexpr q16_16_t operator-(q16_16_t a) {
+            return q16_16_t::fromRaw(-a.raw);
+        }
+
+        friend constexpr q16_16_t operator*(q16_16_t a, q16_16_t b) {
+            return q16_16_t::fromRaw(saturate((((int64_t) a.raw * b.raw) + (Q16_16_ONE / 2)) >> Q16_16_FRACTION_BITS));
+        }
+
+        friend constexpr q16_16_t operator/(q16_16_t a, q16_16_t b) {
+            return b.raw == 0 ? q16_16_t::fromRaw(a.raw < 0 ? INT32_MIN : INT32_MAX)
+                              : q16_16_t::fromRaw(saturate(((int64_t) a.raw * Q16_16_ONE) / b.raw));
+        }
+
+        friend constexpr bool operator==(q16_16_t a, q16_16_t b) { return a.raw == b.raw; }
+        friend constexpr bool operator!=(q16_16_t a, q16_16_t b) { return a.raw != b.raw; }
+        friend constexpr bool operator<(q16_16_t a, q16_16_t b) { return a.raw < b.raw; }
+        friend constexpr bool operator>(q16_16_t a, q16_16_t b) { return a.raw > b.raw; }
+        friend constexpr bool operator<=(q16_16_t a, q16_16_t b) { return a.raw <= b.raw; }
+        friend constexpr bool operator>=(q16_16_t a, q16_16_t b) { return a.raw >= b.raw; }
+
+        q16_16_t& operator+=(q16_16_t b) { return *this = *this + b; }
+        q16_16_t& operator-=(q16_16_t b) { return *this = *this - b; }
+        q16_16_t& operator*=(q16_16_t b) { return *this = *this * b; }
+        q16_16_t& operator/=(q16_16_t b) { return *this = *this / b; }
+
+        int32_t raw;
+
+    private:
+        struct raw_tag {};
+
+        constexpr q16_16_t(int32_t value, raw_tag) : raw(value) {
+        }
+
+        static constexpr int32_t saturate(int64_t value) {
+            return value > INT32_MAX ? INT32_MAX : (value < INT32_MIN ? INT32_MIN : (int32_t) value);
+        }
+};
+
+
+/* Sine and cosine of an angle in radians, accurate to a few counts of the last bit */
+q16_16_t sin(q16_16_t angle);
+q16_16_t cos(q16_16_t angle);
+
+
+#endif //_FIXED_POINT_H_
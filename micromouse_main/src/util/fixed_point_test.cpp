@@ -0,0 +1,60 @@
+#ifndef ARDUINO
+#include <math.h>
+#include "fixed_point.h"
+#include "../testing.h"
+#include "../settings.h"
+
+#define IS_BETWEEN_ERROR(x,y,e) (((x) < (y) + (e)) && ((x) > (y) - (e)))
+#define RESOLUTION (1.0 / Q16_16_ONE)
+
+TEST_FUNC_BEGIN {
+    q16_16_t a = 3.25;
+    q16_16_t b = -1.5;
+
+    if (a.toDouble() != 3.25 || b.toDouble() != -1.5 || q16_16_t(7).toDouble() != 7.0) {
+        TEST_FAIL("Fixed point conversion");
+    } else {
+        TEST_PASS("Fixed point conversion");
+    }
+
+    if ((a + b).toDouble() != 1.75 || (a - b).toDouble() != 4.75 || (-a).toDouble() != -3.25) {
+        TEST_FAIL("Fixed point addition");
+    } else {
+        TEST_PASS("Fixed point addition");
+    }
+
+    if ((a * b).toDouble() != -4.875 || !IS_BETWEEN_ERROR((a / b).toDouble(), 3.25 / -1.5, RESOLUTION)) {
+        TEST_FAIL("Fixed point multiplication");
+    } else {
+        TEST_PASS("Fixed point multiplication");
+    }
+
+    if ((q16_16_t(30000) * q16_16_t(2)).raw != INT32_MAX || (q16_16_t(-30000) * q16_16_t(2)).raw != INT32_MIN ||
+            (a / q16_16_t(0)).raw != INT32_MAX) {
+        TEST_FAIL("Fixed point saturation");
+    } else {
+        TEST_PASS("Fixed point saturation");
+    }
+
+    if (!(b < a) || !(a > 3) || !(b <= -1.5) || a == b || (2.0 * a).toDouble() != 6.5) {
+        TEST_FAIL("Fixed point comparison");
+    } else {
+        TEST_PASS("Fixed point comparison");
+    }
+
+    for (double angle = -10.0; angle < 10.0; angle += 0.01) {
+        if (!IS_BETWEEN_ERROR(sin(q16_16_t(angle)).toDouble(), sin(angle), 4 * RESOLUTION) ||
+                !IS_BETWEEN_ERROR(cos(q16_16_t(angle)).toDouble(), cos(angle), 4 * RESOLUTION)) {
+            printf("angle: %f, sin: %f (%f), cos: %f (%f)\n", angle, sin(q16_16_t(angle)).toDouble(), sin(angle),
+                    cos(q16_16_t(angle)).toDouble(), cos(angle));
+            TEST_FAIL("Fixed point trigonometry");
+            goto after_trigonometry;
+        }
+    }
+    TEST_PASS("Fixed point trigonometry");
+    after_trigonometry:
+    ;
+
+} TEST_FUNC_END("fixed_point_test")
+
+#endif // ARDUINO
@@ -0,0 +1,104 @@
+/* matrix.h
+ *
+ * Fixed size matrices for the localization filters. The size is part
+ * of the type, so there is no heap and no bounds to check at run time,
+ * and the loops unroll for the 3x3 filter state.
+ *
+ * T is the numeric backend, see numeric_policy.h
+ */
+
+#ifndef _MATRIX_H_
+#define _MATRIX_H_
+
+
+template <typename T, int R, int C>
+struct matrix {
+    T m[R][C];
+};
+
+
+/*----------- Public Functions -----------*/
+
+/* All zeros */
+template <typename T, int R, int C>
+matrix<T, R, C> zeroMatrix() {
+    matrix<T, R, C> result;
+    for (int i = 0; i < R; i++) {
+        for (int j = 0; j < C; j++) {
+            result.m[i][j] = 0;
+        }
+    }
+    return result;
+}
+
+/* Identity of size N */
+template <typename T, int N>
+matrix<T, N, N> identityMatrix() {
+    matrix<T, N, N> result = zeroMatrix<T, N, N>();
+    for (int i = 0; i < N; i++) {
+        result.m[i][i] = 1;
+    }
+    return result;
+}
+
+template <typename T, int R, int K, int C>
+matrix<T, R, C> operator*(const matrix<T, R, K>& a, const matrix<T, K, C>& b) {
+    matrix<T, R, C> result;
+    for (int i = 0; i < R; i++) {
+        for (int j = 0; j < C; j++) {
+            T sum = 0;
+            for (int k = 0; k < K; k++) {
+                sum += a.m[i][k] * b.m[k][j];
+            }
+            result.m[i][j] = sum;
+        }
+    }
+    return result;
+}
+
+template <typename T, int R, int C>
+matrix<T, R, C> operator*(T scale, const matrix<T, R, C>& a) {
+    matrix<T, R, C> result;
+    for (int i = 0; i < R; i++) {
+        for (int j = 0; j < C; j++) {
+            result.m[i][j] = scale * a.m[i][j];
+        }
+    }
+    return result;
+}
+
+template <typename T, int R, int C>
+matrix<T, R, C> operator+(const matrix<T, R, C>& a, const matrix<T, R, C>& b) {
+    matrix<T, R, C> result;
+    for (int i = 0; i < R; i++) {
+        for (int j = 0; j < C; j++) {
+            result.m[i][j] = a.m[i][j] + b.m[i][j];
+        }
+    }
+    return result;
+}
+
+template <typename T, int R, int C>
+matrix<T, R, C> operator-(const matrix<T, R, C>& a, const matrix<T, R, C>& b) {
+    matrix<T, R, C> result;
+    for (int i = 0; i < R; i++) {
+        for (int j = 0; j < C; j++) {
+            result.m[i][j] = a.m[i][j] - b.m[i][j];
+        }
+    }
+    return result;
+}
+
+template <typename T, int R, int C>
+matrix<T, C, R> transpose(const matrix<T, R, C>& a) {
+    matrix<T, C, R> result;
+    for (int i = 0; i < R; i++) {
+        for (int j = 0; j < C; j++) {
+            result.m[j][i] = a.m[i][j];
+        }
+    }
+    return result;
+}
+
+
+#endif //_MATRIX_H_
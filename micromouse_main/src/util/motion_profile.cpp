@@ -0,0 +1,188 @@
+/* motion_profile.cpp */
+
+
+#include <math.h>
+
+#include "motion_profile.h"
+
+
+#define PROFILE_BISECTIONS 60   // Halvings of a search, down to the rounding of a double
+
+
+/* A change of speed from from to to, starting and ending with no acceleration
+ *  - ramp is the time of each of the two jerk phases, hold the time at peak_accel between them */
+static void speedChange(const motion_limits_t* limits, double from, double to,
+                        double* ramp, double* hold, double* peak_accel) {
+    double change = fabs(to - from);
+    double accel = limits->max_accel;
+    double jerk = limits->max_jerk;
+
+    if (jerk <= 0) {
+        *ramp = 0;
+        *hold = change / accel;
+        *peak_accel = change > 0 ? accel : 0;
+    } else if (change * jerk >= accel * accel) {
+        // Gets to max_accel
+        *ramp = accel / jerk;
+        *hold = change / accel - accel / jerk;
+        *peak_accel = accel;
+    } else {
+        *ramp = sqrt(change / jerk);
+        *hold = 0;
+        *peak_accel = jerk * *ramp;
+    }
+}
+
+/* Distance covered by speedChange, the acceleration is symmetric so the mean speed is halfway */
+static double speedChangeDistance(const motion_limits_t* limits, double from, double to) {
+    double ramp, hold, peak_accel;
+    speedChange(limits, from, to, &ramp, &hold, &peak_accel);
+    return (from + to) / 2 * (2 * ramp + hold);
+}
+
+/* Set phases first to first + 2 to the change from from to to */
+static void setSpeedChange(const motion_limits_t* limits, double from, double to, int first,
+                           motion_profile_t* profile) {
+    double ramp, hold, peak_accel;
+    speedChange(limits, from, to, &ramp, &hold, &peak_accel);
+    double sign = to >= from ? 1.0 : -1.0;
+    double jerk = limits->max_jerk > 0 ? limits->max_jerk : 0;
+
+    profile->time[first] = ramp;
+    profile->jerk[first] = sign * jerk;
+    profile->accel[first] = 0;
+    profile->time[first + 1] = hold;
+    profile->jerk[first + 1] = 0;
+    profile->accel[first + 1] = sign * peak_accel;
+    profile->time[first + 2] = ramp;
+    profile->jerk[first + 2] = -sign * jerk;
+    profile->accel[first + 2] = sign * peak_accel;
+}
+
+/* plan motion profile
+ * - The peak speed is the highest one, up to max_speed, that leaves room to get to exit_speed; the
+ *   distance of a change of speed grows with the peak, so it is found by bisection */
+bool planMotionProfile(const motion_limits_t* limits, double distance, double entry_speed, double exit_speed,
+                       motion_profile_t* profile) {
+    double top = limits->max_speed;
+    distance = fmax(distance, 0);
+    entry_speed = fmin(fmax(entry_speed, 0), top);
+    exit_speed = fmin(fmax(exit_speed, 0), top);
+
+    bool reachable = true;
+    double low = fmax(entry_speed, exit_speed);
+    double peak, cruise_distance;
+    if (speedChangeDistance(limits, entry_speed, low) + speedChangeDistance(limits, low, exit_speed) > distance) {
+        // Too short to get to exit_speed, go as far toward it as the distance allows
+        reachable = false;
+        double near = entry_speed, far = exit_speed;
+        for (int i = 0; i < PROFILE_BISECTIONS; i++) {
+            double middle = (near + far) / 2;
+            if (speedChangeDistance(limits, entry_speed, middle) > distance) {
+                far = middle;
+            } else {
+                near = middle;
+            }
+        }
+        exit_speed = near;
+        peak = fmax(entry_speed, exit_speed);
+        cruise_distance = distance - speedChangeDistance(limits, entry_speed, exit_speed);
+    } else if (speedChangeDistance(limits, entry_speed, top) + speedChangeDistance(limits, top, exit_speed) <= distance) {
+        peak = top;
+        cruise_distance = distance - speedChangeDistance(limits, entry_speed, top) -
+                          speedChangeDistance(limits, top, exit_speed);
+    } else {
+        double high = top;
+        for (int i = 0; i < PROFILE_BISECTIONS; i++) {
+            double middle = (low + high) / 2;
+            if (speedChangeDistance(limits, entry_speed, middle) + speedChangeDistance(limits, middle, exit_speed) >
+                    distance) {
+                high = middle;
+            } else {
+                low = middle;
+            }
+        }
+        peak = low;
+        cruise_distance = distance - speedChangeDistance(limits, entry_speed, peak) -
+                          speedChangeDistance(limits, peak, exit_speed);
+    }
+
+    setSpeedChange(limits, entry_speed, peak, 0, profile);
+    profile->time[3] = peak > 0 ? fmax(cruise_distance, 0) / peak : 0;
+    profile->jerk[3] = 0;
+    profile->accel[3] = 0;
+    setSpeedChange(limits, peak, exit_speed, 4, profile);
+
+    // Where each phase starts
+    double time = 0, position = 0, speed = entry_speed;
+    for (int i = 0; i < MOTION_PROFILE_PHASES; i++) {
+        double t = profile->time[i], a = profile->accel[i], j = profile->jerk[i];
+        profile->start_time[i] = time;
+        profile->position[i] = position;
+        profile->speed[i] = speed;
+        time += t;
+        position += speed * t + a * t * t / 2 + j * t * t * t / 6;
+        speed += a * t + j * t * t / 2;
+    }
+
+    profile->distance = distance;
+    profile->entry_speed = entry_speed;
+    profile->peak_speed = peak;
+    profile->exit_speed = exit_speed;
+    profile->duration = time;
+    return reachable;
+}
+
+/* Position, speed and acceleration dt into phase i */
+static void samplePhase(const motion_profile_t* profile, int i, double dt, motion_sample_t* sample) {
+    double a = profile->accel[i], j = profile->jerk[i];
+    sample->position = profile->position[i] + profile->speed[i] * dt + a * dt * dt / 2 + j * dt * dt * dt / 6;
+    sample->speed = profile->speed[i] + a * dt + j * dt * dt / 2;
+    sample->accel = a + j * dt;
+}
+
+/* sample motion profile
+ * Where the profile is time s after it starts, past the end it goes on at exit_speed */
+void sampleMotionProfile(const motion_profile_t* profile, double time, motion_sample_t* sample) {
+    if (time >= profile->duration) {
+        sample->position = profile->distance + profile->exit_speed * (time - profile->duration);
+        sample->speed = profile->exit_speed;
+        sample->accel = 0;
+        return;
+    }
+    time = fmax(time, 0);
+
+    int i = MOTION_PROFILE_PHASES - 1;
+    while (i > 0 && profile->start_time[i] > time) {
+        i--;
+    }
+    samplePhase(profile, i, time - profile->start_time[i], sample);
+}
+
+/* motion profile time at
+ * - The speed is never negative, so the position only grows and each phase is searched by bisection */
+double motionProfileTimeAt(const motion_profile_t* profile, double position) {
+    if (position <= 0) {
+        return 0;
+    }
+    if (position >= profile->distance) {
+        return profile->duration;
+    }
+
+    int i = MOTION_PROFILE_PHASES - 1;
+    while (i > 0 && profile->position[i] > position) {
+        i--;
+    }
+    double low = 0, high = profile->time[i];
+    for (int n = 0; n < PROFILE_BISECTIONS; n++) {
+        motion_sample_t sample;
+        double middle = (low + high) / 2;
+        samplePhase(profile, i, middle, &sample);
+        if (sample.position < position) {
+            low = middle;
+        } else {
+            high = middle;
+        }
+    }
+    return profile->start_time[i] + high;
+}
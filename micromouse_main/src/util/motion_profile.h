@@ -0,0 +1,78 @@
+/* motion_profile.h
+ *
+ * Time optimal speed profiles for driving a straight line, with limits
+ * on speed, acceleration and jerk, from an entry speed to an exit speed
+ * over a distance. A profile is seven phases of constant jerk, any of
+ * which can take no time:
+ *
+ *   speed
+ *     |           _______________
+ *     |         /                 \
+ *     |       /                     \
+ *     |  ___/                         \___
+ *     |
+ *     +--1--2--3--------4--------5--6--7--> time
+ *
+ *  1, 3, 5, 7: the acceleration ramps at max_jerk
+ *  2, 6:       the acceleration holds at max_accel
+ *  4:          cruise at the peak speed
+ *
+ * The acceleration is 0 at both ends, so profiles can be chained. With
+ * max_jerk 0 the acceleration steps at once and the profile is a
+ * trapezoid. Distances are in mm and times in s.
+ */
+
+#ifndef _MOTION_PROFILE_H_
+#define _MOTION_PROFILE_H_
+
+
+#define MOTION_PROFILE_PHASES 7
+
+
+typedef struct {
+    double max_speed;       // mm/s
+    double max_accel;       // mm/s^2
+    double max_jerk;        // mm/s^3, 0 for no limit
+} motion_limits_t;
+
+typedef struct {
+    // Each phase starts at start_time[i] with this position, speed and acceleration, and lasts time[i]
+    double time[MOTION_PROFILE_PHASES];
+    double jerk[MOTION_PROFILE_PHASES];
+    double start_time[MOTION_PROFILE_PHASES];
+    double position[MOTION_PROFILE_PHASES];
+    double speed[MOTION_PROFILE_PHASES];
+    double accel[MOTION_PROFILE_PHASES];
+
+    double distance;
+    double entry_speed;
+    double peak_speed;
+    double exit_speed;
+    double duration;
+} motion_profile_t;
+
+typedef struct {
+    double position;
+    double speed;
+    double accel;
+} motion_sample_t;
+
+
+/* plan motion profile
+ * The fastest profile within limits that goes distance from entry_speed and ends at exit_speed
+ *  - Speeds are limited to 0 to max_speed
+ *  - Returns false if exit_speed can not be reached within distance, the profile then ends at the
+ *    closest speed it can (profile->exit_speed) */
+bool planMotionProfile(const motion_limits_t* limits, double distance, double entry_speed, double exit_speed,
+                       motion_profile_t* profile);
+
+/* sample motion profile
+ * Where the profile is time s after it starts, past the end it goes on at exit_speed */
+void sampleMotionProfile(const motion_profile_t* profile, double time, motion_sample_t* sample);
+
+/* motion profile time at
+ * First time the profile gets to position, 0 to profile->duration */
+double motionProfileTimeAt(const motion_profile_t* profile, double position);
+
+
+#endif //_MOTION_PROFILE_H_
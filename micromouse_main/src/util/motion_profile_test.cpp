@@ -0,0 +1,114 @@
+#ifndef ARDUINO
+#include <math.h>
+#include "motion_profile.h"
+#include "../testing.h"
+
+#define IS_BETWEEN_ERROR(x,y,e) (((x) < (y) + (e)) && ((x) > (y) - (e)))
+
+#define SAMPLE_STEP 1e-4    // s
+
+
+/* Sample profile every SAMPLE_STEP and check it stays within limits and ends where it should */
+bool withinLimits(const motion_limits_t* limits, const motion_profile_t* profile) {
+    motion_sample_t sample, previous;
+    sampleMotionProfile(profile, 0, &previous);
+    if (!IS_BETWEEN_ERROR(previous.speed, profile->entry_speed, 1e-9)) {
+        return false;
+    }
+    for (double time = SAMPLE_STEP; time < profile->duration + SAMPLE_STEP; time += SAMPLE_STEP) {
+        sampleMotionProfile(profile, time, &sample);
+        if (sample.speed < -1e-9 || sample.speed > limits->max_speed + 1e-9 ||
+                fabs(sample.accel) > limits->max_accel + 1e-9 || sample.position < previous.position - 1e-9) {
+            return false;
+        }
+        if (limits->max_jerk > 0 && fabs(sample.accel - previous.accel) > limits->max_jerk * SAMPLE_STEP + 1e-6) {
+            return false;
+        }
+        previous = sample;
+    }
+    sampleMotionProfile(profile, profile->duration, &sample);
+    return IS_BETWEEN_ERROR(sample.position, profile->distance, 1e-6) &&
+           IS_BETWEEN_ERROR(sample.speed, profile->exit_speed, 1e-6) && IS_BETWEEN_ERROR(sample.accel, 0, 1e-6);
+}
+
+
+TEST_FUNC_BEGIN {
+
+    motion_limits_t trapezoid = { .max_speed = 500, .max_accel = 1000, .max_jerk = 0 };
+    motion_limits_t s_curve = { .max_speed = 500, .max_accel = 1000, .max_jerk = 10000 };
+    motion_profile_t profile;
+
+    // Rest to rest, up in 0.5 s over 125 mm, cruise 750 mm, down the same
+    if (!planMotionProfile(&trapezoid, 1000, 0, 0, &profile) || !IS_BETWEEN_ERROR(profile.duration, 2.5, 1e-9) ||
+            profile.peak_speed != 500 || !withinLimits(&trapezoid, &profile)) {
+        TEST_FAIL("Trapezoid");
+    } else {
+        TEST_PASS("Trapezoid");
+    }
+
+    // Too short for max_speed, the peak is sqrt(distance * max_accel)
+    if (!planMotionProfile(&trapezoid, 100, 0, 0, &profile) || !IS_BETWEEN_ERROR(profile.peak_speed, sqrt(1e5), 1e-6) ||
+            !IS_BETWEEN_ERROR(profile.duration, 2 * sqrt(1e5) / 1000, 1e-9) || !withinLimits(&trapezoid, &profile)) {
+        TEST_FAIL("Triangle");
+    } else {
+        TEST_PASS("Triangle");
+    }
+
+    // Each jerk limited change takes max_accel / max_jerk longer than the trapezoid's
+    if (!planMotionProfile(&s_curve, 1000, 0, 0, &profile) || !IS_BETWEEN_ERROR(profile.duration, 2.6, 1e-9) ||
+            !withinLimits(&s_curve, &profile)) {
+        TEST_FAIL("S-curve");
+    } else {
+        TEST_PASS("S-curve");
+    }
+
+    bool all_within = true;
+    for (double distance = 0; distance < 1500; distance += 37.5) {
+        for (double entry = 0; entry <= 500; entry += 125) {
+            for (double exit = 0; exit <= 500; exit += 125) {
+                planMotionProfile(&s_curve, distance, entry, exit, &profile);
+                all_within = all_within && withinLimits(&s_curve, &profile);
+                planMotionProfile(&trapezoid, distance, entry, exit, &profile);
+                all_within = all_within && withinLimits(&trapezoid, &profile);
+            }
+        }
+    }
+    if (!all_within) {
+        TEST_FAIL("Limits over entry, exit and distance");
+    } else {
+        TEST_PASS("Limits over entry, exit and distance");
+    }
+
+    // 400 to 0 needs 80 mm at max_accel
+    if (planMotionProfile(&trapezoid, 50, 400, 0, &profile) || profile.exit_speed <= 0 ||
+            !IS_BETWEEN_ERROR(profile.exit_speed, sqrt(400.0 * 400.0 - 2 * 1000 * 50), 1e-6) ||
+            !withinLimits(&trapezoid, &profile)) {
+        TEST_FAIL("Unreachable exit speed");
+    } else {
+        TEST_PASS("Unreachable exit speed");
+    }
+
+    planMotionProfile(&s_curve, 700, 100, 200, &profile);
+    bool inverse = true;
+    for (double time = 0; time <= profile.duration; time += 0.01) {
+        motion_sample_t sample;
+        sampleMotionProfile(&profile, time, &sample);
+        inverse = inverse && IS_BETWEEN_ERROR(motionProfileTimeAt(&profile, sample.position), time, 1e-6);
+    }
+    if (!inverse) {
+        TEST_FAIL("Time at position");
+    } else {
+        TEST_PASS("Time at position");
+    }
+
+    motion_sample_t sample;
+    sampleMotionProfile(&profile, profile.duration + 1, &sample);
+    if (!IS_BETWEEN_ERROR(sample.position, 900, 1e-6) || sample.speed != 200) {
+        TEST_FAIL("Past the end");
+    } else {
+        TEST_PASS("Past the end");
+    }
+
+} TEST_FUNC_END("motion_profile_test")
+
+#endif // ARDUINO
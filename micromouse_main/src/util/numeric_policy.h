@@ -0,0 +1,51 @@
+/* numeric_policy.h
+ *
+ * Describes how the templated math kernels operate on each numeric
+ * backend. Every backend provides:
+ *  - sin(x), cos(x): trigonometry in radians
+ *  - floor(x): round toward negative infinity to an int
+ *  - toDouble(x): conversion for printing and comparisons on the host
+ *  - name(): a short label for benchmarks
+ */
+
+#ifndef _NUMERIC_POLICY_H_
+#define _NUMERIC_POLICY_H_
+
+#include <math.h>
+
+#include "fixed_point.h"
+
+
+template <typename T>
+struct numeric_policy;
+
+
+template <>
+struct numeric_policy<double> {
+    static double sin(double x) { return ::sin(x); }
+    static double cos(double x) { return ::cos(x); }
+    static int floor(double x) { int i = (int) x; return i - (x < i); }
+    static double toDouble(double x) { return x; }
+    static const char* name() { return "double"; }
+};
+
+template <>
+struct numeric_policy<float> {
+    static float sin(float x) { return ::sinf(x); }
+    static float cos(float x) { return ::cosf(x); }
+    static int floor(float x) { int i = (int) x; return i - (x < i); }
+    static double toDouble(float x) { return x; }
+    static const char* name() { return "float"; }
+};
+
+template <>
+struct numeric_policy<q16_16_t> {
+    static q16_16_t sin(q16_16_t x) { return ::sin(x); }
+    static q16_16_t cos(q16_16_t x) { return ::cos(x); }
+    static int floor(q16_16_t x) { return x.toInt(); }
+    static double toDouble(q16_16_t x) { return x.toDouble(); }
+    static const char* name() { return "q16.16"; }
+};
+
+
+#endif //_NUMERIC_POLICY_H_
@@ -0,0 +1,152 @@
+/* trig.h
+ *
+ * Trigonometry service shared by localization and movement
+ *
+ * sinCos() evaluates sine and cosine of the same angle in one call.
+ * With TRIG_LOOKUP_TABLE set in settings.h it interpolates linearly
+ * in a quarter wave table that is generated at compile time, so no
+ * libm call (and no soft float series) is made on the robot.
+ *
+ * Error of the table: linear interpolation over steps of
+ * h = (pi/2) / TRIG_TABLE_SIZE is bounded by h^2 / 8, about 1.2e-6
+ * for 512 steps, plus the rounding of the table's element type.
+ */
+
+#ifndef _TRIG_H_
+#define _TRIG_H_
+
+#include "numeric_policy.h"
+#include "../settings.h"
+
+
+#define TRIG_TABLE_SIZE 512     // Number of interpolation steps per quarter wave
+
+#ifdef TRIG_COUNT_CALLS
+// Number of sinCos evaluations, for benchmarks
+extern unsigned long trig_call_count;
+#endif
+
+
+/*----------- Table generation -----------*/
+
+/* Taylor series of sin(x) evaluated at compile time, good to double precision on [0, pi/2] */
+constexpr double constexprSin(double x, double term, double sum, int n) {
+    return n > 27 ? sum : constexprSin(x, -term * x * x / ((n + 1) * (n + 2)), sum + term, n + 2);
+}
+
+constexpr double constexprSin(double x) {
+    return constexprSin(x, x, 0.0, 1);
+}
+
+template <int... Is>
+struct trig_indices {
+};
+
+template <int N, int... Is>
+struct make_trig_indices : make_trig_indices<N - 1, N - 1, Is...> {
+};
+
+template <int... Is>
+struct make_trig_indices<0, Is...> {
+    typedef trig_indices<Is...> type;
+};
+
+template <typename T, typename Indices>
+struct sine_table_builder;
+
+template <typename T, int... Is>
+struct sine_table_builder<T, trig_indices<Is...> > {
+    static constexpr T values[sizeof...(Is)] = { T(constexprSin(HALF_PI * Is / TRIG_TABLE_SIZE))... };
+};
+
+template <typename T, int... Is>
+constexpr T sine_table_builder<T, trig_indices<Is...> >::values[sizeof...(Is)];
+
+/* The type the table is stored in for each backend, double uses a float table to halve the flash used */
+template <typename T> struct trig_table_type { typedef T type; };
+template <> struct trig_table_type<double> { typedef float type; };
+
+/* sin(i * (pi/2) / TRIG_TABLE_SIZE) for i in [0, TRIG_TABLE_SIZE] */
+template <typename T>
+struct sine_table : sine_table_builder<typename trig_table_type<T>::type,
+                                       typename make_trig_indices<TRIG_TABLE_SIZE + 1>::type> {
+};
+
+
+/*----------- Public Functions -----------*/
+
+/* Limit an angle to [0, 2 pi) */
+template <typename T>
+T wrapAngle(T angle) {
+    if (angle < 0) {
+        angle += TWO_PI;
+    } else if (angle >= TWO_PI) {
+        angle -= TWO_PI;
+    }
+
+    // Far out of range, only happens with bad input
+    if (angle < 0 || angle >= TWO_PI) {
+        angle -= TWO_PI * numeric_policy<T>::floor(angle / TWO_PI);
+        if (angle >= TWO_PI) angle -= TWO_PI;
+    }
+    return angle;
+}
+
+/* Difference a - b of two angles in [0, 2 pi), limited to [-pi, pi) */
+template <typename T>
+T angleDifference(T a, T b) {
+    T difference = a - b;
+    if (difference >= PI) {
+        difference -= TWO_PI;
+    } else if (difference < -PI) {
+        difference += TWO_PI;
+    }
+    return difference;
+}
+
+/* Sine and cosine of angle (in radians) from the interpolated table */
+template <typename T>
+void sinCosTable(T angle, T* sin_out, T* cos_out) {
+
+    typedef sine_table<T> table;
+
+    // Position in table steps over the full circle
+    T position = wrapAngle(angle) * (TRIG_TABLE_SIZE / HALF_PI);
+    int step = numeric_policy<T>::floor(position);
+    T fraction = position - step;
+
+    int quadrant = (step / TRIG_TABLE_SIZE) & 3;
+    int k = step % TRIG_TABLE_SIZE;
+
+    // sin and cos of the angle within the quadrant
+    T sin_q = table::values[k] + fraction * (table::values[k + 1] - table::values[k]);
+    T cos_q = table::values[TRIG_TABLE_SIZE - k] +
+                fraction * (table::values[TRIG_TABLE_SIZE - k - 1] - table::values[TRIG_TABLE_SIZE - k]);
+
+    switch (quadrant) {
+        default:
+        case 0: *sin_out = sin_q;   *cos_out = cos_q;   break;
+        case 1: *sin_out = cos_q;   *cos_out = -sin_q;  break;
+        case 2: *sin_out = -sin_q;  *cos_out = -cos_q;  break;
+        case 3: *sin_out = -cos_q;  *cos_out = sin_q;   break;
+    }
+}
+
+/* Sine and cosine of angle (in radians), from the table or libm depending on TRIG_LOOKUP_TABLE */
+template <typename T>
+void sinCos(T angle, T* sin_out, T* cos_out) {
+
+    #ifdef TRIG_COUNT_CALLS
+        trig_call_count++;
+    #endif
+
+    #ifdef TRIG_LOOKUP_TABLE
+        sinCosTable(angle, sin_out, cos_out);
+    #else
+        *sin_out = numeric_policy<T>::sin(angle);
+        *cos_out = numeric_policy<T>::cos(angle);
+    #endif
+}
+
+
+#endif //_TRIG_H_
@@ -0,0 +1,73 @@
+#ifndef ARDUINO
+#include <math.h>
+#include "trig.h"
+#include "../testing.h"
+#include "../settings.h"
+
+#define IS_BETWEEN_ERROR(x,y,e) (((x) < (y) + (e)) && ((x) > (y) - (e)))
+
+// h^2 / 8 for the table step plus float rounding of the table entries
+#define TABLE_ERROR (((HALF_PI / TRIG_TABLE_SIZE) * (HALF_PI / TRIG_TABLE_SIZE) / 8) + 1e-7)
+
+TEST_FUNC_BEGIN {
+
+    double max_error = 0.0;
+    for (double angle = -20.0; angle < 20.0; angle += 0.0001) {
+        double s, c;
+        sinCosTable(angle, &s, &c);
+        if (fabs(s - sin(angle)) > max_error) max_error = fabs(s - sin(angle));
+        if (fabs(c - cos(angle)) > max_error) max_error = fabs(c - cos(angle));
+    }
+    if (max_error > TABLE_ERROR) {
+        printf("max error: %g, bound: %g\n", max_error, TABLE_ERROR);
+        TEST_FAIL("Table error bound (double)");
+    } else {
+        TEST_PASS("Table error bound (double)");
+    }
+
+    max_error = 0.0;
+    for (double angle = -20.0; angle < 20.0; angle += 0.001) {
+        float s, c;
+        sinCosTable((float) angle, &s, &c);
+        if (fabs(s - sin((float) angle)) > max_error) max_error = fabs(s - sin((float) angle));
+        if (fabs(c - cos((float) angle)) > max_error) max_error = fabs(c - cos((float) angle));
+    }
+    if (max_error > TABLE_ERROR + 1e-6) {
+        TEST_FAIL("Table error bound (float)");
+    } else {
+        TEST_PASS("Table error bound (float)");
+    }
+
+    max_error = 0.0;
+    for (double angle = -20.0; angle < 20.0; angle += 0.001) {
+        q16_16_t s, c;
+        sinCosTable(q16_16_t(angle), &s, &c);
+        double a = q16_16_t(angle).toDouble();
+        if (fabs(s.toDouble() - sin(a)) > max_error) max_error = fabs(s.toDouble() - sin(a));
+        if (fabs(c.toDouble() - cos(a)) > max_error) max_error = fabs(c.toDouble() - cos(a));
+    }
+    if (max_error > TABLE_ERROR + 3.0 / Q16_16_ONE) {
+        TEST_FAIL("Table error bound (q16.16)");
+    } else {
+        TEST_PASS("Table error bound (q16.16)");
+    }
+
+    double s, c;
+    sinCosTable(0.0, &s, &c);
+    if (s != 0.0 || c != 1.0) {
+        TEST_FAIL("Table exact at zero");
+    } else {
+        TEST_PASS("Table exact at zero");
+    }
+
+    if (!IS_BETWEEN_ERROR(wrapAngle(-0.5), TWO_PI - 0.5, 1e-12) || !IS_BETWEEN_ERROR(wrapAngle(TWO_PI + 0.5), 0.5, 1e-12) ||
+            !IS_BETWEEN_ERROR(wrapAngle(100.0), fmod(100.0, TWO_PI), 1e-12) || wrapAngle(TWO_PI) != 0.0 ||
+            !IS_BETWEEN_ERROR(wrapAngle(-100.0), TWO_PI - fmod(100.0, TWO_PI), 1e-12)) {
+        TEST_FAIL("Angle wrapping");
+    } else {
+        TEST_PASS("Angle wrapping");
+    }
+
+} TEST_FUNC_END("trig_test")
+
+#endif // ARDUINO